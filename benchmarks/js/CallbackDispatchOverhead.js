@@ -0,0 +1,82 @@
+window.DefinePanel("CallbackDispatchOverhead");
+include('common.js');
+
+// Microbenchmark for the cost of entering and leaving JS callbacks (this is where the slow script watcher is notified).
+//
+// Two kinds of callbacks are measured:
+// - zero-delay timers: every callback is a separate outermost JS action, i.e. an idle watcher thread has to be woken up;
+// - `window.NotifyOthers()`: `on_notify_data` is invoked synchronously in other panels, i.e. a nested action.
+//   Add this script to at least two panels to get this result.
+//
+// Results are reported as an average time per callback, the cost of the callback body itself is negligible.
+
+const g_timer_callback_count = 20000;
+const g_notify_count = 100000;
+const g_notify_name = 'CallbackDispatchOverhead';
+
+let g_received_count = 0;
+
+function format_per_callback(name, total_ms, count) {
+    return `${name}: ${(total_ms * 1000 / count).toFixed(2)} us per callback (${count} callbacks in ${total_ms} ms)`;
+}
+
+// resolves when `count` timer callbacks were invoked one after another
+function run_timer_chain(count) {
+    return new Promise((resolve) => {
+        let profiler = fb.CreateProfiler();
+        let remaining = count;
+        const tick = () => {
+            if (--remaining) {
+                window.SetTimeout(tick, 0);
+            }
+            else {
+                resolve(profiler.Time);
+            }
+        };
+        window.SetTimeout(tick, 0);
+    });
+}
+
+function run_notify_burst(count) {
+    let profiler = fb.CreateProfiler();
+    for (let i = 0; i < count; ++i) {
+        window.NotifyOthers(g_notify_name, i);
+    }
+    return profiler.Time;
+}
+
+async function run_benchmark() {
+    let lines = [];
+
+    // the first callbacks of the chain might be delayed by the click handling
+    await run_timer_chain(100);
+    lines.push(format_per_callback('Zero-delay timer', await run_timer_chain(g_timer_callback_count), g_timer_callback_count));
+
+    g_received_count = 0;
+    const notify_ms = run_notify_burst(g_notify_count);
+    lines.push(g_received_count
+        ? format_per_callback('NotifyOthers', notify_ms, g_notify_count)
+        : 'NotifyOthers: skipped, add this script to another panel');
+
+    return lines;
+}
+
+function on_notify_data(name, info) {
+    if (name === g_notify_name) {
+        // replies only to the first message, so that receivers are detected without affecting the measurement
+        if (!info) {
+            window.NotifyOthers(`${g_notify_name}:ack`, 0);
+        }
+    }
+    else if (name === `${g_notify_name}:ack`) {
+        ++g_received_count;
+    }
+}
+
+function on_paint(gr) {
+    bench.paint(gr);
+}
+
+function on_mouse_lbtn_up() {
+    bench.start(run_benchmark);
+}
@@ -0,0 +1,90 @@
+window.DefinePanel("DrawList");
+include('common.js');
+
+// Paint throughput benchmark: compares painting a list-like view with immediate GdiGraphics calls
+// and with a recorded GdiDrawList.
+// The view itself is painted via the recorded list.
+
+const g_row_count = 60;
+const g_row_height = 22;
+const g_iteration_count = 200;
+const g_width = 600;
+const g_height = g_row_count * g_row_height;
+
+let g_draw_list = gdi.CreateDrawList();
+
+// 15 primitives per row
+function paint_row(gr, i) {
+    const y = i * g_row_height;
+    const bg = (i % 2) ? RGB(40, 40, 40) : RGB(50, 50, 50);
+
+    gr.FillSolidRect(0, y, g_width, g_row_height, bg);
+    gr.FillGradRect(0, y, 4, g_row_height, 90, RGB(255, 128, 0), RGB(255, 200, 0));
+    gr.DrawLine(0, y + g_row_height - 1, g_width, y + g_row_height - 1, 1, RGB(70, 70, 70));
+    gr.FillEllipse(8, y + 6, 10, 10, RGB(0, 160, 220));
+    gr.DrawEllipse(8, y + 6, 10, 10, 1, RGB(255, 255, 255));
+    gr.DrawString(`${i + 1}.`, bench.font, RGB(160, 160, 160), 24, y, 30, g_row_height, 0);
+    gr.DrawString(`Track title #${i + 1}`, bench.font, RGB(230, 230, 230), 56, y, 250, g_row_height, 0);
+    gr.DrawString('Artist', bench.font, RGB(180, 180, 180), 310, y, 150, g_row_height, 0);
+    gr.DrawString('3:45', bench.font, RGB(180, 180, 180), 540, y, 50, g_row_height, 0);
+    gr.FillRoundRect(470, y + 5, 60, 12, 4, 4, RGB(80, 80, 80));
+    gr.FillSolidRect(472, y + 7, (i * 7) % 56, 8, RGB(0, 200, 100));
+    gr.DrawRoundRect(470, y + 5, 60, 12, 4, 4, 1, RGB(120, 120, 120));
+    gr.DrawRect(1, y + 1, g_width - 2, g_row_height - 2, 1, RGB(60, 60, 60));
+    gr.FillSolidRect(g_width - 6, y + 4, 2, g_row_height - 8, RGB(100, 100, 100));
+    gr.DrawLine(g_width - 10, y + 4, g_width - 10, y + g_row_height - 4, 1, RGB(90, 90, 90));
+}
+
+function paint_immediate(gr) {
+    for (let i = 0; i < g_row_count; ++i) {
+        paint_row(gr, i);
+    }
+}
+
+function record() {
+    g_draw_list.Clear();
+    // GdiDrawList has the same recording methods as GdiGraphics
+    paint_immediate(g_draw_list);
+}
+
+function measure(fn) {
+    let img = gdi.CreateImage(g_width, g_height);
+    let gr = img.GetGraphics();
+    try {
+        let profiler = fb.CreateProfiler();
+        for (let i = 0; i < g_iteration_count; ++i) {
+            fn(gr);
+        }
+        return profiler.Time;
+    }
+    finally {
+        img.ReleaseGraphics(gr);
+    }
+}
+
+function run_benchmark() {
+    const record_time = measure(() => record());
+    const immediate_time = measure((gr) => paint_immediate(gr));
+    const replay_time = measure((gr) => gr.Replay(g_draw_list));
+
+    const per_frame = (time) => (time / g_iteration_count).toFixed(2);
+    return [
+        `Rows: ${g_row_count}, commands per frame: ${g_draw_list.Count}, frames: ${g_iteration_count}`,
+        `Immediate: ${immediate_time} ms (${per_frame(immediate_time)} ms per frame)`,
+        `Replay: ${replay_time} ms (${per_frame(replay_time)} ms per frame)`,
+        `Recording: ${record_time} ms (${per_frame(record_time)} ms per list)`
+    ];
+}
+
+function on_paint(gr) {
+    if (!g_draw_list.Count) {
+        record();
+    }
+
+    gr.Replay(g_draw_list);
+    bench.paint(gr, 0, 0, window.Width, 90);
+}
+
+function on_mouse_lbtn_up() {
+    bench.start(run_benchmark);
+}
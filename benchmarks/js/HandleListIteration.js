@@ -0,0 +1,135 @@
+window.DefinePanel("HandleListIteration");
+include('common.js');
+
+// Iteration benchmark: compares different ways of looping through a big FbMetadbHandleList.
+// Library items are repeated until the list contains `g_item_count` items.
+// Every method sums the track lengths: sums are compared to make sure that all methods visit the same handles.
+// Median times are drawn as bars.
+
+const g_item_count = 100000;
+const g_round_count = 5;
+const g_row_height = 20;
+
+const g_methods = [
+    {
+        name: 'Indexed access',
+        sum: (handle_list) => {
+            let total = 0;
+            for (let i = 0; i < handle_list.Count; ++i) {
+                total += handle_list[i].Length;
+            }
+            return total;
+        }
+    },
+    {
+        name: 'Convert()',
+        sum: (handle_list) => handle_list.Convert().reduce((total, handle) => total + handle.Length, 0)
+    },
+    {
+        name: 'for...of',
+        sum: (handle_list) => {
+            let total = 0;
+            for (const handle of handle_list) {
+                total += handle.Length;
+            }
+            return total;
+        }
+    },
+    {
+        name: 'ForEach()',
+        sum: (handle_list) => {
+            let total = 0;
+            handle_list.ForEach((handle) => {
+                total += handle.Length;
+            });
+            return total;
+        }
+    },
+    {
+        name: 'Map()',
+        sum: (handle_list) => handle_list.Map((handle) => handle.Length).reduce((total, length) => total + length, 0)
+    },
+    {
+        name: 'ToArrayView()',
+        sum: (handle_list) => {
+            let total = 0;
+            const view = handle_list.ToArrayView();
+            for (let i = 0; i < view.length; ++i) {
+                total += view[i].Length;
+            }
+            return total;
+        }
+    }
+];
+
+// { name, ms, is_valid }
+let g_rows = [];
+
+function create_list() {
+    const library_items = fb.GetLibraryItems();
+    if (!library_items.Count) {
+        return null;
+    }
+
+    let handle_list = new FbMetadbHandleList();
+    while (handle_list.Count < g_item_count) {
+        handle_list.AddRange(library_items);
+    }
+    handle_list.RemoveRange(g_item_count, handle_list.Count - g_item_count);
+    return handle_list;
+}
+
+function run_benchmark() {
+    g_rows = [];
+    const handle_list = create_list();
+    if (!handle_list) {
+        return ['Media library is empty'];
+    }
+
+    let times = g_methods.map(() => []);
+    let sums = g_methods.map(() => null);
+    // methods are interleaved, so that GC and caches affect all of them equally
+    for (let round = 0; round < g_round_count; ++round) {
+        g_methods.forEach((method, idx) => {
+            let profiler = fb.CreateProfiler();
+            sums[idx] = method.sum(handle_list);
+            times[idx].push(profiler.Time);
+        });
+    }
+
+    g_rows = g_methods.map((method, idx) => ({
+        name: method.name,
+        ms: bench.median(times[idx]),
+        // lengths are not integer, but they are added in the same order by every method
+        is_valid: sums[idx] === sums[0]
+    }));
+
+    return [
+        `${handle_list.Count} items, median of ${g_round_count} rounds:`,
+        ...g_rows.map((row) => `  ${row.name}: ${row.ms} ms${row.is_valid ? '' : ' (WRONG SUM)'}`)
+    ];
+}
+
+function on_paint(gr) {
+    if (!g_rows.length) {
+        bench.paint(gr);
+        return;
+    }
+
+    gr.FillSolidRect(0, 0, window.Width, window.Height, RGB(30, 30, 30));
+    gr.GdiDrawText(bench.lines[0], bench.font, RGB(255, 255, 255), 5, 5, window.Width - 10, g_row_height, DT_LEFT | DT_VCENTER | DT_SINGLELINE);
+
+    const max_ms = Math.max(1, ...g_rows.map((row) => row.ms));
+    const label_width = 110;
+    const bar_width = Math.max(0, window.Width - label_width - 80);
+    g_rows.forEach((row, idx) => {
+        const y = 5 + (idx + 1) * g_row_height;
+        gr.GdiDrawText(row.name, bench.font, RGB(220, 220, 220), 5, y, label_width, g_row_height, DT_LEFT | DT_VCENTER | DT_SINGLELINE);
+        gr.FillSolidRect(label_width, y + 3, Math.max(1, Math.round(bar_width * row.ms / max_ms)), g_row_height - 6, row.is_valid ? RGB(80, 160, 230) : RGB(230, 70, 70));
+        gr.GdiDrawText(`${row.ms} ms`, bench.font, RGB(220, 220, 220), label_width + bar_width + 5, y, 75, g_row_height, DT_LEFT | DT_VCENTER | DT_SINGLELINE);
+    });
+}
+
+function on_mouse_lbtn_up() {
+    bench.start(run_benchmark);
+}
@@ -0,0 +1,119 @@
+window.DefinePanel("ImageResampler");
+include('common.js');
+
+// Reference checks and benchmark for the native resampler (Box, Mitchell and Lanczos3 modes of GdiBitmap.Resize()).
+//
+// Reference checks compare results with values that are known exactly:
+// - flat colour stays exactly the same with any filter and any size;
+// - box downscale by an integer factor is the average of the source block (+-1 for rounding);
+// - opaque images stay opaque (edges are not blended with transparent pixels).
+//
+// Benchmark compares native filters with GdiPlus modes on a 4K image.
+
+const g_native_modes = [
+    { name: 'Box', mode: InterpolationMode.Box },
+    { name: 'Mitchell', mode: InterpolationMode.Mitchell },
+    { name: 'Lanczos3', mode: InterpolationMode.Lanczos3 }
+];
+const g_gdiplus_modes = [
+    { name: 'HighQualityBilinear (GdiPlus)', mode: InterpolationMode.HighQualityBilinear },
+    { name: 'HighQualityBicubic (GdiPlus)', mode: InterpolationMode.HighQualityBicubic }
+];
+const g_sizes = [[1, 1], [37, 23], [160, 90], [333, 517], [1200, 700]];
+const g_bench_size = [3840, 2160];
+const g_bench_targets = [[1920, 1080], [300, 169], [7680, 4320]];
+const g_bench_run_count = 3;
+
+function create_image(w, h, pixel_fn) {
+    let pixels = new Uint32Array(w * h);
+    for (let i = 0; i < pixels.length; ++i) {
+        pixels[i] = pixel_fn(i);
+    }
+    return { img: gdi.CreateImageFromBuffer(w, h, pixels), pixels: pixels };
+}
+
+function random_opaque_pixel() {
+    return (0xFF000000 | (Math.random() * 0x1000000)) >>> 0;
+}
+
+function read_pixels(img) {
+    // copy: array is detached on unlock
+    const pixels = new Uint32Array(img.LockPixels().buffer).slice();
+    img.UnlockPixels();
+    return pixels;
+}
+
+function check_flat_colour(filter) {
+    const colour = 0xFF3A7BC4;
+    const src = create_image(300, 200, () => colour).img;
+    return g_sizes.every(([w, h]) => read_pixels(src.Resize(w, h, filter.mode)).every((pixel) => pixel === colour));
+}
+
+function check_box_average(factor) {
+    const w = 64 * factor;
+    const h = 48 * factor;
+    const src = create_image(w, h, random_opaque_pixel);
+    const dst = read_pixels(src.img.Resize(w / factor, h / factor, InterpolationMode.Box));
+
+    const dst_w = w / factor;
+    for (let i = 0; i < dst.length; ++i) {
+        const x0 = (i % dst_w) * factor;
+        const y0 = Math.floor(i / dst_w) * factor;
+        for (const shift of [0, 8, 16]) {
+            let sum = 0;
+            for (let y = y0; y < y0 + factor; ++y) {
+                for (let x = x0; x < x0 + factor; ++x) {
+                    sum += (src.pixels[y * w + x] >>> shift) & 0xFF;
+                }
+            }
+            const expected = sum / (factor * factor);
+            if (Math.abs(((dst[i] >>> shift) & 0xFF) - expected) > 1) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+function check_opaque_edges(filter) {
+    const src = create_image(257, 131, random_opaque_pixel).img;
+    return g_sizes.every(([w, h]) => read_pixels(src.Resize(w, h, filter.mode)).every((pixel) => (pixel >>> 24) === 0xFF));
+}
+
+function run_checks() {
+    const result = (ok) => ok ? 'ok' : 'FAILED';
+    let lines = ['Reference checks:'];
+    for (const filter of g_native_modes) {
+        lines.push(`  ${filter.name}: flat colour ${result(check_flat_colour(filter))}, opaque edges ${result(check_opaque_edges(filter))}`);
+    }
+    for (const factor of [2, 3, 4]) {
+        lines.push(`  Box 1/${factor} average: ${result(check_box_average(factor))}`);
+    }
+    return lines;
+}
+
+function run_benchmark() {
+    const [src_w, src_h] = g_bench_size;
+    let src = gdi.CreateImage(src_w, src_h);
+    let gr = src.GetGraphics();
+    gr.FillGradRect(0, 0, src_w, src_h, 30, 0xFF1E5AA0, 0xFFF0B040);
+    gr.FillEllipse(src_w / 4, src_h / 4, src_w / 2, src_h / 2, 0xC0FFFFFF);
+    src.ReleaseGraphics(gr);
+
+    let lines = [`Benchmark (${src_w}x${src_h} source, fastest of ${g_bench_run_count}):`];
+    for (const [w, h] of g_bench_targets) {
+        lines.push(`  to ${w}x${h}:`);
+        for (const filter of [...g_gdiplus_modes, ...g_native_modes]) {
+            lines.push(`    ${filter.name}: ${bench.fastest_ms(g_bench_run_count, () => src.Resize(w, h, filter.mode))} ms`);
+        }
+    }
+    return lines;
+}
+
+function on_paint(gr) {
+    bench.paint(gr);
+}
+
+function on_mouse_lbtn_up() {
+    bench.start(() => [...run_checks(), '', ...run_benchmark()]);
+}
@@ -0,0 +1,119 @@
+window.DefinePanel("PixelKernels");
+include('common.js');
+
+// Pixel kernel check and benchmark for GdiBitmap.ApplyEffect(), ApplyAlpha() and ApplyMask().
+//
+// Check: kernels process four pixels at a time with SIMD and the rest of the row with scalar code.
+// Test images are 7 pixels wide: the first 4 pixels of every row go through the SIMD path
+// and the last 3 (copies of the SIMD pixels of the same row) go through the scalar path,
+// so both paths must produce identical results.
+//
+// Benchmark: every operation is applied to a 4K image, the fastest of several runs is reported.
+// Plain JS loop over LockPixels() is measured as a baseline.
+
+const g_check_width = 7;
+const g_check_height = 16384;
+const g_bench_width = 3840;
+const g_bench_height = 2160;
+const g_bench_run_count = 5;
+
+// ApplyEffect() modifies the image in place
+function effect(...args) {
+    return (img) => {
+        img.ApplyEffect(...args);
+        return img;
+    };
+}
+
+// every operation returns the resulting image
+const g_operations = [
+    { name: 'Greyscale', apply: effect(ImageEffect.Greyscale) },
+    { name: 'Invert', apply: effect(ImageEffect.Invert) },
+    { name: 'Brightness +60', apply: effect(ImageEffect.Brightness, 60) },
+    { name: 'Brightness -60', apply: effect(ImageEffect.Brightness, -60) },
+    { name: 'Contrast 40%', apply: effect(ImageEffect.Contrast, 40) },
+    { name: 'Contrast 250%', apply: effect(ImageEffect.Contrast, 250) },
+    { name: 'Tint', apply: effect(ImageEffect.Tint, 100, 0xFF3080C0) },
+    { name: 'ApplyAlpha', apply: (img) => img.ApplyAlpha(77) },
+    { name: 'ApplyMask', apply: (img, mask) => { img.ApplyMask(mask); return img; } }
+];
+
+function random_pixel() {
+    return (Math.random() * 0x100000000) >>> 0;
+}
+
+function create_check_image() {
+    let pixels = new Uint32Array(g_check_width * g_check_height);
+    for (let y = 0; y < g_check_height; ++y) {
+        const row = y * g_check_width;
+        for (let x = 0; x < 4; ++x) {
+            pixels[row + x] = random_pixel();
+        }
+        // rotate the source lanes, so that every SIMD lane is compared
+        for (let x = 4; x < g_check_width; ++x) {
+            pixels[row + x] = pixels[row + (x + y) % 4];
+        }
+    }
+    // premultiplied=false: GDI+ conversion is the same for both copies of a pixel
+    return gdi.CreateImageFromBuffer(g_check_width, g_check_height, pixels);
+}
+
+function count_mismatches(img) {
+    const pixels = new Uint32Array(img.LockPixels().buffer);
+    let mismatches = 0;
+    for (let y = 0; y < g_check_height; ++y) {
+        const row = y * g_check_width;
+        for (let x = 4; x < g_check_width; ++x) {
+            if (pixels[row + x] !== pixels[row + (x + y) % 4]) {
+                ++mismatches;
+            }
+        }
+    }
+    img.UnlockPixels();
+    return mismatches;
+}
+
+function run_check() {
+    let lines = ['SIMD vs scalar:'];
+    for (const op of g_operations) {
+        // mask is built the same way, so its pixels are paired too
+        const result = op.apply(create_check_image(), create_check_image());
+        const mismatches = count_mismatches(result);
+        lines.push(`  ${op.name}: ${mismatches ? `FAILED (${mismatches} mismatches)` : 'ok'}`);
+    }
+    return lines;
+}
+
+function run_benchmark() {
+    const mpix = g_bench_width * g_bench_height / 1000000;
+    const create_image = () => {
+        let img = gdi.CreateImage(g_bench_width, g_bench_height);
+        let gr = img.GetGraphics();
+        gr.FillGradRect(0, 0, g_bench_width, g_bench_height, 45, 0xFF2060A0, 0x80E0A040);
+        img.ReleaseGraphics(gr);
+        return img;
+    };
+    const format = (name, ms) => `  ${name}: ${ms} ms (${(mpix / Math.max(ms, 1) * 1000).toFixed(0)} Mpix/s)`;
+
+    let lines = [`Benchmark (${g_bench_width}x${g_bench_height}, fastest of ${g_bench_run_count}):`];
+    lines.push(format('JS loop (invert)', bench.fastest_ms(g_bench_run_count, (img) => {
+        // native premultiplied pixels are not copied: only the loop itself is measured
+        let pixels = new Uint32Array(img.LockPixels().buffer);
+        for (let i = 0; i < pixels.length; ++i) {
+            pixels[i] ^= 0x00FFFFFF;
+        }
+        img.UnlockPixels();
+    }, () => [create_image()])));
+    for (const op of g_operations) {
+        lines.push(format(op.name, bench.fastest_ms(g_bench_run_count, op.apply, () => [create_image(), create_image()])));
+    }
+    return lines;
+}
+
+function on_paint(gr) {
+    bench.paint(gr);
+}
+
+function on_mouse_lbtn_up() {
+    bench.start(() => [...run_check(), '', ...run_benchmark()]);
+}
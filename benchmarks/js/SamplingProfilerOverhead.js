@@ -0,0 +1,60 @@
+window.DefinePanel("SamplingProfilerOverhead");
+include('common.js');
+
+// Sampling profiler overhead benchmark: runs the same workload with the profiler stopped
+// and with the profiler sampling at 1 kHz and compares the fastest of several runs.
+// Note: collected profile is saved to `<profile>\foo_spider_monkey_panel\profiler\`.
+
+const g_run_count = 5;
+const g_frequency = 1000;
+// watcher thread needs some time to notice that the profiler was started
+const g_profiler_warmup_ms = 1500;
+
+// mix of pure JS code and native calls
+function fib(n) {
+    return (n < 2) ? n : fib(n - 1) + fib(n - 2);
+}
+
+function workload() {
+    let result = fib(27);
+    let text = '';
+    for (let i = 0; i < 20000; ++i) {
+        text = utils.FormatDuration(i);
+        result += text.length;
+    }
+    return result;
+}
+
+function sleep(ms) {
+    return new Promise((resolve) => window.SetTimeout(resolve, ms));
+}
+
+async function run_benchmark() {
+    const baseline_time = bench.fastest_ms(g_run_count, workload);
+
+    fb.StartSamplingProfiler(g_frequency);
+    let profiled_time;
+    try {
+        await sleep(g_profiler_warmup_ms);
+        profiled_time = bench.fastest_ms(g_run_count, workload);
+    }
+    finally {
+        fb.StopSamplingProfiler();
+    }
+
+    const overhead = (profiled_time - baseline_time) / baseline_time * 100;
+    return [
+        `Fastest of ${g_run_count} runs`,
+        `Profiler stopped: ${baseline_time} ms`,
+        `Profiler at ${g_frequency} Hz: ${profiled_time} ms`,
+        `Overhead: ${overhead.toFixed(2)}%`
+    ];
+}
+
+function on_paint(gr) {
+    bench.paint(gr);
+}
+
+function on_mouse_lbtn_up() {
+    bench.start(run_benchmark);
+}
@@ -0,0 +1,90 @@
+window.DefinePanel("TextFileLineIndex");
+include('common.js');
+
+// Line index benchmark for TextFileReader (see utils.OpenTextFile).
+// A test file of `g_file_size_mb` megabytes is generated in the temp directory before every run and is deleted afterwards
+// (it is written in 1 MB pieces, so the script never holds the whole file in memory).
+
+const g_file_size_mb = 64;
+const g_window_count = 1000;
+const g_window_lines = 100;
+
+function generate_file(fso) {
+    const path = `${fso.GetSpecialFolder(2).Path}\\${fso.GetTempName()}`;
+
+    // lines of varying length, like in a real log file
+    let piece = '';
+    for (let i = 0; piece.length < 1024 * 1024; ++i) {
+        piece += `[${utils.FormatDuration(i)}] message #${i}: ${'x'.repeat(i % 120)}\r\n`;
+    }
+
+    let stream = fso.CreateTextFile(path, true);
+    for (let i = 0; i < g_file_size_mb; ++i) {
+        stream.Write(piece);
+    }
+    stream.Close();
+
+    return path;
+}
+
+function time_ms(fn) {
+    let profiler = fb.CreateProfiler();
+    fn();
+    return profiler.Time;
+}
+
+function measure(path) {
+    let results = [];
+    let reader;
+    results.push(`Open: ${time_ms(() => reader = utils.OpenTextFile(path, 65001))} ms`);
+
+    try {
+        let line_count;
+        results.push(`Line index (LineCount): ${time_ms(() => line_count = reader.LineCount)} ms`);
+        results.push(`Second LineCount: ${time_ms(() => reader.LineCount)} ms`);
+
+        results.push(`Last ${g_window_lines} lines: ${time_ms(() => reader.ReadLines(line_count - g_window_lines, g_window_lines))} ms`);
+
+        // random access: served by the sparse index
+        results.push(`${g_window_count} random windows of ${g_window_lines} lines: ${time_ms(() => {
+            for (let i = 0; i < g_window_count; ++i) {
+                const start = Math.floor(Math.random() * (line_count - g_window_lines));
+                reader.ReadLines(start, g_window_lines);
+            }
+        })} ms`);
+
+        let chunk_count = 0;
+        results.push(`Sequential 1 MB chunks: ${time_ms(() => {
+            reader.Seek(0);
+            while (reader.ReadChunk(1024 * 1024) !== null) {
+                ++chunk_count;
+            }
+        })} ms`);
+
+        results.unshift(`File: ${g_file_size_mb} MB, ${line_count} lines, ${chunk_count} chunks`);
+    }
+    finally {
+        reader.Close();
+    }
+
+    return results;
+}
+
+function run_benchmark() {
+    const fso = new ActiveXObject('Scripting.FileSystemObject');
+    const path = generate_file(fso);
+    try {
+        return measure(path);
+    }
+    finally {
+        fso.DeleteFile(path);
+    }
+}
+
+function on_paint(gr) {
+    bench.paint(gr);
+}
+
+function on_mouse_lbtn_up() {
+    bench.start(run_benchmark);
+}
@@ -0,0 +1,68 @@
+// Shared code of benchmark scripts: timing helpers and the click-to-run report.
+// Included by every benchmark via a relative path, see ../README.md.
+
+include(`${fb.ComponentPath}docs\\Flags.js`);
+include(`${fb.ComponentPath}docs\\Helpers.js`);
+
+const bench = {
+    font: gdi.Font('Segoe UI', 12),
+    lines: ['Click the panel to run'],
+    is_running: false,
+
+    /**
+     * @param {number} run_count
+     * @param {function(...*)} fn Measured function, receives the result of `prepare`
+     * @param {function(): Array=} prepare Invoked before every run, not measured
+     * @return {number} Fastest run time in ms
+     */
+    fastest_ms(run_count, fn, prepare = () => []) {
+        let fastest = Infinity;
+        for (let i = 0; i < run_count; ++i) {
+            const args = prepare();
+            let profiler = fb.CreateProfiler();
+            fn(...args);
+            fastest = Math.min(fastest, profiler.Time);
+        }
+        return fastest;
+    },
+
+    median(values) {
+        const sorted = [...values].sort((a, b) => a - b);
+        return sorted[Math.floor(sorted.length / 2)];
+    },
+
+    report(lines) {
+        this.lines = lines;
+        lines.forEach((line) => console.log(line));
+        window.Repaint();
+    },
+
+    /**
+     * Runs the benchmark, unless it's already running.
+     * Panel is repainted before the benchmark is started, since the latter usually blocks the main thread.
+     *
+     * @param {function(): (Array<string>|Promise<Array<string>>)} run Returns report lines
+     */
+    start(run) {
+        if (this.is_running) {
+            return;
+        }
+
+        this.is_running = true;
+        this.report(['Running...']);
+        window.SetTimeout(() => {
+            Promise.resolve()
+                .then(run)
+                .catch((e) => [`Error: ${e.message}`])
+                .then((lines) => {
+                    this.is_running = false;
+                    this.report(lines);
+                });
+        }, 50);
+    },
+
+    paint(gr, x = 0, y = 0, w = window.Width, h = window.Height) {
+        gr.FillSolidRect(x, y, w, h, RGBA(0, 0, 0, 200));
+        gr.GdiDrawText(this.lines.join('\n'), this.font, RGB(255, 255, 255), x + 5, y + 5, w - 10, h - 10, DT_LEFT | DT_WORDBREAK);
+    }
+};
@@ -0,0 +1,163 @@
+#pragma once
+
+// Shared code of native tests and benchmarks: test images, checks and timing.
+
+#include <utils/pixel_kernels.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace bench
+{
+
+/// @brief 32bpp image with padded rows: padding is filled with a guard value to detect out of bounds writes
+class Image
+{
+public:
+    static constexpr uint32_t kGuard = 0xdeadbeef;
+
+    Image( uint32_t width, uint32_t height, uint32_t padding = 3 )
+        : width_( width )
+        , height_( height )
+        , stride_( width + padding )
+        , pixels_( static_cast<size_t>( stride_ ) * height, kGuard )
+    {
+    }
+
+    /// @param bottomUp Rows are addressed with a negative stride, like in a bottom-up DIB
+    smp::pixels::PixelView GetView( bool bottomUp = false )
+    {
+        const auto strideBytes = static_cast<int32_t>( stride_ * sizeof( uint32_t ) );
+        if ( bottomUp )
+        {
+            auto* pLastRow = reinterpret_cast<uint8_t*>( pixels_.data() + static_cast<size_t>( stride_ ) * ( height_ - 1 ) );
+            return { pLastRow, width_, height_, -strideBytes };
+        }
+        return { reinterpret_cast<uint8_t*>( pixels_.data() ), width_, height_, strideBytes };
+    }
+
+    uint32_t& At( uint32_t x, uint32_t y )
+    {
+        return pixels_[static_cast<size_t>( y ) * stride_ + x];
+    }
+
+    template <typename Fn>
+    void Fill( Fn&& fn )
+    {
+        for ( uint32_t y = 0; y < height_; ++y )
+        {
+            for ( uint32_t x = 0; x < width_; ++x )
+            {
+                At( x, y ) = fn( x, y );
+            }
+        }
+    }
+
+    /// @brief Random pixels, with extra weight on the edge values of channels (0, 1, 127, 128, 254, 255)
+    void FillRandom( std::mt19937& rng, bool premultiplied = false )
+    {
+        std::uniform_int_distribution<uint32_t> channelDist( 0, 255 );
+        std::uniform_int_distribution<uint32_t> edgeDist( 0, 11 );
+        const uint8_t edges[] = { 0, 1, 127, 128, 254, 255 };
+        const auto channel = [&] {
+            const uint32_t i = edgeDist( rng );
+            return ( i < std::size( edges ) ? edges[i] : channelDist( rng ) );
+        };
+
+        Fill( [&]( uint32_t, uint32_t ) {
+            const uint32_t a = channel();
+            uint32_t rgb[3] = { channel(), channel(), channel() };
+            if ( premultiplied )
+            {
+                for ( auto& value: rgb )
+                {
+                    value = value * a / 255;
+                }
+            }
+            return ( a << 24 ) | ( rgb[0] << 16 ) | ( rgb[1] << 8 ) | rgb[2];
+        } );
+    }
+
+    uint32_t Width() const
+    {
+        return width_;
+    }
+
+    uint32_t Height() const
+    {
+        return height_;
+    }
+
+    /// @brief Compares pixels and padding
+    bool operator==( const Image& other ) const
+    {
+        return width_ == other.width_ && height_ == other.height_ && pixels_ == other.pixels_;
+    }
+
+    bool IsPaddingIntact() const
+    {
+        for ( uint32_t y = 0; y < height_; ++y )
+        {
+            for ( uint32_t x = width_; x < stride_; ++x )
+            {
+                if ( pixels_[static_cast<size_t>( y ) * stride_ + x] != kGuard )
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    uint32_t width_;
+    uint32_t height_;
+    uint32_t stride_; ///< in pixels
+    std::vector<uint32_t> pixels_;
+};
+
+/// @brief Counts failed checks, `main` of the test returns non-zero if any has failed
+class Checker
+{
+public:
+    void Check( bool condition, const char* what, uint32_t width, uint32_t height )
+    {
+        ++checkCount_;
+        if ( !condition )
+        {
+            ++failureCount_;
+            std::printf( "FAILED: %s (%ux%u)\n", what, width, height );
+        }
+    }
+
+    int Finish() const
+    {
+        std::printf( "%zu checks, %zu failed\n", checkCount_, failureCount_ );
+        return ( failureCount_ ? 1 : 0 );
+    }
+
+private:
+    size_t checkCount_ = 0;
+    size_t failureCount_ = 0;
+};
+
+/// @return Fastest run time in ms
+template <typename Fn>
+double FastestMs( size_t runCount, Fn&& fn )
+{
+    double fastest = 1e300;
+    for ( size_t i = 0; i < runCount; ++i )
+    {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        fastest = std::min( fastest, elapsed.count() );
+    }
+    return fastest;
+}
+
+} // namespace bench
@@ -0,0 +1,69 @@
+// Throughput of image resampler (utils/image_resampler_impl.h): scalar vs SIMD, single thread.
+
+#include "common.h"
+
+#include <utils/image_resampler_impl.h>
+
+using namespace smp::pixels;
+using namespace smp::pixels::impl;
+
+namespace
+{
+
+constexpr size_t kRunCount = 5;
+
+struct ResampleCase
+{
+    const char* name;
+    ResampleFilter filter;
+    uint32_t srcWidth;
+    uint32_t srcHeight;
+    uint32_t dstWidth;
+    uint32_t dstHeight;
+};
+
+template <bool kUseSimd>
+double Measure( bench::Image& src, bench::Image& dst, ResampleFilter filter )
+{
+    const auto srcView = src.GetView();
+    const auto dstView = dst.GetView();
+    return bench::FastestMs( kRunCount, [&] {
+        impl::Resample<kUseSimd>( srcView, dstView, filter, []( uint32_t height, size_t, auto&& fn ) { fn( 0, height ); } );
+    } );
+}
+
+} // namespace
+
+int main()
+{
+    const ResampleCase cases[] = {
+        { "box", ResampleFilter::box, 3840, 2160, 1920, 1080 },
+        { "mitchell", ResampleFilter::mitchell, 3840, 2160, 1920, 1080 },
+        { "lanczos3", ResampleFilter::lanczos3, 3840, 2160, 1920, 1080 },
+        { "box", ResampleFilter::box, 1920, 1080, 300, 300 },
+        { "mitchell", ResampleFilter::mitchell, 1920, 1080, 300, 300 },
+        { "lanczos3", ResampleFilter::lanczos3, 1920, 1080, 300, 300 },
+        { "mitchell", ResampleFilter::mitchell, 500, 500, 1920, 1080 },
+        { "lanczos3", ResampleFilter::lanczos3, 500, 500, 1920, 1080 },
+    };
+
+    std::printf( "Fastest of %zu runs, SIMD: %s\n", kRunCount, kHasSimd ? "SSE2" : "not available" );
+    std::printf( "%-9s %-22s %13s | %13s |\n", "filter", "size", "scalar", "SIMD" );
+
+    std::mt19937 rng( 42 );
+    for ( const auto& resampleCase: cases )
+    {
+        bench::Image src( resampleCase.srcWidth, resampleCase.srcHeight, 0 );
+        src.FillRandom( rng, true );
+        bench::Image dst( resampleCase.dstWidth, resampleCase.dstHeight, 0 );
+
+        const double scalarMs = Measure<false>( src, dst, resampleCase.filter );
+        const double simdMs = Measure<true>( src, dst, resampleCase.filter );
+
+        std::printf( "%-9s %4ux%-4u -> %4ux%-4u %10.2f ms | %10.2f ms | x%.2f\n",
+                     resampleCase.name, resampleCase.srcWidth, resampleCase.srcHeight, resampleCase.dstWidth, resampleCase.dstHeight,
+                     scalarMs, simdMs, scalarMs / simdMs );
+    }
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+// Checks image resampler (utils/image_resampler_impl.h): analytic cases and bit-exactness of SIMD and scalar versions.
+
+#include "common.h"
+
+#include <utils/image_resampler_impl.h>
+
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+using namespace smp::pixels;
+using namespace smp::pixels::impl;
+
+namespace
+{
+
+const ResampleFilter kFilters[] = { ResampleFilter::box, ResampleFilter::mitchell, ResampleFilter::lanczos3 };
+
+const char* GetFilterName( ResampleFilter filter )
+{
+    switch ( filter )
+    {
+    case ResampleFilter::box:
+        return "box";
+    case ResampleFilter::mitchell:
+        return "mitchell";
+    case ResampleFilter::lanczos3:
+        return "lanczos3";
+    default:
+        return "unknown";
+    }
+}
+
+/// @brief Processes all rows at once
+void ForAllRows( uint32_t height, size_t, const std::function<void( uint32_t, uint32_t )>& fn )
+{
+    fn( 0, height );
+}
+
+/// @brief Processes rows one by one, like a worst case split between threads
+void ForEachRow( uint32_t height, size_t, const std::function<void( uint32_t, uint32_t )>& fn )
+{
+    for ( uint32_t y = 0; y < height; ++y )
+    {
+        fn( y, y + 1 );
+    }
+}
+
+template <bool kUseSimd>
+bench::Image Resample( bench::Image& src, uint32_t width, uint32_t height, ResampleFilter filter, bool bottomUp = false )
+{
+    bench::Image dst( width, height );
+    impl::Resample<kUseSimd>( src.GetView( bottomUp ), dst.GetView( bottomUp ), filter, ForAllRows );
+    return dst;
+}
+
+std::string GetCaseName( const char* name, ResampleFilter filter, uint32_t srcWidth, uint32_t srcHeight )
+{
+    return std::string( name ) + " [" + GetFilterName( filter ) + ", from " + std::to_string( srcWidth ) + "x" + std::to_string( srcHeight ) + "]";
+}
+
+uint32_t AverageChannels( uint32_t a, uint32_t b )
+{
+    uint32_t result = 0;
+    for ( int shift = 0; shift < 32; shift += 8 )
+    {
+        result |= ( ( ( ( a >> shift ) & 0xff ) + ( ( b >> shift ) & 0xff ) + 1 ) >> 1 ) << shift;
+    }
+    return result;
+}
+
+void CheckConstantImage( bench::Checker& checker )
+{
+    const uint32_t colours[] = { 0x00000000, 0xffffffff, 0x80402010, 0x01010000, 0xfe7f00fe };
+    const uint32_t sizes[][4] = { { 37, 23, 100, 7 }, { 64, 64, 17, 5 }, { 5, 5, 1, 1 }, { 1, 1, 13, 9 }, { 300, 2, 7, 3 } };
+
+    for ( auto filter: kFilters )
+    {
+        for ( const auto& size: sizes )
+        {
+            for ( uint32_t colour: colours )
+            {
+                bench::Image src( size[0], size[1] );
+                src.Fill( [colour]( uint32_t, uint32_t ) { return colour; } );
+
+                bench::Image expected( size[2], size[3] );
+                expected.Fill( [colour]( uint32_t, uint32_t ) { return colour; } );
+
+                auto dst = Resample<kHasSimd>( src, size[2], size[3], filter );
+                const bool isConstant = ( dst == expected );
+                checker.Check( isConstant,
+                               GetCaseName( "constant image stays constant", filter, size[0], size[1] ).c_str(), size[2], size[3] );
+            }
+        }
+    }
+}
+
+void CheckIdentity( bench::Checker& checker, std::mt19937& rng )
+{
+    for ( auto filter: kFilters )
+    {
+        for ( bool bottomUp: { false, true } )
+        {
+            bench::Image src( 33, 17 );
+            src.FillRandom( rng, true );
+
+            auto dst = Resample<kHasSimd>( src, src.Width(), src.Height(), filter, bottomUp );
+            checker.Check( dst == src, GetCaseName( "1:1 is a copy", filter, src.Width(), src.Height() ).c_str(), src.Width(), src.Height() );
+        }
+    }
+}
+
+void CheckBox( bench::Checker& checker, std::mt19937& rng )
+{
+    bench::Image src( 64, 32 );
+    src.FillRandom( rng, true );
+
+    { // 2:1 horizontal: average of two adjacent pixels
+        auto dst = Resample<kHasSimd>( src, 32, 32, ResampleFilter::box );
+        bool isExpected = true;
+        for ( uint32_t y = 0; y < 32; ++y )
+        {
+            for ( uint32_t x = 0; x < 32; ++x )
+            {
+                isExpected = isExpected && ( dst.At( x, y ) == AverageChannels( src.At( 2 * x, y ), src.At( 2 * x + 1, y ) ) );
+            }
+        }
+        checker.Check( isExpected, "box 2:1 horizontal is the average of two pixels", 32, 32 );
+    }
+
+    { // 2:1 both dimensions: average of rows of the horizontal averages (each pass is rounded)
+        auto dst = Resample<kHasSimd>( src, 32, 16, ResampleFilter::box );
+        bool isExpected = true;
+        for ( uint32_t y = 0; y < 16; ++y )
+        {
+            for ( uint32_t x = 0; x < 32; ++x )
+            {
+                const uint32_t top = AverageChannels( src.At( 2 * x, 2 * y ), src.At( 2 * x + 1, 2 * y ) );
+                const uint32_t bottom = AverageChannels( src.At( 2 * x, 2 * y + 1 ), src.At( 2 * x + 1, 2 * y + 1 ) );
+                isExpected = isExpected && ( dst.At( x, y ) == AverageChannels( top, bottom ) );
+            }
+        }
+        checker.Check( isExpected, "box 2:1 is the average of 2x2 pixels", 32, 16 );
+    }
+
+    { // 1:2: every pixel is duplicated
+        auto dst = Resample<kHasSimd>( src, 128, 64, ResampleFilter::box );
+        bool isExpected = true;
+        for ( uint32_t y = 0; y < 64; ++y )
+        {
+            for ( uint32_t x = 0; x < 128; ++x )
+            {
+                isExpected = isExpected && ( dst.At( x, y ) == src.At( x / 2, y / 2 ) );
+            }
+        }
+        checker.Check( isExpected, "box 1:2 duplicates pixels", 128, 64 );
+    }
+}
+
+/// @brief Mitchell-Netravali filter (B + 2C = 1) reproduces linear gradients away from the edges
+void CheckLinearGradient( bench::Checker& checker )
+{
+    constexpr uint32_t kSrcWidth = 64;
+    constexpr uint32_t kDstWidth = 128;
+    constexpr double kStep = 3.0;
+
+    bench::Image src( kSrcWidth, 4 );
+    src.Fill( []( uint32_t x, uint32_t ) { return 0xff000000 | ( 0x010101 * static_cast<uint32_t>( 30 + kStep * x ) ); } );
+
+    auto dst = Resample<kHasSimd>( src, kDstWidth, 4, ResampleFilter::mitchell );
+    bool isExpected = true;
+    for ( uint32_t x = 8; x < kDstWidth - 8; ++x )
+    {
+        const double srcPos = ( x + 0.5 ) * kSrcWidth / kDstWidth - 0.5;
+        const double expected = 30 + kStep * srcPos;
+        const uint32_t pixel = dst.At( x, 1 );
+        isExpected = isExpected && ( pixel >> 24 ) == 0xff && std::abs( static_cast<double>( pixel & 0xff ) - expected ) <= 1.0
+                     && ( pixel & 0xff ) * 0x010101 == ( pixel & 0xffffff );
+    }
+    checker.Check( isExpected, "mitchell 1:2 reproduces linear gradient", kDstWidth, 4 );
+}
+
+void CheckSimdIsBitExact( bench::Checker& checker, std::mt19937& rng )
+{
+    const uint32_t sizes[][4] = {
+        { 64, 64, 32, 32 }, { 37, 23, 100, 7 }, { 1, 1, 9, 3 }, { 9, 3, 1, 1 }, { 255, 3, 3, 255 },
+        { 17, 33, 17, 5 }, { 17, 33, 5, 33 }, { 640, 480, 123, 77 }, { 31, 31, 97, 97 }
+    };
+
+    for ( auto filter: kFilters )
+    {
+        for ( const auto& size: sizes )
+        {
+            for ( bool bottomUp: { false, true } )
+            {
+                bench::Image src( size[0], size[1] );
+                src.FillRandom( rng, true );
+
+                auto scalar = Resample<false>( src, size[2], size[3], filter, bottomUp );
+                auto simd = Resample<true>( src, size[2], size[3], filter, bottomUp );
+                bench::Image simdByRows( size[2], size[3] );
+                impl::Resample<true>( src.GetView( bottomUp ), simdByRows.GetView( bottomUp ), filter, ForEachRow );
+
+                const auto name = GetCaseName( bottomUp ? "bottom-up" : "top-down", filter, size[0], size[1] );
+                checker.Check( simd == scalar, ( name + ": SIMD result differs from scalar" ).c_str(), size[2], size[3] );
+                checker.Check( simdByRows == simd, ( name + ": result depends on row split" ).c_str(), size[2], size[3] );
+                checker.Check( scalar.IsPaddingIntact() && simd.IsPaddingIntact(), ( name + ": row padding was modified" ).c_str(), size[2], size[3] );
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    std::printf( "SIMD: %s\n", kHasSimd ? "SSE2" : "not available, only the scalar version is checked" );
+
+    bench::Checker checker;
+    std::mt19937 rng( 42 );
+
+    CheckConstantImage( checker );
+    CheckIdentity( checker, rng );
+    CheckBox( checker, rng );
+    CheckLinearGradient( checker );
+    CheckSimdIsBitExact( checker, rng );
+
+    return checker.Finish();
+}
@@ -0,0 +1,67 @@
+// Throughput of pixel kernels (utils/pixel_kernels_impl.h): scalar vs SIMD, single thread.
+
+#include "common.h"
+
+#include <utils/pixel_kernels_impl.h>
+
+using namespace smp::pixels;
+using namespace smp::pixels::impl;
+
+namespace
+{
+
+constexpr uint32_t kWidth = 1920;
+constexpr uint32_t kHeight = 1080;
+constexpr size_t kRunCount = 20;
+
+template <bool kUseSimd, typename Kernel>
+double Measure( bench::Image& image, const Kernel& kernel )
+{
+    const auto view = image.GetView();
+    return bench::FastestMs( kRunCount, [&] { ProcessRows<kUseSimd>( view, 0, view.height, kernel ); } );
+}
+
+template <bool kUseSimd>
+double MeasureMask( bench::Image& image, bench::Image& mask )
+{
+    const auto view = image.GetView();
+    const auto maskView = mask.GetView();
+    return bench::FastestMs( kRunCount, [&] { ProcessRows<kUseSimd>( view, maskView, 0, view.height, MaskKernel{} ); } );
+}
+
+void Report( const char* name, double scalarMs, double simdMs )
+{
+    const double megapixels = static_cast<double>( kWidth ) * kHeight / 1e6;
+    std::printf( "%-18s %8.3f ms %8.1f MP/s | %8.3f ms %8.1f MP/s | x%.2f\n",
+                 name, scalarMs, megapixels / scalarMs * 1000, simdMs, megapixels / simdMs * 1000, scalarMs / simdMs );
+}
+
+template <typename Kernel>
+void Run( const char* name, bench::Image& image, const Kernel& kernel )
+{
+    Report( name, Measure<false>( image, kernel ), Measure<true>( image, kernel ) );
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 rng( 42 );
+    bench::Image image( kWidth, kHeight, 0 );
+    image.FillRandom( rng );
+    bench::Image mask( kWidth, kHeight, 0 );
+    mask.FillRandom( rng );
+
+    std::printf( "%ux%u, fastest of %zu runs, SIMD: %s\n", kWidth, kHeight, kRunCount, kHasSimd ? "SSE2" : "not available" );
+    std::printf( "%-18s %24s | %24s |\n", "kernel", "scalar", "SIMD" );
+
+    Report( "ApplyMask", MeasureMask<false>( image, mask ), MeasureMask<true>( image, mask ) );
+    Run( "ScaleAlpha", image, ScaleAlphaKernel{ 128 } );
+    Run( "Greyscale", image, GreyscaleKernel{} );
+    Run( "Invert", image, InvertKernel{} );
+    Run( "Tint", image, TintKernel( 0xff3080f0, 100 ) );
+    Run( "AdjustBrightness", image, BrightnessKernel( 40 ) );
+    Run( "AdjustContrast", image, ContrastKernel( 300 ) );
+
+    return 0;
+}
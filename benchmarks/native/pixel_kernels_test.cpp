@@ -0,0 +1,155 @@
+// Checks that SIMD and scalar versions of pixel kernels (utils/pixel_kernels_impl.h) produce the same results.
+
+#include "common.h"
+
+#include <utils/pixel_kernels_impl.h>
+
+#include <functional>
+#include <string>
+
+using namespace smp::pixels;
+using namespace smp::pixels::impl;
+
+namespace
+{
+
+using ApplyFn = std::function<void( const PixelView& dst, const PixelView& src, bool useSimd )>;
+
+struct KernelCase
+{
+    std::string name;
+    ApplyFn apply;
+    bool isIdentity = false; ///< kernel must not change the pixels
+};
+
+template <typename Kernel>
+KernelCase MakeCase( std::string name, Kernel kernel, bool isIdentity = false )
+{
+    return { std::move( name ), [kernel]( const PixelView& dst, const PixelView&, bool useSimd ) {
+                if ( useSimd )
+                {
+                    ProcessRows<true>( dst, 0, dst.height, kernel );
+                }
+                else
+                {
+                    ProcessRows<false>( dst, 0, dst.height, kernel );
+                }
+            },
+             isIdentity };
+}
+
+std::vector<KernelCase> GetCases()
+{
+    std::vector<KernelCase> cases;
+    cases.push_back( { "ApplyMask", []( const PixelView& dst, const PixelView& src, bool useSimd ) {
+                          if ( useSimd )
+                          {
+                              ProcessRows<true>( dst, src, 0, dst.height, MaskKernel{} );
+                          }
+                          else
+                          {
+                              ProcessRows<false>( dst, src, 0, dst.height, MaskKernel{} );
+                          }
+                      } } );
+    for ( uint32_t factor: { 0, 1, 128, 254 } )
+    {
+        cases.push_back( MakeCase( "ScaleAlpha " + std::to_string( factor ), ScaleAlphaKernel{ factor } ) );
+    }
+    cases.push_back( MakeCase( "ScaleAlpha 255", ScaleAlphaKernel{ 255 }, true ) );
+    cases.push_back( MakeCase( "Greyscale", GreyscaleKernel{} ) );
+    cases.push_back( MakeCase( "Invert", InvertKernel{} ) );
+    for ( uint32_t amount: { 1, 77, 200, 255 } )
+    {
+        cases.push_back( MakeCase( "Tint " + std::to_string( amount ), TintKernel( 0xff3080f0, static_cast<uint8_t>( amount ) ) ) );
+    }
+    cases.push_back( MakeCase( "Tint 0", TintKernel( 0xff3080f0, 0 ), true ) );
+    for ( int32_t delta: { -1000, -255, -100, -1, 1, 100, 255, 1000 } )
+    {
+        cases.push_back( MakeCase( "AdjustBrightness " + std::to_string( delta ), BrightnessKernel( delta ) ) );
+    }
+    cases.push_back( MakeCase( "AdjustBrightness 0", BrightnessKernel( 0 ), true ) );
+    for ( uint32_t factor: { 0u, 1u, 100u, 255u, 257u, 512u, 32767u, 100000u } )
+    {
+        cases.push_back( MakeCase( "AdjustContrast " + std::to_string( factor ), ContrastKernel( factor ) ) );
+    }
+    cases.push_back( MakeCase( "AdjustContrast 256", ContrastKernel( 256 ), true ) );
+    return cases;
+}
+
+} // namespace
+
+int main()
+{
+    std::printf( "SIMD: %s\n", kHasSimd ? "SSE2" : "not available, only the scalar version is checked" );
+
+    bench::Checker checker;
+    std::mt19937 rng( 42 );
+
+    const uint32_t widths[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 64, 255, 257 };
+    const uint32_t heights[] = { 1, 3, 8 };
+
+    for ( const auto& kernelCase: GetCases() )
+    {
+        for ( uint32_t width: widths )
+        {
+            for ( uint32_t height: heights )
+            {
+                for ( bool bottomUp: { false, true } )
+                {
+                    bench::Image original( width, height );
+                    original.FillRandom( rng );
+                    bench::Image src( width, height );
+                    src.FillRandom( rng );
+
+                    bench::Image scalar = original;
+                    bench::Image simd = original;
+                    kernelCase.apply( scalar.GetView( bottomUp ), src.GetView( bottomUp ), false );
+                    kernelCase.apply( simd.GetView( bottomUp ), src.GetView( bottomUp ), true );
+
+                    const std::string name = kernelCase.name + ( bottomUp ? " (bottom-up)" : "" );
+                    checker.Check( simd == scalar, ( name + ": SIMD result differs from scalar" ).c_str(), width, height );
+                    checker.Check( scalar.IsPaddingIntact() && simd.IsPaddingIntact(), ( name + ": row padding was modified" ).c_str(), width, height );
+                    if ( kernelCase.isIdentity )
+                    {
+                        checker.Check( scalar == original, ( name + ": pixels were modified" ).c_str(), width, height );
+                    }
+                }
+            }
+        }
+    }
+
+    { // all possible channel values
+        bench::Image original( 256, 256 );
+        original.Fill( []( uint32_t x, uint32_t y ) { return ( y << 24 ) | ( x << 16 ) | ( ( 255 - x ) << 8 ) | ( x ^ y ); } );
+
+        for ( const auto& kernelCase: GetCases() )
+        {
+            bench::Image scalar = original;
+            bench::Image simd = original;
+            kernelCase.apply( scalar.GetView(), original.GetView(), false );
+            kernelCase.apply( simd.GetView(), original.GetView(), true );
+            checker.Check( simd == scalar, ( kernelCase.name + " (all channel values): SIMD result differs from scalar" ).c_str(), 256, 256 );
+        }
+    }
+
+    { // reference values
+        bench::Image image( 5, 1 );
+        const uint32_t pixels[] = { 0xff808080, 0x80ff0000, 0x00123456, 0xff000000, 0xffffffff };
+        image.Fill( [&pixels]( uint32_t x, uint32_t ) { return pixels[x]; } );
+
+        bench::Image grey = image;
+        ProcessRows<kHasSimd>( grey.GetView(), 0, 1, GreyscaleKernel{} );
+        checker.Check( grey.At( 0, 0 ) == 0xff808080 && grey.At( 1, 0 ) == 0x804d4d4d && grey.At( 4, 0 ) == 0xffffffff,
+                       "Greyscale: reference values", 5, 1 );
+
+        bench::Image inverted = image;
+        ProcessRows<kHasSimd>( inverted.GetView(), 0, 1, InvertKernel{} );
+        checker.Check( inverted.At( 1, 0 ) == 0x8000ffff && inverted.At( 2, 0 ) == 0x00edcba9, "Invert: reference values", 5, 1 );
+
+        bench::Image scaled = image;
+        ProcessRows<kHasSimd>( scaled.GetView(), 0, 1, ScaleAlphaKernel{ 128 } );
+        checker.Check( scaled.At( 0, 0 ) == 0x80808080 && scaled.At( 1, 0 ) == 0x40ff0000, "ScaleAlpha: reference values", 5, 1 );
+    }
+
+    return checker.Finish();
+}
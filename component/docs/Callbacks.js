@@ -80,6 +80,20 @@ function on_drag_over(action, x, y, mask) { }
  */
 function on_dsp_preset_changed() { }
 
+/**
+ * Called when files watched via {@link window.WatchPath} are changed.<br>
+ * Changes are delivered in batches: rapid successive changes of the same file are merged into a single entry.<br>
+ * <br>
+ * Possible actions:<br>
+ * - "added", "removed", "modified".<br>
+ * - "rescan": some changes were lost (e.g. because too many files were changed at once),
+ *   anything inside `path` directory might have changed.
+ *
+ * @param {number} watch_id Id returned by {@link window.WatchPath}
+ * @param {Array<{path: string, action: string}>} changes
+ */
+function on_file_changed(watch_id, changes) { }
+
 /**
  *  Called when the panel gets or loses focus.
  *
@@ -155,6 +169,15 @@ function on_library_items_changed(handle_list) { }
  */
 function on_library_items_removed(handle_list) { }
 
+/**
+ * Called when the result set of the library query that is watched via {@link window.WatchQuery} is changed.
+ *
+ * @param {number} watch_id Id returned by {@link window.WatchQuery}
+ * @param {FbMetadbHandleList} added Items that started matching the query
+ * @param {FbMetadbHandleList} removed Items that don't match the query anymore (or were removed from the library)
+ */
+function on_library_query_changed(watch_id, added, removed) { }
+
 /**
  * Called when thread created by {@link gdi.LoadImageAsync} is done.
  *
@@ -437,21 +460,24 @@ function on_playlist_item_ensure_visible(playlistIndex, playlistItemIndex) { }
 
 /**
  * @param {number} playlistIndex
+ * @param {number} version Playlist version after the change, see {@link plman.GetPlaylistChanges}
  */
-function on_playlist_items_added(playlistIndex) { }
+function on_playlist_items_added(playlistIndex, version) { }
 
 /**
  * @param {number} playlistIndex
  * @param {number} new_count
+ * @param {number} version Playlist version after the change, see {@link plman.GetPlaylistChanges}
  */
-function on_playlist_items_removed(playlistIndex, new_count) { }
+function on_playlist_items_removed(playlistIndex, new_count, version) { }
 
 /**
  * Changes selection too. Doesn't actually change the set of items that are selected or item having focus, just changes their order.
  *
  * @param {number} playlistIndex
+ * @param {number} version Playlist version after the change, see {@link plman.GetPlaylistChanges}
  */
-function on_playlist_items_reordered(playlistIndex) { }
+function on_playlist_items_reordered(playlistIndex, version) { }
 
 /**
  * Workaround for some 3rd party playlist viewers not working with {@link module:callbacks~on_selection_changed on_selection_changed}.
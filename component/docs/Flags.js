@@ -187,7 +187,12 @@ var InterpolationMode = {
 	Bicubic: 4,
 	NearestNeighbor: 5,
 	HighQualityBilinear: 6,
-	HighQualityBicubic: 7
+	HighQualityBicubic: 7,
+
+	// Supported only by GdiBitmap.Resize()
+	Box: 8,
+	Mitchell: 9,
+	Lanczos3: 10
 };
 
 // Used in RotateFlip()
@@ -214,6 +219,15 @@ var RotateFlipType = {
 	Rotate270FlipXY: 1
 };
 
+// Used in GdiBitmap.ApplyEffect()
+var ImageEffect = {
+	Greyscale: 0,
+	Invert: 1,
+	Brightness: 2,
+	Contrast: 3,
+	Tint: 4
+};
+
 // h_align/v_align:
 // http://msdn.microsoft.com/en-us/library/ms534177(VS.85).aspx
 var StringAlignment = {
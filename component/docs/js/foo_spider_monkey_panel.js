@@ -53,7 +53,12 @@ function setInterval(func, delay, func_args) { } // (uint)
 function setTimeout(func, delay, func_args) { } // (uint)
 
 /**
- * Load ActiveX object.
+ * Load ActiveX object.<br>
+ * <br>
+ * Array conversion notes:<br>
+ * - COM arrays of bytes (VT_UI1) are returned as Uint8Array and arrays of doubles (VT_R8) as Float64Array,
+ *   other COM arrays are returned as Array.<br>
+ * - Typed arrays are passed to COM as arrays of corresponding type (e.g. Uint8Array is passed as array of VT_UI1).
  *
  * @constructor
  * @param {string} name
@@ -315,6 +320,15 @@ let fb = {
      */
     CreateProfiler: function (name) { }, // (FbProfiler) [name]
 
+    /**
+     * Compiled queries are cached by expression text,
+     * so creating the query with the same expression again is cheap.
+     *
+     * @param {string} expression Query expression, e.g. "rating IS 5"
+     * @return {FbQuery}
+     */
+    CreateQuery: function (expression) { }, // (FbQuery)
+
     /**
      * Invokes drag-n-drop operation (see {@link https://msdn.microsoft.com/en-us/library/windows/desktop/ms678486.aspx}).<br>
      * <br>
@@ -632,9 +646,43 @@ let fb = {
     /** @method */
     ShowPreferences: function () { }, // (void)
 
+    /**
+     * Starts sampling profiler for all panels.<br>
+     * Can also be toggled via `File > Spider Monkey Panel > Sampling profiler` menu.
+     *
+     * @param {number=} [frequency=1000] Sampling frequency in Hz, maximum is 1000.
+     */
+    StartSamplingProfiler: function (frequency) { }, // (void) [, frequency]
+
+    /**
+     * Starts recording of Chrome trace.<br>
+     * Trace contains spans from {@link FbProfiler#BeginSpan} and built-in spans:
+     * callbacks, `on_paint`, GC slices, script compilation, image decoding and title formatting.<br>
+     * Can also be toggled via `File > Spider Monkey Panel > Tracing` menu.
+     */
+    StartTracing: function () { }, // (void)
+
     /** @method */
     Stop: function () { }, // (void)
 
+    /**
+     * Stops sampling profiler and saves collected samples to `<profile>\foo_spider_monkey_panel\profiler\`:<br>
+     * - `.folded` file contains collapsed stacks (can be used to generate flame graphs).<br>
+     * - `.json` file contains Chrome trace (can be opened in `chrome://tracing` or similar viewers).<br>
+     * Native methods are recorded as `[native] ClassName::MethodName` frames.
+     *
+     * @return {Array<string>} Paths to the `.folded` and `.json` files
+     */
+    StopSamplingProfiler: function () { }, // (Array<string>)
+
+    /**
+     * Stops recording of Chrome trace and saves it to `<profile>\foo_spider_monkey_panel\profiler\`.<br>
+     * Trace can be opened in `chrome://tracing` or similar viewers.
+     *
+     * @return {string} Path to the trace file
+     */
+    StopTracing: function () { }, // (string)
+
     /**
      * Performance note: if you use the same query frequently, 
      * try caching FbTitleFormat object (by storing it somewhere),
@@ -662,6 +710,13 @@ let fb = {
  */
 let gdi = {
 
+    /**
+     * Creates an empty draw list: see {@link GdiDrawList} and {@link GdiGraphics#Replay}.
+     *
+     * @return {GdiDrawList}
+     */
+    CreateDrawList: function () { }, // (GdiDrawList)
+
     /**
      * @param {number} w
      * @param {number} h
@@ -670,7 +725,24 @@ let gdi = {
     CreateImage: function (w, h) { }, // (GdiBitmap)
 
     /**
-     * Performance note: avoid using inside `on_paint`.
+     * Creates an image from raw pixels: see {@link GdiBitmap#LockPixels} for the pixel layout.
+     *
+     * @param {number} w
+     * @param {number} h
+     * @param {Uint8ClampedArray|Uint8Array|Uint32Array} buffer Must contain exactly `w * h * 4` bytes.
+     * @param {boolean=} [premultiplied=false] If true, colour channels of pixels are premultiplied by alpha.
+     * @return {GdiBitmap}
+     *
+     * @example
+     * let pixels = new Uint32Array(w * h);
+     * pixels.fill(0xFFFF0000); // opaque red
+     * let img = gdi.CreateImageFromBuffer(w, h, pixels);
+     */
+    CreateImageFromBuffer: function (w, h, buffer, premultiplied) { }, // (GdiBitmap) [, premultiplied]
+
+    /**
+     * Fonts are cached: fonts with the same parameters share the same underlying font object,
+     * so calling this method repeatedly (e.g. on every resize) is cheap.
      *
      * @param {string} name
      * @param {number} size_px See Helper.js > Point2Pixel function for conversions
@@ -679,6 +751,22 @@ let gdi = {
      */
     Font: function (name, size_px, style) { }, // (GdiFont) [, style]
 
+    /**
+     * Returns statistics of the background snapshots that are used by pseudo-transparent panels.<br>
+     * Parent background is captured once and is shared by all of its panels,
+     * it is recaptured only when the parent is resized or when theme or colours are changed.
+     *
+     * @return {{reuses: number, recaptures: number, count: number}} `count` is the amount of currently cached parent snapshots.
+     */
+    GetBackgroundSnapshotStats: function () { }, // (Object)
+
+    /**
+     * Returns statistics of the font cache, which is shared by all panels (see {@link gdi.Font}).
+     *
+     * @return {{hits: number, misses: number, count: number}} `count` is the amount of currently cached fonts.
+     */
+    GetFontCacheStats: function () { }, // (Object)
+
     /**
      * Load image from file.<br>
      * <br>
@@ -793,6 +881,31 @@ let plman = {
      */
     AddLocations: function (playlistIndex, paths, select) { }, // (void) [, select]
 
+    /**
+     * Starts a transaction for the specified playlist: all subsequent edits of this playlist are staged
+     * and are applied only on {@link plman.Commit}, which takes a single undo backup
+     * and generates a single notification of each kind (e.g. `on_playlist_items_added`).<br>
+     * While the transaction is in progress, playlist getters (e.g. {@link plman.GetPlaylistItems}) return staged data.<br>
+     * Staged methods: `ClearPlaylist`, `ClearPlaylistSelection`, `InsertPlaylistItems`, `InsertPlaylistItemsFilter`,
+     * `MovePlaylistSelection`, `RemovePlaylistSelection`, `SetPlaylistFocusItem`, `SetPlaylistFocusItemByHandle`,
+     * `SetPlaylistSelection`, `SetPlaylistSelectionSingle`, `SortByFormat`, `SortByFormatV2` and `UndoBackup`.
+     * Other methods are applied immediately.<br>
+     * The transaction follows its playlist when other playlists are added, removed or reordered,
+     * so the playlist must be addressed by its current index.<br>
+     * Only one transaction can be in progress at a time.
+     *
+     * @param {number} playlistIndex
+     *
+     * @example
+     * let ap = plman.ActivePlaylist;
+     * plman.BeginTransaction(ap);
+     * plman.RemovePlaylistSelection(ap);
+     * plman.InsertPlaylistItems(ap, 0, handle_list, true);
+     * plman.SortByFormatV2(ap, '%album artist%|%date%|%album%');
+     * plman.Commit();
+     */
+    BeginTransaction: function (playlistIndex) { }, // (void)
+
     /**
      * @param {number} playlistIndex
      *
@@ -809,6 +922,13 @@ let plman = {
      */
     ClearPlaylistSelection: function (playlistIndex) { }, // (void)
 
+    /**
+     * Applies the edits staged since {@link plman.BeginTransaction} and finishes the transaction.<br>
+     * Throws an error, if the playlist was modified outside of the transaction or if it's locked:
+     * the transaction is finished (and discarded) in this case too.
+     */
+    Commit: function () { }, // (void)
+
     /**
      * @param {number} playlistIndex
      * @param {string} name Name for the new autoplaylist.
@@ -886,6 +1006,35 @@ let plman = {
      */
     GetPlayingItemLocation: function () { }, // (FbPlayingItemLocation)
 
+    /**
+     * Returns changes that were made to the playlist items after the specified version.<br>
+     * Allows playlist viewers to patch their contents instead of re-reading the whole playlist.<br>
+     * <br>
+     * Every change is an object with the following properties:<br>
+     * - `type`: one of 'added', 'removed', 'reordered' or 'replaced'.<br>
+     * - `version`: version of the playlist after the change.<br>
+     * - `start` and `handles` ('added' only): index of the first inserted item and the inserted items.<br>
+     * - `ranges` ('removed' only): flat array of [start, count] pairs of removed items (indices before the removal).<br>
+     * - `order` ('reordered' only): order[newIndex] = oldIndex.<br>
+     * - `indices` and `handles` ('replaced' only): indices of replaced items and their new handles.<br>
+     * <br>
+     * Note: 'replaced' changes have no dedicated callback, they are available only via this method.<br>
+     * Note: only the most recent changes are stored.
+     *
+     * @param {number} playlistIndex
+     * @param {number} sinceVersion Version that was received from {@link plman.GetPlaylistVersion} or from one of the playlist item callbacks
+     * @return {?Array<Object>} Changes in the order they were made, or null if the changes are not available anymore (playlist must be re-read in this case)
+     *
+     * @example
+     * let version = plman.GetPlaylistVersion(plman.ActivePlaylist);
+     * // ...
+     * let changes = plman.GetPlaylistChanges(plman.ActivePlaylist, version);
+     * if (!changes) {
+     *     // reload everything
+     * }
+     */
+    GetPlaylistChanges: function (playlistIndex, sinceVersion) { }, // (Array<Object>|null)
+
     /**
      * @param {number} playlistIndex
      * @return {number} Returns -1 if nothing is selected
@@ -922,6 +1071,15 @@ let plman = {
      */
     GetPlaylistSelectedItems: function (playlistIndex) { }, // (FbMetadbHandleList)
 
+    /**
+     * Version is changed on every change of the playlist items.
+     * Versions are shared by all playlists and are always increasing.
+     *
+     * @param {number} playlistIndex
+     * @return {number}
+     */
+    GetPlaylistVersion: function (playlistIndex) { }, // (uint)
+
     /**
      * @param {number} playlistIndex
      * @param {number} base Position in playlist
@@ -1035,6 +1193,11 @@ let plman = {
      */
     RenamePlaylist: function (playlistIndex, name) { }, // (boolean)
 
+    /**
+     * Discards the edits staged since {@link plman.BeginTransaction} and finishes the transaction.
+     */
+    Rollback: function () { }, // (void)
+
     /**
      * Workaround so you can use the Edit menu or run {@link fb.RunMainMenuCommand}("Edit/Something...")
      * when your panel has focus and a dedicated playlist viewer doesn't.
@@ -1406,6 +1569,20 @@ let utils = {
      */
     Glob: function (pattern, exc_mask, inc_mask) { }, // (Array) [, exc_mask][, inc_mask]
 
+    /**
+     * Asynchronous version of {@link utils.Glob}: file search is performed in a background thread.
+     *
+     * @param {number} window_id {@link window.ID}
+     * @param {string} pattern
+     * @param {number=} [exc_mask=0x10] Default is FILE_ATTRIBUTE_DIRECTORY. See Flags.js > Used in utils.Glob()
+     * @param {number=} [inc_mask=0xffffffff]
+     * @return {Promise<Array<string>>}
+     *
+     * @example
+     * utils.GlobAsync(window.ID, "C:\\*.*").then((arr) => console.log(arr.length));
+     */
+    GlobAsync: function (window_id, pattern, exc_mask, inc_mask) { }, // (Promise) [, exc_mask][, inc_mask]
+
     /**
      * @param {number} window_id
      * @param {string} prompt
@@ -1448,6 +1625,25 @@ let utils = {
      */
     MapString: function (text, lcid, flags) { }, // (string)
 
+    /**
+     * Opens text file for streaming reads.<br>
+     * Unlike {@link utils.ReadTextFile}, the file is not read as a whole:
+     * only the requested lines are decoded, so this method is suitable for huge files (e.g. logs).<br>
+     * <br>
+     * Note: the file stays locked for writing until {@link TextFileReader#Close} is called or the object is garbage-collected.<br>
+     * Performance note: supply codepage argument if it is known, since codepage detection might take some time.
+     *
+     * @param {string} path
+     * @param {number=} [codepage=0] See Codepages.js. If codepage is 0, then automatic detection is performed
+     * @return {TextFileReader}
+     *
+     * @example
+     * let reader = utils.OpenTextFile(fb.ProfilePath + 'huge.log', 65001);
+     * let lines = reader.ReadLines(reader.LineCount - 100, 100); // last 100 lines
+     * reader.Close();
+     */
+    OpenTextFile: function (path, codepage) { }, // (TextFileReader)
+
     /**
      * Check if the supplied string matches the pattern.<br>
      * Using Microsoft MS-DOS wildcards match type. eg "*.txt", "abc?.tx?"
@@ -1470,6 +1666,32 @@ let utils = {
      */
     ReadTextFile: function (filename, codepage) { }, // (string) [,codepage]
 
+    /**
+     * Asynchronous version of {@link utils.ReadTextFile}: file is read and decoded in a background thread.
+     *
+     * @param {number} window_id {@link window.ID}
+     * @param {string} filename
+     * @param {number=} [codepage=0] See Codepages.js. If codepage is 0, then automatic detection is performed.
+     * @return {Promise<string>}
+     *
+     * @example
+     * let text = await utils.ReadTextFileAsync(window.ID, "E:\\some text file.txt");
+     */
+    ReadTextFileAsync: function (window_id, filename, codepage) { }, // (Promise) [,codepage]
+
+    /**
+     * Reads the whole file in a background thread.<br>
+     * File data is read directly into the memory of the resulting ArrayBuffer, so no additional copies are made.
+     *
+     * @param {number} window_id {@link window.ID}
+     * @param {string} filename
+     * @return {Promise<ArrayBuffer>}
+     *
+     * @example
+     * let bytes = new Uint8Array(await utils.ReadBinaryFileAsync(window.ID, "E:\\cover.jpg"));
+     */
+    ReadBinaryFileAsync: function (window_id, filename) { }, // (Promise)
+
     /**
      * Note: this only returns up to 255 characters per value.
      *
@@ -1524,6 +1746,23 @@ let utils = {
      */
     ShowHtmlDialog: function (window_id, code_or_path, options) { },
 
+    /**
+     * Retrieves file information in a background thread.<br>
+     * Not an error if the file does not exist: `exists` field will be false in that case.
+     *
+     * @param {number} window_id {@link window.ID}
+     * @param {string} path
+     * @return {Promise<{exists: boolean, isDirectory: boolean, size: number, attributes: number, created: number, modified: number}>}
+     *     `created` and `modified` are in milliseconds since the Unix epoch (i.e. can be passed to `new Date()`).
+     *
+     * @example
+     * let stat = await utils.StatAsync(window.ID, "E:\\some text file.txt");
+     * if (stat.exists) {
+     *     console.log(new Date(stat.modified));
+     * }
+     */
+    StatAsync: function (window_id, path) { }, // (Promise)
+
     /**
      * @param {string} filename
      * @param {string} section
@@ -1556,6 +1795,21 @@ let utils = {
      * utils.WriteTextFile("z:\\3.txt", "test", false);
      */
     WriteTextFile: function (filename, content, write_bom) { }, //(boolean)
+
+    /**
+     * Asynchronous version of {@link utils.WriteTextFile}: file is written in a background thread.<br>
+     * The write is atomic: data is written to a temporary file, which then replaces the target file,
+     * so the target file is never left partially written.<br>
+     * <br>
+     * Note: the parent folder must already exist.
+     *
+     * @param {number} window_id {@link window.ID}
+     * @param {string} filename
+     * @param {string} content
+     * @param {boolean=} [write_bom=true]
+     * @return {Promise<void>} Rejected if the file could not be written.
+     */
+    WriteTextFileAsync: function (window_id, filename, content, write_bom) { }, // (Promise) [, write_bom]
 };
 
 /**
@@ -1776,6 +2030,27 @@ let window = {
      */
     GetFontDUI: function (type) { }, // (GdiFont)
 
+    /**
+     * Returns latency statistics of asynchronous messages (callbacks, timers, promises and etc) processed by this panel.<br>
+     * All values are in microseconds:<br>
+     * - `queue`: time between the moment the message was posted and the moment the panel started processing it.<br>
+     *   High values mean that the UI thread was blocked (most likely by some other panel).<br>
+     * - `handler`: time spent processing the message (including the JS callback).<br>
+     * <br>
+     * Statistics are collected for the whole lifetime of the panel (i.e. they are not reset on script reload).
+     *
+     * @return {Object<string, {count: number, queue: Object, handler: Object}>}
+     *     Keyed by callback name, e.g. `on_playback_new_track`.
+     *     `queue` and `handler` have the following fields: `min`, `mean`, `p50`, `p90`, `p99`, `max`.
+     *
+     * @example
+     * let stats = window.GetMessageLatencyStats();
+     * if (stats.on_selection_changed) {
+     *     console.log(stats.on_selection_changed.queue.p99);
+     * }
+     */
+    GetMessageLatencyStats: function () { }, // (Object)
+
     /**
      * Get value of property.<br>
      * If property does not exist and default_val is not undefined and not null,
@@ -1797,6 +2072,11 @@ let window = {
      */
     NotifyOthers: function (name, info) { }, // (void)
 
+    /**
+     * Prints {@link window.GetMessageLatencyStats} in a human-readable form to console.
+     */
+    PrintMessageLatencyStats: function () { }, // (void)
+
     /**
      * Reload panel.
      * @method
@@ -1827,6 +2107,11 @@ let window = {
      */
     RepaintRect: function (x, y, w, h, force) { }, // (void) [force]
 
+    /**
+     * Discards statistics collected for {@link window.GetMessageLatencyStats}.
+     */
+    ResetMessageLatencyStats: function () { }, // (void)
+
     /**
      * This would usually be used inside the {@link module:callbacks~on_mouse_move on_mouse_move} callback.<br>
      * Use -1 if you want to hide the cursor.
@@ -1851,6 +2136,12 @@ let window = {
      * <br>
      * Property values are saved per panel instance and are remembered between foobar2000 restarts.<br>
      * <br>
+     * Supported value types: boolean, number, string, Array, plain Object, ArrayBuffer and typed arrays (e.g. Uint8Array).<br>
+     * Arrays and objects are stored in a compact binary form, so there is no need to use JSON.stringify on them.
+     * Note: arrays and objects are stored by value, i.e. changes to the object will not be saved until it's passed to SetProperty again.
+     * Stored array or object is decoded only once: subsequent {@link window.GetProperty} calls return the same object
+     * (including its unsaved changes) until the property is set again.<br>
+     * <br>
      * Note: leading and trailing whitespace are removed from property name.
      *
      * @param {string} name
@@ -1879,6 +2170,61 @@ let window = {
      * @method
      */
     ShowProperties: function () { }, // (void)
+
+    /**
+     * Stops watching the path.
+     *
+     * @param {number} watch_id Id returned by {@link window.WatchPath}
+     */
+    UnwatchPath: function (watch_id) { }, // (void)
+
+    /**
+     * Stops watching the library query.
+     *
+     * @param {number} watch_id Id returned by {@link window.WatchQuery}
+     */
+    UnwatchQuery: function (watch_id) { }, // (void)
+
+    /**
+     * Starts watching the file or directory for changes.<br>
+     * Changes are reported via {@link module:callbacks~on_file_changed on_file_changed} callback.<br>
+     * Watch is removed automatically when the script is unloaded.
+     *
+     * @param {string} path Path to a file or a directory
+     * @param {boolean=} [recursive=false] If true, changes in subdirectories are reported as well. Ignored for files.
+     * @return {number} Watch id
+     *
+     * @example
+     * let watch_id = window.WatchPath(fb.ProfilePath + 'my_data', true);
+     * function on_file_changed(id, changes) {
+     *     if (id === watch_id) {
+     *         changes.forEach((c) => console.log(c.action, c.path));
+     *     }
+     * }
+     */
+    WatchPath: function (path, recursive) { }, // (uint)
+
+    /**
+     * Starts watching media library items that match the query.<br>
+     * Changes of the result set are reported via {@link module:callbacks~on_library_query_changed on_library_query_changed} callback.<br>
+     * Result set is maintained incrementally and is shared by all panels that watch the same query.<br>
+     * Time-relative queries (e.g. `%added% DURING LAST 1 WEEK`) are re-evaluated when foobar2000 reports that their results might have changed.<br>
+     * Watch is removed automatically when the script is unloaded.
+     *
+     * @param {string} expression Query expression
+     * @return {number} Watch id
+     *
+     * @example
+     * let query = fb.CreateQuery('rating IS 5');
+     * let items = query.GetLibraryItems();
+     * let watch_id = window.WatchQuery(query.Expression);
+     * function on_library_query_changed(id, added, removed) {
+     *     if (id === watch_id) {
+     *         items = query.GetLibraryItems();
+     *     }
+     * }
+     */
+    WatchQuery: function (expression) { }, // (uint)
 };
 
 /**
@@ -2074,7 +2420,12 @@ function FbFileInfo() {
 }
 
 /**
- * Handle list elements can be accessed with array accessor, e.g. handle_list[i]
+ * Handle list elements can be accessed with array accessor, e.g. handle_list[i].<br>
+ * Handle list is iterable, e.g. `for (const handle of handle_list)`.<br>
+ * <br>
+ * Performance note: array accessor is slow, since it can't be optimized by JIT.
+ * Use `for...of`, {@link FbMetadbHandleList#ForEach}, {@link FbMetadbHandleList#Map}
+ * or {@link FbMetadbHandleList#ToArrayView} to loop through big lists.
  *
  * @constructor
  * @param {FbMetadbHandleList | FbMetadbHandle | Array<FbMetadbHandle> | null | undefined} arg
@@ -2180,6 +2531,17 @@ function FbMetadbHandleList(arg) {
      */
     this.Find = function (handle) { }; // (int)
 
+    /**
+     * Invokes `callback` for every handle in the list.<br>
+     * Faster than looping through the list via array accessor.
+     *
+     * @param {function(FbMetadbHandle, number)} callback Receives handle and its index.
+     *
+     * @example
+     * plman.GetPlaylistItems(plman.ActivePlaylist).ForEach((handle, i) => console.log(i, handle.Path));
+     */
+    this.ForEach = function (callback) { }; // (void)
+
     /**
      * See {@link fb.GetLibraryRelativePath}.<br>
      * <br>
@@ -2194,6 +2556,26 @@ function FbMetadbHandleList(arg) {
      */
     this.GetLibraryRelativePaths = function () { }; //(Array)
 
+    /**
+     * Sorts the handle list and splits it into groups of adjacent items with the same group key.<br>
+     * Handle list is sorted by `sort_tfo` if it is supplied, otherwise it is sorted by group key (both sorts are stable).<br>
+     * Group keys are compared case-insensitively.<br>
+     * Performance note: title formatting is performed in multiple threads for large lists,
+     * which is much faster than evaluating and comparing keys in JS.
+     *
+     * @param {FbTitleFormat} group_tfo Group key
+     * @param {?FbTitleFormat=} [sort_tfo=null]
+     * @param {number=} [flags=0] 1 - calculate total duration of each group, 2 - calculate total size of each group. Can be combined.
+     * @return {Array<{key: string, start: number, count: number, duration: (number|undefined), size: (number|undefined)}>}
+     *     Groups in the order of handles: `start` is the index of the first handle of the group.
+     *
+     * @example
+     * let handle_list = fb.GetLibraryItems();
+     * let groups = handle_list.GroupBy(fb.TitleFormat('%album artist%|%album%'), fb.TitleFormat('%album artist%|%date%|%album%|%discnumber%|%tracknumber%'), 1);
+     * groups.forEach((g) => console.log(g.key, g.count, utils.FormatDuration(g.duration)));
+     */
+    this.GroupBy = function (group_tfo, sort_tfo, flags) { }; // (Array) [, sort_tfo][, flags]
+
     /**
      * @param {number} index
      * @param {FbMetadbHandle} handle
@@ -2228,6 +2610,19 @@ function FbMetadbHandleList(arg) {
      */
     this.MakeDifference = function (handle_list) { }; // (void)
 
+    /**
+     * Creates an array with the results of `callback` invoked for every handle in the list.<br>
+     * Handles that are added by `callback` are not visited.
+     * If handles are removed by `callback`, iteration stops at the new end of the list and the array contains only the visited handles.
+     *
+     * @param {function(FbMetadbHandle, number): *} callback Receives handle and its index.
+     * @return {Array<*>}
+     *
+     * @example
+     * let paths = fb.GetLibraryItems().Map((handle) => handle.Path);
+     */
+    this.Map = function (callback) { }; // (Array)
+
     /**
      * Note: sort with {@link FbMetadbHandleList#Sort} before using.
      * 
@@ -2336,6 +2731,24 @@ function FbMetadbHandleList(arg) {
      */
     this.Sort = function () { }; // (void)
 
+    /**
+     * Creates an array-like snapshot of the handle list (changing its elements does not affect the handle list).<br>
+     * Unlike {@link FbMetadbHandleList#Convert}, elements are converted to {@link FbMetadbHandle} only when they are accessed,
+     * and unlike the handle list itself, accessing elements can be optimized by JIT.<br>
+     * View has `length` property, supports `for...of` and has `forEach()` and `map()` methods
+     * (other array methods can be used via `Array.prototype`).
+     *
+     * @return {ArrayLike<FbMetadbHandle>}
+     *
+     * @example
+     * let view = plman.GetPlaylistItems(plman.ActivePlaylist).ToArrayView();
+     * for (let i = 0; i < view.length; ++i) {
+     *    // do something with view[i]
+     * }
+     * let filtered = Array.prototype.filter.call(view, (handle) => handle.Length > 600);
+     */
+    this.ToArrayView = function () { }; // (Object)
+
     /**
      * Updated metadb tags with new values.
      *
@@ -2486,6 +2899,26 @@ function FbProfiler(name) {
      */
     this.Time = undefined; // (uint) // milliseconds
 
+    /**
+     * Starts a span in the trace (see {@link fb.StartTracing}).<br>
+     * Spans can be nested and must be closed with {@link FbProfiler#EndSpan}.<br>
+     * Does nothing if tracing is not running.
+     *
+     * @param {string} name Will be prefixed with profiler name
+     *
+     * @example
+     * let profiler = new FbProfiler('Playlist');
+     * profiler.BeginSpan('Layout');
+     * // Do smth
+     * profiler.EndSpan();
+     */
+    this.BeginSpan = function (name) { }; // (void)
+
+    /**
+     * Ends the last span started with {@link FbProfiler#BeginSpan}.
+     */
+    this.EndSpan = function () { }; // (void)
+
     /** @method */
     this.Reset = function () { }; // (void)
 
@@ -2511,6 +2944,41 @@ function FbProfiler(name) {
     this.Print = function (additionalMsg, printComponentInfo) { }; // (void)
 }
 
+/**
+ * Compiled media library query, see {@link fb.CreateQuery}.
+ *
+ * @constructor
+ * @hideconstructor
+ */
+function FbQuery() {
+    /**
+     * @type {string}
+     * @readonly
+     */
+    this.Expression = undefined; // (string) (read)
+
+    /**
+     * @param {FbMetadbHandleList} handle_list
+     * @return {FbMetadbHandleList} Items that match the query
+     */
+    this.Filter = function (handle_list) { }; // (FbMetadbHandleList)
+
+    /**
+     * Returns media library items that match the query.<br>
+     * Performance note: the whole library is scanned only on first call (or if the query is not watched by any panel),
+     * afterwards the result is maintained incrementally.
+     *
+     * @return {FbMetadbHandleList} Items are sorted by pointer
+     */
+    this.GetLibraryItems = function () { }; // (FbMetadbHandleList)
+
+    /**
+     * @param {FbMetadbHandle} handle
+     * @return {boolean}
+     */
+    this.Test = function (handle) { }; // (boolean)
+}
+
 /**
  * Performance note: if you use the same query frequently, 
  * try caching FbTitleFormat object (by storing it somewhere),
@@ -2688,6 +3156,9 @@ function FbUiSelectionHolder() {
 }
 
 /**
+ * Copies of the image (including album art images that were loaded by several panels)
+ * share the same pixel data until one of them is modified.
+ *
  * @constructor
  * @param {GdiBitmap} arg
  */
@@ -2711,6 +3182,20 @@ function GdiBitmap(arg) {
      */
     this.ApplyAlpha = function (alpha) { }; // (GdiBitmap)
 
+    /**
+     * Applies colour effect to the bitmap.<br>
+     * Alpha channel is not changed.<br>
+     * Changes will be saved in the current bitmap.
+     *
+     * @param {number} effect See Flags.js > ImageEffect
+     * @param {number=} [value=0] Effect specific value:<br>
+     *     - Brightness: value to add to every colour channel, valid values -255-255.<br>
+     *     - Contrast: contrast in percents, 100 means no change.<br>
+     *     - Tint: tint strength, valid values 0-255.
+     * @param {number=} [colour=0] Tint colour, used only by Tint effect.
+     */
+    this.ApplyEffect = function (effect, value, colour) { };
+
     /**
      * Changes will be saved in the current bitmap.
      *
@@ -2721,6 +3206,18 @@ function GdiBitmap(arg) {
      */
     this.ApplyMask = function (img) { }; // (boolean)
 
+    /**
+     * Asynchronous version of {@link GdiBitmap#ApplyMask}.<br>
+     * Returns a `Promise` object, which will be resolved with a new bitmap when the operation is done:
+     * the current bitmap is not changed.<br>
+     * The work is performed in a background thread on a copy of the bitmap.
+     *
+     * @param {number} window_id see {@link window.ID}
+     * @param {GdiBitmap} img
+     * @return {Promise.<GdiBitmap>}
+     */
+    this.ApplyMaskAsync = function (window_id, img) { };
+
     /**
      * @param {number} x
      * @param {number} y
@@ -2743,6 +3240,17 @@ function GdiBitmap(arg) {
      */
     this.GetColourScheme = function (max_count) { }; // (Array)
 
+    /**
+     * Asynchronous version of {@link GdiBitmap#GetColourScheme}.<br>
+     * Returns a `Promise` object, which will be resolved when the operation is done.<br>
+     * The work is performed in a background thread on a copy of the bitmap.
+     *
+     * @param {number} window_id see {@link window.ID}
+     * @param {number} max_count
+     * @return {Promise.<Array<number>>}
+     */
+    this.GetColourSchemeAsync = function (window_id, max_count) { };
+
     /**
      * Returns a JSON array in string form so you need to use JSON.parse() on the result.<br>
      * Each entry in the array is an object which contains colour and frequency values.<br>
@@ -2764,18 +3272,61 @@ function GdiBitmap(arg) {
     this.GetColourSchemeJSON = function (max_count) { }; // (string)
 
     /**
-     * Note: don't forget to use {@link GdiBitmap#ReleaseGraphics} after work on GdiGraphics is done!
+     * Asynchronous version of {@link GdiBitmap#GetColourSchemeJSON}.<br>
+     * Returns a `Promise` object, which will be resolved when the operation is done.<br>
+     * The work is performed in a background thread on a copy of the bitmap.
+     *
+     * @param {number} window_id see {@link window.ID}
+     * @param {number} max_count
+     * @return {Promise.<string>}
+     */
+    this.GetColourSchemeJSONAsync = function (window_id, max_count) { };
+
+    /**
+     * Note: don't forget to use {@link GdiBitmap#ReleaseGraphics} after work on GdiGraphics is done!<br>
+     * Note: the image is never shared with its copies after this call, i.e. every copy is a full copy.
      *
      * @return {GdiGraphics}
      */
     this.GetGraphics = function () { };
 
+    /**
+     * Provides direct access to pixels of the image.<br>
+     * Pixels are stored row by row, 4 bytes per pixel in B, G, R, A order,
+     * i.e. `new Uint32Array(pixels.buffer)` contains colours in the same format as all the other methods (0xAARRGGBB).<br>
+     * Changes are applied to the image immediately (or on {@link GdiBitmap#UnlockPixels}, if the pixel format had to be converted).<br>
+     * <br>
+     * Note: {@link GdiBitmap#UnlockPixels} must be called before any other use of the image
+     * (e.g. drawing it, resizing it or saving it): such calls throw an error while pixels are locked.
+     * The returned array becomes empty after unlock.
+     *
+     * @param {boolean=} [premultiplied=true] If true, colour channels of pixels are premultiplied by alpha.<br>
+     *     This is the native format of images created by the panel (e.g. via {@link gdi.CreateImage}, {@link GdiBitmap#Resize}),
+     *     so pixels are accessed directly.<br>
+     *     If false or if the image has a different format (e.g. a JPEG loaded from disk), pixels are converted into a temporary copy
+     *     on lock and converted back on unlock.
+     * @return {Uint8ClampedArray}
+     *
+     * @example
+     * // straight (not premultiplied) colours are easier to modify, but they are copied
+     * let pixels = new Uint32Array(img.LockPixels(false).buffer);
+     * for (let i = 0; i < pixels.length; ++i) {
+     *     pixels[i] ^= 0x00FFFFFF; // invert colours
+     * }
+     * img.UnlockPixels();
+     */
+    this.LockPixels = function (premultiplied) { }; // (Uint8ClampedArray) [, premultiplied]
+
     /**
      * @param {GdiGraphics} gr
      */
     this.ReleaseGraphics = function (gr) { }; // (GdiGraphics)
 
     /**
+     * Box, Mitchell and Lanczos3 interpolation modes are handled by the native multi-threaded resampler,
+     * which is much faster than GdiPlus and does not produce semi-transparent edges.<br>
+     * Box (area averaging) is the fastest one and is best suited for creating thumbnails.
+     *
      * @param {number} w
      * @param {number} h
      * @param {number=} [mode=0] See Flags.js > InterpolationMode
@@ -2783,6 +3334,25 @@ function GdiBitmap(arg) {
      */
     this.Resize = function (w, h, mode) { }; // (GdiBitmap) [, mode]
 
+    /**
+     * Asynchronous version of {@link GdiBitmap#Resize}.<br>
+     * Returns a `Promise` object, which will be resolved when the operation is done.<br>
+     * The work is performed in a background thread on a copy of the bitmap.
+     *
+     * @param {number} window_id see {@link window.ID}
+     * @param {number} w
+     * @param {number} h
+     * @param {number=} [mode=0] See Flags.js > InterpolationMode
+     * @return {Promise.<GdiBitmap>}
+     *
+     * @example
+     * img.ResizeAsync(window.ID, 300, 300, 8).then((thumb) => {
+     *     thumbnail = thumb;
+     *     window.Repaint();
+     * });
+     */
+    this.ResizeAsync = function (window_id, w, h, mode) { };
+
     /**
      * Changes will be saved in the current bitmap.
      * 
@@ -2790,6 +3360,18 @@ function GdiBitmap(arg) {
      */
     this.RotateFlip = function (mode) { }; // (void)
 
+    /**
+     * Asynchronous version of {@link GdiBitmap#RotateFlip}.<br>
+     * Returns a `Promise` object, which will be resolved with a new bitmap when the operation is done:
+     * the current bitmap is not changed.<br>
+     * The work is performed in a background thread on a copy of the bitmap.
+     *
+     * @param {number} window_id see {@link window.ID}
+     * @param {number} mode See Flags.js > RotateFlipType
+     * @return {Promise.<GdiBitmap>}
+     */
+    this.RotateFlipAsync = function (window_id, mode) { };
+
     /**
      * @param {string} path Full path including file extension. The parent folder must already exist.
      * @param {string=} [format='image/png']
@@ -2808,6 +3390,18 @@ function GdiBitmap(arg) {
      */
     this.SaveAs = function (path, format) { }; // (boolean) [, format]
 
+    /**
+     * Asynchronous version of {@link GdiBitmap#SaveAs}.<br>
+     * Returns a `Promise` object, which will be resolved when the operation is done.<br>
+     * The work is performed in a background thread on a copy of the bitmap.
+     *
+     * @param {number} window_id see {@link window.ID}
+     * @param {string} path Full path including file extension. The parent folder must already exist.
+     * @param {string=} [format='image/png']
+     * @return {Promise.<boolean>}
+     */
+    this.SaveAsAsync = function (window_id, path, format) { };
+
     /**
      * Changes will be saved in the current bitmap.
      * 
@@ -2820,6 +3414,108 @@ function GdiBitmap(arg) {
      * // samples\basic\StackBlur (text).txt
      */
     this.StackBlur = function (radius) { }; // (void)
+
+    /**
+     * Asynchronous version of {@link GdiBitmap#StackBlur}.<br>
+     * Returns a `Promise` object, which will be resolved with a new bitmap when the operation is done:
+     * the current bitmap is not changed.<br>
+     * The work is performed in a background thread on a copy of the bitmap.
+     *
+     * @param {number} window_id see {@link window.ID}
+     * @param {number} radius Valid values 2-254.
+     * @return {Promise.<GdiBitmap>}
+     */
+    this.StackBlurAsync = function (window_id, radius) { };
+
+    /**
+     * Releases pixels that were locked via {@link GdiBitmap#LockPixels}.<br>
+     * Does nothing, if pixels are not locked.
+     */
+    this.UnlockPixels = function () { }; // (void)
+}
+
+/**
+ * Recorded list of drawing commands.<br>
+ * Commands are recorded once and then replayed with {@link GdiGraphics#Replay} as many times as needed,
+ * which is much cheaper than issuing the same calls from JS on every `on_paint`:
+ * arguments are converted and validated only during recording,
+ * and brushes and pens are created once and shared by all the commands with the same colour and line width.<br>
+ * <br>
+ * Methods have the same arguments as the corresponding {@link GdiGraphics} methods (unless stated otherwise).<br>
+ * Fonts and images used by the list are kept alive while the list exists (or until {@link GdiDrawList#Clear} is called).<br>
+ * Note: images are referenced, not copied, so changes to the image are visible on the next replay.
+ *
+ * @constructor
+ * @hideconstructor
+ *
+ * @example
+ * let draw_list = gdi.CreateDrawList();
+ * // recorded once...
+ * draw_list.FillSolidRect(0, 0, 100, 20, RGB(50, 50, 50));
+ * draw_list.DrawString('Title', font, RGB(255, 255, 255), 5, 0, 90, 20);
+ *
+ * function on_paint(gr) {
+ *     // ...replayed on every repaint
+ *     gr.Replay(draw_list);
+ * }
+ */
+function GdiDrawList() {
+    /**
+     * Amount of recorded commands.
+     *
+     * @type {number}
+     * @readonly
+     */
+    this.Count = undefined; // (uint) (read)
+
+    /**
+     * Removes all recorded commands.
+     */
+    this.Clear = function () { }; // (void)
+
+    this.DrawEllipse = function (x, y, w, h, line_width, colour) { }; // (void)
+
+    this.DrawImage = function (img, dstX, dstY, dstW, dstH, srcX, srcY, srcW, srcH, angle, alpha) { }; // (void) [, angle][, alpha]
+
+    /**
+     * @param {number} x1
+     * @param {number} y1
+     * @param {number} x2
+     * @param {number} y2
+     * @param {number} line_width
+     * @param {number} colour
+     */
+    this.DrawLine = function (x1, y1, x2, y2, line_width, colour) { }; // (void)
+
+    this.DrawRect = function (x, y, w, h, line_width, colour) { }; // (void)
+
+    this.DrawRoundRect = function (x, y, w, h, arc_width, arc_height, line_width, colour) { }; // (void)
+
+    /**
+     * @param {string} str
+     * @param {GdiFont} font
+     * @param {number} colour
+     * @param {number} x
+     * @param {number} y
+     * @param {number} w
+     * @param {number} h
+     * @param {number=} [flags=0] See Flags.js > StringFormatFlags
+     */
+    this.DrawString = function (str, font, colour, x, y, w, h, flags) { }; // (void) [, flags]
+
+    this.FillEllipse = function (x, y, w, h, colour) { }; // (void)
+
+    this.FillGradRect = function (x, y, w, h, angle, colour1, colour2, focus) { }; // (void) [, focus]
+
+    this.FillRoundRect = function (x, y, w, h, arc_width, arc_height, colour) { }; // (void)
+
+    this.FillSolidRect = function (x, y, w, h, colour) { }; // (void)
+
+    this.SetInterpolationMode = function (mode) { }; // (void) [, mode]
+
+    this.SetSmoothingMode = function (mode) { }; // (void) [, mode]
+
+    this.SetTextRenderingHint = function (mode) { }; // (void) [, mode]
 }
 
 /**
@@ -2831,6 +3527,30 @@ function GdiBitmap(arg) {
  * @param {number=} [style=0] See Flags.js > FontStyle
  */
 function GdiFont() {
+    /**
+     * Font ascent in pixels (as reported by Gdi).
+     *
+     * @type {number}
+     * @readonly
+     */
+    this.Ascent = undefined; // (uint) (read)
+
+    /**
+     * Average character width in pixels (as reported by Gdi).
+     *
+     * @type {number}
+     * @readonly
+     */
+    this.AvgCharWidth = undefined; // (uint) (read)
+
+    /**
+     * Font descent in pixels (as reported by Gdi).
+     *
+     * @type {number}
+     * @readonly
+     */
+    this.Descent = undefined; // (uint) (read)
+
     /**
      * @type {number}
      * @readonly
@@ -2876,7 +3596,11 @@ function GdiFont() {
  * Note: there are many different ways to get colours:
  * window.GetColourDUI/window.GetColourCUI,
  * RGB function from Helpers.js, utils.ColourPicker and
- * etc.
+ * etc.<br>
+ * <br>
+ * Performance note: switching between Gdi methods (`Gdi*`, `CalcText*`, `EstimateLineWrap`) and GdiPlus methods (the rest)
+ * is expensive, since each switch causes GdiPlus to flush the pending drawing operations.
+ * Consecutive Gdi calls share a single flush, so it's better to group them together when possible.
  *
  * @constructor
  * @hideconstructor
@@ -3181,6 +3905,14 @@ function GdiGraphics() {
         this.Width = undefined; // (float) (read)
     }
 
+    /**
+     * Executes all commands of the draw list.<br>
+     * Rendering state (smoothing mode and etc) that was changed by the list is not restored afterwards.
+     *
+     * @param {GdiDrawList} draw_list
+     */
+    this.Replay = function (draw_list) { }; // (void)
+
     /**
      * @param {number=} [mode=0] See Flags.js > InterpolationMode
      */
@@ -3368,6 +4100,85 @@ function MenuObject() {
     this.TrackPopupMenu = function (x, y, flags) { }; // (uint) [, flags]
 }
 
+/**
+ * Streaming text file reader, see {@link utils.OpenTextFile}.<br>
+ * Lines are separated by `\n`, trailing `\r` is removed.
+ *
+ * @constructor
+ * @hideconstructor
+ */
+function TextFileReader() {
+    /**
+     * Detected (or supplied) codepage of the file.
+     *
+     * @type {number}
+     * @readonly
+     */
+    this.CodePage = undefined; // (uint) (read)
+
+    /**
+     * Total amount of lines.<br>
+     * Performance note: the whole file is scanned on first access.
+     *
+     * @type {number}
+     * @readonly
+     */
+    this.LineCount = undefined; // (uint) (read)
+
+    /**
+     * Index of the line that will be returned by the next {@link TextFileReader#ReadLine} call.
+     *
+     * @type {number}
+     * @readonly
+     */
+    this.LineIndex = undefined; // (uint) (read)
+
+    /**
+     * File size in bytes.
+     *
+     * @type {number}
+     * @readonly
+     */
+    this.Size = undefined; // (uint64) (read)
+
+    /**
+     * Releases the file. Any other method call after this will throw an error.
+     */
+    this.Close = function () { }; // (void)
+
+    /**
+     * Reads whole lines from the current position, until at least `max_size` bytes are read (or the end of the file is reached).<br>
+     * At least one line is always read. Line separators are retained.
+     *
+     * @param {number} max_size Chunk size in bytes
+     * @return {?string} null, if there are no more lines
+     */
+    this.ReadChunk = function (max_size) { }; // (string)
+
+    /**
+     * Reads the line at the current position and advances it.
+     *
+     * @return {?string} null, if there are no more lines
+     */
+    this.ReadLine = function () { }; // (string)
+
+    /**
+     * Reads lines in range [start, start + count). Does not change the current position.
+     *
+     * @param {number} start
+     * @param {number} count
+     * @return {Array<string>} Might contain less than `count` lines, if the end of the file is reached
+     */
+    this.ReadLines = function (start, count) { }; // (Array<string>)
+
+    /**
+     * Changes the current position.
+     *
+     * @param {number} line_index Must not be larger than {@link TextFileReader#LineCount}
+     */
+    this.Seek = function (line_index) { }; // (void)
+}
+
 /**
  * @constructor
  * @hideconstructor
@@ -27,6 +27,8 @@ constexpr GUID menu_7 = { 0xfd142b78, 0x8fbf, 0x43ab, { 0x9b, 0xea, 0x6d, 0x23,
 constexpr GUID menu_8 = { 0x89992bdd, 0x6303, 0x4fbd, { 0xb1, 0xd5, 0xf5, 0x7b, 0x7e, 0x83, 0xaa, 0x96 } };
 constexpr GUID menu_9 = { 0x682a01a1, 0xe2ad, 0x404e, { 0x8c, 0xd8, 0xe3, 0x5b, 0xde, 0x3c, 0xb1, 0x18 } };
 constexpr GUID menu_10 = { 0x7a6ec255, 0x88d2, 0x44df, { 0xb9, 0xd3, 0x63, 0x8, 0x36, 0x5d, 0x52, 0xc8 } };
+constexpr GUID menu_sampling_profiler = { 0x7f66b3e3, 0x38f0, 0x4a69, { 0xb8, 0x1e, 0x1a, 0x37, 0x9e, 0xde, 0x12, 0x2a } };
+constexpr GUID menu_tracing = { 0xef0ff964, 0x4501, 0x444e, { 0x8f, 0xc1, 0xd7, 0xdd, 0x30, 0xd1, 0xa5, 0xfb } };
 constexpr GUID metadb_index = { 0xe58a4298, 0x65e, 0x469b, { 0xb5, 0xd6, 0x19, 0x91, 0x6, 0xe2, 0x83, 0xdd } };
 constexpr GUID scintilla_props = { 0xcec3d0de, 0x2db, 0x49b5, { 0xb2, 0x74, 0xda, 0x72, 0xba, 0xc0, 0x5, 0x25 } };
 constexpr GUID ui_pref = { 0x7602977a, 0x8727, 0x427f, { 0x9d, 0xd2, 0xbc, 0x3a, 0x5, 0x78, 0x21, 0x24 } };
@@ -16,6 +16,8 @@ constexpr uint32_t kPropConfigVersion = 1;
 
 constexpr const char kPropJsonConfigVersion[] = "1";
 constexpr const char kPropJsonConfigId[] = "properties";
+/// @brief Key for base64-encoded structured values (see mozjs::SerializedJsStructure)
+constexpr const char kPropJsonStructureId[] = "structure";
 
 } // namespace
 
@@ -40,15 +42,15 @@ PanelProperties::config_map& PanelProperties::get_val()
     return m_map;
 }
 
-std::optional<mozjs::SerializedJsValue> PanelProperties::get_config_item( const std::wstring& propName )
+std::shared_ptr<const mozjs::SerializedJsValue> PanelProperties::get_config_item( const std::wstring& propName )
 {
     auto it = m_map.find( propName );
     if ( it == m_map.end() )
     {
-        return std::nullopt;
+        return nullptr;
     }
 
-    return *( it->second );
+    return it->second;
 }
 
 void PanelProperties::set_config_item( const std::wstring& propName, const mozjs::SerializedJsValue& serializedValue )
@@ -133,6 +135,15 @@ bool PanelProperties::g_load_json( config_map& data, stream_reader& reader, abor
             {
                 serializedValue = value.get<std::string>();
             }
+            else if ( value.is_object() && value.count( kPropJsonStructureId ) )
+            {
+                const auto base64Str = value.at( kPropJsonStructureId ).get<std::string>();
+
+                mozjs::SerializedJsStructure structure;
+                structure.data.resize( pfc::base64_decode_estimate( base64Str.c_str() ) );
+                pfc::base64_decode( base64Str.c_str(), structure.data.data() );
+                serializedValue = std::move( structure );
+            }
             else
             {
                 assert( 0 );
@@ -190,7 +201,17 @@ void PanelProperties::g_save_json( const config_map& data, stream_writer& writer
             const auto& serializedValue = *pValue;
 
             std::visit( [&jsonValues, &propertyName]( auto&& arg ) {
-                jsonValues.push_back( { propertyName, arg } );
+                using T = std::decay_t<decltype( arg )>;
+                if constexpr ( std::is_same_v<T, mozjs::SerializedJsStructure> )
+                {
+                    pfc::string8_fast base64Str;
+                    pfc::base64_encode( base64Str, arg.data.data(), arg.data.size() );
+                    jsonValues.push_back( { propertyName, json::object( { { kPropJsonStructureId, base64Str.c_str() } } ) } );
+                }
+                else
+                {
+                    jsonValues.push_back( { propertyName, arg } );
+                }
             }, serializedValue );
         }
 
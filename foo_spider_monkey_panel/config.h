@@ -28,7 +28,8 @@ public:
     using config_map = std::unordered_map<std::wstring, std::shared_ptr<mozjs::SerializedJsValue>>;
 
     config_map& get_val();
-    std::optional<mozjs::SerializedJsValue> get_config_item( const std::wstring& propName );
+    /// @return null, if there is no such property
+    std::shared_ptr<const mozjs::SerializedJsValue> get_config_item( const std::wstring& propName );
     void set_config_item( const std::wstring& propName, const mozjs::SerializedJsValue& serializedValue );
     void remove_config_item( const std::wstring& propName );
 
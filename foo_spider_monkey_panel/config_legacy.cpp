@@ -12,6 +12,7 @@ enum class JsValueType : uint32_t
     pt_int32 = 1,
     pt_double = 2,
     pt_string = 3,
+    pt_structure = 4,
 };
 
 }
@@ -65,6 +66,17 @@ bool LoadProperties_Binary( PanelProperties::config_map& data, stream_reader& re
                 serializedValue = smp::pfc_x::ReadString( reader, abort );
                 break;
             }
+            case JsValueType::pt_structure:
+            {
+                uint32_t size;
+                reader.read_lendian_t( size, abort );
+
+                mozjs::SerializedJsStructure value;
+                value.data.resize( size );
+                reader.read_object( value.data.data(), size, abort );
+                serializedValue = std::move( value );
+                break;
+            }
             default:
             {
                 assert( 0 );
@@ -113,6 +125,10 @@ void SaveProperties_Binary( const PanelProperties::config_map& data, stream_writ
                 {
                     return JsValueType::pt_string;
                 }
+                else if constexpr ( std::is_same_v<T, mozjs::SerializedJsStructure> )
+                {
+                    return JsValueType::pt_structure;
+                }
                 else
                 {
                     static_assert( false, "non-exhaustive visitor!" );
@@ -128,6 +144,12 @@ void SaveProperties_Binary( const PanelProperties::config_map& data, stream_writ
                     const auto& value = arg;
                     writer.write_string( value.c_str(), value.length(), abort );
                 }
+                else if constexpr ( std::is_same_v<T, mozjs::SerializedJsStructure> )
+                {
+                    const auto& value = arg.data;
+                    writer.write_lendian_t( static_cast<uint32_t>( value.size() ), abort );
+                    writer.write_object( value.data(), value.size(), abort );
+                }
                 else
                 {
                     writer.write_lendian_t( arg, abort );
@@ -175,9 +175,9 @@ void JsArrayToComArray( JSContext* cx, JS::HandleObject obj, VARIANT& var )
             SafeArrayUnaccessData( safeArray );
         } );
 
+        JS::RootedValue val( cx );
         for ( uint32_t i = 0; i < len; ++i )
         {
-            JS::RootedValue val( cx );
             if ( !JS_GetElement( cx, obj, i, &val ) )
             {
                 throw smp::JsException();
@@ -192,61 +192,154 @@ void JsArrayToComArray( JSContext* cx, JS::HandleObject obj, VARIANT& var )
     autoSa.cancel(); // cancel array destruction
 }
 
+void JsTypedArrayToComArray( JSContext* cx, JS::HandleObject obj, VARIANT& var )
+{
+    const VARTYPE vartype = [arrayType = JS_GetArrayBufferViewType( obj )] {
+        switch ( arrayType )
+        {
+        case js::Scalar::Int8:
+            return VT_I1;
+        case js::Scalar::Uint8:
+        case js::Scalar::Uint8Clamped:
+            return VT_UI1;
+        case js::Scalar::Int16:
+            return VT_I2;
+        case js::Scalar::Uint16:
+            return VT_UI2;
+        case js::Scalar::Int32:
+            return VT_I4;
+        case js::Scalar::Uint32:
+            return VT_UI4;
+        case js::Scalar::Float32:
+            return VT_R4;
+        case js::Scalar::Float64:
+            return VT_R8;
+        default:
+            throw SmpException( "ActiveX: unsupported typed array type" );
+        }
+    }();
+
+    const uint32_t len = JS_GetTypedArrayLength( obj );
+    const uint32_t byteLength = JS_GetTypedArrayByteLength( obj );
+
+    SAFEARRAY* safeArray = SafeArrayCreateVector( vartype, 0, len );
+    SmpException::ExpectTrue( safeArray, "SafeArrayCreateVector failed" );
+
+    utils::final_action autoSa( [safeArray]() {
+        SafeArrayDestroy( safeArray );
+    } );
+
+    if ( len )
+    {
+        void* pSaData = nullptr;
+        HRESULT hr = SafeArrayAccessData( safeArray, &pSaData );
+        smp::error::CheckHR( hr, "SafeArrayAccessData" );
+
+        utils::final_action autoSaData( [safeArray]() {
+            SafeArrayUnaccessData( safeArray );
+        } );
+
+        JS::AutoCheckCannotGC nogc;
+        bool isShared;
+        const void* pJsData = JS_GetArrayBufferViewData( obj, &isShared, nogc );
+        memcpy( pSaData, pJsData, byteLength );
+    }
+
+    var.vt = VT_ARRAY | vartype;
+    var.parray = safeArray;
+    autoSa.cancel(); // cancel array destruction
+}
+
+/// @brief Converts element of the accessed SAFEARRAY without copying it to an intermediate VARIANT
+void ComArrayElementToJs( JSContext* cx, VARTYPE vartype, void* pElement, JS::MutableHandleValue jsValue )
+{
+    if ( vartype == VT_VARIANT )
+    {
+        VariantToJs( cx, *static_cast<VARIANT*>( pElement ), jsValue );
+    }
+    else
+    {
+        VARIANT var; ///< not owning: must not be cleared
+        var.vt = vartype | VT_BYREF;
+        var.byref = pElement;
+        VariantToJs( cx, var, jsValue );
+    }
+}
+
 bool ComArrayToJsArray( JSContext* cx, const VARIANT& src, JS::MutableHandleValue& dest )
 {
+    SAFEARRAY* safeArray = ( src.vt & VT_BYREF ) ? *src.pparray : src.parray;
+    SmpException::ExpectTrue( safeArray, "ActiveX: array is null" );
+
     // We only support one dimensional arrays for now
-    SmpException::ExpectTrue( SafeArrayGetDim( src.parray ) == 1, "Multi-dimensional array are not supported failed" );
+    SmpException::ExpectTrue( SafeArrayGetDim( safeArray ) == 1, "Multi-dimensional array are not supported failed" );
 
     // Get the upper bound;
     long ubound;
-    HRESULT hr = SafeArrayGetUBound( src.parray, 1, &ubound );
+    HRESULT hr = SafeArrayGetUBound( safeArray, 1, &ubound );
     smp::error::CheckHR( hr, "SafeArrayGetUBound" );
 
     // Get the lower bound
     long lbound;
-    hr = SafeArrayGetLBound( src.parray, 1, &lbound );
+    hr = SafeArrayGetLBound( safeArray, 1, &lbound );
     smp::error::CheckHR( hr, "SafeArrayGetLBound" );
 
-    // Create the JS Array
-    JS::RootedObject jsArray( cx, JS_NewArrayObject( cx, ubound - lbound + 1 ) );
-    JsException::ExpectTrue( jsArray );
+    const uint32_t len = static_cast<uint32_t>( ubound - lbound + 1 );
 
     // Divine the type of our array
     VARTYPE vartype;
     if ( ( src.vt & VT_ARRAY ) != 0 )
     {
-        vartype = src.vt & ~VT_ARRAY;
+        vartype = src.vt & ~( VT_ARRAY | VT_BYREF );
     }
     else // This was maybe a VT_SAFEARRAY
     {
-        hr = SafeArrayGetVartype( src.parray, &vartype );
+        hr = SafeArrayGetVartype( safeArray, &vartype );
         smp::error::CheckHR( hr, "SafeArrayGetVartype" );
     }
 
-    JS::RootedValue jsVal( cx );
-    for ( long i = lbound; i <= ubound; ++i )
-    {
-        HRESULT hr;
-        _variant_t var;
-        if ( vartype == VT_VARIANT )
-        {
-            hr = SafeArrayGetElement( src.parray, &i, &var );
-        }
-        else
-        {
-            var.vt = vartype;
-            hr = SafeArrayGetElement( src.parray, &i, &var.byref );
-        }
-        smp::error::CheckHR( hr, "SafeArrayGetElement" );
+    // Access the whole array at once instead of copying every element with SafeArrayGetElement
+    uint8_t* pSaData = nullptr;
+    hr = SafeArrayAccessData( safeArray, reinterpret_cast<void**>( &pSaData ) );
+    smp::error::CheckHR( hr, "SafeArrayAccessData" );
+
+    utils::final_action autoSaData( [safeArray]() {
+        SafeArrayUnaccessData( safeArray );
+    } );
 
-        VariantToJs( cx, var, &jsVal );
+    if ( vartype == VT_UI1 || vartype == VT_R8 )
+    { // fast path: plain data can be copied directly to typed array
+        JS::RootedObject jsArray( cx, ( vartype == VT_UI1 ? JS_NewUint8Array( cx, len ) : JS_NewFloat64Array( cx, len ) ) );
+        JsException::ExpectTrue( jsArray );
 
-        if ( !JS_SetElement( cx, jsArray, i, jsVal ) )
+        if ( len )
         {
-            throw smp::JsException();
+            JS::AutoCheckCannotGC nogc;
+            bool isShared;
+            void* pJsData = JS_GetArrayBufferViewData( jsArray, &isShared, nogc );
+            memcpy( pJsData, pSaData, len * SafeArrayGetElemsize( safeArray ) );
         }
+
+        dest.setObjectOrNull( jsArray );
+        return true;
+    }
+
+    const size_t elementSize = SafeArrayGetElemsize( safeArray );
+
+    JS::AutoValueVector jsValues( cx );
+    if ( !jsValues.resize( len ) )
+    {
+        throw std::bad_alloc();
+    }
+
+    for ( uint32_t i = 0; i < len; ++i )
+    {
+        ComArrayElementToJs( cx, vartype, pSaData + i * elementSize, jsValues[i] );
     }
 
+    JS::RootedObject jsArray( cx, JS_NewArrayObject( cx, jsValues ) );
+    JsException::ExpectTrue( jsArray );
+
     dest.setObjectOrNull( jsArray );
     return true;
 }
@@ -374,14 +467,14 @@ void VariantToJs( JSContext* cx, VARIANTARG& var, JS::MutableHandleValue rval )
         }
         break;
     default:
-        if ( ( type & VT_ARRAY ) && !( type & VT_UI1 ) )
-        {// skip binary data: SMP has no use for it, but it's needed in COM interface
+        if ( type & VT_ARRAY )
+        {
             ComArrayToJsArray( cx, var, rval );
             break;
         }
         else
         {
-            SmpException::ExpectTrue( type <= VT_CLSID || type == ( VT_ARRAY | VT_UI1 ), "ActiveX: unsupported object type: {:#x}", type );
+            SmpException::ExpectTrue( type <= VT_CLSID, "ActiveX: unsupported object type: {:#x}", type );
 
             JS::RootedObject jsObject( cx, ActiveXObject::CreateJsFromNative( cx, std::make_unique<ActiveXObject>( cx, var ) ) );
             assert( jsObject );
@@ -438,6 +531,10 @@ void JsToVariant( JSContext* cx, JS::HandleValue rval, VARIANTARG& arg )
             arg.vt = VT_DISPATCH;
             arg.pdispVal = new com_object_impl_t<WrappedJs>( cx, func );
         }
+        else if ( JS_IsTypedArrayObject( j0 ) )
+        {
+            JsTypedArrayToComArray( cx, j0, arg );
+        }
         else
         {
             bool is;
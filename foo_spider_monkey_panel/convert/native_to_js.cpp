@@ -6,6 +6,10 @@
 #include <js_objects/fb_metadb_handle_list.h>
 #include <js_objects/fb_playback_queue_item.h>
 #include <js_objects/gdi_bitmap.h>
+#include <js_utils/js_object_helper.h>
+#include <utils/file_watcher.h>
+#include <utils/handle_grouping.h>
+#include <utils/playlist_journal.h>
 
 
 namespace mozjs::convert::to_js
@@ -23,6 +27,18 @@ void ToValue( JSContext * cx, std::unique_ptr<Gdiplus::Bitmap> inValue, JS::Muta
     wrappedValue.setObjectOrNull( JsGdiBitmap::CreateJs( cx, std::move( inValue ) ) );
 }
 
+template <>
+void ToValue( JSContext* cx, const std::shared_ptr<Gdiplus::Bitmap>& inValue, JS::MutableHandleValue wrappedValue )
+{
+    if ( !inValue )
+    { // Not an error
+        wrappedValue.setNull();
+        return;
+    }
+
+    wrappedValue.setObjectOrNull( JsGdiBitmap::CreateJs( cx, inValue ) );
+}
+
 template <>
 void ToValue( JSContext *, JS::HandleObject inValue, JS::MutableHandleValue wrappedValue )
 {
@@ -149,4 +165,188 @@ void ToValue( JSContext* cx, const t_playback_queue_item& inValue, JS::MutableHa
     wrappedValue.setObjectOrNull( JsFbPlaybackQueueItem::CreateJs( cx, inValue ) );
 }
 
+template <>
+void ToValue( JSContext* cx, const smp::utils::FileChangeEvent& inValue, JS::MutableHandleValue wrappedValue )
+{
+    using smp::utils::FileChangeType;
+
+    JS::RootedObject jsObject( cx, JS_NewPlainObject( cx ) );
+    smp::JsException::ExpectTrue( jsObject );
+
+    JS::RootedValue jsValue( cx );
+    ToValue( cx, inValue.path.wstring(), &jsValue );
+    if ( !JS_DefineProperty( cx, jsObject, "path", jsValue, DefaultPropsFlags() ) )
+    {
+        throw smp::JsException();
+    }
+
+    const std::u8string action = [type = inValue.type] {
+        switch ( type )
+        {
+        case FileChangeType::added:
+            return "added";
+        case FileChangeType::removed:
+            return "removed";
+        case FileChangeType::modified:
+            return "modified";
+        case FileChangeType::rescan:
+            return "rescan";
+        default:
+            assert( 0 );
+            return "";
+        }
+    }();
+    ToValue( cx, action, &jsValue );
+    if ( !JS_DefineProperty( cx, jsObject, "action", jsValue, DefaultPropsFlags() ) )
+    {
+        throw smp::JsException();
+    }
+
+    wrappedValue.setObject( *jsObject );
+}
+
+template <>
+void ToValue( JSContext* cx, const std::vector<smp::utils::FileChangeEvent>& inValue, JS::MutableHandleValue wrappedValue )
+{
+    ToArrayValue(
+        cx,
+        inValue,
+        []( const auto& vec, auto index ) -> const auto& {
+            return vec[index];
+        },
+        wrappedValue );
+}
+
+template <>
+void ToValue( JSContext* cx, const smp::utils::HandleGroup& inValue, JS::MutableHandleValue wrappedValue )
+{
+    JS::RootedObject jsObject( cx, JS_NewPlainObject( cx ) );
+    smp::JsException::ExpectTrue( jsObject );
+
+    JS::RootedValue jsValue( cx );
+    ToValue( cx, inValue.key, &jsValue );
+    if ( !JS_DefineProperty( cx, jsObject, "key", jsValue, DefaultPropsFlags() )
+         || !JS_DefineProperty( cx, jsObject, "start", static_cast<uint32_t>( inValue.start ), DefaultPropsFlags() )
+         || !JS_DefineProperty( cx, jsObject, "count", static_cast<uint32_t>( inValue.count ), DefaultPropsFlags() ) )
+    {
+        throw smp::JsException();
+    }
+
+    if ( inValue.duration
+         && !JS_DefineProperty( cx, jsObject, "duration", *inValue.duration, DefaultPropsFlags() ) )
+    {
+        throw smp::JsException();
+    }
+    if ( inValue.size
+         && !JS_DefineProperty( cx, jsObject, "size", static_cast<double>( *inValue.size ), DefaultPropsFlags() ) )
+    {
+        throw smp::JsException();
+    }
+
+    wrappedValue.setObject( *jsObject );
+}
+
+template <>
+void ToValue( JSContext* cx, const smp::utils::PlaylistChange& inValue, JS::MutableHandleValue wrappedValue )
+{
+    using smp::utils::PlaylistChangeType;
+
+    JS::RootedObject jsObject( cx, JS_NewPlainObject( cx ) );
+    smp::JsException::ExpectTrue( jsObject );
+
+    const std::u8string type = [type = inValue.type] {
+        switch ( type )
+        {
+        case PlaylistChangeType::added:
+            return "added";
+        case PlaylistChangeType::removed:
+            return "removed";
+        case PlaylistChangeType::reordered:
+            return "reordered";
+        case PlaylistChangeType::replaced:
+            return "replaced";
+        default:
+            assert( 0 );
+            return "";
+        }
+    }();
+
+    JS::RootedValue jsValue( cx );
+    ToValue( cx, type, &jsValue );
+    if ( !JS_DefineProperty( cx, jsObject, "type", jsValue, DefaultPropsFlags() )
+         || !JS_DefineProperty( cx, jsObject, "version", inValue.version, DefaultPropsFlags() ) )
+    {
+        throw smp::JsException();
+    }
+
+    switch ( inValue.type )
+    {
+    case PlaylistChangeType::added:
+    {
+        ToValue( cx, inValue.handles, &jsValue );
+        if ( !JS_DefineProperty( cx, jsObject, "start", static_cast<uint32_t>( inValue.start ), DefaultPropsFlags() )
+             || !JS_DefineProperty( cx, jsObject, "handles", jsValue, DefaultPropsFlags() ) )
+        {
+            throw smp::JsException();
+        }
+        break;
+    }
+    case PlaylistChangeType::removed:
+    { // flattened: [start0, count0, start1, count1, ...]
+        std::vector<uint32_t> ranges;
+        ranges.reserve( inValue.ranges.size() * 2 );
+        for ( const auto& [start, count]: inValue.ranges )
+        {
+            ranges.emplace_back( static_cast<uint32_t>( start ) );
+            ranges.emplace_back( static_cast<uint32_t>( count ) );
+        }
+
+        ToArrayValue(
+            cx,
+            ranges,
+            []( const auto& vec, auto index ) {
+                return vec[index];
+            },
+            &jsValue );
+        if ( !JS_DefineProperty( cx, jsObject, "ranges", jsValue, DefaultPropsFlags() ) )
+        {
+            throw smp::JsException();
+        }
+        break;
+    }
+    case PlaylistChangeType::reordered:
+    case PlaylistChangeType::replaced:
+    {
+        ToArrayValue(
+            cx,
+            inValue.indices,
+            []( const auto& vec, auto index ) {
+                return static_cast<uint32_t>( vec[index] );
+            },
+            &jsValue );
+        if ( !JS_DefineProperty( cx, jsObject, ( inValue.type == PlaylistChangeType::reordered ? "order" : "indices" ), jsValue, DefaultPropsFlags() ) )
+        {
+            throw smp::JsException();
+        }
+
+        if ( inValue.type == PlaylistChangeType::replaced )
+        {
+            ToValue( cx, inValue.handles, &jsValue );
+            if ( !JS_DefineProperty( cx, jsObject, "handles", jsValue, DefaultPropsFlags() ) )
+            {
+                throw smp::JsException();
+            }
+        }
+        break;
+    }
+    default:
+    {
+        assert( 0 );
+        break;
+    }
+    }
+
+    wrappedValue.setObject( *jsObject );
+}
+
 }
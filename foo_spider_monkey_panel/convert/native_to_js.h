@@ -1,5 +1,14 @@
 #pragma once
 
+#include <vector>
+
+namespace smp::utils
+{
+struct FileChangeEvent;
+struct HandleGroup;
+struct PlaylistChange;
+}
+
 namespace mozjs::convert::to_js
 {
 
@@ -30,6 +39,10 @@ void ToValue( JSContext* cx, const InType& inValue, JS::MutableHandleValue wrapp
     static_assert( 0, "Unsupported type" );
 }
 
+/// @details Bitmap is shared with the created GdiBitmap object
+template <>
+void ToValue( JSContext* cx, const std::shared_ptr<Gdiplus::Bitmap>& inValue, JS::MutableHandleValue wrappedValue );
+
 template <>
 void ToValue( JSContext* cx, const bool& inValue, JS::MutableHandleValue wrappedValue );
 
@@ -83,6 +96,18 @@ void ToValue( JSContext* cx, const metadb_handle_list& inValue, JS::MutableHandl
 template <>
 void ToValue( JSContext* cx, const t_playback_queue_item& inValue, JS::MutableHandleValue wrappedValue );
 
+template <>
+void ToValue( JSContext* cx, const smp::utils::FileChangeEvent& inValue, JS::MutableHandleValue wrappedValue );
+
+template <>
+void ToValue( JSContext* cx, const std::vector<smp::utils::FileChangeEvent>& inValue, JS::MutableHandleValue wrappedValue );
+
+template <>
+void ToValue( JSContext* cx, const smp::utils::HandleGroup& inValue, JS::MutableHandleValue wrappedValue );
+
+template <>
+void ToValue( JSContext* cx, const smp::utils::PlaylistChange& inValue, JS::MutableHandleValue wrappedValue );
+
 template <typename T, typename F>
 void ToArrayValue( JSContext* cx, const T& inVector, F&& accessorFunc, JS::MutableHandleValue wrappedValue )
 {
@@ -5,8 +5,14 @@
 #include <abort_callback.h>
 
 #include <js_engine/js_engine.h>
+#include <utils/background_snapshot.h>
+#include <utils/bitmap_cache.h>
 #include <utils/delayed_executor.h>
+#include <utils/dib_pool.h>
 #include <utils/error_popup.h>
+#include <utils/file_watcher.h>
+#include <utils/font_cache.h>
+#include <utils/library_query.h>
 #include <utils/thread_pool.h>
 
 #include <map>
@@ -125,6 +131,12 @@ public:
         smp::panel::message_manager::instance().send_msg_to_all( static_cast<UINT>( smp::InternalSyncMessage::terminate_script ) );
         smp::GlobalAbortCallback::GetInstance().Abort();
         smp::ThreadPool::GetInstance().Finalize();
+        smp::utils::FileWatcher::GetInstance().Finalize();
+        smp::utils::LibraryQueryManager::GetInstance().Finalize();
+        smp::utils::FontCache::GetInstance().Finalize();
+        smp::utils::BitmapCache::GetInstance().Finalize();
+        smp::gdi::DibPool::GetInstance().Finalize();
+        smp::gdi::BackgroundSnapshotCache::GetInstance().Finalize();
     }
 
 private:
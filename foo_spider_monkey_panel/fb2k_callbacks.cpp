@@ -1,5 +1,8 @@
 #include <stdafx.h>
 
+#include <utils/library_query.h>
+#include <utils/playlist_journal.h>
+
 #include <message_manager.h>
 
 namespace
@@ -165,18 +168,21 @@ void my_initquit::outputConfigChanged()
 
 void my_library_callback::on_items_added( metadb_handle_list_cref p_data )
 {
+    smp::utils::LibraryQueryManager::GetInstance().OnItemsAdded( p_data );
     panel::message_manager::instance().post_callback_msg_to_all( CallbackMessage::fb_library_items_added,
                                                                  std::make_unique<CallbackDataImpl<metadb_handle_list>>( p_data ) );
 }
 
 void my_library_callback::on_items_modified( metadb_handle_list_cref p_data )
 {
+    smp::utils::LibraryQueryManager::GetInstance().OnItemsModified( p_data );
     panel::message_manager::instance().post_callback_msg_to_all( CallbackMessage::fb_library_items_changed,
                                                                  std::make_unique<CallbackDataImpl<metadb_handle_list>>( p_data ) );
 }
 
 void my_library_callback::on_items_removed( metadb_handle_list_cref p_data )
 {
+    smp::utils::LibraryQueryManager::GetInstance().OnItemsRemoved( p_data );
     panel::message_manager::instance().post_callback_msg_to_all( CallbackMessage::fb_library_items_removed,
                                                                  std::make_unique<CallbackDataImpl<metadb_handle_list>>( p_data ) );
 }
@@ -299,7 +305,7 @@ void my_config_object_notify::on_watched_object_changed( const config_object::pt
 
 unsigned my_playlist_callback_static::get_flags()
 {
-    return flag_on_items_added | flag_on_items_reordered | flag_on_items_removed | flag_on_items_selection_change | flag_on_item_focus_change | flag_on_item_ensure_visible | flag_on_playlist_activate | flag_on_playlist_created | flag_on_playlists_reorder | flag_on_playlists_removed | flag_on_playlist_renamed | flag_on_playback_order_changed | flag_on_playlist_locked;
+    return flag_on_items_added | flag_on_items_reordered | flag_on_items_removed | flag_on_items_replaced | flag_on_items_selection_change | flag_on_item_focus_change | flag_on_item_ensure_visible | flag_on_playlist_activate | flag_on_playlist_created | flag_on_playlists_reorder | flag_on_playlists_removed | flag_on_playlist_renamed | flag_on_playback_order_changed | flag_on_playlist_locked;
 }
 
 void my_playlist_callback_static::on_default_format_changed()
@@ -319,7 +325,9 @@ void my_playlist_callback_static::on_item_focus_change( t_size p_playlist, t_siz
 
 void my_playlist_callback_static::on_items_added( t_size p_playlist, t_size p_start, metadb_handle_list_cref p_data, const pfc::bit_array& p_selection )
 {
-    panel::message_manager::instance().post_msg_to_all( static_cast<UINT>( PlayerMessage::fb_playlist_items_added ), p_playlist );
+    const auto version = smp::utils::PlaylistJournal::GetInstance().OnItemsAdded( p_playlist, p_start, p_data );
+    panel::message_manager::instance().post_callback_msg_to_all( CallbackMessage::fb_playlist_items_added,
+                                                                 std::make_unique<CallbackDataImpl<t_size, uint32_t>>( p_playlist, version ) );
 }
 
 void my_playlist_callback_static::on_items_removing( t_size p_playlist, const pfc::bit_array& p_mask, t_size p_old_count, t_size p_new_count )
@@ -328,16 +336,21 @@ void my_playlist_callback_static::on_items_removing( t_size p_playlist, const pf
 
 void my_playlist_callback_static::on_items_removed( t_size p_playlist, const pfc::bit_array& p_mask, t_size p_old_count, t_size p_new_count )
 {
-    panel::message_manager::instance().post_msg_to_all( static_cast<UINT>( PlayerMessage::fb_playlist_items_removed ), p_playlist, p_new_count );
+    const auto version = smp::utils::PlaylistJournal::GetInstance().OnItemsRemoved( p_playlist, p_mask, p_old_count );
+    panel::message_manager::instance().post_callback_msg_to_all( CallbackMessage::fb_playlist_items_removed,
+                                                                 std::make_unique<CallbackDataImpl<t_size, t_size, uint32_t>>( p_playlist, p_new_count, version ) );
 }
 
 void my_playlist_callback_static::on_items_reordered( t_size p_playlist, const t_size* p_order, t_size p_count )
 {
-    panel::message_manager::instance().post_msg_to_all( static_cast<UINT>( PlayerMessage::fb_playlist_items_reordered ), p_playlist );
+    const auto version = smp::utils::PlaylistJournal::GetInstance().OnItemsReordered( p_playlist, p_order, p_count );
+    panel::message_manager::instance().post_callback_msg_to_all( CallbackMessage::fb_playlist_items_reordered,
+                                                                 std::make_unique<CallbackDataImpl<t_size, uint32_t>>( p_playlist, version ) );
 }
 
 void my_playlist_callback_static::on_items_replaced( t_size p_playlist, const pfc::bit_array& p_mask, const pfc::list_base_const_t<t_on_items_replaced_entry>& p_data )
-{
+{ // there is no dedicated JS callback: change is delivered via journal only
+    (void)smp::utils::PlaylistJournal::GetInstance().OnItemsReplaced( p_playlist, p_data );
 }
 
 void my_playlist_callback_static::on_items_selection_change( t_size p_playlist, const pfc::bit_array& p_affected, const pfc::bit_array& p_state )
@@ -368,6 +381,7 @@ void my_playlist_callback_static::on_playlist_activate( t_size p_old, t_size p_n
 
 void my_playlist_callback_static::on_playlist_created( t_size p_index, const char* p_name, t_size p_name_len )
 {
+    smp::utils::PlaylistJournal::GetInstance().OnPlaylistCreated( p_index );
     on_playlists_changed();
 }
 
@@ -387,11 +401,13 @@ void my_playlist_callback_static::on_playlists_removing( const pfc::bit_array& p
 
 void my_playlist_callback_static::on_playlists_removed( const pfc::bit_array& p_mask, t_size p_old_count, t_size p_new_count )
 {
+    smp::utils::PlaylistJournal::GetInstance().OnPlaylistsRemoved( p_mask, p_old_count );
     on_playlists_changed();
 }
 
 void my_playlist_callback_static::on_playlists_reorder( const t_size* p_order, t_size p_count )
 {
+    smp::utils::PlaylistJournal::GetInstance().OnPlaylistsReordered( p_order, p_count );
     on_playlists_changed();
 }
 
@@ -113,6 +113,10 @@ void JsContainer::Finalize()
         jsStatus_ = JsStatus::Ready;
     }
 
+    if ( pNativeGraphics_ )
+    { // might be called from `on_paint`: graphics object must be detached before it is destroyed
+        pNativeGraphics_->SetGraphicsObject( nullptr );
+    }
     pNativeGraphics_ = nullptr;
     jsGraphics_.reset();
     jsDropAction_.reset();
@@ -189,6 +193,8 @@ bool JsContainer::ExecuteScript( const std::u8string& scriptCode )
     OnJsActionStart();
     smp::utils::final_action autoAction( [&] { OnJsActionEnd(); } );
 
+    SMP_TRACE_SCOPE( "script", "ExecuteScript: <main>" );
+
     JS::RootedValue dummyRval( pJsCtx_ );
     bool bRet = JS::Evaluate( pJsCtx_, opts, scriptCode.c_str(), scriptCode.length(), &dummyRval );
 
@@ -274,7 +280,7 @@ void JsContainer::InvokeOnPaint( Gdiplus::Graphics& gr )
     }
 
     auto selfSaver = shared_from_this();
-    pNativeGraphics_->SetGraphicsObject( &gr );
+    pNativeGraphics_->SetGraphicsObject( &gr, true );
 
     (void)InvokeJsCallback( "on_paint",
                             static_cast<JS::HandleObject>( jsGraphics_ ) );
@@ -2,6 +2,7 @@
 
 #include <js_engine/native_to_js_invoker.h>
 #include <utils/scope_helpers.h>
+#include <utils/trace_recorder.h>
 
 #include <optional>
 
@@ -70,6 +71,8 @@ public:
 
         auto selfSaver = shared_from_this();
 
+        SMP_TRACE_SCOPE( "callback", functionName );
+
         OnJsActionStart();
         smp::utils::final_action autoAction( [&] { OnJsActionEnd(); } );
 
@@ -10,6 +10,7 @@
 #include <utils/scope_helpers.h>
 #include <utils/string_helpers.h>
 #include <utils/thread_helpers.h>
+#include <utils/trace_recorder.h>
 
 #include <adv_config.h>
 #include <heartbeat_window.h>
@@ -50,6 +51,34 @@ void ReportException( const std::u8string& errorText )
     smp::utils::ShowErrorPopup( errorTextPadded.c_str() );
 }
 
+void GcSliceCallback( JSContext* cx, JS::GCProgress progress, const JS::GCDescription& /* desc */ )
+{
+    if ( !smp::utils::TraceRecorder::IsEnabled() )
+    {
+        return;
+    }
+
+    // Only slices are traced as spans: JS code is executed between slices of the same cycle,
+    // so cycle spans would not nest properly.
+    auto& traceRecorder = smp::utils::TraceRecorder::GetInstance();
+    switch ( progress )
+    {
+    case JS::GC_SLICE_BEGIN:
+    {
+        traceRecorder.Begin( "gc", "GC slice" );
+        break;
+    }
+    case JS::GC_SLICE_END:
+    {
+        traceRecorder.End( "gc" );
+        traceRecorder.Counter( "gc", "GC heap size", static_cast<double>( JS_GetGCParameter( cx, JSGC_BYTES ) ) );
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 } // namespace
 
 namespace mozjs
@@ -192,6 +221,11 @@ JsInternalGlobal& JsEngine::GetInternalGlobal()
     return *internalGlobal_;
 }
 
+JsSamplingProfiler& JsEngine::GetSamplingProfiler()
+{
+    return jsMonitor_.GetSamplingProfiler();
+}
+
 void JsEngine::OnHeartbeat()
 {
     if ( !isInitialized_ || isBeating_ || shouldStopHeartbeatThread_ )
@@ -241,6 +275,7 @@ bool JsEngine::Initialize()
         }
 
         JS::SetPromiseRejectionTrackerCallback( cx, RejectedPromiseHandler, this );
+        (void)JS::SetGCSliceCallback( cx, GcSliceCallback );
 
         // TODO: JS::SetWarningReporter( pJsCtx_ )
 
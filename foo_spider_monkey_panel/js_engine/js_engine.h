@@ -45,6 +45,7 @@ public: // methods accessed by js objects
     JsGc& GetGcEngine();
     const JsGc& GetGcEngine() const;
     JsInternalGlobal& GetInternalGlobal();
+    JsSamplingProfiler& GetSamplingProfiler();
 
 public: // methods accessed by other internals
     void OnHeartbeat();
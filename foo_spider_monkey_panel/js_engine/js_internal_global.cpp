@@ -3,6 +3,9 @@
 
 #include <js_engine/js_compartment_inner.h>
 #include <utils/file_helpers.h>
+#include <utils/file_watcher.h>
+#include <utils/scope_helpers.h>
+#include <utils/trace_recorder.h>
 
 using namespace smp;
 
@@ -11,6 +14,18 @@ namespace
 
 using namespace mozjs;
 
+std::filesystem::file_time_type GetLastWriteTime( const std::filesystem::path& path )
+{
+    try
+    {
+        return std::filesystem::last_write_time( path );
+    }
+    catch ( const std::filesystem::filesystem_error& e )
+    {
+        throw SmpException( fmt::format( "Failed to open file `{}`: {}", path.u8string(), e.what() ) );
+    }
+}
+
 void JsFinalizeOpLocal( JSFreeOp* /*fop*/, JSObject* obj )
 {
     auto pJsCompartment = static_cast<JsCompartmentInner*>( JS_GetCompartmentPrivate( js::GetObjectCompartment( obj ) ) );
@@ -55,6 +70,14 @@ JsInternalGlobal::JsInternalGlobal( JSContext* cx, JS::HandleObject global )
 
 JsInternalGlobal::~JsInternalGlobal()
 {
+    for ( const auto& [path, value]: scriptCache_.get().data )
+    {
+        if ( value.watchId )
+        {
+            smp::utils::FileWatcher::GetInstance().Unsubscribe( value.watchId );
+        }
+    }
+
     scriptCache_.reset();
     jsGlobal_.reset();
 }
@@ -86,26 +109,37 @@ JSScript* JsInternalGlobal::GetCachedScript( const std::filesystem::path& absolu
 
     auto& scriptDataMap = scriptCache_.get().data;
     const auto u8path = absolutePath.lexically_normal().u8string();
-    const auto lastWriteTime = [&absolutePath, &u8path] {
-        try
-        {
-            return std::filesystem::last_write_time( absolutePath );
-        }
-        catch ( const std::filesystem::filesystem_error& e )
-        {
-            throw SmpException( fmt::format( "Failed to open file `{}`: {}", u8path, e.what() ) );
-        }
-    }();
 
     if ( auto it = scriptDataMap.find( u8path.c_str() );
          scriptDataMap.cend() != it )
-    {
-        if ( it->second.writeTime == lastWriteTime )
+    { // watched entries are removed from cache on change, so there is no need to check the file
+        if ( !it->second.writeTime || *it->second.writeTime == GetLastWriteTime( absolutePath ) )
         {
             return it->second.script;
         }
     }
 
+    // watch is created before reading, so that changes made during compilation are not lost
+    std::optional<std::filesystem::file_time_type> lastWriteTime;
+    uint32_t watchId = 0;
+    try
+    {
+        watchId = smp::utils::FileWatcher::GetInstance().Subscribe( absolutePath, false, [this, u8path]( const auto& ) {
+            OnScriptFileChanged( u8path );
+        } );
+    }
+    catch ( const SmpException& )
+    { // fallback to write time check on every access
+        lastWriteTime = GetLastWriteTime( absolutePath );
+    }
+
+    utils::final_action autoWatch( [watchId] {
+        if ( watchId )
+        {
+            smp::utils::FileWatcher::GetInstance().Unsubscribe( watchId );
+        }
+    } );
+
     const std::wstring scriptCode = smp::file::ReadFileW( u8path.c_str(), CP_ACP, false );
     const auto filename = absolutePath.filename().u8string();
 
@@ -113,13 +147,31 @@ JSScript* JsInternalGlobal::GetCachedScript( const std::filesystem::path& absolu
     opts.setUTF8( true );
     opts.setFileAndLine( filename.c_str(), 1 );
 
+    SMP_TRACE_SCOPE( "script", "CompileScript: " + filename );
+
     JS::RootedScript parsedScript( pJsCtx_ );
     if ( !JS_CompileUCScript( pJsCtx_, (char16_t*)scriptCode.c_str(), scriptCode.length(), opts, &parsedScript ) )
     {
         throw smp::JsException();
     }
 
-    return scriptDataMap.insert_or_assign( u8path.c_str(), JsHashMap::ValueType{ parsedScript, lastWriteTime } ).first->second.script;
+    autoWatch.cancel();
+    return scriptDataMap.insert_or_assign( u8path.c_str(), JsHashMap::ValueType{ parsedScript, lastWriteTime, watchId } ).first->second.script;
+}
+
+void JsInternalGlobal::OnScriptFileChanged( const std::string& u8path )
+{
+    auto& scriptDataMap = scriptCache_.get().data;
+
+    const auto it = scriptDataMap.find( u8path );
+    if ( it == scriptDataMap.cend() )
+    {
+        return;
+    }
+
+    const auto watchId = it->second.watchId;
+    scriptDataMap.erase( it );
+    smp::utils::FileWatcher::GetInstance().Unsubscribe( watchId );
 }
 
 } // namespace mozjs
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <filesystem>
@@ -31,6 +32,8 @@ public:
 private:
     JsInternalGlobal( JSContext* cx, JS::HandleObject global );
 
+    void OnScriptFileChanged( const std::string& u8path );
+
 private:
     JSContext* pJsCtx_ = nullptr;
     JS::PersistentRootedObject jsGlobal_;
@@ -40,14 +43,18 @@ private:
         struct ValueType
         {
             template <typename T1, typename T2>
-            ValueType( T1&& arg1, T2&& arg2 )
+            ValueType( T1&& arg1, T2&& arg2, uint32_t watchId )
                 : script( std::forward<T1>( arg1 ) )
                 , writeTime( std::forward<T2>( arg2 ) )
+                , watchId( watchId )
             {
             }
 
             JS::Heap<JSScript*> script;
-            std::filesystem::file_time_type writeTime;
+            /// @brief Only used when file watch could not be created
+            std::optional<std::filesystem::file_time_type> writeTime;
+            /// @brief Cache entry is invalidated by the file watcher, 0 if not watched
+            uint32_t watchId;
         };
         std::unordered_map<std::string, ValueType> data;
 
@@ -39,12 +39,14 @@ JsMonitor::JsMonitor()
 void JsMonitor::Start( JSContext* cx )
 {
     pJsCtx_ = cx;
+    samplingProfiler_.Initialize( cx );
     StartMonitorThread();
 }
 
 void JsMonitor::Stop()
 {
     StopMonitorThread();
+    samplingProfiler_.Finalize();
     pJsCtx_ = nullptr;
 }
 
@@ -58,6 +60,7 @@ void JsMonitor::RemoveContainer( JsContainer& jsContainer )
 {
     assert( monitoredContainers_.count( &jsContainer ) );
     monitoredContainers_.erase( &jsContainer );
+    samplingProfiler_.OnContainerRemoved( jsContainer );
 }
 
 void JsMonitor::OnJsActionStart( JsContainer& jsContainer )
@@ -65,18 +68,25 @@ void JsMonitor::OnJsActionStart( JsContainer& jsContainer )
     auto it = monitoredContainers_.find( &jsContainer );
     assert( it != monitoredContainers_.cend() );
 
+    samplingProfiler_.OnJsActionStart( jsContainer );
+
     auto& [key, data] = *it;
     if ( data.ignoreSlowScriptCheck )
     {
+        if ( samplingProfiler_.IsRunning() )
+        { // action still has to be sampled
+            WakeUpWatcher();
+        }
         return;
     }
     const auto curTime = GetLowResTime();
     data.slowScriptCheckpoint = curTime;
+    data.isActive = true;
 
-    {
-        std::unique_lock<std::mutex> ul( watcherDataMutex_ );
-        activeContainers_.emplace( &jsContainer, curTime );
-        hasAction_.notify_one();
+    if ( activeContainerCount_++ == 0 )
+    { // outermost action: nested actions can't be older than this one
+        activeSinceMs_.store( std::max<uint64_t>( curTime.count(), 1 ), std::memory_order_release );
+        WakeUpWatcher();
     }
 }
 
@@ -84,12 +94,22 @@ void JsMonitor::OnJsActionEnd( JsContainer& jsContainer )
 {
     const auto it = monitoredContainers_.find( &jsContainer );
     assert( it != monitoredContainers_.cend() );
-    it->second.slowScriptSecondHalf = false;
 
+    auto& [key, data] = *it;
+    data.slowScriptSecondHalf = false;
+
+    samplingProfiler_.OnJsActionEnd( jsContainer );
+
+    if ( !data.isActive )
+    { // container was ignored when the action was started
+        return;
+    }
+    data.isActive = false;
+
+    assert( activeContainerCount_ );
+    if ( --activeContainerCount_ == 0 )
     {
-        std::unique_lock<std::mutex> ul( watcherDataMutex_ );
-        assert( activeContainers_.count( &jsContainer ) );
-        activeContainers_.erase( &jsContainer );
+        activeSinceMs_.store( 0, std::memory_order_release );
     }
 }
 
@@ -100,16 +120,18 @@ bool JsMonitor::OnInterrupt()
         return true;
     }
 
+    samplingProfiler_.OnInterrupt();
+
+    if ( !isSlowScriptCheckRequested_.exchange( false ) )
+    { // interrupt was requested only for sampling
+        return true;
+    }
+
+    if ( isInInterrupt_.exchange( true ) )
     {
-        std::unique_lock<std::mutex> lock( watcherDataMutex_ );
-        if ( isInInterrupt_ )
-        {
-            return true;
-        }
-        isInInterrupt_ = true;
+        return true;
     }
     smp::utils::final_action autoBool( [&] {
-        std::unique_lock<std::mutex> lock( watcherDataMutex_ );
         isInInterrupt_ = false;
     } );
 
@@ -124,12 +146,9 @@ bool JsMonitor::OnInterrupt()
             {
                 containerData.slowScriptCheckpoint = curTime;
             }
+            if ( activeContainerCount_ )
             {
-                std::unique_lock<std::mutex> lock( watcherDataMutex_ );
-                for ( auto& [pContainer, startTime]: activeContainers_ )
-                {
-                    startTime = curTime;
-                }
+                activeSinceMs_.store( std::max<uint64_t>( curTime.count(), 1 ), std::memory_order_release );
             }
         }
         wasInModal_ = isInModal;
@@ -141,15 +160,10 @@ bool JsMonitor::OnInterrupt()
     }
 
     auto containerDataToProcess = [&]() {
-        std::unique_lock<std::mutex> lock( watcherDataMutex_ );
         std::vector<std::pair<JsContainer*, ContainerData*>> dataToProcess;
         for ( auto& [pContainer, containerData]: monitoredContainers_ )
         {
-            auto tmp = pContainer; // compiler bug?
-            const auto it = ranges::find_if( activeContainers_, [&tmp]( auto& elem ) {
-                return ( elem.first == tmp );
-            } );
-            if ( activeContainers_.cend() != it )
+            if ( containerData.isActive )
             {
                 dataToProcess.emplace_back( pContainer, &containerData );
             }
@@ -242,6 +256,11 @@ bool JsMonitor::OnInterrupt()
     return true;
 }
 
+JsSamplingProfiler& JsMonitor::GetSamplingProfiler()
+{
+    return samplingProfiler_;
+}
+
 void JsMonitor::StartMonitorThread()
 {
     shouldStopThread_ = false;
@@ -259,44 +278,73 @@ void JsMonitor::StartMonitorThread()
             // periods, the script still has the other (timeout/2) seconds to
             // finish.
 
-            std::this_thread::sleep_for( kMonitorRate );
-            bool hasPotentiallySlowScripts = false;
-            {
-                std::unique_lock<std::mutex> lock( watcherDataMutex_ );
-
-                if ( activeContainers_.empty() )
+            const bool isProfiling = samplingProfiler_.IsRunning();
+            const auto hasActiveJs = [&] {
+                return ( activeSinceMs_.load( std::memory_order_acquire ) || isProfiling && samplingProfiler_.HasActiveJs() );
+            };
+
+            if ( !hasActiveJs() )
+            { // Main thread signals only the start of the outermost action (and actions that are sampled),
+                // so idle thread does not consume any CPU.
+                isWatcherIdle_.store( true, std::memory_order_relaxed );
+                // Pairs with the fence in WakeUpWatcher: either we see the new action here,
+                // or main thread sees that we are idle.
+                std::atomic_thread_fence( std::memory_order_seq_cst );
+
+                std::unique_lock<std::mutex> lock( watcherMutex_ );
+                if ( !hasActiveJs() )
                 {
-                    hasAction_.wait( lock, [&] { return shouldStopThread_ || !activeContainers_.empty() && !isInInterrupt_; } );
-                }
-                else if ( isInInterrupt_ )
-                { // Can't interrupt
-                    continue;
+                    watcherCv_.wait( lock, [&] { return shouldStopThread_ || !isWatcherIdle_; } );
                 }
+                isWatcherIdle_ = false;
+                // action has just started: check it after a full interval
+                continue;
+            }
+
+            const auto waitInterval = ( isProfiling
+                                            ? samplingProfiler_.GetSamplingInterval()
+                                            : std::chrono::duration_cast<std::chrono::microseconds>( kMonitorRate ) );
+            {
+                std::unique_lock<std::mutex> lock( watcherMutex_ );
+                watcherCv_.wait_for( lock, waitInterval, [&] { return shouldStopThread_.load(); } );
+            }
+
+            if ( shouldStopThread_ )
+            {
+                break;
+            }
+
+            if ( isInInterrupt_ )
+            { // Can't interrupt
+                continue;
+            }
 
-                if ( shouldStopThread_ )
+            const bool hasPotentiallySlowScripts = [&] {
+                const auto activeSince = activeSinceMs_.load( std::memory_order_acquire );
+                if ( !activeSince )
                 {
-                    break;
+                    return false;
                 }
 
-                hasPotentiallySlowScripts = [&] {
-                    if ( HasActivePopup( false ) )
-                    { // popup detected, delay monitoring
-                        wasInModal_ = true;
-                        return false;
-                    }
-
-                    const auto curTime = GetLowResTime();
+                if ( HasActivePopup( false ) )
+                { // popup detected, delay monitoring
+                    wasInModal_ = true;
+                    return false;
+                }
 
-                    const auto it = ranges::find_if( activeContainers_, [&curTime]( auto& elem ) {
-                        auto& [pContainer, startTime] = elem;
-                        return ( ( curTime - startTime ) > kSlowScriptLimit / 2.0 );
-                    } );
+                return ( ( GetLowResTime() - std::chrono::milliseconds( activeSince ) ) > kSlowScriptLimit / 2.0 );
+            }();
+            const bool shouldSample = isProfiling && samplingProfiler_.HasActiveJs();
 
-                    return ( it != activeContainers_.cend() );
-                }();
+            if ( shouldSample )
+            {
+                samplingProfiler_.OnSampleTick();
             }
-
             if ( hasPotentiallySlowScripts )
+            {
+                isSlowScriptCheckRequested_ = true;
+            }
+            if ( hasPotentiallySlowScripts || shouldSample )
             {
                 JS_RequestInterruptCallback( pJsCtx_ );
             }
@@ -308,9 +356,9 @@ void JsMonitor::StartMonitorThread()
 void JsMonitor::StopMonitorThread()
 {
     {
-        std::unique_lock<std::mutex> lock( watcherDataMutex_ );
+        std::unique_lock<std::mutex> lock( watcherMutex_ );
         shouldStopThread_ = true;
-        hasAction_.notify_one();
+        watcherCv_.notify_one();
     }
 
     if ( watcherThread_.joinable() )
@@ -319,6 +367,21 @@ void JsMonitor::StopMonitorThread()
     }
 }
 
+void JsMonitor::WakeUpWatcher()
+{
+    // Pairs with the fence in the watcher thread, see StartMonitorThread.
+    // Fence is cheaper than the mutex: the latter is locked only when the thread is actually idle.
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( !isWatcherIdle_.load( std::memory_order_relaxed ) )
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock( watcherMutex_ );
+    isWatcherIdle_ = false;
+    watcherCv_.notify_one();
+}
+
 bool JsMonitor::HasActivePopup( bool isMainThread ) const
 {
     if ( isMainThread && MessageBlockingScope::IsBlocking() )
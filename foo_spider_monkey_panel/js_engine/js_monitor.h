@@ -1,8 +1,14 @@
 #pragma once
 
-#include <map>
+#include <js_engine/js_sampling_profiler.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
 
 struct JSContext;
 
@@ -40,12 +46,16 @@ public:
 
     bool OnInterrupt();
 
+    JsSamplingProfiler& GetSamplingProfiler();
+
 private:
     /// @throw smp::SmpException
     void StartMonitorThread();
     void StopMonitorThread();
 
-	bool HasActivePopup( bool isMainThread ) const;
+    bool HasActivePopup( bool isMainThread ) const;
+    /// @brief Wakes up the watcher thread, if it's waiting for JS activity
+    void WakeUpWatcher();
 
 private:
     JSContext* pJsCtx_ = nullptr;
@@ -60,22 +70,41 @@ private:
 
         JsContainer* pContainer;
 
+        /// @brief Container is in JS action that is subject to slow script check
+        bool isActive = false;
         bool ignoreSlowScriptCheck = false;
         std::chrono::milliseconds slowScriptCheckpoint{};
         bool slowScriptSecondHalf = false;
     };
 
+    // main thread data
+
     std::unordered_map<JsContainer*, ContainerData> monitoredContainers_;
+    uint32_t activeContainerCount_ = 0;
+
+    // shared data
+
+    // JS actions are executed only on the main thread and are strictly nested,
+    // so the start time of the outermost active action is the oldest start time of all active containers.
+    // Contains 0 if there are no active containers.
+    // This is the only value sampled by the watcher thread, so main thread never has to wait for it.
+    std::atomic<uint64_t> activeSinceMs_ = 0;
+    // Watcher thread is waiting for JS activity: main thread signals it only in this case.
+    std::atomic_bool isWatcherIdle_ = false;
+    std::atomic_bool isInInterrupt_ = false;
+    // Interrupts are also requested by sampling profiler
+    std::atomic_bool isSlowScriptCheckRequested_ = false;
+    std::atomic_bool wasInModal_ = false;
+
+    // watcher thread data
 
-    std::mutex watcherDataMutex_;
     std::thread watcherThread_;
+    // Used only to wake up the idle thread and to wake up the thread on stop
+    std::mutex watcherMutex_;
+    std::condition_variable watcherCv_;
     std::atomic_bool shouldStopThread_ = false;
-    std::condition_variable hasAction_;
-    // Contains the same time as slowScriptCheckpoint in monitoredContainers_
-    std::unordered_map<JsContainer*, std::chrono::milliseconds> activeContainers_;
-    bool isInInterrupt_ = false;
 
-    std::atomic_bool wasInModal_ = false;
+    JsSamplingProfiler samplingProfiler_;
 };
 
 } // namespace mozjs
@@ -0,0 +1,575 @@
+#include <stdafx.h>
+#include "js_sampling_profiler.h"
+
+#include <convert/js_to_native.h>
+#include <js_engine/js_container.h>
+#include <utils/file_helpers.h>
+#include <utils/scope_helpers.h>
+
+#include <component_paths.h>
+#include <js_panel_window.h>
+
+#include <js/GCHashTable.h>
+#include <js/GCVector.h>
+#include <nlohmann/json.hpp>
+
+#include <ctime>
+
+using namespace smp;
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+constexpr uint32_t kMaxJsStackDepth = 128;
+/// @brief Limits the size of Chrome trace (aggregated data is not affected)
+constexpr size_t kMaxTimelineSamples = 1'000'000;
+constexpr uint32_t kNoJsStackId = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t kEmptyNativeStackId = 0;
+
+/// @brief Pending ticks are tagged with the epoch of the action they were recorded in
+constexpr uint64_t PackPendingTicks( uint32_t epoch, uint32_t ticks )
+{
+    return ( static_cast<uint64_t>( epoch ) << 32 ) | ticks;
+}
+
+constexpr uint32_t GetPendingTicksEpoch( uint64_t pendingTicks )
+{
+    return static_cast<uint32_t>( pendingTicks >> 32 );
+}
+
+constexpr uint32_t GetPendingTicksCount( uint64_t pendingTicks )
+{
+    return static_cast<uint32_t>( pendingTicks );
+}
+
+std::u8string GetFileNameFromSource( const std::u8string& source )
+{
+    const auto pos = source.find_last_of( "\\/" );
+    return ( pos == std::u8string::npos ? source : source.substr( pos + 1 ) );
+}
+
+/// @brief Replaces characters that have special meaning in collapsed stack format
+std::u8string EscapeCollapsedFrame( std::u8string frame )
+{
+    ranges::replace( frame, ';', ':' );
+    ranges::replace( frame, '\n', ' ' );
+    return frame;
+}
+
+std::u8string GenerateProfileName()
+{
+    const auto curTime = std::time( nullptr );
+    std::tm localTime{};
+    localtime_s( &localTime, &curTime );
+
+    std::array<char, 64> buffer{};
+    std::strftime( buffer.data(), buffer.size(), "%Y%m%d_%H%M%S", &localTime );
+
+    return std::u8string( "js_profile_" ) + buffer.data();
+}
+
+} // namespace
+
+namespace mozjs
+{
+
+struct JsSamplingProfiler::JsStackTable
+{
+    // SavedFrame objects are hash-consed by the engine, so the leaf frame identifies the whole stack
+    JS::GCHashMap<JSObject*, uint32_t, js::MovableCellHasher<JSObject*>, js::SystemAllocPolicy> ids;
+    JS::GCVector<JSObject*, 0, js::SystemAllocPolicy> stacks;
+
+    void trace( JSTracer* trc )
+    {
+        ids.trace( trc );
+        stacks.trace( trc );
+    }
+};
+
+JsSamplingProfiler::JsSamplingProfiler()
+{
+    // Should be enough for any sane amount of nested callbacks
+    activeContainers_.reserve( 64 );
+}
+
+JsSamplingProfiler::~JsSamplingProfiler()
+{
+    assert( !jsStackTable_ );
+}
+
+void JsSamplingProfiler::Initialize( JSContext* cx )
+{
+    pJsCtx_ = cx;
+}
+
+void JsSamplingProfiler::Finalize()
+{
+    if ( isRunning_ )
+    {
+        isRunning_ = false;
+        timeEndPeriod( 1 );
+    }
+
+    ClearData();
+    pJsCtx_ = nullptr;
+}
+
+void JsSamplingProfiler::Start( uint32_t frequency )
+{
+    assert( core_api::is_main_thread() );
+
+    SmpException::ExpectTrue( pJsCtx_, "JS engine is not initialized" );
+    SmpException::ExpectTrue( !isRunning_, "Sampling profiler is already running" );
+    SmpException::ExpectTrue( frequency > 0 && frequency <= kMaxFrequency,
+                              "Invalid sampling frequency: {}; must be in range [1, {}]",
+                              frequency,
+                              kMaxFrequency );
+
+    ClearData();
+
+    jsStackTable_ = std::make_unique<JS::PersistentRooted<JsStackTable>>( pJsCtx_ );
+    if ( !jsStackTable_->get().ids.init() )
+    {
+        jsStackTable_.reset();
+        throw SmpException( "Failed to initialize sampling profiler: out of memory" );
+    }
+
+    nativeStackIds_.emplace( std::vector<const char*>{}, kEmptyNativeStackId );
+    nativeStacks_.emplace_back();
+
+    samplingIntervalUs_ = 1'000'000 / frequency;
+    startTime_ = std::chrono::steady_clock::now();
+
+    // default timer resolution (~15ms) is too coarse for the watcher thread
+    timeBeginPeriod( 1 );
+    isRunning_ = true;
+}
+
+std::pair<fs::path, fs::path> JsSamplingProfiler::Stop()
+{
+    assert( core_api::is_main_thread() );
+
+    SmpException::ExpectTrue( isRunning_, "Sampling profiler is not running" );
+
+    isRunning_ = false;
+    timeEndPeriod( 1 );
+    pendingTicks_ = 0;
+
+    utils::final_action autoClear( [&] { ClearData(); } );
+
+    const auto profileDir = fs::u8path( get_profile_path() ) / SMP_UNDERSCORE_NAME / "profiler";
+    std::error_code ec;
+    fs::create_directories( profileDir, ec );
+    SmpException::ExpectTrue( !ec, "Failed to create directory `{}`: {}", profileDir.u8string(), ec.message() );
+
+    const auto profileName = GenerateProfileName();
+    const auto collapsedPath = profileDir / fs::u8path( profileName + ".folded" );
+    const auto tracePath = profileDir / fs::u8path( profileName + ".json" );
+
+    JSAutoRequest ar( pJsCtx_ );
+
+    SaveCollapsedStacks( collapsedPath );
+    SaveChromeTrace( tracePath );
+
+    return { collapsedPath, tracePath };
+}
+
+bool JsSamplingProfiler::IsRunning() const
+{
+    return isRunning_;
+}
+
+void JsSamplingProfiler::OnJsActionStart( JsContainer& jsContainer )
+{
+    activeContainers_.push_back( &jsContainer );
+    // ticks that weren't handled belong to the previous action
+    actionEpoch_.store( actionEpoch_.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+    activeDepth_.store( static_cast<uint32_t>( activeContainers_.size() ), std::memory_order_release );
+}
+
+void JsSamplingProfiler::OnJsActionEnd( JsContainer& jsContainer )
+{
+    assert( !activeContainers_.empty() && activeContainers_.back() == &jsContainer );
+    activeContainers_.pop_back();
+    // ticks that weren't handled belong to the finished action:
+    // resetting the counter is not enough, since the watcher might increment it right after the reset
+    actionEpoch_.store( actionEpoch_.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+    activeDepth_.store( static_cast<uint32_t>( activeContainers_.size() ), std::memory_order_release );
+}
+
+void JsSamplingProfiler::OnContainerRemoved( JsContainer& jsContainer )
+{
+    // pointer might be reused by another container
+    containerToPanelId_.erase( &jsContainer );
+}
+
+bool JsSamplingProfiler::HasActiveJs() const
+{
+    return !!activeDepth_.load( std::memory_order_acquire );
+}
+
+std::chrono::microseconds JsSamplingProfiler::GetSamplingInterval() const
+{
+    return std::chrono::microseconds( samplingIntervalUs_.load() );
+}
+
+void JsSamplingProfiler::OnSampleTick()
+{
+    if ( !isRunning_ )
+    {
+        return;
+    }
+
+    {
+        // Native code can't be interrupted, so we need to record its frames right now:
+        // JS stack will be captured once the native call returns to the JS caller.
+        std::lock_guard<std::mutex> lg( pendingNativeStackMutex_ );
+
+        const auto depth = std::min<uint32_t>( nativeDepth_.load( std::memory_order_acquire ), kMaxNativeDepth );
+        pendingNativeStack_.resize( depth );
+        for ( uint32_t i = 0; i < depth; ++i )
+        {
+            pendingNativeStack_[i] = nativeFrames_[i].load( std::memory_order_relaxed );
+        }
+    }
+
+    const auto epoch = actionEpoch_.load( std::memory_order_acquire );
+    auto pendingTicks = pendingTicks_.load( std::memory_order_relaxed );
+    uint64_t newPendingTicks;
+    do
+    {
+        newPendingTicks = ( GetPendingTicksEpoch( pendingTicks ) == epoch
+                                ? pendingTicks + 1
+                                : PackPendingTicks( epoch, 1 ) );
+    } while ( !pendingTicks_.compare_exchange_weak( pendingTicks, newPendingTicks ) );
+}
+
+void JsSamplingProfiler::OnInterrupt()
+{
+    assert( core_api::is_main_thread() );
+
+    if ( !isRunning_ )
+    {
+        return;
+    }
+
+    const auto epoch = actionEpoch_.load( std::memory_order_relaxed );
+    const auto pendingTicks = pendingTicks_.exchange( PackPendingTicks( epoch, 0 ) );
+    if ( GetPendingTicksEpoch( pendingTicks ) != epoch )
+    { // ticks were recorded in another action
+        return;
+    }
+
+    const auto weight = GetPendingTicksCount( pendingTicks );
+    if ( !weight )
+    {
+        return;
+    }
+
+    const auto nativeStackId = [&] {
+        std::lock_guard<std::mutex> lg( pendingNativeStackMutex_ );
+        return GetNativeStackId( pendingNativeStack_ );
+    }();
+
+    JS::RootedObject jsStack( pJsCtx_ );
+    if ( !JS::CaptureCurrentStack( pJsCtx_, &jsStack, JS::StackCapture( JS::MaxFrames( kMaxJsStackDepth ) ) ) )
+    { // Interrupt handler must not leave pending exceptions
+        JS_ClearPendingException( pJsCtx_ );
+        return;
+    }
+
+    uint32_t jsStackId = kNoJsStackId;
+    if ( jsStack && !GetJsStackId( pJsCtx_, jsStack, jsStackId ) )
+    {
+        JS_ClearPendingException( pJsCtx_ );
+        return;
+    }
+
+    const auto panelId = GetPanelId( activeContainers_.empty() ? nullptr : activeContainers_.back() );
+
+    panels_[panelId].stackWeights[{ jsStackId, nativeStackId }] += weight;
+
+    if ( timeline_.size() < kMaxTimelineSamples )
+    {
+        const auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - startTime_ );
+        timeline_.push_back( Sample{ static_cast<uint64_t>( timestamp.count() ), panelId, jsStackId, nativeStackId, weight } );
+    }
+}
+
+void JsSamplingProfiler::PushNativeFrame( const char* frameName ) noexcept
+{
+    const auto depth = nativeDepth_.load( std::memory_order_relaxed );
+    if ( depth < kMaxNativeDepth )
+    {
+        nativeFrames_[depth].store( frameName, std::memory_order_relaxed );
+    }
+    nativeDepth_.store( depth + 1, std::memory_order_release );
+}
+
+void JsSamplingProfiler::PopNativeFrame() noexcept
+{
+    const auto depth = nativeDepth_.load( std::memory_order_relaxed );
+    assert( depth );
+    nativeDepth_.store( depth - 1, std::memory_order_release );
+}
+
+uint32_t JsSamplingProfiler::GetPanelId( JsContainer* pContainer )
+{
+    if ( auto it = containerToPanelId_.find( pContainer ); it != containerToPanelId_.cend() )
+    {
+        return it->second;
+    }
+
+    std::u8string panelName = [pContainer]() -> std::u8string {
+        if ( !pContainer || JsContainer::JsStatus::Working != pContainer->GetStatus() )
+        {
+            return "<unknown panel>";
+        }
+
+        return pContainer->GetParentPanel().ScriptInfo().build_info_string( false );
+    }();
+
+    // panels with the same script should still be distinguishable
+    const auto sameNameCount = ranges::count_if( panels_, [&panelName]( const auto& panel ) {
+        return ( panel.name == panelName || panel.name.find( panelName + " (" ) == 0 );
+    } );
+    if ( sameNameCount )
+    {
+        panelName += fmt::format( " ({})", sameNameCount + 1 );
+    }
+
+    const auto panelId = static_cast<uint32_t>( panels_.size() );
+    panels_.push_back( PanelData{ panelName, {} } );
+    containerToPanelId_.emplace( pContainer, panelId );
+
+    return panelId;
+}
+
+uint32_t JsSamplingProfiler::GetNativeStackId( const std::vector<const char*>& nativeStack )
+{
+    if ( nativeStack.empty() )
+    {
+        return kEmptyNativeStackId;
+    }
+
+    if ( auto it = nativeStackIds_.find( nativeStack ); it != nativeStackIds_.cend() )
+    {
+        return it->second;
+    }
+
+    const auto stackId = static_cast<uint32_t>( nativeStacks_.size() );
+    nativeStacks_.push_back( nativeStack );
+    nativeStackIds_.emplace( nativeStack, stackId );
+
+    return stackId;
+}
+
+bool JsSamplingProfiler::GetJsStackId( JSContext* cx, JS::HandleObject jsStack, uint32_t& stackId )
+{
+    assert( jsStackTable_ );
+    auto& stackTable = jsStackTable_->get();
+
+    auto p = stackTable.ids.lookupForAdd( jsStack );
+    if ( p )
+    {
+        stackId = p->value();
+        return true;
+    }
+
+    stackId = static_cast<uint32_t>( stackTable.stacks.length() );
+    if ( !stackTable.stacks.append( jsStack.get() ) )
+    {
+        return false;
+    }
+
+    return stackTable.ids.add( p, jsStack.get(), stackId );
+}
+
+void JsSamplingProfiler::SaveCollapsedStacks( const fs::path& path )
+{
+    std::u8string content;
+    for ( const auto& panel: panels_ )
+    {
+        const auto panelFrame = EscapeCollapsedFrame( panel.name );
+        for ( const auto& [stackIds, weight]: panel.stackWeights )
+        {
+            content += panelFrame;
+            for ( const auto& frame: GetFrameNames( stackIds.first, stackIds.second ) )
+            {
+                content += ';';
+                content += EscapeCollapsedFrame( frame );
+            }
+            content += fmt::format( " {}\n", weight );
+        }
+    }
+
+    SmpException::ExpectTrue( smp::file::WriteFile( path.wstring().c_str(), content, false ),
+                              "Failed to write file: {}",
+                              path.u8string() );
+}
+
+void JsSamplingProfiler::SaveChromeTrace( const fs::path& path )
+{
+    using json = nlohmann::json;
+
+    const uint32_t samplingIntervalUs = samplingIntervalUs_;
+
+    json traceEvents = json::array();
+    traceEvents.push_back( { { "name", "process_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", 0 }, { "args", { { "name", SMP_NAME } } } } );
+    for ( const auto& [panelId, panel]: ranges::view::enumerate( panels_ ) )
+    {
+        traceEvents.push_back( { { "name", "thread_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", panelId + 1 }, { "args", { { "name", panel.name } } } } );
+    }
+
+    // Frames are stored as a tree: (parent frame id, frame name) > frame id
+    json stackFrames = json::object();
+    std::map<std::pair<uint32_t, std::u8string>, uint32_t> frameIds;
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> leafFrameIds;
+    const auto getLeafFrameId = [&]( uint32_t jsStackId, uint32_t nativeStackId ) {
+        if ( auto it = leafFrameIds.find( { jsStackId, nativeStackId } ); it != leafFrameIds.cend() )
+        {
+            return it->second;
+        }
+
+        uint32_t parentId = 0;
+        for ( const auto& frame: GetFrameNames( jsStackId, nativeStackId ) )
+        {
+            auto [it, isNew] = frameIds.try_emplace( std::make_pair( parentId, frame ), static_cast<uint32_t>( frameIds.size() + 1 ) );
+            if ( isNew )
+            {
+                json frameJson = { { "category", "js" }, { "name", frame } };
+                if ( parentId )
+                {
+                    frameJson["parent"] = std::to_string( parentId );
+                }
+                stackFrames[std::to_string( it->second )] = frameJson;
+            }
+            parentId = it->second;
+        }
+
+        leafFrameIds.emplace( std::make_pair( jsStackId, nativeStackId ), parentId );
+        return parentId;
+    };
+
+    json samples = json::array();
+    for ( const auto& sample: timeline_ )
+    {
+        const auto leafFrameId = getLeafFrameId( sample.jsStackId, sample.nativeStackId );
+        for ( uint32_t i = 0; i < sample.weight; ++i )
+        { // samples that were delayed by native code are spread evenly
+            json sampleJson = { { "cpu", 0 },
+                                { "pid", 1 },
+                                { "tid", sample.panelId + 1 },
+                                { "ts", sample.timestampUs - ( sample.weight - i - 1 ) * samplingIntervalUs },
+                                { "name", "sample" },
+                                { "weight", 1 } };
+            if ( leafFrameId )
+            {
+                sampleJson["sf"] = std::to_string( leafFrameId );
+            }
+            samples.push_back( std::move( sampleJson ) );
+        }
+    }
+
+    const json trace = { { "traceEvents", std::move( traceEvents ) },
+                         { "stackFrames", std::move( stackFrames ) },
+                         { "samples", std::move( samples ) },
+                         { "displayTimeUnit", "ms" } };
+
+    SmpException::ExpectTrue( smp::file::WriteFile( path.wstring().c_str(), trace.dump(), false ),
+                              "Failed to write file: {}",
+                              path.u8string() );
+}
+
+std::vector<std::u8string> JsSamplingProfiler::GetJsFrameNames( uint32_t jsStackId )
+{
+    assert( jsStackTable_ );
+    assert( jsStackId < jsStackTable_->get().stacks.length() );
+
+    JSContext* cx = pJsCtx_;
+
+    const auto getString = [cx]( JS::HandleString jsString ) -> std::u8string {
+        if ( !jsString )
+        {
+            return "";
+        }
+
+        JS::RootedValue jsValue( cx, JS::StringValue( jsString ) );
+        return convert::to_native::ToValue<std::u8string>( cx, jsValue );
+    };
+
+    std::vector<std::u8string> frames;
+
+    JS::RootedObject jsFrame( cx, jsStackTable_->get().stacks[jsStackId] );
+    JS::RootedString jsName( cx );
+    JS::RootedString jsSource( cx );
+    while ( jsFrame )
+    {
+        if ( JS::GetSavedFrameFunctionDisplayName( cx, jsFrame, &jsName ) != JS::SavedFrameResult::Ok
+             || JS::GetSavedFrameSource( cx, jsFrame, &jsSource ) != JS::SavedFrameResult::Ok )
+        {
+            break;
+        }
+
+        std::u8string functionName = getString( jsName );
+        if ( functionName.empty() )
+        {
+            functionName = "(anonymous)";
+        }
+        const std::u8string fileName = GetFileNameFromSource( getString( jsSource ) );
+
+        frames.emplace_back( fileName.empty() ? functionName : fmt::format( "{} ({})", functionName, fileName ) );
+
+        JS::RootedObject jsParent( cx );
+        if ( JS::GetSavedFrameParent( cx, jsFrame, &jsParent ) != JS::SavedFrameResult::Ok )
+        {
+            break;
+        }
+        jsFrame = jsParent;
+    }
+
+    // SavedFrame chain goes from the leaf to the root
+    ranges::reverse( frames );
+
+    return frames;
+}
+
+std::vector<std::u8string> JsSamplingProfiler::GetFrameNames( uint32_t jsStackId, uint32_t nativeStackId )
+{
+    std::vector<std::u8string> frames;
+    if ( jsStackId != kNoJsStackId )
+    {
+        try
+        {
+            frames = GetJsFrameNames( jsStackId );
+        }
+        catch ( const smp::JsException& )
+        {
+            JS_ClearPendingException( pJsCtx_ );
+            frames = { "<unknown JS frame>" };
+        }
+    }
+
+    assert( nativeStackId < nativeStacks_.size() );
+    for ( const auto* nativeFrame: nativeStacks_[nativeStackId] )
+    {
+        frames.emplace_back( fmt::format( "[native] {}", nativeFrame ) );
+    }
+
+    return frames;
+}
+
+void JsSamplingProfiler::ClearData()
+{
+    panels_.clear();
+    containerToPanelId_.clear();
+    nativeStackIds_.clear();
+    nativeStacks_.clear();
+    timeline_.clear();
+    timeline_.shrink_to_fit();
+    jsStackTable_.reset();
+}
+
+} // namespace mozjs
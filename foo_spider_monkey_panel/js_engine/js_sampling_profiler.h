@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct JSContext;
+
+namespace mozjs
+{
+
+class JsContainer;
+
+/// @brief Sampling profiler for panel scripts.
+/// @details Sampling is driven by JsMonitor: watcher thread calls OnSampleTick()
+///          and requests an interrupt, the stack is then captured in OnInterrupt() on the main thread.
+///          Native frames are recorded by NativeFrameScope (see MJS_DEFINE_JS_FN* macros) and are appended to the JS stack.
+///          Samples are aggregated per panel and exported as collapsed stacks (flamegraph) and as Chrome trace.
+class JsSamplingProfiler final
+{
+public:
+    static constexpr uint32_t kMaxFrequency = 1000;
+    static constexpr uint32_t kDefaultFrequency = 1000;
+
+    /// @brief Records native frame for the duration of the scope.
+    ///        Costs a single relaxed atomic load when profiler is not running.
+    class NativeFrameScope
+    {
+    public:
+        /// @param frameName Must have static storage duration
+        explicit NativeFrameScope( const char* frameName ) noexcept
+            : isPushed_( JsSamplingProfiler::isRunning_.load( std::memory_order_relaxed ) )
+        {
+            if ( isPushed_ )
+            {
+                JsSamplingProfiler::PushNativeFrame( frameName );
+            }
+        }
+        ~NativeFrameScope()
+        {
+            if ( isPushed_ )
+            {
+                JsSamplingProfiler::PopNativeFrame();
+            }
+        }
+
+        NativeFrameScope( const NativeFrameScope& ) = delete;
+        NativeFrameScope& operator=( const NativeFrameScope& ) = delete;
+
+    private:
+        const bool isPushed_;
+    };
+
+public:
+    JsSamplingProfiler();
+    ~JsSamplingProfiler();
+    JsSamplingProfiler( const JsSamplingProfiler& ) = delete;
+    JsSamplingProfiler& operator=( const JsSamplingProfiler& ) = delete;
+
+    void Initialize( JSContext* cx );
+    /// @brief Discards all collected data
+    void Finalize();
+
+    /// @throw smp::SmpException
+    void Start( uint32_t frequency );
+    /// @brief Stops profiling and saves collected data to `<profile>\foo_spider_monkey_panel\profiler\`.
+    /// @return Paths of collapsed stack file and Chrome trace file
+    /// @throw smp::SmpException
+    std::pair<std::filesystem::path, std::filesystem::path> Stop();
+
+    bool IsRunning() const;
+
+public: // methods accessed by JsMonitor
+    void OnJsActionStart( JsContainer& jsContainer );
+    void OnJsActionEnd( JsContainer& jsContainer );
+    void OnContainerRemoved( JsContainer& jsContainer );
+
+    /// @brief Invoked from watcher thread
+    bool HasActiveJs() const;
+    /// @brief Invoked from watcher thread
+    std::chrono::microseconds GetSamplingInterval() const;
+    /// @brief Invoked from watcher thread, marks that a sample should be captured on next interrupt
+    void OnSampleTick();
+
+    void OnInterrupt();
+
+private:
+    static void PushNativeFrame( const char* frameName ) noexcept;
+    static void PopNativeFrame() noexcept;
+
+    uint32_t GetPanelId( JsContainer* pContainer );
+    uint32_t GetNativeStackId( const std::vector<const char*>& nativeStack );
+    /// @return false on OOM
+    bool GetJsStackId( JSContext* cx, JS::HandleObject jsStack, uint32_t& stackId );
+
+    /// @throw smp::SmpException
+    void SaveCollapsedStacks( const std::filesystem::path& path );
+    /// @throw smp::SmpException
+    void SaveChromeTrace( const std::filesystem::path& path );
+
+    /// @throw smp::SmpException
+    /// @throw smp::JsException
+    std::vector<std::u8string> GetJsFrameNames( uint32_t jsStackId );
+    std::vector<std::u8string> GetFrameNames( uint32_t jsStackId, uint32_t nativeStackId );
+
+    void ClearData();
+
+private:
+    static constexpr size_t kMaxNativeDepth = 32;
+
+    inline static std::atomic_bool isRunning_ = false;
+    inline static std::array<std::atomic<const char*>, kMaxNativeDepth> nativeFrames_{};
+    inline static std::atomic<uint32_t> nativeDepth_ = 0;
+
+    JSContext* pJsCtx_ = nullptr;
+
+    std::atomic<uint32_t> samplingIntervalUs_ = 1000;
+    std::chrono::steady_clock::time_point startTime_;
+
+    // main thread data
+
+    std::vector<JsContainer*> activeContainers_;
+    std::atomic<uint32_t> activeDepth_ = 0;
+    /// @brief Incremented on every action start and end
+    std::atomic<uint32_t> actionEpoch_ = 0;
+
+    // watcher thread data
+
+    /// @brief Action epoch in high 32 bits, tick count in low 32 bits
+    std::atomic<uint64_t> pendingTicks_ = 0;
+    std::mutex pendingNativeStackMutex_;
+    std::vector<const char*> pendingNativeStack_;
+
+    // collected data
+
+    struct PanelData
+    {
+        std::u8string name;
+        // (js stack id, native stack id) > sample weight
+        std::map<std::pair<uint32_t, uint32_t>, uint64_t> stackWeights;
+    };
+    std::vector<PanelData> panels_;
+    std::unordered_map<JsContainer*, uint32_t> containerToPanelId_;
+
+    std::map<std::vector<const char*>, uint32_t> nativeStackIds_;
+    std::vector<std::vector<const char*>> nativeStacks_;
+
+    struct JsStackTable;
+    std::unique_ptr<JS::PersistentRooted<JsStackTable>> jsStackTable_;
+
+    struct Sample
+    {
+        uint64_t timestampUs;
+        uint32_t panelId;
+        uint32_t jsStackId;
+        uint32_t nativeStackId;
+        uint32_t weight;
+    };
+    std::vector<Sample> timeline_;
+};
+
+} // namespace mozjs
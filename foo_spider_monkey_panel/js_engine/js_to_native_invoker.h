@@ -2,6 +2,7 @@
 
 #include <convert/js_to_native.h>
 #include <convert/native_to_js.h>
+#include <js_engine/js_sampling_profiler.h>
 #include <js_objects/global_object.h>
 #include <js_utils/js_error_helper.h>
 #include <js_utils/js_object_helper.h>
@@ -365,9 +366,11 @@ void InvokeNativeCallback( JSContext* cx,
 /// @brief Defines a function named `functionName`, which executes `functionImpl` in a safe way:
 ///        traps C++ exceptions and converts them to JS exceptions,
 ///        while adding `functionName` to error report.
+///        `functionImpl` is also recorded as a native frame by sampling profiler.
 #define MJS_DEFINE_JS_FN( functionName, functionImpl )                                    \
     bool functionName( JSContext* cx, unsigned argc, JS::Value* vp )                      \
     {                                                                                     \
+        mozjs::JsSamplingProfiler::NativeFrameScope autoNativeFrame( #functionImpl );     \
         return mozjs::error::Execute_JsSafe( cx, #functionName, functionImpl, argc, vp ); \
     }
 
@@ -379,6 +382,7 @@ void InvokeNativeCallback( JSContext* cx,
 #define MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( functionName, functionImpl, functionImplWithOpt, optArgCount ) \
     bool functionName( JSContext* cx, unsigned argc, JS::Value* vp )                                          \
     {                                                                                                         \
+        mozjs::JsSamplingProfiler::NativeFrameScope autoNativeFrame( #functionImpl );                         \
         const auto wrappedFunc = []( JSContext* cx, unsigned argc, JS::Value* vp ) {                          \
             InvokeNativeCallback<optArgCount>( cx, &functionImpl, &functionImplWithOpt, argc, vp );           \
         };                                                                                                    \
@@ -484,10 +484,14 @@ std::optional<DISPID> ActiveXObject::GetDispId( const std::wstring& name, bool r
         return 0;
     }
 
-    auto it = members_.find( name );
-    if ( it != members_.end() && it->second->hasDispId )
+    if ( auto pMember = FindMember( name ); pMember && pMember->hasDispId )
     {
-        return it->second->dispId;
+        return pMember->dispId;
+    }
+
+    if ( auto it = dispIds_.find( name ); it != dispIds_.cend() )
+    {
+        return it->second;
     }
 
     DISPID dispId;
@@ -506,49 +510,54 @@ std::optional<DISPID> ActiveXObject::GetDispId( const std::wstring& name, bool r
         }
     }
 
-    if ( it != members_.end() )
-    {
-        it->second->hasDispId = true;
-        it->second->dispId = dispId;
-    }
-    else
-    {
-        auto newMember = std::make_unique<MemberInfo>();
-        newMember->hasDispId = true;
-        newMember->dispId = dispId;
+    dispIds_.emplace( name, dispId );
 
-        members_.insert_or_assign( name, std::move( newMember ) );
+    return dispId;
+}
+
+const ActiveXTypeCache::MemberInfo* ActiveXObject::FindMember( const std::wstring& name ) const
+{
+    if ( !pMembers_ )
+    {
+        return nullptr;
     }
 
-    return dispId;
+    auto it = pMembers_->find( name );
+    return ( it == pMembers_->cend() ? nullptr : &it->second );
 }
 
 bool ActiveXObject::Has( const std::wstring& name )
 {
-    return members_.count( name );
+    return FindMember( name );
 }
 
 bool ActiveXObject::IsGet( const std::wstring& name )
 {
-    return members_.count( name ) && members_[name]->isGet;
+    auto pMember = FindMember( name );
+    return pMember && pMember->isGet;
 }
 
 bool ActiveXObject::IsSet( const std::wstring& name )
 {
-    return members_.count( name ) && ( members_[name]->isPut || members_[name]->isPutRef );
+    auto pMember = FindMember( name );
+    return pMember && ( pMember->isPut || pMember->isPutRef );
 }
 
 bool ActiveXObject::IsInvoke( const std::wstring& name )
 {
-    return members_.count( name ) && members_[name]->isInvoke;
+    auto pMember = FindMember( name );
+    return pMember && pMember->isInvoke;
 }
 
 std::vector<std::wstring> ActiveXObject::GetAllMembers()
 {
     std::vector<std::wstring> memberList;
-    for ( const auto& member: members_ )
+    if ( pMembers_ )
     {
-        memberList.push_back( member.first );
+        for ( const auto& member: *pMembers_ )
+        {
+            memberList.push_back( member.first );
+        }
     }
     return memberList;
 }
@@ -659,8 +668,8 @@ void ActiveXObject::Set( const std::wstring& propName, JS::HandleValue v )
     DISPPARAMS dispparams = { &arg, &dispput, 1, 1 };
 
     WORD flag = DISPATCH_PROPERTYPUT;
-    if ( ( arg.vt == VT_DISPATCH || arg.vt == VT_UNKNOWN )
-         && members_.count( propName ) && members_[propName]->isPutRef )
+    if ( auto pMember = FindMember( propName );
+         ( arg.vt == VT_DISPATCH || arg.vt == VT_UNKNOWN ) && pMember && pMember->isPutRef )
     { //must be passed by name
         flag = DISPATCH_PROPERTYPUTREF;
     }
@@ -714,8 +723,8 @@ void ActiveXObject::Set( const JS::CallArgs& callArgs )
     UINT argerr = 0;
 
     WORD flag = DISPATCH_PROPERTYPUT;
-    if ( ( args[argc - 1].vt == VT_DISPATCH || args[argc - 1].vt == VT_UNKNOWN )
-         && members_.count( propName ) && members_[propName]->isPutRef )
+    if ( auto pMember = FindMember( propName );
+         ( args[argc - 1].vt == VT_DISPATCH || args[argc - 1].vt == VT_UNKNOWN ) && pMember && pMember->isPutRef )
     { //must be passed by name
         flag = DISPATCH_PROPERTYPUTREF;
     }
@@ -819,116 +828,17 @@ void ActiveXObject::SetupMembers( JS::HandleObject jsObject )
         smp::error::CheckHR( hr, "GetTypeInfo" );
     }
 
-    ParseTypeInfoRecursive( pJsCtx_, pTypeInfo_, members_ );
+    pMembers_ = ActiveXTypeCache::Get().GetMembers( pTypeInfo_ );
     SetupMembers_Impl( jsObject );
 
     areMembersSetup_ = true;
 }
 
-void ActiveXObject::ParseTypeInfoRecursive( JSContext* cx, ITypeInfo* pTypeInfo, MemberMap& members )
-{
-    ParseTypeInfo( pTypeInfo, members );
-
-    TYPEATTR* pAttr = nullptr;
-    HRESULT hr = pTypeInfo->GetTypeAttr( &pAttr );
-    smp::error::CheckHR( hr, "GetTypeAttr" );
-
-    utils::final_action autoTypeAttr( [pTypeInfo, pAttr] {
-        pTypeInfo->ReleaseTypeAttr( pAttr );
-    } );
-
-    if ( !( pAttr->wTypeFlags & TYPEFLAG_FRESTRICTED )
-         && ( TKIND_DISPATCH == pAttr->typekind || TKIND_INTERFACE == pAttr->typekind )
-         && pAttr->cImplTypes )
-    {
-        for ( auto i: ranges::view::indices( pAttr->cImplTypes ) )
-        {
-            HREFTYPE hRef = 0;
-            hr = pTypeInfo->GetRefTypeOfImplType( i, &hRef );
-            smp::error::CheckHR( hr, "GetTypeAttr" );
-
-            ITypeInfo* pTypeInfoCur = nullptr;
-            hr = pTypeInfo->GetRefTypeInfo( hRef, &pTypeInfoCur );
-            if ( SUCCEEDED( hr ) && pTypeInfoCur )
-            {
-                utils::final_action autoTypeInfo( [pTypeInfoCur] {
-                    pTypeInfoCur->Release();
-                } );
-
-                ParseTypeInfoRecursive( cx, pTypeInfoCur, members );
-            }
-
-            /*
-            if ( FAILED( hresult ) )
-            {
-                JS_ReportErrorUTF8( cx, "Failed to GetRefTypeInfo" );
-                return false;
-            }
-            */
-        }
-    }
-}
-
-void ActiveXObject::ParseTypeInfo( ITypeInfo* pTypeInfo, MemberMap& members )
-{
-    VARDESC* vardesc;
-    for ( size_t i = 0; pTypeInfo->GetVarDesc( i, &vardesc ) == S_OK; ++i )
-    {
-        _bstr_t name;
-        //_bstr_t desc;
-        if ( pTypeInfo->GetDocumentation( vardesc->memid, name.GetAddress(), nullptr /*&desc*/, nullptr, nullptr ) == S_OK )
-        {
-            if ( !( vardesc->wVarFlags & VARFLAG_FRESTRICTED )
-                 && !( vardesc->wVarFlags & VARFLAG_FHIDDEN ) )
-            {
-                auto [it, bRet] = members.try_emplace( name.GetBSTR(), std::make_unique<MemberInfo>() );
-                auto pProp = it->second.get();
-                pProp->isGet = true;
-                pProp->isPut = true;
-            }
-        }
-        pTypeInfo->ReleaseVarDesc( vardesc );
-    }
-
-    FUNCDESC* funcdesc;
-    for ( size_t i = 0; pTypeInfo->GetFuncDesc( i, &funcdesc ) == S_OK; ++i )
-    {
-        _bstr_t name;
-        //_bstr_t desc;
-        if ( pTypeInfo->GetDocumentation( funcdesc->memid, name.GetAddress(), nullptr /*&desc*/, nullptr, nullptr ) == S_OK )
-        {
-            if ( !( funcdesc->wFuncFlags & FUNCFLAG_FRESTRICTED )
-                 && !( funcdesc->wFuncFlags & FUNCFLAG_FHIDDEN ) )
-            {
-                auto [it, bRet] = members.try_emplace( name.GetBSTR(), std::make_unique<MemberInfo>() );
-                auto pProp = it->second.get();
-                if ( INVOKE_PROPERTYPUT == funcdesc->invkind )
-                {
-                    pProp->isPut = true;
-                }
-                if ( INVOKE_PROPERTYPUTREF == funcdesc->invkind )
-                {
-                    pProp->isPutRef = true;
-                }
-                if ( INVOKE_PROPERTYGET == funcdesc->invkind )
-                {
-                    pProp->isGet = true;
-                }
-                if ( INVOKE_FUNC == funcdesc->invkind )
-                {
-                    pProp->isInvoke = true;
-                }
-            }
-        }
-        pTypeInfo->ReleaseFuncDesc( funcdesc );
-    }
-}
-
 void ActiveXObject::SetupMembers_Impl( JS::HandleObject jsObject )
 {
-    for ( const auto& [name, member]: members_ )
+    for ( const auto& [name, member]: *pMembers_ )
     {
-        if ( member->isInvoke )
+        if ( member.isInvoke )
         {
             if ( !JS_DefineUCFunction( pJsCtx_, jsObject, reinterpret_cast<const char16_t*>( name.c_str() ), name.length(), ActiveX_Run, 0, JSPROP_ENUMERATE ) )
             {
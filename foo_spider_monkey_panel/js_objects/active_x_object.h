@@ -1,4 +1,5 @@
 #include <js_objects/object_base.h>
+#include <js_objects/internal/active_x_type_cache.h>
 
 #pragma warning( push )  
 #pragma warning( disable : 4100 ) // unused variable
@@ -70,32 +71,19 @@ public:
     void Set( const JS::CallArgs& args );
     void Invoke( const std::wstring& funcName, const JS::CallArgs& args );
 
-private:
-    struct MemberInfo
-    {
-        bool isGet = false;
-        bool isPut = false;
-        bool isPutRef = false;
-        bool isInvoke = false;
-        bool hasDispId = false;
-        DISPID dispId{};
-    };
-
-    using MemberMap = std::unordered_map<std::wstring, std::unique_ptr<MemberInfo>>;
-
 private:
     std::optional<DISPID> GetDispId( const std::wstring& name, bool reportError = true );
+    const ActiveXTypeCache::MemberInfo* FindMember( const std::wstring& name ) const;
 
     void SetupMembers( JS::HandleObject jsObject );
-    static void ParseTypeInfoRecursive( JSContext * cx, ITypeInfo * pTypeInfo, MemberMap& members );
-    static void ParseTypeInfo( ITypeInfo * pTypeInfo, MemberMap& members );
     void SetupMembers_Impl( JS::HandleObject jsObject );
 
 private:
     JSContext * pJsCtx_ = nullptr;
     bool areMembersSetup_ = false;
 
-    MemberMap members_;
+    std::shared_ptr<ActiveXTypeCache::MemberMap> pMembers_; ///< shared between objects of the same type
+    std::unordered_map<std::wstring, DISPID> dispIds_; ///< DISPIDs that were not provided by type info
 };
 
 }
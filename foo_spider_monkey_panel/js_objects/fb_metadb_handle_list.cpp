@@ -4,10 +4,12 @@
 
 #include <js_engine/js_to_native_invoker.h>
 #include <js_objects/fb_metadb_handle.h>
+#include <js_objects/fb_metadb_handle_list_view.h>
 #include <js_objects/fb_title_format.h>
 #include <js_utils/js_error_helper.h>
 #include <js_utils/js_object_helper.h>
 #include <utils/art_helpers.h>
+#include <utils/handle_grouping.h>
 #include <utils/string_helpers.h>
 #include <utils/text_helpers.h>
 
@@ -58,12 +60,16 @@ MJS_DEFINE_JS_FN_FROM_NATIVE( CalcTotalDuration, JsFbMetadbHandleList::CalcTotal
 MJS_DEFINE_JS_FN_FROM_NATIVE( CalcTotalSize, JsFbMetadbHandleList::CalcTotalSize );
 MJS_DEFINE_JS_FN_FROM_NATIVE( Clone, JsFbMetadbHandleList::Clone );
 MJS_DEFINE_JS_FN_FROM_NATIVE( Convert, JsFbMetadbHandleList::Convert );
+MJS_DEFINE_JS_FN_FROM_NATIVE( CreateIterator, JsFbMetadbHandleList::CreateIterator );
 MJS_DEFINE_JS_FN_FROM_NATIVE( RemoveAttachedImage, JsFbMetadbHandleList::RemoveAttachedImage );
 MJS_DEFINE_JS_FN_FROM_NATIVE( RemoveAttachedImages, JsFbMetadbHandleList::RemoveAttachedImages );
 MJS_DEFINE_JS_FN_FROM_NATIVE( Find, JsFbMetadbHandleList::Find );
+MJS_DEFINE_JS_FN_FROM_NATIVE( ForEach, JsFbMetadbHandleList::ForEach );
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetLibraryRelativePaths, JsFbMetadbHandleList::GetLibraryRelativePaths );
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( GroupBy, JsFbMetadbHandleList::GroupBy, JsFbMetadbHandleList::GroupByWithOpt, 2 );
 MJS_DEFINE_JS_FN_FROM_NATIVE( Insert, JsFbMetadbHandleList::Insert );
 MJS_DEFINE_JS_FN_FROM_NATIVE( InsertRange, JsFbMetadbHandleList::InsertRange );
+MJS_DEFINE_JS_FN_FROM_NATIVE( Map, JsFbMetadbHandleList::Map );
 MJS_DEFINE_JS_FN_FROM_NATIVE( MakeDifference, JsFbMetadbHandleList::MakeDifference );
 MJS_DEFINE_JS_FN_FROM_NATIVE( MakeIntersection, JsFbMetadbHandleList::MakeIntersection );
 MJS_DEFINE_JS_FN_FROM_NATIVE( MakeUnion, JsFbMetadbHandleList::MakeUnion );
@@ -76,6 +82,7 @@ MJS_DEFINE_JS_FN_FROM_NATIVE( RemoveAll, JsFbMetadbHandleList::RemoveAll );
 MJS_DEFINE_JS_FN_FROM_NATIVE( RemoveById, JsFbMetadbHandleList::RemoveById );
 MJS_DEFINE_JS_FN_FROM_NATIVE( RemoveRange, JsFbMetadbHandleList::RemoveRange );
 MJS_DEFINE_JS_FN_FROM_NATIVE( Sort, JsFbMetadbHandleList::Sort );
+MJS_DEFINE_JS_FN_FROM_NATIVE( ToArrayView, JsFbMetadbHandleList::ToArrayView );
 MJS_DEFINE_JS_FN_FROM_NATIVE( UpdateFileInfoFromJSON, JsFbMetadbHandleList::UpdateFileInfoFromJSON );
 
 const JSFunctionSpec jsFunctions[] = {
@@ -88,9 +95,12 @@ const JSFunctionSpec jsFunctions[] = {
     JS_FN( "Clone", Clone, 0, DefaultPropsFlags() ),
     JS_FN( "Convert", Convert, 0, DefaultPropsFlags() ),
     JS_FN( "Find", Find, 1, DefaultPropsFlags() ),
+    JS_FN( "ForEach", ForEach, 1, DefaultPropsFlags() ),
     JS_FN( "GetLibraryRelativePaths", GetLibraryRelativePaths, 0, DefaultPropsFlags() ),
+    JS_FN( "GroupBy", GroupBy, 1, DefaultPropsFlags() ),
     JS_FN( "Insert", Insert, 2, DefaultPropsFlags() ),
     JS_FN( "InsertRange", InsertRange, 2, DefaultPropsFlags() ),
+    JS_FN( "Map", Map, 1, DefaultPropsFlags() ),
     JS_FN( "MakeDifference", MakeDifference, 1, DefaultPropsFlags() ),
     JS_FN( "MakeIntersection", MakeIntersection, 1, DefaultPropsFlags() ),
     JS_FN( "MakeUnion", MakeUnion, 1, DefaultPropsFlags() ),
@@ -105,7 +115,9 @@ const JSFunctionSpec jsFunctions[] = {
     JS_FN( "RemoveById", RemoveById, 1, DefaultPropsFlags() ),
     JS_FN( "RemoveRange", RemoveRange, 2, DefaultPropsFlags() ),
     JS_FN( "Sort", Sort, 0, DefaultPropsFlags() ),
+    JS_FN( "ToArrayView", ToArrayView, 0, DefaultPropsFlags() ),
     JS_FN( "UpdateFileInfoFromJSON", UpdateFileInfoFromJSON, 1, DefaultPropsFlags() ),
+    JS_SYM_FN( iterator, CreateIterator, 0, DefaultPropsFlags() ),
     JS_FS_END
 };
 
@@ -401,6 +413,12 @@ JSObject* JsFbMetadbHandleList::Convert()
     return &jsValue.toObject();
 }
 
+JSObject* JsFbMetadbHandleList::CreateIterator()
+{
+    JS::RootedObject jsView( pJsCtx_, ToArrayView() );
+    return JsFbMetadbHandleListView::CreateIterator( pJsCtx_, jsView );
+}
+
 int32_t JsFbMetadbHandleList::Find( JsFbMetadbHandle* handle )
 {
     SmpException::ExpectTrue( handle, "handle argument is null" );
@@ -411,6 +429,24 @@ int32_t JsFbMetadbHandleList::Find( JsFbMetadbHandle* handle )
     return static_cast<int32_t>( metadbHandleList_.find_item( fbHandle ) );
 }
 
+void JsFbMetadbHandleList::ForEach( JS::HandleValue callback )
+{
+    SmpException::ExpectTrue( callback.isObject() && JS::IsCallable( &callback.toObject() ), "callback argument is not a function" );
+
+    JS::AutoValueArray<2> jsArgs( pJsCtx_ );
+    JS::RootedValue jsRetVal( pJsCtx_ );
+    // list might be modified by the callback
+    for ( uint32_t i = 0; i < metadbHandleList_.get_count(); ++i )
+    {
+        jsArgs[0].setObject( *JsFbMetadbHandle::CreateJs( pJsCtx_, metadbHandleList_[i] ) );
+        jsArgs[1].setNumber( i );
+        if ( !JS::Call( pJsCtx_, JS::UndefinedHandleValue, callback, jsArgs, &jsRetVal ) )
+        {
+            throw JsException();
+        }
+    }
+}
+
 JSObject* JsFbMetadbHandleList::GetLibraryRelativePaths()
 {
     auto api = library_manager::get();
@@ -429,6 +465,46 @@ JSObject* JsFbMetadbHandleList::GetLibraryRelativePaths()
     return &jsValue.toObject();
 }
 
+JSObject* JsFbMetadbHandleList::GroupBy( JsFbTitleFormat* groupScript, JsFbTitleFormat* sortScript, uint32_t flags )
+{
+    SmpException::ExpectTrue( groupScript, "groupScript argument is null" );
+
+    smp::utils::HandleGroupOptions options;
+    options.calcDuration = !!( flags & 1 );
+    options.calcSize = !!( flags & 2 );
+
+    const auto groups = smp::utils::GroupHandles( metadbHandleList_,
+                                                  groupScript->GetTitleFormat(),
+                                                  ( sortScript ? sortScript->GetTitleFormat() : titleformat_object::ptr{} ),
+                                                  options );
+
+    JS::RootedValue jsValue( pJsCtx_ );
+    convert::to_js::ToArrayValue(
+        pJsCtx_,
+        groups,
+        []( const auto& vec, auto index ) -> const auto& {
+            return vec[index];
+        },
+        &jsValue );
+
+    return &jsValue.toObject();
+}
+
+JSObject* JsFbMetadbHandleList::GroupByWithOpt( size_t optArgCount, JsFbTitleFormat* groupScript, JsFbTitleFormat* sortScript, uint32_t flags )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return GroupBy( groupScript, sortScript, flags );
+    case 1:
+        return GroupBy( groupScript, sortScript );
+    case 2:
+        return GroupBy( groupScript );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
 void JsFbMetadbHandleList::Insert( uint32_t index, JsFbMetadbHandle* handle )
 {
     SmpException::ExpectTrue( handle, "handle argument is null" );
@@ -446,6 +522,37 @@ void JsFbMetadbHandleList::InsertRange( uint32_t index, JsFbMetadbHandleList* ha
     metadbHandleList_.insert_items( handles->GetHandleList(), index );
 }
 
+JSObject* JsFbMetadbHandleList::Map( JS::HandleValue callback )
+{
+    SmpException::ExpectTrue( callback.isObject() && JS::IsCallable( &callback.toObject() ), "callback argument is not a function" );
+
+    const uint32_t count = metadbHandleList_.get_count();
+    JS::RootedObject jsArray( pJsCtx_, JS_NewArrayObject( pJsCtx_, count ) );
+    JsException::ExpectTrue( jsArray );
+
+    JS::AutoValueArray<2> jsArgs( pJsCtx_ );
+    JS::RootedValue jsRetVal( pJsCtx_ );
+    // list might be modified by the callback
+    uint32_t i = 0;
+    for ( ; i < count && i < metadbHandleList_.get_count(); ++i )
+    {
+        jsArgs[0].setObject( *JsFbMetadbHandle::CreateJs( pJsCtx_, metadbHandleList_[i] ) );
+        jsArgs[1].setNumber( i );
+        if ( !JS::Call( pJsCtx_, JS::UndefinedHandleValue, callback, jsArgs, &jsRetVal )
+             || !JS_SetElement( pJsCtx_, jsArray, i, jsRetVal ) )
+        {
+            throw JsException();
+        }
+    }
+
+    if ( i < count )
+    { // list was shrunk by the callback: array must not contain holes
+        JsException::ExpectTrue( JS_SetArrayLength( pJsCtx_, jsArray, i ) );
+    }
+
+    return jsArray;
+}
+
 void JsFbMetadbHandleList::MakeDifference( JsFbMetadbHandleList* handles )
 {
     SmpException::ExpectTrue( handles, "handles argument is null" );
@@ -610,6 +717,11 @@ void JsFbMetadbHandleList::Sort()
     metadbHandleList_.sort_by_pointer_remove_duplicates();
 }
 
+JSObject* JsFbMetadbHandleList::ToArrayView()
+{
+    return JsFbMetadbHandleListView::CreateJs( pJsCtx_, metadbHandleList_ );
+}
+
 void JsFbMetadbHandleList::UpdateFileInfoFromJSON( const std::u8string& str )
 {
     using json = nlohmann::json;
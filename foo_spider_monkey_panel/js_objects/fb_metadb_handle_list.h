@@ -73,10 +73,16 @@ public: // methods
     JSObject* Clone();
     // TODO: rename to ToArray()
     JSObject* Convert();
+    /// @brief Implements `[Symbol.iterator]`
+    JSObject* CreateIterator();
     int32_t Find( JsFbMetadbHandle* handle );
+    void ForEach( JS::HandleValue callback );
     JSObject* GetLibraryRelativePaths();
+    JSObject* GroupBy( JsFbTitleFormat* groupScript, JsFbTitleFormat* sortScript = nullptr, uint32_t flags = 0 );
+    JSObject* GroupByWithOpt( size_t optArgCount, JsFbTitleFormat* groupScript, JsFbTitleFormat* sortScript, uint32_t flags );
     void Insert( uint32_t index, JsFbMetadbHandle* handle );
     void InsertRange( uint32_t index, JsFbMetadbHandleList* handles );
+    JSObject* Map( JS::HandleValue callback );
     void MakeDifference( JsFbMetadbHandleList* handles );
     void MakeIntersection( JsFbMetadbHandleList* handles );
     void MakeUnion( JsFbMetadbHandleList* handles );
@@ -91,6 +97,7 @@ public: // methods
     void RemoveById( uint32_t index );
     void RemoveRange( uint32_t from, uint32_t count );
     void Sort();
+    JSObject* ToArrayView();
     void UpdateFileInfoFromJSON( const std::u8string& str );
 
 public: // props
@@ -0,0 +1,198 @@
+#include <stdafx.h>
+
+#include "fb_metadb_handle_list_view.h"
+
+#include <js_objects/fb_metadb_handle.h>
+#include <js_utils/js_error_helper.h>
+#include <js_utils/js_object_helper.h>
+
+using namespace smp;
+
+namespace
+{
+
+using namespace mozjs;
+
+JSClassOps jsOps = {
+    nullptr,
+    nullptr,
+    JsFbMetadbHandleListView::Enumerate,
+    nullptr,
+    JsFbMetadbHandleListView::Resolve,
+    JsFbMetadbHandleListView::MayResolve,
+    JsFbMetadbHandleListView::FinalizeJsObject,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr
+};
+
+JSClass jsClass = {
+    "FbMetadbHandleListView",
+    DefaultClassFlags(),
+    &jsOps
+};
+
+// Self-hosted array methods are generic: they work with any array-like object and are compiled by JIT.
+const JSFunctionSpec jsFunctions[] = {
+    JS_SELF_HOSTED_FN( "forEach", "ArrayForEach", 1, 0 ),
+    JS_SELF_HOSTED_FN( "map", "ArrayMap", 1, 0 ),
+    JS_SELF_HOSTED_SYM_FN( iterator, "ArrayValues", 0, 0 ),
+    JS_FS_END
+};
+
+const JSPropertySpec jsProperties[] = {
+    JS_PS_END
+};
+
+} // namespace
+
+namespace mozjs
+{
+
+const JSClass JsFbMetadbHandleListView::JsClass = jsClass;
+const JSFunctionSpec* JsFbMetadbHandleListView::JsFunctions = jsFunctions;
+const JSPropertySpec* JsFbMetadbHandleListView::JsProperties = jsProperties;
+const JsPrototypeId JsFbMetadbHandleListView::PrototypeId = JsPrototypeId::FbMetadbHandleListView;
+
+JsFbMetadbHandleListView::JsFbMetadbHandleListView( JSContext* cx, const metadb_handle_list& handles )
+    : pJsCtx_( cx )
+    , metadbHandleList_( handles )
+{
+}
+
+std::unique_ptr<JsFbMetadbHandleListView>
+JsFbMetadbHandleListView::CreateNative( JSContext* cx, const metadb_handle_list& handles )
+{
+    return std::unique_ptr<JsFbMetadbHandleListView>( new JsFbMetadbHandleListView( cx, handles ) );
+}
+
+size_t JsFbMetadbHandleListView::GetInternalSize( const metadb_handle_list& handles )
+{
+    return sizeof( metadb_handle ) * handles.get_size();
+}
+
+void JsFbMetadbHandleListView::PostCreate( JSContext* cx, JS::HandleObject self )
+{
+    auto pNative = static_cast<JsFbMetadbHandleListView*>( JS_GetPrivate( self ) );
+    assert( pNative );
+
+    // non-enumerable, as in arrays
+    if ( !JS_DefineProperty( cx, self, "length", static_cast<uint32_t>( pNative->metadbHandleList_.get_count() ), JSPROP_PERMANENT | JSPROP_READONLY ) )
+    {
+        throw JsException();
+    }
+}
+
+bool JsFbMetadbHandleListView::Resolve( JSContext* cx, JS::HandleObject obj, JS::HandleId id, bool* resolvedp )
+{
+    *resolvedp = false;
+
+    auto pNative = static_cast<JsFbMetadbHandleListView*>( JS_GetPrivate( obj ) );
+    if ( !pNative || !JSID_IS_INT( id ) || JSID_TO_INT( id ) < 0 )
+    {
+        return true;
+    }
+
+    const auto index = static_cast<uint32_t>( JSID_TO_INT( id ) );
+    if ( index >= pNative->metadbHandleList_.get_count() )
+    {
+        return true;
+    }
+
+    try
+    {
+        pNative->DefineItem( obj, index );
+    }
+    catch ( ... )
+    {
+        mozjs::error::ExceptionToJsError( cx );
+        return false;
+    }
+
+    *resolvedp = true;
+    return true;
+}
+
+bool JsFbMetadbHandleListView::MayResolve( const JSAtomState& /*names*/, jsid id, JSObject* maybeObj )
+{
+    if ( !JSID_IS_INT( id ) || JSID_TO_INT( id ) < 0 )
+    {
+        return false;
+    }
+
+    if ( !maybeObj )
+    { // called for the class as a whole: any valid index might be resolved
+        return true;
+    }
+
+    // out of range indices are never resolved, so that e.g. the final `view[view.length]` check is not pessimized
+    auto pNative = static_cast<JsFbMetadbHandleListView*>( JS_GetPrivate( maybeObj ) );
+    return ( pNative && static_cast<uint32_t>( JSID_TO_INT( id ) ) < pNative->metadbHandleList_.get_count() );
+}
+
+bool JsFbMetadbHandleListView::Enumerate( JSContext* cx, JS::HandleObject obj )
+{
+    auto pNative = static_cast<JsFbMetadbHandleListView*>( JS_GetPrivate( obj ) );
+    if ( !pNative )
+    {
+        return true;
+    }
+
+    try
+    {
+        for ( uint32_t i = 0; i < pNative->metadbHandleList_.get_count(); ++i )
+        {
+            bool hasItem;
+            if ( !JS_AlreadyHasOwnElement( cx, obj, i, &hasItem ) )
+            {
+                throw JsException();
+            }
+            if ( !hasItem )
+            {
+                pNative->DefineItem( obj, i );
+            }
+        }
+    }
+    catch ( ... )
+    {
+        mozjs::error::ExceptionToJsError( cx );
+        return false;
+    }
+
+    return true;
+}
+
+JSObject* JsFbMetadbHandleListView::CreateIterator( JSContext* cx, JS::HandleObject jsView )
+{
+    JS::RootedId jsIteratorId( cx, SYMBOL_TO_JSID( JS::GetWellKnownSymbol( cx, JS::SymbolCode::iterator ) ) );
+    JS::RootedValue jsIteratorFn( cx );
+    if ( !JS_GetPropertyById( cx, jsView, jsIteratorId, &jsIteratorFn ) )
+    {
+        throw JsException();
+    }
+
+    JS::RootedValue jsViewValue( cx, JS::ObjectValue( *jsView ) );
+    JS::RootedValue jsIterator( cx );
+    if ( !JS::Call( cx, jsViewValue, jsIteratorFn, JS::HandleValueArray::empty(), &jsIterator ) )
+    {
+        throw JsException();
+    }
+
+    assert( jsIterator.isObject() );
+    return &jsIterator.toObject();
+}
+
+void JsFbMetadbHandleListView::DefineItem( JS::HandleObject self, uint32_t index )
+{
+    JS::RootedValue jsItem( pJsCtx_, JS::ObjectValue( *JsFbMetadbHandle::CreateJs( pJsCtx_, metadbHandleList_[index] ) ) );
+    // Default (writable and configurable) attributes are required for the element to be stored densely:
+    // any other attributes turn the object into a sparse dictionary, where every access is a slow lookup.
+    // JSPROP_RESOLVING: invoked from resolve and enumerate hooks
+    if ( !JS_DefineElement( pJsCtx_, self, index, jsItem, JSPROP_ENUMERATE | JSPROP_RESOLVING ) )
+    {
+        throw JsException();
+    }
+}
+
+} // namespace mozjs
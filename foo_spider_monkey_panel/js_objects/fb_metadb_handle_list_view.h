@@ -0,0 +1,58 @@
+#pragma once
+
+#include <js_objects/object_base.h>
+
+class JSObject;
+struct JSContext;
+struct JSClass;
+
+namespace mozjs
+{
+
+/// @brief Array-like snapshot of FbMetadbHandleList.
+/// @details Elements are created on first access (via class resolve hook) as plain writable data properties,
+///          so that they are stored as dense elements (as long as they are accessed in order)
+///          and indexed access is handled by JIT inline caches instead of proxy traps.
+///          Only the accessed elements are ever converted to FbMetadbHandle objects.
+class JsFbMetadbHandleListView
+    : public JsObjectBase<JsFbMetadbHandleListView>
+{
+public:
+    static constexpr bool HasProto = true;
+    static constexpr bool HasGlobalProto = false;
+    static constexpr bool HasProxy = false;
+    static constexpr bool HasPostCreate = true;
+
+    static const JSClass JsClass;
+    static const JSFunctionSpec* JsFunctions;
+    static const JSPropertySpec* JsProperties;
+    static const JsPrototypeId PrototypeId;
+
+public:
+    ~JsFbMetadbHandleListView() = default;
+
+    static std::unique_ptr<JsFbMetadbHandleListView> CreateNative( JSContext* cx, const metadb_handle_list& handles );
+    static size_t GetInternalSize( const metadb_handle_list& handles );
+    static void PostCreate( JSContext* cx, JS::HandleObject self );
+
+    static bool Resolve( JSContext* cx, JS::HandleObject obj, JS::HandleId id, bool* resolvedp );
+    static bool MayResolve( const JSAtomState& names, jsid id, JSObject* maybeObj );
+    static bool Enumerate( JSContext* cx, JS::HandleObject obj );
+
+    /// @brief Creates the same iterator as `Array.prototype[Symbol.iterator]` does
+    /// @throw smp::JsException
+    static JSObject* CreateIterator( JSContext* cx, JS::HandleObject jsView );
+
+private:
+    JsFbMetadbHandleListView( JSContext* cx, const metadb_handle_list& handles );
+
+    /// @throw smp::JsException
+    /// @throw smp::SmpException
+    void DefineItem( JS::HandleObject self, uint32_t index );
+
+private:
+    JSContext* pJsCtx_ = nullptr;
+    metadb_handle_list metadbHandleList_;
+};
+
+} // namespace mozjs
@@ -12,6 +12,8 @@
 #include <utils/string_helpers.h>
 #include <utils/text_helpers.h>
 #include <utils/location_processor.h>
+#include <utils/playlist_journal.h>
+#include <utils/playlist_transaction.h>
 
 #include <abort_callback.h>
 
@@ -45,8 +47,10 @@ JSClass jsClass = {
 MJS_DEFINE_JS_FN_FROM_NATIVE( AddItemToPlaybackQueue, JsFbPlaylistManager::AddItemToPlaybackQueue );
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( AddLocations, JsFbPlaylistManager::AddLocations, JsFbPlaylistManager::AddLocationsWithOpt, 1 );
 MJS_DEFINE_JS_FN_FROM_NATIVE( AddPlaylistItemToPlaybackQueue, JsFbPlaylistManager::AddPlaylistItemToPlaybackQueue );
+MJS_DEFINE_JS_FN_FROM_NATIVE( BeginTransaction, JsFbPlaylistManager::BeginTransaction );
 MJS_DEFINE_JS_FN_FROM_NATIVE( ClearPlaylist, JsFbPlaylistManager::ClearPlaylist );
 MJS_DEFINE_JS_FN_FROM_NATIVE( ClearPlaylistSelection, JsFbPlaylistManager::ClearPlaylistSelection );
+MJS_DEFINE_JS_FN_FROM_NATIVE( Commit, JsFbPlaylistManager::Commit );
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( CreateAutoPlaylist, JsFbPlaylistManager::CreateAutoPlaylist, JsFbPlaylistManager::CreateAutoPlaylistWithOpt, 2 );
 MJS_DEFINE_JS_FN_FROM_NATIVE( CreatePlaylist, JsFbPlaylistManager::CreatePlaylist );
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( DuplicatePlaylist, JsFbPlaylistManager::DuplicatePlaylist, JsFbPlaylistManager::DuplicatePlaylistWithOpt, 1 );
@@ -59,10 +63,12 @@ MJS_DEFINE_JS_FN_FROM_NATIVE( FlushPlaybackQueue, JsFbPlaylistManager::FlushPlay
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetPlaybackQueueContents, JsFbPlaylistManager::GetPlaybackQueueContents );
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetPlaybackQueueHandles, JsFbPlaylistManager::GetPlaybackQueueHandles );
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetPlayingItemLocation, JsFbPlaylistManager::GetPlayingItemLocation );
+MJS_DEFINE_JS_FN_FROM_NATIVE( GetPlaylistChanges, JsFbPlaylistManager::GetPlaylistChanges );
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetPlaylistFocusItemIndex, JsFbPlaylistManager::GetPlaylistFocusItemIndex );
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetPlaylistItems, JsFbPlaylistManager::GetPlaylistItems );
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetPlaylistName, JsFbPlaylistManager::GetPlaylistName );
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetPlaylistSelectedItems, JsFbPlaylistManager::GetPlaylistSelectedItems );
+MJS_DEFINE_JS_FN_FROM_NATIVE( GetPlaylistVersion, JsFbPlaylistManager::GetPlaylistVersion );
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( InsertPlaylistItems, JsFbPlaylistManager::InsertPlaylistItems, JsFbPlaylistManager::InsertPlaylistItemsWithOpt, 1 );
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( InsertPlaylistItemsFilter, JsFbPlaylistManager::InsertPlaylistItemsFilter, JsFbPlaylistManager::InsertPlaylistItemsFilterWithOpt, 1 );
 MJS_DEFINE_JS_FN_FROM_NATIVE( IsAutoPlaylist, JsFbPlaylistManager::IsAutoPlaylist );
@@ -77,6 +83,7 @@ MJS_DEFINE_JS_FN_FROM_NATIVE( RemovePlaylist, JsFbPlaylistManager::RemovePlaylis
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( RemovePlaylistSelection, JsFbPlaylistManager::RemovePlaylistSelection, JsFbPlaylistManager::RemovePlaylistSelectionWithOpt, 1 );
 MJS_DEFINE_JS_FN_FROM_NATIVE( RemovePlaylistSwitch, JsFbPlaylistManager::RemovePlaylistSwitch );
 MJS_DEFINE_JS_FN_FROM_NATIVE( RenamePlaylist, JsFbPlaylistManager::RenamePlaylist );
+MJS_DEFINE_JS_FN_FROM_NATIVE( Rollback, JsFbPlaylistManager::Rollback );
 MJS_DEFINE_JS_FN_FROM_NATIVE( SetActivePlaylistContext, JsFbPlaylistManager::SetActivePlaylistContext );
 MJS_DEFINE_JS_FN_FROM_NATIVE( SetPlaylistFocusItem, JsFbPlaylistManager::SetPlaylistFocusItem );
 MJS_DEFINE_JS_FN_FROM_NATIVE( SetPlaylistFocusItemByHandle, JsFbPlaylistManager::SetPlaylistFocusItemByHandle );
@@ -92,8 +99,10 @@ const JSFunctionSpec jsFunctions[] = {
     JS_FN( "AddItemToPlaybackQueue", AddItemToPlaybackQueue, 1, DefaultPropsFlags() ),
     JS_FN( "AddLocations", AddLocations, 2, DefaultPropsFlags() ),
     JS_FN( "AddPlaylistItemToPlaybackQueue", AddPlaylistItemToPlaybackQueue, 2, DefaultPropsFlags() ),
+    JS_FN( "BeginTransaction", BeginTransaction, 1, DefaultPropsFlags() ),
     JS_FN( "ClearPlaylist", ClearPlaylist, 1, DefaultPropsFlags() ),
     JS_FN( "ClearPlaylistSelection", ClearPlaylistSelection, 1, DefaultPropsFlags() ),
+    JS_FN( "Commit", Commit, 0, DefaultPropsFlags() ),
     JS_FN( "CreateAutoPlaylist", CreateAutoPlaylist, 3, DefaultPropsFlags() ),
     JS_FN( "CreatePlaylist", CreatePlaylist, 2, DefaultPropsFlags() ),
     JS_FN( "DuplicatePlaylist", DuplicatePlaylist, 1, DefaultPropsFlags() ),
@@ -106,10 +115,12 @@ const JSFunctionSpec jsFunctions[] = {
     JS_FN( "GetPlaybackQueueContents", GetPlaybackQueueContents, 0, DefaultPropsFlags() ),
     JS_FN( "GetPlaybackQueueHandles", GetPlaybackQueueHandles, 0, DefaultPropsFlags() ),
     JS_FN( "GetPlayingItemLocation", GetPlayingItemLocation, 0, DefaultPropsFlags() ),
+    JS_FN( "GetPlaylistChanges", GetPlaylistChanges, 2, DefaultPropsFlags() ),
     JS_FN( "GetPlaylistFocusItemIndex", GetPlaylistFocusItemIndex, 1, DefaultPropsFlags() ),
     JS_FN( "GetPlaylistItems", GetPlaylistItems, 1, DefaultPropsFlags() ),
     JS_FN( "GetPlaylistName", GetPlaylistName, 1, DefaultPropsFlags() ),
     JS_FN( "GetPlaylistSelectedItems", GetPlaylistSelectedItems, 1, DefaultPropsFlags() ),
+    JS_FN( "GetPlaylistVersion", GetPlaylistVersion, 1, DefaultPropsFlags() ),
     JS_FN( "InsertPlaylistItems", InsertPlaylistItems, 3, DefaultPropsFlags() ),
     JS_FN( "InsertPlaylistItemsFilter", InsertPlaylistItemsFilter, 3, DefaultPropsFlags() ),
     JS_FN( "IsAutoPlaylist", IsAutoPlaylist, 1, DefaultPropsFlags() ),
@@ -124,6 +135,7 @@ const JSFunctionSpec jsFunctions[] = {
     JS_FN( "RemovePlaylistSelection", RemovePlaylistSelection, 1, DefaultPropsFlags() ),
     JS_FN( "RemovePlaylistSwitch", RemovePlaylistSwitch, 1, DefaultPropsFlags() ),
     JS_FN( "RenamePlaylist", RenamePlaylist, 2, DefaultPropsFlags() ),
+    JS_FN( "Rollback", Rollback, 0, DefaultPropsFlags() ),
     JS_FN( "SetActivePlaylistContext", SetActivePlaylistContext, 0, DefaultPropsFlags() ),
     JS_FN( "SetPlaylistFocusItem", SetPlaylistFocusItem, 2, DefaultPropsFlags() ),
     JS_FN( "SetPlaylistFocusItemByHandle", SetPlaylistFocusItemByHandle, 2, DefaultPropsFlags() ),
@@ -188,6 +200,7 @@ size_t JsFbPlaylistManager::GetInternalSize()
 void JsFbPlaylistManager::PrepareForGc()
 {
     jsPlaylistRecycler_.reset();
+    pTransaction_.reset();
 }
 
 void JsFbPlaylistManager::AddItemToPlaybackQueue( JsFbMetadbHandle* handle )
@@ -233,16 +246,42 @@ void JsFbPlaylistManager::AddPlaylistItemToPlaybackQueue( uint32_t playlistIndex
     playlist_manager::get()->queue_add_item_playlist( playlistIndex, playlistItemIndex );
 }
 
+void JsFbPlaylistManager::BeginTransaction( uint32_t playlistIndex )
+{
+    SmpException::ExpectTrue( !pTransaction_, "Another transaction is already in progress" );
+
+    pTransaction_ = std::make_unique<smp::utils::PlaylistTransaction>( playlistIndex );
+}
+
 void JsFbPlaylistManager::ClearPlaylist( uint32_t playlistIndex )
 {
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        return pTransaction->Clear();
+    }
+
     playlist_manager::get()->playlist_clear( playlistIndex );
 }
 
 void JsFbPlaylistManager::ClearPlaylistSelection( uint32_t playlistIndex )
 {
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        return pTransaction->ClearSelection();
+    }
+
     playlist_manager::get()->playlist_clear_selection( playlistIndex );
 }
 
+void JsFbPlaylistManager::Commit()
+{
+    SmpException::ExpectTrue( pTransaction_.get(), "No transaction is in progress" );
+
+    // transaction is finished regardless of the commit result
+    const auto pTransaction = std::move( pTransaction_ );
+    pTransaction->Commit();
+}
+
 uint32_t JsFbPlaylistManager::CreateAutoPlaylist( uint32_t playlistIndex, const std::u8string& name, const std::u8string& query, const std::u8string& sort, uint32_t flags )
 {
     const uint32_t upos = CreatePlaylist( playlistIndex, name );
@@ -420,8 +459,34 @@ JSObject* JsFbPlaylistManager::GetPlayingItemLocation()
     return JsFbPlayingItemLocation::CreateJs( pJsCtx_, isValid, playlistIndex, playlistItemIndex );
 }
 
+JS::Value JsFbPlaylistManager::GetPlaylistChanges( uint32_t playlistIndex, uint32_t sinceVersion )
+{
+    const auto changesOpt = smp::utils::PlaylistJournal::GetInstance().GetChanges( playlistIndex, sinceVersion );
+    if ( !changesOpt )
+    { // playlist must be re-read
+        return JS::NullValue();
+    }
+
+    JS::RootedValue jsValue( pJsCtx_ );
+    convert::to_js::ToArrayValue(
+        pJsCtx_,
+        *changesOpt,
+        []( const auto& vec, auto index ) -> const auto& {
+            return vec[index];
+        },
+        &jsValue );
+
+    return jsValue;
+}
+
 int32_t JsFbPlaylistManager::GetPlaylistFocusItemIndex( uint32_t playlistIndex )
 {
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        const auto focusIdxOpt = pTransaction->GetFocusItem();
+        return ( focusIdxOpt ? static_cast<int32_t>( *focusIdxOpt ) : -1 );
+    }
+
     const uint32_t upos = playlist_manager::get()->playlist_get_focus_item( playlistIndex );
     return ( pfc_infinite == upos ? -1 : static_cast<int32_t>( upos ) );
 }
@@ -429,7 +494,14 @@ int32_t JsFbPlaylistManager::GetPlaylistFocusItemIndex( uint32_t playlistIndex )
 JSObject* JsFbPlaylistManager::GetPlaylistItems( uint32_t playlistIndex )
 {
     metadb_handle_list items;
-    playlist_manager::get()->playlist_get_all_items( playlistIndex, items );
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        pTransaction->GetItems( items );
+    }
+    else
+    {
+        playlist_manager::get()->playlist_get_all_items( playlistIndex, items );
+    }
 
     return JsFbMetadbHandleList::CreateJs( pJsCtx_, items );
 }
@@ -444,15 +516,34 @@ pfc::string8_fast JsFbPlaylistManager::GetPlaylistName( uint32_t playlistIndex )
 JSObject* JsFbPlaylistManager::GetPlaylistSelectedItems( uint32_t playlistIndex )
 {
     metadb_handle_list items;
-    playlist_manager::get()->playlist_get_selected_items( playlistIndex, items );
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        pTransaction->GetSelectedItems( items );
+    }
+    else
+    {
+        playlist_manager::get()->playlist_get_selected_items( playlistIndex, items );
+    }
 
     return JsFbMetadbHandleList::CreateJs( pJsCtx_, items );
 }
 
+uint32_t JsFbPlaylistManager::GetPlaylistVersion( uint32_t playlistIndex )
+{
+    SmpException::ExpectTrue( playlistIndex < playlist_manager::get()->get_playlist_count(), "Index is out of bounds" );
+
+    return smp::utils::PlaylistJournal::GetInstance().GetVersion( playlistIndex );
+}
+
 void JsFbPlaylistManager::InsertPlaylistItems( uint32_t playlistIndex, uint32_t base, JsFbMetadbHandleList* handles, bool select )
 {
     SmpException::ExpectTrue( handles, "handles argument is null" );
 
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        return pTransaction->InsertItems( base, handles->GetHandleList(), select );
+    }
+
     pfc::bit_array_val selection( select );
     playlist_manager::get()->playlist_insert_items( playlistIndex, base, handles->GetHandleList(), selection );
 }
@@ -474,6 +565,13 @@ void JsFbPlaylistManager::InsertPlaylistItemsFilter( uint32_t playlistIndex, uin
 {
     SmpException::ExpectTrue( handles, "handles argument is null" );
 
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        metadb_handle_list filteredItems;
+        playlist_incoming_item_filter::get()->filter_items( handles->GetHandleList(), filteredItems );
+        return pTransaction->InsertItems( base, filteredItems, select );
+    }
+
     playlist_manager::get()->playlist_insert_items_filter( playlistIndex, base, handles->GetHandleList(), select );
 }
 
@@ -499,6 +597,11 @@ bool JsFbPlaylistManager::IsAutoPlaylist( uint32_t playlistIndex )
 
 bool JsFbPlaylistManager::IsPlaylistItemSelected( uint32_t playlistIndex, uint32_t playlistItemIndex )
 {
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        return pTransaction->IsItemSelected( playlistItemIndex );
+    }
+
     return playlist_manager::get()->playlist_is_item_selected( playlistIndex, playlistItemIndex );
 }
 
@@ -538,11 +641,22 @@ bool JsFbPlaylistManager::MovePlaylist( uint32_t from, uint32_t to )
 
 bool JsFbPlaylistManager::MovePlaylistSelection( uint32_t playlistIndex, int32_t delta )
 {
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        pTransaction->MoveSelection( delta );
+        return true;
+    }
+
     return playlist_manager::get()->playlist_move_selection( playlistIndex, delta );
 }
 
 uint32_t JsFbPlaylistManager::PlaylistItemCount( uint32_t playlistIndex )
 {
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        return pTransaction->GetItemCount();
+    }
+
     return playlist_manager::get()->playlist_get_item_count( playlistIndex );
 }
 
@@ -568,6 +682,11 @@ bool JsFbPlaylistManager::RemovePlaylist( uint32_t playlistIndex )
 
 void JsFbPlaylistManager::RemovePlaylistSelection( uint32_t playlistIndex, bool crop )
 {
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        return pTransaction->RemoveSelection( crop );
+    }
+
     playlist_manager::get()->playlist_remove_selection( playlistIndex, crop );
 }
 
@@ -594,6 +713,13 @@ bool JsFbPlaylistManager::RenamePlaylist( uint32_t playlistIndex, const std::u8s
     return playlist_manager::get()->playlist_rename( playlistIndex, name.c_str(), name.length() );
 }
 
+void JsFbPlaylistManager::Rollback()
+{
+    SmpException::ExpectTrue( pTransaction_.get(), "No transaction is in progress" );
+
+    pTransaction_.reset();
+}
+
 void JsFbPlaylistManager::SetActivePlaylistContext()
 {
     ui_edit_context_manager::get()->set_context_active_playlist();
@@ -601,6 +727,11 @@ void JsFbPlaylistManager::SetActivePlaylistContext()
 
 void JsFbPlaylistManager::SetPlaylistFocusItem( uint32_t playlistIndex, uint32_t playlistItemIndex )
 {
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        return pTransaction->SetFocusItem( playlistItemIndex );
+    }
+
     playlist_manager::get()->playlist_set_focus_item( playlistIndex, playlistItemIndex );
 }
 
@@ -608,25 +739,41 @@ void JsFbPlaylistManager::SetPlaylistFocusItemByHandle( uint32_t playlistIndex,
 {
     SmpException::ExpectTrue( handle, "handle argument is null" );
 
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        return pTransaction->SetFocusByHandle( handle->GetHandle() );
+    }
+
     playlist_manager::get()->playlist_set_focus_by_handle( playlistIndex, handle->GetHandle() );
 }
 
 void JsFbPlaylistManager::SetPlaylistSelection( uint32_t playlistIndex, JS::HandleValue affectedItems, bool state )
 {
     auto api = playlist_manager::get();
-    pfc::bit_array_bittable affected( api->playlist_get_item_count( playlistIndex ) );
+    auto pTransaction = GetTransaction( playlistIndex );
+    pfc::bit_array_bittable affected( pTransaction ? pTransaction->GetItemCount() : api->playlist_get_item_count( playlistIndex ) );
 
     convert::to_native::ProcessArray<uint32_t>(
         pJsCtx_,
         affectedItems,
         [&affected]( uint32_t index ) { affected.set( index, true ); } );
 
+    if ( pTransaction )
+    {
+        return pTransaction->SetSelection( affected, state );
+    }
+
     pfc::bit_array_val status( state );
     api->playlist_set_selection( playlistIndex, affected, status );
 }
 
 void JsFbPlaylistManager::SetPlaylistSelectionSingle( uint32_t playlistIndex, uint32_t playlistItemIndex, bool state )
 {
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        return pTransaction->SetSelectionSingle( playlistItemIndex, state );
+    }
+
     playlist_manager::get()->playlist_set_selection_single( playlistIndex, playlistItemIndex, state );
 }
 
@@ -648,6 +795,18 @@ bool JsFbPlaylistManager::ShowAutoPlaylistUI( uint32_t playlistIndex )
 
 bool JsFbPlaylistManager::SortByFormat( uint32_t playlistIndex, const std::u8string& pattern, bool selOnly )
 {
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        titleformat_object::ptr script;
+        if ( !pattern.empty() )
+        {
+            titleformat_compiler::get()->compile_safe( script, pattern.c_str() );
+        }
+
+        pTransaction->SortByFormat( script, selOnly, 1 );
+        return true;
+    }
+
     return playlist_manager::get()->playlist_sort_by_format( playlistIndex, pattern.empty() ? nullptr : pattern.c_str(), selOnly );
 }
 
@@ -666,6 +825,15 @@ bool JsFbPlaylistManager::SortByFormatWithOpt( size_t optArgCount, uint32_t play
 
 bool JsFbPlaylistManager::SortByFormatV2( uint32_t playlistIndex, const std::u8string& pattern, int8_t direction )
 {
+    if ( auto pTransaction = GetTransaction( playlistIndex ) )
+    {
+        titleformat_object::ptr script;
+        titleformat_compiler::get()->compile_safe( script, pattern.c_str() );
+
+        pTransaction->SortByFormat( script, false, direction );
+        return true;
+    }
+
     auto api = playlist_manager::get();
 
     metadb_handle_list handles;
@@ -732,6 +900,11 @@ void JsFbPlaylistManager::SortPlaylistsByNameWithOpt( size_t optArgCount, int8_t
 
 void JsFbPlaylistManager::UndoBackup( uint32_t playlistIndex )
 {
+    if ( GetTransaction( playlistIndex ) )
+    { // backup is performed on commit
+        return;
+    }
+
     playlist_manager::get()->playlist_undo_backup( playlistIndex );
 }
 
@@ -791,4 +964,14 @@ void JsFbPlaylistManager::put_PlayingPlaylist( uint32_t playlistIndex )
     api->set_playing_playlist( playlistIndex );
 }
 
+smp::utils::PlaylistTransaction* JsFbPlaylistManager::GetTransaction( uint32_t playlistIndex )
+{
+    if ( !pTransaction_ || pTransaction_->GetPlaylistIndex() != playlistIndex )
+    {
+        return nullptr;
+    }
+
+    return pTransaction_.get();
+}
+
 } // namespace mozjs
@@ -2,6 +2,7 @@
 
 #include <js_objects/object_base.h>
 
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -9,6 +10,11 @@ class JSObject;
 struct JSContext;
 struct JSClass;
 
+namespace smp::utils
+{
+class PlaylistTransaction;
+}
+
 namespace mozjs
 {
 
@@ -42,8 +48,10 @@ public:
     void AddLocations( uint32_t playlistIndex, JS::HandleValue locations, bool select = false );
     void AddLocationsWithOpt( size_t optArgCount, uint32_t playlistIndex, JS::HandleValue locations, bool select );
     void AddPlaylistItemToPlaybackQueue( uint32_t playlistIndex, uint32_t playlistItemIndex );
+    void BeginTransaction( uint32_t playlistIndex );
     void ClearPlaylist( uint32_t playlistIndex );
     void ClearPlaylistSelection( uint32_t playlistIndex );
+    void Commit();
     uint32_t CreateAutoPlaylist( uint32_t playlistIndex, const std::u8string& name, const std::u8string& query, const std::u8string& sort = "", uint32_t flags = 0 );
     uint32_t CreateAutoPlaylistWithOpt( size_t optArgCount, uint32_t playlistIndex, const std::u8string& name, const std::u8string& query, const std::u8string& sort, uint32_t flags );
     uint32_t CreatePlaylist( uint32_t playlistIndex, const std::u8string& name );
@@ -58,10 +66,12 @@ public:
     JSObject* GetPlaybackQueueContents();
     JSObject* GetPlaybackQueueHandles();
     JSObject* GetPlayingItemLocation();
+    JS::Value GetPlaylistChanges( uint32_t playlistIndex, uint32_t sinceVersion );
     int32_t GetPlaylistFocusItemIndex( uint32_t playlistIndex );
     JSObject* GetPlaylistItems( uint32_t playlistIndex );
     pfc::string8_fast GetPlaylistName( uint32_t playlistIndex );
     JSObject* GetPlaylistSelectedItems( uint32_t playlistIndex );
+    uint32_t GetPlaylistVersion( uint32_t playlistIndex );
     void InsertPlaylistItems( uint32_t playlistIndex, uint32_t base, JsFbMetadbHandleList* handles, bool select = false );
     void InsertPlaylistItemsWithOpt( size_t optArgCount, uint32_t playlistIndex, uint32_t base, JsFbMetadbHandleList* handles, bool select );
     void InsertPlaylistItemsFilter( uint32_t playlistIndex, uint32_t base, JsFbMetadbHandleList* handles, bool select = false );
@@ -79,6 +89,7 @@ public:
     void RemovePlaylistSelectionWithOpt( size_t optArgCount, uint32_t playlistIndex, bool crop );
     bool RemovePlaylistSwitch( uint32_t playlistIndex );
     bool RenamePlaylist( uint32_t playlistIndex, const std::u8string& name );
+    void Rollback();
     void SetActivePlaylistContext();
     void SetPlaylistFocusItem( uint32_t playlistIndex, uint32_t playlistItemIndex );
     void SetPlaylistFocusItemByHandle( uint32_t playlistIndex, JsFbMetadbHandle* handle );
@@ -106,9 +117,13 @@ public:
 private:
     JsFbPlaylistManager( JSContext* cx );
 
+    /// @return Transaction in progress for the specified playlist, nullptr if there is none
+    smp::utils::PlaylistTransaction* GetTransaction( uint32_t playlistIndex );
+
 private:
     JSContext* pJsCtx_ = nullptr;
     JS::PersistentRootedObject jsPlaylistRecycler_;
+    std::unique_ptr<smp::utils::PlaylistTransaction> pTransaction_;
 };
 
 } // namespace mozjs
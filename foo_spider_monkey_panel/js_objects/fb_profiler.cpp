@@ -5,6 +5,7 @@
 #include <js_engine/js_to_native_invoker.h>
 #include <js_utils/js_error_helper.h>
 #include <js_utils/js_object_helper.h>
+#include <utils/trace_recorder.h>
 #include <smp_exception.h>
 
 using namespace smp;
@@ -34,10 +35,14 @@ JSClass jsClass = {
     &jsOps
 };
 
+MJS_DEFINE_JS_FN_FROM_NATIVE( BeginSpan, JsFbProfiler::BeginSpan )
+MJS_DEFINE_JS_FN_FROM_NATIVE( EndSpan, JsFbProfiler::EndSpan )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( Print, JsFbProfiler::Print, JsFbProfiler::PrintWithOpt, 2 )
 MJS_DEFINE_JS_FN_FROM_NATIVE( Reset, JsFbProfiler::Reset )
 
 const JSFunctionSpec jsFunctions[] = {
+    JS_FN( "BeginSpan", BeginSpan, 1, DefaultPropsFlags() ),
+    JS_FN( "EndSpan", EndSpan, 0, DefaultPropsFlags() ),
     JS_FN( "Print", Print, 0, DefaultPropsFlags() ),
     JS_FN( "Reset", Reset, 0, DefaultPropsFlags() ),
     JS_FS_END
@@ -103,6 +108,34 @@ JSObject* JsFbProfiler::ConstructorWithOpt( JSContext* cx, size_t optArgCount, c
     }
 }
 
+void JsFbProfiler::BeginSpan( const std::u8string& name )
+{
+    if ( !smp::utils::TraceRecorder::IsEnabled() )
+    {
+        openSpans_.emplace_back( std::nullopt );
+        return;
+    }
+
+    smp::utils::TraceRecorder::GetInstance().Begin( "script", name_.empty() ? name : fmt::format( "{}: {}", name_, name ) );
+    openSpans_.emplace_back( smp::utils::TraceRecorder::GetSessionId() );
+}
+
+void JsFbProfiler::EndSpan()
+{
+    SmpException::ExpectTrue( !openSpans_.empty(), "There are no open spans" );
+
+    const auto sessionIdOpt = openSpans_.back();
+    openSpans_.pop_back();
+
+    // don't emit unmatched end events when tracing was restarted after the span had begun
+    if ( sessionIdOpt
+         && smp::utils::TraceRecorder::IsEnabled()
+         && *sessionIdOpt == smp::utils::TraceRecorder::GetSessionId() )
+    {
+        smp::utils::TraceRecorder::GetInstance().End( "script" );
+    }
+}
+
 void JsFbProfiler::Print( const std::u8string& additionalMsg, bool printComponentInfo )
 {
     std::u8string msg;
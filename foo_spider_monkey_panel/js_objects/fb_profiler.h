@@ -4,6 +4,7 @@
 
 #include <optional>
 #include <string>
+#include <vector>
 
 class JSObject;
 struct JSContext;
@@ -38,6 +39,8 @@ public: // ctor
     static JSObject* ConstructorWithOpt( JSContext* cx, size_t optArgCount, const std::u8string& name );
 
 public:
+    void BeginSpan( const std::u8string& name );
+    void EndSpan();
     void Print( const std::u8string& additionalMsg = "", bool printComponentInfo = true );
     void PrintWithOpt( size_t optArgCount, const std::u8string& additionalMsg, bool printComponentInfo );
     void Reset();
@@ -52,6 +55,8 @@ private:
     JSContext* pJsCtx_ = nullptr;
     std::u8string name_;
     pfc::hires_timer timer_;
+    // trace session id, if span was recorded by TraceRecorder
+    std::vector<std::optional<uint32_t>> openSpans_;
 };
 
 } // namespace mozjs
@@ -0,0 +1,119 @@
+#include <stdafx.h>
+#include "fb_query.h"
+
+#include <js_engine/js_to_native_invoker.h>
+#include <js_objects/fb_metadb_handle.h>
+#include <js_objects/fb_metadb_handle_list.h>
+#include <js_utils/js_error_helper.h>
+#include <js_utils/js_object_helper.h>
+#include <utils/library_query.h>
+
+using namespace smp;
+
+namespace
+{
+
+using namespace mozjs;
+
+JSClassOps jsOps = {
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    JsFbQuery::FinalizeJsObject,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr
+};
+
+JSClass jsClass = {
+    "FbQuery",
+    DefaultClassFlags(),
+    &jsOps
+};
+
+MJS_DEFINE_JS_FN_FROM_NATIVE( Filter, JsFbQuery::Filter )
+MJS_DEFINE_JS_FN_FROM_NATIVE( GetLibraryItems, JsFbQuery::GetLibraryItems )
+MJS_DEFINE_JS_FN_FROM_NATIVE( Test, JsFbQuery::Test )
+
+const JSFunctionSpec jsFunctions[] = {
+    JS_FN( "Filter", Filter, 1, DefaultPropsFlags() ),
+    JS_FN( "GetLibraryItems", GetLibraryItems, 0, DefaultPropsFlags() ),
+    JS_FN( "Test", Test, 1, DefaultPropsFlags() ),
+    JS_FS_END
+};
+
+MJS_DEFINE_JS_FN_FROM_NATIVE( get_Expression, JsFbQuery::get_Expression )
+
+const JSPropertySpec jsProperties[] = {
+    JS_PSG( "Expression", get_Expression, DefaultPropsFlags() ),
+    JS_PS_END
+};
+
+} // namespace
+
+namespace mozjs
+{
+
+const JSClass JsFbQuery::JsClass = jsClass;
+const JSFunctionSpec* JsFbQuery::JsFunctions = jsFunctions;
+const JSPropertySpec* JsFbQuery::JsProperties = jsProperties;
+const JsPrototypeId JsFbQuery::PrototypeId = JsPrototypeId::FbQuery;
+
+JsFbQuery::JsFbQuery( JSContext* cx, std::shared_ptr<const smp::utils::LibraryQuery> pQuery )
+    : pJsCtx_( cx )
+    , pQuery_( pQuery )
+{
+}
+
+JsFbQuery::~JsFbQuery()
+{
+}
+
+std::unique_ptr<JsFbQuery>
+JsFbQuery::CreateNative( JSContext* cx, const std::u8string& expression )
+{
+    return std::unique_ptr<JsFbQuery>( new JsFbQuery( cx, smp::utils::LibraryQueryManager::GetInstance().GetQuery( expression ) ) );
+}
+
+size_t JsFbQuery::GetInternalSize( const std::u8string& /*expression*/ )
+{
+    return sizeof( smp::utils::LibraryQuery );
+}
+
+JSObject* JsFbQuery::Filter( JsFbMetadbHandleList* handles )
+{
+    SmpException::ExpectTrue( handles, "handles argument is null" );
+
+    metadb_handle_list items( handles->GetHandleList() );
+    pQuery_->Filter( items );
+
+    return JsFbMetadbHandleList::CreateJs( pJsCtx_, items );
+}
+
+JSObject* JsFbQuery::GetLibraryItems()
+{
+    if ( !pView_ )
+    {
+        pView_ = smp::utils::LibraryQueryManager::GetInstance().GetView( pQuery_->GetExpression() );
+    }
+
+    return JsFbMetadbHandleList::CreateJs( pJsCtx_, pView_->GetItems() );
+}
+
+bool JsFbQuery::Test( JsFbMetadbHandle* handle )
+{
+    SmpException::ExpectTrue( handle, "handle argument is null" );
+
+    return pQuery_->Test( handle->GetHandle() );
+}
+
+std::u8string JsFbQuery::get_Expression()
+{
+    return pQuery_->GetExpression();
+}
+
+} // namespace mozjs
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <js_objects/object_base.h>
+
+#include <memory>
+#include <string>
+
+class JSObject;
+struct JSContext;
+struct JSClass;
+
+namespace smp::utils
+{
+class LibraryQuery;
+class LibraryQueryView;
+} // namespace smp::utils
+
+namespace mozjs
+{
+
+class JsFbMetadbHandle;
+class JsFbMetadbHandleList;
+
+class JsFbQuery
+    : public JsObjectBase<JsFbQuery>
+{
+public:
+    static constexpr bool HasProto = true;
+    static constexpr bool HasGlobalProto = false;
+    static constexpr bool HasProxy = false;
+    static constexpr bool HasPostCreate = false;
+
+    static const JSClass JsClass;
+    static const JSFunctionSpec* JsFunctions;
+    static const JSPropertySpec* JsProperties;
+    static const JsPrototypeId PrototypeId;
+
+public:
+    ~JsFbQuery();
+
+    static std::unique_ptr<JsFbQuery> CreateNative( JSContext* cx, const std::u8string& expression );
+    static size_t GetInternalSize( const std::u8string& expression );
+
+public:
+    JSObject* Filter( JsFbMetadbHandleList* handles );
+    JSObject* GetLibraryItems();
+    bool Test( JsFbMetadbHandle* handle );
+
+public:
+    std::u8string get_Expression();
+
+private:
+    JsFbQuery( JSContext* cx, std::shared_ptr<const smp::utils::LibraryQuery> pQuery );
+
+private:
+    JSContext* pJsCtx_ = nullptr;
+    std::shared_ptr<const smp::utils::LibraryQuery> pQuery_;
+    /// @brief Created on first use, keeps the live view alive while this object exists
+    std::shared_ptr<smp::utils::LibraryQueryView> pView_;
+};
+
+} // namespace mozjs
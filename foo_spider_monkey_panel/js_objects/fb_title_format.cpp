@@ -7,6 +7,7 @@
 #include <js_utils/js_error_helper.h>
 #include <js_utils/js_object_helper.h>
 #include <utils/string_helpers.h>
+#include <utils/trace_recorder.h>
 
 using namespace smp;
 
@@ -96,6 +97,8 @@ JSObject* JsFbTitleFormat::Constructor( JSContext* cx, const std::u8string& expr
 
 pfc::string8_fast JsFbTitleFormat::Eval( bool force )
 {
+    SMP_TRACE_SCOPE( "titleformat", "FbTitleFormat.Eval" );
+
     auto pc = playback_control::get();
     metadb_handle_ptr handle;
     
@@ -129,6 +132,8 @@ pfc::string8_fast JsFbTitleFormat::EvalWithMetadb( JsFbMetadbHandle* handle )
 {
     SmpException::ExpectTrue( handle, "handle argument is null" );
 
+    SMP_TRACE_SCOPE( "titleformat", "FbTitleFormat.EvalWithMetadb" );
+
     pfc::string8_fast text;
     handle->GetHandle()->format_title( nullptr, text, titleFormatObject_, nullptr );
     return text;
@@ -138,6 +143,8 @@ JSObject* JsFbTitleFormat::EvalWithMetadbs( JsFbMetadbHandleList* handles )
 {
     SmpException::ExpectTrue( handles, "handles argument is null" );
 
+    SMP_TRACE_SCOPE( "titleformat", "FbTitleFormat.EvalWithMetadbs" );
+
     JS::RootedValue jsValue( pJsCtx_ );
     convert::to_js::ToArrayValue(
         pJsCtx_,
@@ -1,6 +1,7 @@
 #include <stdafx.h>
 #include "fb_utils.h"
 
+#include <js_engine/js_engine.h>
 #include <js_engine/js_to_native_invoker.h>
 #include <js_objects/fb_ui_selection_holder.h>
 #include <js_objects/main_menu_manager.h>
@@ -8,6 +9,7 @@
 #include <js_objects/fb_metadb_handle.h>
 #include <js_objects/fb_metadb_handle_list.h>
 #include <js_objects/fb_profiler.h>
+#include <js_objects/fb_query.h>
 #include <js_objects/fb_title_format.h>
 #include <js_objects/gdi_bitmap.h>
 #include <js_utils/js_error_helper.h>
@@ -15,8 +17,10 @@
 #include <js_utils/js_property_helper.h>
 #include <utils/art_helpers.h>
 #include <utils/delayed_executor.h>
+#include <utils/library_query.h>
 #include <utils/menu_helpers.h>
 #include <utils/string_helpers.h>
+#include <utils/trace_recorder.h>
 #include <com_objects/drop_source_impl.h>
 #include <stats.h>
 #include <message_blocking_scope.h>
@@ -59,6 +63,7 @@ MJS_DEFINE_JS_FN_FROM_NATIVE( CreateContextMenuManager, JsFbUtils::CreateContext
 MJS_DEFINE_JS_FN_FROM_NATIVE( CreateHandleList, JsFbUtils::CreateHandleList )
 MJS_DEFINE_JS_FN_FROM_NATIVE( CreateMainMenuManager, JsFbUtils::CreateMainMenuManager )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( CreateProfiler, JsFbUtils::CreateProfiler, JsFbUtils::CreateProfilerWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE( CreateQuery, JsFbUtils::CreateQuery )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( DoDragDrop, JsFbUtils::DoDragDrop, JsFbUtils::DoDragDropWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE( Exit, JsFbUtils::Exit )
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetClipboardContents, JsFbUtils::GetClipboardContents )
@@ -92,7 +97,11 @@ MJS_DEFINE_JS_FN_FROM_NATIVE( ShowConsole, JsFbUtils::ShowConsole )
 MJS_DEFINE_JS_FN_FROM_NATIVE( ShowLibrarySearchUI, JsFbUtils::ShowLibrarySearchUI )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( ShowPopupMessage, JsFbUtils::ShowPopupMessage, JsFbUtils::ShowPopupMessageWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE( ShowPreferences, JsFbUtils::ShowPreferences )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( StartSamplingProfiler, JsFbUtils::StartSamplingProfiler, JsFbUtils::StartSamplingProfilerWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE( StartTracing, JsFbUtils::StartTracing )
 MJS_DEFINE_JS_FN_FROM_NATIVE( Stop, JsFbUtils::Stop )
+MJS_DEFINE_JS_FN_FROM_NATIVE( StopSamplingProfiler, JsFbUtils::StopSamplingProfiler )
+MJS_DEFINE_JS_FN_FROM_NATIVE( StopTracing, JsFbUtils::StopTracing )
 MJS_DEFINE_JS_FN_FROM_NATIVE( TitleFormat, JsFbUtils::TitleFormat )
 MJS_DEFINE_JS_FN_FROM_NATIVE( VolumeDown, JsFbUtils::VolumeDown )
 MJS_DEFINE_JS_FN_FROM_NATIVE( VolumeMute, JsFbUtils::VolumeMute )
@@ -109,6 +118,7 @@ const JSFunctionSpec jsFunctions[] = {
     JS_FN( "CreateHandleList", CreateHandleList, 0, DefaultPropsFlags() ),
     JS_FN( "CreateMainMenuManager", CreateMainMenuManager, 0, DefaultPropsFlags() ),
     JS_FN( "CreateProfiler", CreateProfiler, 0, DefaultPropsFlags() ),
+    JS_FN( "CreateQuery", CreateQuery, 1, DefaultPropsFlags() ),
     JS_FN( "DoDragDrop", DoDragDrop, 3, DefaultPropsFlags() ),
     JS_FN( "Exit", Exit, 0, DefaultPropsFlags() ),
     JS_FN( "GetClipboardContents", GetClipboardContents, 0, DefaultPropsFlags() ),
@@ -142,7 +152,11 @@ const JSFunctionSpec jsFunctions[] = {
     JS_FN( "ShowLibrarySearchUI", ShowLibrarySearchUI, 1, DefaultPropsFlags() ),
     JS_FN( "ShowPopupMessage", ShowPopupMessage, 1, DefaultPropsFlags() ),
     JS_FN( "ShowPreferences", ShowPreferences, 0, DefaultPropsFlags() ),
+    JS_FN( "StartSamplingProfiler", StartSamplingProfiler, 0, DefaultPropsFlags() ),
+    JS_FN( "StartTracing", StartTracing, 0, DefaultPropsFlags() ),
     JS_FN( "Stop", Stop, 0, DefaultPropsFlags() ),
+    JS_FN( "StopSamplingProfiler", StopSamplingProfiler, 0, DefaultPropsFlags() ),
+    JS_FN( "StopTracing", StopTracing, 0, DefaultPropsFlags() ),
     JS_FN( "TitleFormat", TitleFormat, 1, DefaultPropsFlags() ),
     JS_FN( "VolumeDown", VolumeDown, 0, DefaultPropsFlags() ),
     JS_FN( "VolumeMute", VolumeMute, 0, DefaultPropsFlags() ),
@@ -293,13 +307,18 @@ JSObject* JsFbUtils::CreateProfilerWithOpt( size_t optArgCount, const std::u8str
     }
 }
 
+JSObject* JsFbUtils::CreateQuery( const std::u8string& expression )
+{
+    return JsFbQuery::CreateJs( pJsCtx_, expression );
+}
+
 uint32_t JsFbUtils::DoDragDrop( uint32_t hWindow, JsFbMetadbHandleList* handles, uint32_t okEffects, JS::HandleValue options )
 {
     SmpException::ExpectTrue( handles, "handles argument is null" );
     const metadb_handle_list& handleList = handles->GetHandleList();
     const size_t handleCount = handleList.get_count();
 
-    std::unique_ptr<Gdiplus::Bitmap> autoImage;
+    std::shared_ptr<Gdiplus::Bitmap> autoImage;
     auto parsedOptions = ParseDoDragDropOptions( options );
     if ( !parsedOptions.pCustomImage && parsedOptions.useAlbumArt && handleCount )
     {
@@ -493,25 +512,8 @@ JSObject* JsFbUtils::GetQueryItems( JsFbMetadbHandleList* handles, const std::u8
 {
     SmpException::ExpectTrue( handles, "handles argument is null" );
 
-    const metadb_handle_list& handles_ptr = handles->GetHandleList();
-    metadb_handle_list dst_list( handles_ptr );
-    search_filter_v2::ptr filter;
-
-    try
-    {
-        filter = search_filter_manager_v2::get()->create_ex( query.c_str(),
-                                                             fb2k::service_new<completion_notify_dummy>(),
-                                                             search_filter_manager_v2::KFlagSuppressNotify );
-    }
-    catch ( const pfc::exception& e )
-    {
-        throw SmpException( e.what() );
-    }
-
-    pfc::array_t<bool> mask;
-    mask.set_size( dst_list.get_count() );
-    filter->test_multi( dst_list, mask.get_ptr() );
-    dst_list.filter_mask( mask.get_ptr() );
+    metadb_handle_list dst_list( handles->GetHandleList() );
+    smp::utils::LibraryQueryManager::GetInstance().GetQuery( query )->Filter( dst_list );
 
     return JsFbMetadbHandleList::CreateJs( pJsCtx_, dst_list );
 }
@@ -751,11 +753,56 @@ void JsFbUtils::ShowPreferences()
     standard_commands::main_preferences();
 }
 
+void JsFbUtils::StartSamplingProfiler( uint32_t frequency )
+{
+    JsEngine::GetInstance().GetSamplingProfiler().Start( frequency );
+}
+
+void JsFbUtils::StartSamplingProfilerWithOpt( size_t optArgCount, uint32_t frequency )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return StartSamplingProfiler( frequency );
+    case 1:
+        return StartSamplingProfiler();
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+void JsFbUtils::StartTracing()
+{
+    smp::utils::TraceRecorder::GetInstance().Start();
+}
+
 void JsFbUtils::Stop()
 {
     standard_commands::main_stop();
 }
 
+JSObject* JsFbUtils::StopSamplingProfiler()
+{
+    const auto [collapsedPath, tracePath] = JsEngine::GetInstance().GetSamplingProfiler().Stop();
+    const std::array<std::u8string, 2> paths{ collapsedPath.u8string(), tracePath.u8string() };
+
+    JS::RootedValue jsValue( pJsCtx_ );
+    convert::to_js::ToArrayValue(
+        pJsCtx_,
+        paths,
+        []( const auto& vec, auto index ) {
+            return vec[index];
+        },
+        &jsValue );
+
+    return &jsValue.toObject();
+}
+
+std::u8string JsFbUtils::StopTracing()
+{
+    return smp::utils::TraceRecorder::GetInstance().Stop().u8string();
+}
+
 JSObject* JsFbUtils::TitleFormat( const std::u8string& expression )
 {
     return JsFbTitleFormat::Constructor( pJsCtx_, expression );
@@ -904,6 +951,7 @@ JsFbUtils::DoDragDropOptions JsFbUtils::ParseDoDragDropOptions( JS::HandleValue
         auto jsImage = GetOptionalProperty<JsGdiBitmap*>( pJsCtx_, jsOptions, "custom_image" ).value_or( nullptr );
         if ( jsImage )
         {
+            jsImage->EnsureNotLocked();
             parsedoptions.pCustomImage = jsImage->GdiBitmap();
         }
     }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <js_engine/js_sampling_profiler.h>
 #include <js_objects/object_base.h>
 
 #include <optional>
@@ -47,6 +48,7 @@ public:
     JSObject* CreateMainMenuManager();
     JSObject* CreateProfiler( const std::u8string& name = "" );
     JSObject* CreateProfilerWithOpt( size_t optArgCount, const std::u8string& name );
+    JSObject* CreateQuery( const std::u8string& expression );
     uint32_t DoDragDrop( uint32_t hWindow, JsFbMetadbHandleList* handles, uint32_t okEffects, JS::HandleValue options = JS::UndefinedHandleValue );
     uint32_t DoDragDropWithOpt( size_t optArgCount, uint32_t hWindow, JsFbMetadbHandleList* handles, uint32_t okEffects, JS::HandleValue options );
     void Exit();
@@ -86,7 +88,12 @@ public:
     void ShowPopupMessage( const std::u8string& msg, const std::u8string& title = "Spider Monkey Panel" );
     void ShowPopupMessageWithOpt( size_t optArgCount, const std::u8string& msg, const std::u8string& title );
     void ShowPreferences();
+    void StartSamplingProfiler( uint32_t frequency = JsSamplingProfiler::kDefaultFrequency );
+    void StartSamplingProfilerWithOpt( size_t optArgCount, uint32_t frequency );
+    void StartTracing();
     void Stop();
+    JSObject* StopSamplingProfiler();
+    std::u8string StopTracing();
     JSObject* TitleFormat( const std::u8string& expression );
     void VolumeDown();
     void VolumeMute();
@@ -1,12 +1,16 @@
 #include <stdafx.h>
 #include "gdi_bitmap.h"
 
+#include <js_engine/js_compartment_inner.h>
 #include <js_engine/js_to_native_invoker.h>
 #include <js_objects/gdi_graphics.h>
 #include <js_objects/gdi_raw_bitmap.h>
+#include <js_utils/js_bitmap_helpers.h>
 #include <utils/gdi_error_helpers.h>
 #include <utils/scope_helpers.h>
 #include <utils/image_helpers.h>
+#include <utils/image_resampler.h>
+#include <utils/pixel_kernels.h>
 #include <js_utils/js_error_helper.h>
 #include <js_utils/js_object_helper.h>
 
@@ -17,8 +21,10 @@
 
 #include <nonstd/span.hpp>
 
-#include <map>
 #include <cmath>
+#include <limits>
+#include <map>
+#include <vector>
 
 // range-v3 0.5.0 compatibility fix.
 // remove after updating to the latest version
@@ -42,41 +48,61 @@ JSClassOps jsOps = {
     nullptr,
     nullptr,
     nullptr,
-    nullptr
+    JsGdiBitmap::Trace
 };
 
 JSClass jsClass = {
     "GdiBitmap",
-    DefaultClassFlags(),
+    JSCLASS_HAS_PRIVATE | JSCLASS_FOREGROUND_FINALIZE, // traced JS::Heap members must be destroyed on the main thread
     &jsOps
 };
 
 MJS_DEFINE_JS_FN_FROM_NATIVE( ApplyAlpha, JsGdiBitmap::ApplyAlpha )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( ApplyEffect, JsGdiBitmap::ApplyEffect, JsGdiBitmap::ApplyEffectWithOpt, 2 )
 MJS_DEFINE_JS_FN_FROM_NATIVE( ApplyMask, JsGdiBitmap::ApplyMask )
+MJS_DEFINE_JS_FN_FROM_NATIVE( ApplyMaskAsync, JsGdiBitmap::ApplyMaskAsync )
 MJS_DEFINE_JS_FN_FROM_NATIVE( Clone, JsGdiBitmap::Clone )
 MJS_DEFINE_JS_FN_FROM_NATIVE( CreateRawBitmap, JsGdiBitmap::CreateRawBitmap )
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetColourScheme, JsGdiBitmap::GetColourScheme )
+MJS_DEFINE_JS_FN_FROM_NATIVE( GetColourSchemeAsync, JsGdiBitmap::GetColourSchemeAsync )
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetColourSchemeJSON, JsGdiBitmap::GetColourSchemeJSON )
+MJS_DEFINE_JS_FN_FROM_NATIVE( GetColourSchemeJSONAsync, JsGdiBitmap::GetColourSchemeJSONAsync )
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetGraphics, JsGdiBitmap::GetGraphics )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( LockPixels, JsGdiBitmap::LockPixels, JsGdiBitmap::LockPixelsWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE( ReleaseGraphics, JsGdiBitmap::ReleaseGraphics )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( Resize, JsGdiBitmap::Resize, JsGdiBitmap::ResizeWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( ResizeAsync, JsGdiBitmap::ResizeAsync, JsGdiBitmap::ResizeAsyncWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE( RotateFlip, JsGdiBitmap::RotateFlip )
+MJS_DEFINE_JS_FN_FROM_NATIVE( RotateFlipAsync, JsGdiBitmap::RotateFlipAsync )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( SaveAs, JsGdiBitmap::SaveAs, JsGdiBitmap::SaveAsWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( SaveAsAsync, JsGdiBitmap::SaveAsAsync, JsGdiBitmap::SaveAsAsyncWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE( StackBlur, JsGdiBitmap::StackBlur )
+MJS_DEFINE_JS_FN_FROM_NATIVE( StackBlurAsync, JsGdiBitmap::StackBlurAsync )
+MJS_DEFINE_JS_FN_FROM_NATIVE( UnlockPixels, JsGdiBitmap::UnlockPixels )
 
 const JSFunctionSpec jsFunctions[] = {
     JS_FN( "ApplyAlpha", ApplyAlpha, 1, DefaultPropsFlags() ),
+    JS_FN( "ApplyEffect", ApplyEffect, 1, DefaultPropsFlags() ),
     JS_FN( "ApplyMask", ApplyMask, 1, DefaultPropsFlags() ),
+    JS_FN( "ApplyMaskAsync", ApplyMaskAsync, 2, DefaultPropsFlags() ),
     JS_FN( "Clone", Clone, 4, DefaultPropsFlags() ),
     JS_FN( "CreateRawBitmap", CreateRawBitmap, 0, DefaultPropsFlags() ),
     JS_FN( "GetColourScheme", GetColourScheme, 1, DefaultPropsFlags() ),
+    JS_FN( "GetColourSchemeAsync", GetColourSchemeAsync, 2, DefaultPropsFlags() ),
     JS_FN( "GetColourSchemeJSON", GetColourSchemeJSON, 1, DefaultPropsFlags() ),
+    JS_FN( "GetColourSchemeJSONAsync", GetColourSchemeJSONAsync, 2, DefaultPropsFlags() ),
     JS_FN( "GetGraphics", GetGraphics, 0, DefaultPropsFlags() ),
+    JS_FN( "LockPixels", LockPixels, 0, DefaultPropsFlags() ),
     JS_FN( "ReleaseGraphics", ReleaseGraphics, 1, DefaultPropsFlags() ),
     JS_FN( "Resize", Resize, 2, DefaultPropsFlags() ),
+    JS_FN( "ResizeAsync", ResizeAsync, 3, DefaultPropsFlags() ),
     JS_FN( "RotateFlip", RotateFlip, 1, DefaultPropsFlags() ),
+    JS_FN( "RotateFlipAsync", RotateFlipAsync, 2, DefaultPropsFlags() ),
     JS_FN( "SaveAs", SaveAs, 1, DefaultPropsFlags() ),
+    JS_FN( "SaveAsAsync", SaveAsAsync, 2, DefaultPropsFlags() ),
     JS_FN( "StackBlur", StackBlur, 1, DefaultPropsFlags() ),
+    JS_FN( "StackBlurAsync", StackBlurAsync, 2, DefaultPropsFlags() ),
+    JS_FN( "UnlockPixels", UnlockPixels, 0, DefaultPropsFlags() ),
     JS_FS_END
 };
 
@@ -96,6 +122,56 @@ MJS_DEFINE_JS_FN_FROM_NATIVE( GdiBitmap_Constructor, JsGdiBitmap::Constructor )
 namespace
 {
 
+smp::pixels::PixelView GetPixelView( const Gdiplus::BitmapData& bmpData )
+{
+    assert( bmpData.Scan0 );
+    return smp::pixels::PixelView{ static_cast<uint8_t*>( bmpData.Scan0 ), bmpData.Width, bmpData.Height, bmpData.Stride };
+}
+
+/// @brief Interpolation modes that are handled by the native resampler instead of GdiPlus
+std::optional<smp::pixels::ResampleFilter> GetResampleFilter( uint32_t interpolationMode )
+{
+    switch ( interpolationMode )
+    {
+    case 8:
+        return smp::pixels::ResampleFilter::box;
+    case 9:
+        return smp::pixels::ResampleFilter::mitchell;
+    case 10:
+        return smp::pixels::ResampleFilter::lanczos3;
+    default:
+        return std::nullopt;
+    }
+}
+
+std::unique_ptr<Gdiplus::Bitmap> ResampleImage( Gdiplus::Bitmap& srcImg, uint32_t w, uint32_t h, smp::pixels::ResampleFilter filter )
+{
+    auto pBitmap = std::make_unique<Gdiplus::Bitmap>( w, h, PixelFormat32bppPARGB );
+    smp::error::CheckGdiPlusObject( pBitmap );
+
+    const Gdiplus::Rect srcRect{ 0, 0, static_cast<int>( srcImg.GetWidth() ), static_cast<int>( srcImg.GetHeight() ) };
+    Gdiplus::BitmapData srcBmpData = { 0 };
+    Gdiplus::Status gdiRet = srcImg.LockBits( &srcRect, Gdiplus::ImageLockModeRead, PixelFormat32bppPARGB, &srcBmpData );
+    smp::error::CheckGdi( gdiRet, "src::LockBits" );
+
+    utils::final_action autoSrcBits( [&srcImg, &srcBmpData] {
+        srcImg.UnlockBits( &srcBmpData );
+    } );
+
+    const Gdiplus::Rect dstRect{ 0, 0, static_cast<int>( w ), static_cast<int>( h ) };
+    Gdiplus::BitmapData dstBmpData = { 0 };
+    gdiRet = pBitmap->LockBits( &dstRect, Gdiplus::ImageLockModeWrite, PixelFormat32bppPARGB, &dstBmpData );
+    smp::error::CheckGdi( gdiRet, "dst::LockBits" );
+
+    utils::final_action autoDstBits( [&pBitmap, &dstBmpData] {
+        pBitmap->UnlockBits( &dstBmpData );
+    } );
+
+    smp::pixels::Resample( GetPixelView( srcBmpData ), GetPixelView( dstBmpData ), filter );
+
+    return pBitmap;
+}
+
 std::unique_ptr<Gdiplus::Bitmap> CreateDownsizedImage( Gdiplus::Bitmap& srcImg, uint32_t maxPixelCount )
 {
     const auto [imgWidth, imgHeight] = [&srcImg, maxPixelCount] {
@@ -113,6 +189,7 @@ std::unique_ptr<Gdiplus::Bitmap> CreateDownsizedImage( Gdiplus::Bitmap& srcImg,
         }
     }();
 
+    // GdiPlus is used instead of the native resampler, so that colour schemes stay the same as before
     auto pBitmap = std::make_unique<Gdiplus::Bitmap>( imgWidth, imgHeight, PixelFormat32bppPARGB );
     smp::error::CheckGdiPlusObject( pBitmap );
 
@@ -127,159 +204,68 @@ std::unique_ptr<Gdiplus::Bitmap> CreateDownsizedImage( Gdiplus::Bitmap& srcImg,
     return pBitmap;
 }
 
-} // namespace
-
-namespace mozjs
-{
-
-const JSClass JsGdiBitmap::JsClass = jsClass;
-const JSFunctionSpec* JsGdiBitmap::JsFunctions = jsFunctions;
-const JSPropertySpec* JsGdiBitmap::JsProperties = jsProperties;
-const JsPrototypeId JsGdiBitmap::PrototypeId = JsPrototypeId::GdiBitmap;
-const JSNative JsGdiBitmap::JsConstructor = ::GdiBitmap_Constructor;
-
-JsGdiBitmap::JsGdiBitmap( JSContext* cx, std::unique_ptr<Gdiplus::Bitmap> gdiBitmap )
-    : pJsCtx_( cx )
-    , pGdi_( std::move( gdiBitmap ) )
-{
-}
-
-JsGdiBitmap::~JsGdiBitmap()
-{
-}
-
-std::unique_ptr<JsGdiBitmap>
-JsGdiBitmap::CreateNative( JSContext* cx, std::unique_ptr<Gdiplus::Bitmap> gdiBitmap )
+/// @brief Locks bitmap pixels in 32bpp ARGB format for in-place modification
+template <typename Fn>
+void ModifyPixels( Gdiplus::Bitmap& bitmap, Fn&& fn )
 {
-    SmpException::ExpectTrue( !!gdiBitmap, "Internal error: Gdiplus::Bitmap object is null" );
+    const Gdiplus::Rect rect{ 0, 0, static_cast<int>( bitmap.GetWidth() ), static_cast<int>( bitmap.GetHeight() ) };
 
-    return std::unique_ptr<JsGdiBitmap>( new JsGdiBitmap( cx, std::move( gdiBitmap ) ) );
-}
+    Gdiplus::BitmapData bmpData = { 0 };
+    Gdiplus::Status gdiRet = bitmap.LockBits( &rect, Gdiplus::ImageLockModeRead | Gdiplus::ImageLockModeWrite, PixelFormat32bppARGB, &bmpData );
+    smp::error::CheckGdi( gdiRet, "LockBits" );
 
-size_t JsGdiBitmap::GetInternalSize( const std::unique_ptr<Gdiplus::Bitmap>& gdiBitmap )
-{
-    // TODO: GetInternalSize is called before CreateNative (that has argument validation), but gdiBitmap is not checked for null here.
-    return sizeof( Gdiplus::Bitmap ) + gdiBitmap->GetWidth() * gdiBitmap->GetHeight() * Gdiplus::GetPixelFormatSize( gdiBitmap->GetPixelFormat() ) / 8;
-}
+    utils::final_action autoBits( [&bitmap, &bmpData] {
+        bitmap.UnlockBits( &bmpData );
+    } );
 
-Gdiplus::Bitmap* JsGdiBitmap::GdiBitmap() const
-{
-    return pGdi_.get();
+    fn( GetPixelView( bmpData ) );
 }
 
-JSObject* JsGdiBitmap::Constructor( JSContext* cx, JsGdiBitmap* other )
+std::unique_ptr<Gdiplus::Bitmap> ResizeImage( Gdiplus::Bitmap& srcImg, uint32_t w, uint32_t h, uint32_t interpolationMode )
 {
-    SmpException::ExpectTrue( other, "Invalid argument type" );
-
-    auto pGdi = other->GdiBitmap();
-
-    std::unique_ptr<Gdiplus::Bitmap> img( pGdi->Clone( 0, 0, pGdi->GetWidth(), pGdi->GetHeight(), PixelFormat32bppPARGB ) );
-    smp::error::CheckGdiPlusObject( img, pGdi );
-
-    return JsGdiBitmap::CreateJs( cx, std::move( img ) );
-}
+    if ( const auto filter = GetResampleFilter( interpolationMode ); filter )
+    {
+        return ResampleImage( srcImg, w, h, *filter );
+    }
 
-std::uint32_t JsGdiBitmap::get_Height()
-{
-    return pGdi_->GetHeight();
-}
+    std::unique_ptr<Gdiplus::Bitmap> bitmap( new Gdiplus::Bitmap( w, h, PixelFormat32bppPARGB ) );
+    smp::error::CheckGdiPlusObject( bitmap );
 
-std::uint32_t JsGdiBitmap::get_Width()
-{
-    return pGdi_->GetWidth();
-}
+    Gdiplus::Graphics g( bitmap.get() );
+    Gdiplus::Status gdiRet = g.SetInterpolationMode( (Gdiplus::InterpolationMode)interpolationMode );
+    smp::error::CheckGdi( gdiRet, "SetInterpolationMode" );
 
-JSObject* JsGdiBitmap::ApplyAlpha( uint8_t alpha )
-{
-    const UINT width = pGdi_->GetWidth();
-    const UINT height = pGdi_->GetHeight();
-
-    std::unique_ptr<Gdiplus::Bitmap> out( new Gdiplus::Bitmap( width, height, PixelFormat32bppPARGB ) );
-    smp::error::CheckGdiPlusObject( out );
-
-    Gdiplus::ColorMatrix cm = { 0.0 };
-    cm.m[0][0] = cm.m[1][1] = cm.m[2][2] = cm.m[4][4] = 1.0;
-    cm.m[3][3] = static_cast<float>( alpha ) / 255;
-
-    Gdiplus::ImageAttributes ia;
-    Gdiplus::Status gdiRet = ia.SetColorMatrix( &cm );
-    smp::error::CheckGdi( gdiRet, "SetColorMatrix" );
-
-    Gdiplus::Graphics g( out.get() );
-    gdiRet = g.DrawImage( pGdi_.get(),
-                          Gdiplus::Rect{ 0, 0, static_cast<int>( width ), static_cast<int>( height ) },
-                          0,
-                          0,
-                          width,
-                          height,
-                          Gdiplus::UnitPixel,
-                          &ia );
+    gdiRet = g.DrawImage( &srcImg, 0, 0, w, h );
     smp::error::CheckGdi( gdiRet, "DrawImage" );
 
-    return JsGdiBitmap::CreateJs( pJsCtx_, std::move( out ) );
+    return bitmap;
 }
 
-void JsGdiBitmap::ApplyMask( JsGdiBitmap* mask )
+void ApplyImageMask( Gdiplus::Bitmap& bitmap, Gdiplus::Bitmap& mask )
 {
-    SmpException::ExpectTrue( mask, "mask argument is null" );
-
-    Gdiplus::Bitmap* pBitmapMask = mask->GdiBitmap();
-    assert( pBitmapMask );
-
-    SmpException::ExpectTrue( pBitmapMask->GetHeight() == pGdi_->GetHeight()
-                                  && pBitmapMask->GetWidth() == pGdi_->GetWidth(),
+    SmpException::ExpectTrue( mask.GetHeight() == bitmap.GetHeight()
+                                  && mask.GetWidth() == bitmap.GetWidth(),
                               "Mismatched dimensions" );
 
-    const Gdiplus::Rect rect{ 0, 0, static_cast<int>( pGdi_->GetWidth() ), static_cast<int>( pGdi_->GetHeight() ) };
+    const Gdiplus::Rect rect{ 0, 0, static_cast<int>( bitmap.GetWidth() ), static_cast<int>( bitmap.GetHeight() ) };
 
     Gdiplus::BitmapData maskBmpData = { 0 };
-    Gdiplus::Status gdiRet = pBitmapMask->LockBits( &rect, Gdiplus::ImageLockModeRead, PixelFormat32bppARGB, &maskBmpData );
+    Gdiplus::Status gdiRet = mask.LockBits( &rect, Gdiplus::ImageLockModeRead, PixelFormat32bppARGB, &maskBmpData );
     smp::error::CheckGdi( gdiRet, "mask::LockBits" );
 
-    utils::final_action autoMaskBits( [pBitmapMask, &maskBmpData] {
-        pBitmapMask->UnlockBits( &maskBmpData );
+    utils::final_action autoMaskBits( [&mask, &maskBmpData] {
+        mask.UnlockBits( &maskBmpData );
     } );
 
-    Gdiplus::BitmapData dstBmpData = { 0 };
-    gdiRet = pGdi_->LockBits( &rect, Gdiplus::ImageLockModeRead | Gdiplus::ImageLockModeWrite, PixelFormat32bppARGB, &dstBmpData );
-    smp::error::CheckGdi( gdiRet, "dst::LockBits" );
-
-    utils::final_action autoDstBits( [& pGdi = pGdi_, &dstBmpData] {
-        pGdi->UnlockBits( &dstBmpData );
+    ModifyPixels( bitmap, [&maskBmpData]( const auto& pixels ) {
+        smp::pixels::ApplyMask( pixels, GetPixelView( maskBmpData ) );
     } );
-
-    assert( maskBmpData.Scan0 );
-    const auto maskRange = ranges::make_subrange( reinterpret_cast<uint32_t*>( maskBmpData.Scan0 ),
-                                                  reinterpret_cast<uint32_t*>( maskBmpData.Scan0 ) + rect.Width * rect.Height );
-    for ( auto pMaskIt = maskRange.begin(), pDst = reinterpret_cast<uint32_t*>( dstBmpData.Scan0 ); pMaskIt != maskRange.end(); ++pMaskIt, ++pDst )
-    {
-        /// Method 1:
-        // alpha = (~*p_mask & 0xff) * (*p_dst >> 24) + 0x80;
-        // *p_dst = ((((alpha >> 8) + alpha) & 0xff00) << 16) | (*p_dst & 0xffffff);
-
-        /// Method 2
-        uint32_t alpha = ( ( ( ~*pMaskIt & 0xff ) * ( *pDst >> 24 ) ) << 16 ) & 0xff000000;
-        *pDst = alpha | ( *pDst & 0xffffff );
-    }
-}
-
-JSObject* JsGdiBitmap::Clone( float x, float y, float w, float h )
-{
-    std::unique_ptr<Gdiplus::Bitmap> img( pGdi_->Clone( x, y, w, h, PixelFormat32bppPARGB ) );
-    smp::error::CheckGdiPlusObject( img, pGdi_.get() );
-
-    return JsGdiBitmap::CreateJs( pJsCtx_, std::move( img ) );
-}
-
-JSObject* JsGdiBitmap::CreateRawBitmap()
-{
-    return JsGdiRawBitmap::CreateJs( pJsCtx_, pGdi_.get() );
 }
 
-JSObject* JsGdiBitmap::GetColourScheme( uint32_t count )
+std::vector<uint32_t> CalculateColourScheme( Gdiplus::Bitmap& bitmap, uint32_t count )
 {
     constexpr uint32_t kMaxPixelCount = 220 * 220;
-    auto pBitmap = CreateDownsizedImage( *pGdi_, kMaxPixelCount );
+    auto pBitmap = CreateDownsizedImage( bitmap, kMaxPixelCount );
     assert( pBitmap );
 
     const Gdiplus::Rect rect{ 0, 0, static_cast<int>( pBitmap->GetWidth() ), static_cast<int>( pBitmap->GetHeight() ) };
@@ -318,26 +304,24 @@ JSObject* JsGdiBitmap::GetColourScheme( uint32_t count )
                   } );
     sort_vec.resize( std::min( count, color_counters.size() ) );
 
-    JS::RootedValue jsValue( pJsCtx_ );
-    convert::to_js::ToArrayValue(
-        pJsCtx_,
-        sort_vec,
-        []( const auto& vec, auto index ) {
-            return vec[index].first;
-        },
-        &jsValue );
+    std::vector<uint32_t> colours;
+    colours.reserve( sort_vec.size() );
+    for ( const auto& elem: sort_vec )
+    {
+        colours.emplace_back( elem.first );
+    }
 
-    return &jsValue.toObject();
+    return colours;
 }
 
-std::u8string JsGdiBitmap::GetColourSchemeJSON( uint32_t count )
+std::u8string CalculateColourSchemeJson( Gdiplus::Bitmap& bitmap, uint32_t count )
 {
     using json = nlohmann::json;
     namespace kmeans = smp::utils::kmeans;
 
     // rescaled image will have max of ~48k pixels
     constexpr uint32_t kMaxPixelCount = 220 * 220;
-    auto pBitmap = CreateDownsizedImage( *pGdi_, kMaxPixelCount );
+    auto pBitmap = CreateDownsizedImage( bitmap, kMaxPixelCount );
     assert( pBitmap );
 
     const Gdiplus::Rect rect{ 0, 0, static_cast<int>( pBitmap->GetWidth() ), static_cast<int>( pBitmap->GetHeight() ) };
@@ -413,71 +397,7 @@ std::u8string JsGdiBitmap::GetColourSchemeJSON( uint32_t count )
     return j.dump();
 }
 
-JSObject* JsGdiBitmap::GetGraphics()
-{
-    std::unique_ptr<Gdiplus::Graphics> g( new Gdiplus::Graphics( pGdi_.get() ) );
-    smp::error::CheckGdiPlusObject( g );
-
-    JS::RootedObject jsObject( pJsCtx_, JsGdiGraphics::CreateJs( pJsCtx_ ) );
-
-    JsGdiGraphics* pNativeObject = GetInnerInstancePrivate<JsGdiGraphics>( pJsCtx_, jsObject );
-    SmpException::ExpectTrue( pNativeObject, "Internal error: failed to get JsGdiGraphics object" );
-
-    pNativeObject->SetGraphicsObject( g.release() );
-
-    return jsObject;
-}
-
-void JsGdiBitmap::ReleaseGraphics( JsGdiGraphics* graphics )
-{
-    if ( !graphics )
-    { // Not an error
-        return;
-    }
-
-    auto pGdiGraphics = graphics->GetGraphicsObject();
-    graphics->SetGraphicsObject( nullptr );
-    if ( pGdiGraphics )
-    {
-        delete pGdiGraphics;
-    }
-}
-
-JSObject* JsGdiBitmap::Resize( uint32_t w, uint32_t h, uint32_t interpolationMode )
-{
-    std::unique_ptr<Gdiplus::Bitmap> bitmap( new Gdiplus::Bitmap( w, h, PixelFormat32bppPARGB ) );
-    smp::error::CheckGdiPlusObject( bitmap );
-
-    Gdiplus::Graphics g( bitmap.get() );
-    Gdiplus::Status gdiRet = g.SetInterpolationMode( (Gdiplus::InterpolationMode)interpolationMode );
-    smp::error::CheckGdi( gdiRet, "SetInterpolationMode" );
-
-    gdiRet = g.DrawImage( pGdi_.get(), 0, 0, w, h );
-    smp::error::CheckGdi( gdiRet, "DrawImage" );
-
-    return JsGdiBitmap::CreateJs( pJsCtx_, std::move( bitmap ) );
-}
-
-JSObject* JsGdiBitmap::ResizeWithOpt( size_t optArgCount, uint32_t w, uint32_t h, uint32_t interpolationMode )
-{
-    switch ( optArgCount )
-    {
-    case 0:
-        return Resize( w, h, interpolationMode );
-    case 1:
-        return Resize( w, h );
-    default:
-        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
-    }
-}
-
-void JsGdiBitmap::RotateFlip( uint32_t mode )
-{
-    Gdiplus::Status gdiRet = pGdi_->RotateFlip( (Gdiplus::RotateFlipType)mode );
-    smp::error::CheckGdi( gdiRet, "RotateFlip" );
-}
-
-bool JsGdiBitmap::SaveAs( const std::wstring& path, const std::wstring& format )
+bool SaveImage( Gdiplus::Bitmap& bitmap, const std::wstring& path, const std::wstring& format )
 {
     const auto clsIdRet = [&format]() -> std::optional<CLSID> {
         UINT num = 0;
@@ -513,26 +433,720 @@ bool JsGdiBitmap::SaveAs( const std::wstring& path, const std::wstring& format )
         return false;
     }
 
-    Gdiplus::Status gdiRet = pGdi_->Save( path.c_str(), &( *clsIdRet ) );
+    Gdiplus::Status gdiRet = bitmap.Save( path.c_str(), &( *clsIdRet ) );
     return ( Gdiplus::Ok == gdiRet );
 }
 
-bool JsGdiBitmap::SaveAsWithOpt( size_t optArgCount, const std::wstring& path, const std::wstring& format /* ='image/png' */ )
+/// @brief Creates a private copy of the bitmap, so that it could be processed off main thread
+/// @details Source pixel format is retained: results must be the same as those of synchronous methods,
+///          which operate on the bitmap itself (e.g. `SaveAs` of 24bpp image must not add alpha channel).
+std::unique_ptr<Gdiplus::Bitmap> CreateSnapshot( Gdiplus::Bitmap& bitmap )
 {
-    switch ( optArgCount )
+    std::unique_ptr<Gdiplus::Bitmap> pSnapshot( bitmap.Clone( 0, 0, bitmap.GetWidth(), bitmap.GetHeight(), bitmap.GetPixelFormat() ) );
+    smp::error::CheckGdiPlusObject( pSnapshot, &bitmap );
+
+    return pSnapshot;
+}
+
+uint32_t GetPixelDataSize( uint32_t w, uint32_t h )
+{
+    return static_cast<uint32_t>( std::min<uint64_t>( static_cast<uint64_t>( w ) * h * 4, UINT32_MAX ) );
+}
+
+/// @brief Same as above, but for the actual pixel format of the bitmap
+uint32_t GetPixelDataSize( Gdiplus::Bitmap& bitmap )
+{
+    const uint64_t bitCount = static_cast<uint64_t>( bitmap.GetWidth() ) * bitmap.GetHeight() * Gdiplus::GetPixelFormatSize( bitmap.GetPixelFormat() );
+    return static_cast<uint32_t>( std::min<uint64_t>( bitCount / 8, UINT32_MAX ) );
+}
+
+/// @brief std::function requires copyable callable, but tasks own move-only snapshots
+template <typename F>
+mozjs::async_bitmap::Task MakeAsyncTask( F&& fn )
+{
+    return [pFn = std::make_shared<std::decay_t<F>>( std::forward<F>( fn ) )]() -> mozjs::async_bitmap::TaskResult {
+        return ( *pFn )();
+    };
+}
+
+} // namespace
+
+namespace mozjs
+{
+
+/// @brief Pixels of the bitmap that were locked via LockBits.
+/// @details Lock is also released on destruction, which might happen off main thread (on ArrayBuffer finalization),
+///          but in that case bitmap is not used by anything else already.
+class JsGdiBitmap::LockedPixels
+{
+public:
+    /// @throw smp::SmpException
+    LockedPixels( std::shared_ptr<Gdiplus::Bitmap> pBitmap, Gdiplus::PixelFormat pixelFormat );
+    ~LockedPixels();
+    LockedPixels( const LockedPixels& ) = delete;
+    LockedPixels& operator=( const LockedPixels& ) = delete;
+
+    /// @brief Releases the lock: pixels are written back to the bitmap (and converted, if needed)
+    /// @throw smp::SmpException
+    void Unlock();
+
+    uint8_t* GetData() const;
+    size_t GetSize() const;
+
+private:
+    std::shared_ptr<Gdiplus::Bitmap> pBitmap_; ///< null, when unlocked
+    Gdiplus::BitmapData bmpdata_{};
+    /// @brief Used only when rows of the bitmap are not contiguous in memory
+    std::vector<uint8_t> buffer_;
+};
+
+JsGdiBitmap::LockedPixels::LockedPixels( std::shared_ptr<Gdiplus::Bitmap> pBitmap, Gdiplus::PixelFormat pixelFormat )
+{
+    assert( pBitmap );
+
+    const auto w = pBitmap->GetWidth();
+    const auto h = pBitmap->GetHeight();
+    const auto rowSize = w * 4;
+    const Gdiplus::Rect rect{ 0, 0, static_cast<int>( w ), static_cast<int>( h ) };
+
+    Gdiplus::Status gdiRet = pBitmap->LockBits( &rect, Gdiplus::ImageLockModeRead | Gdiplus::ImageLockModeWrite, pixelFormat, &bmpdata_ );
+    smp::error::CheckGdi( gdiRet, "LockBits" );
+
+    if ( bmpdata_.Stride != static_cast<int>( rowSize ) )
+    { // e.g. bottom-up bitmap: lock into a separate buffer, since ArrayBuffer needs contiguous memory
+        pBitmap->UnlockBits( &bmpdata_ );
+
+        buffer_.resize( static_cast<size_t>( rowSize ) * h );
+
+        bmpdata_ = Gdiplus::BitmapData{};
+        bmpdata_.Width = w;
+        bmpdata_.Height = h;
+        bmpdata_.Stride = static_cast<int>( rowSize );
+        bmpdata_.PixelFormat = pixelFormat;
+        bmpdata_.Scan0 = buffer_.data();
+
+        gdiRet = pBitmap->LockBits( &rect, Gdiplus::ImageLockModeRead | Gdiplus::ImageLockModeWrite | Gdiplus::ImageLockModeUserInputBuf, pixelFormat, &bmpdata_ );
+        smp::error::CheckGdi( gdiRet, "LockBits" );
+    }
+
+    pBitmap_ = std::move( pBitmap );
+}
+
+JsGdiBitmap::LockedPixels::~LockedPixels()
+{
+    if ( pBitmap_ )
     {
-    case 0:
-        return SaveAs( path, format );
-    case 1:
-        return SaveAs( path );
-    default:
-        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+        pBitmap_->UnlockBits( &bmpdata_ );
     }
 }
 
-void JsGdiBitmap::StackBlur( uint32_t radius )
+void JsGdiBitmap::LockedPixels::Unlock()
 {
-    smp::utils::stack_blur_filter( *pGdi_, radius );
+    if ( !pBitmap_ )
+    {
+        return;
+    }
+
+    auto pBitmap = std::move( pBitmap_ );
+
+    Gdiplus::Status gdiRet = pBitmap->UnlockBits( &bmpdata_ );
+    smp::error::CheckGdi( gdiRet, "UnlockBits" );
+}
+
+uint8_t* JsGdiBitmap::LockedPixels::GetData() const
+{
+    return static_cast<uint8_t*>( bmpdata_.Scan0 );
+}
+
+size_t JsGdiBitmap::LockedPixels::GetSize() const
+{
+    return static_cast<size_t>( bmpdata_.Stride ) * bmpdata_.Height;
+}
+
+/// @brief Accounts pixels of the bitmap in the GC heap size of the panel.
+/// @details Shared by all GdiBitmap objects of the panel that share the same pixels,
+///          so that pixels are accounted once and for as long as any of those objects is alive.
+class JsGdiBitmap::PixelsCharge
+{
+public:
+    PixelsCharge( JSContext* cx, uint32_t size );
+    ~PixelsCharge();
+    PixelsCharge( const PixelsCharge& ) = delete;
+    PixelsCharge& operator=( const PixelsCharge& ) = delete;
+
+private:
+    JSCompartment* pJsCompartment_;
+    uint32_t size_;
+};
+
+JsGdiBitmap::PixelsCharge::PixelsCharge( JSContext* cx, uint32_t size )
+    : pJsCompartment_( js::GetContextCompartment( cx ) )
+    , size_( size )
+{
+    auto pNativeCompartment = static_cast<JsCompartmentInner*>( JS_GetCompartmentPrivate( pJsCompartment_ ) );
+    assert( pNativeCompartment );
+    pNativeCompartment->OnHeapAllocate( size_ );
+}
+
+JsGdiBitmap::PixelsCharge::~PixelsCharge()
+{ // released on finalization of the last owner: compartment is still alive, but its private data might be already destroyed
+    auto pNativeCompartment = static_cast<JsCompartmentInner*>( JS_GetCompartmentPrivate( pJsCompartment_ ) );
+    if ( pNativeCompartment )
+    {
+        pNativeCompartment->OnHeapDeallocate( size_ );
+    }
+}
+
+const JSClass JsGdiBitmap::JsClass = jsClass;
+const JSFunctionSpec* JsGdiBitmap::JsFunctions = jsFunctions;
+const JSPropertySpec* JsGdiBitmap::JsProperties = jsProperties;
+const JsPrototypeId JsGdiBitmap::PrototypeId = JsPrototypeId::GdiBitmap;
+const JSNative JsGdiBitmap::JsConstructor = ::GdiBitmap_Constructor;
+
+JsGdiBitmap::JsGdiBitmap( JSContext* cx, std::shared_ptr<Gdiplus::Bitmap> gdiBitmap, bool isExternal, std::shared_ptr<PixelsCharge> pPixelsCharge )
+    : pJsCtx_( cx )
+    , pGdi_( std::move( gdiBitmap ) )
+    , pPixelsCharge_( std::move( pPixelsCharge ) )
+    , isExternal_( isExternal )
+{
+    if ( !pPixelsCharge_ )
+    {
+        pPixelsCharge_ = std::make_shared<PixelsCharge>( cx, GetPixelDataSize( *pGdi_ ) );
+    }
+}
+
+JsGdiBitmap::~JsGdiBitmap()
+{
+}
+
+std::unique_ptr<JsGdiBitmap>
+JsGdiBitmap::CreateNative( JSContext* cx, std::unique_ptr<Gdiplus::Bitmap> gdiBitmap )
+{
+    SmpException::ExpectTrue( !!gdiBitmap, "Internal error: Gdiplus::Bitmap object is null" );
+
+    return std::unique_ptr<JsGdiBitmap>( new JsGdiBitmap( cx, std::move( gdiBitmap ), false ) );
+}
+
+std::unique_ptr<JsGdiBitmap>
+JsGdiBitmap::CreateNative( JSContext* cx, std::shared_ptr<Gdiplus::Bitmap> gdiBitmap, bool isExternal )
+{
+    SmpException::ExpectTrue( !!gdiBitmap, "Internal error: Gdiplus::Bitmap object is null" );
+
+    return std::unique_ptr<JsGdiBitmap>( new JsGdiBitmap( cx, std::move( gdiBitmap ), isExternal ) );
+}
+
+size_t JsGdiBitmap::GetInternalSize( const std::unique_ptr<Gdiplus::Bitmap>& /*gdiBitmap*/ )
+{
+    return sizeof( Gdiplus::Bitmap );
+}
+
+size_t JsGdiBitmap::GetInternalSize( const std::shared_ptr<Gdiplus::Bitmap>& /*gdiBitmap*/, bool /*isExternal*/ )
+{
+    return sizeof( Gdiplus::Bitmap );
+}
+
+void JsGdiBitmap::Trace( JSTracer* trc, JSObject* obj )
+{
+    auto pNative = static_cast<JsGdiBitmap*>( JS_GetPrivate( obj ) );
+    if ( !pNative || !pNative->jsLockedBuffer_ )
+    {
+        return;
+    }
+
+    JS::TraceEdge( trc, &pNative->jsLockedBuffer_, "GdiBitmap: locked pixels" );
+}
+
+Gdiplus::Bitmap* JsGdiBitmap::GdiBitmap() const
+{
+    return pGdi_.get();
+}
+
+void JsGdiBitmap::EnsureNotLocked() const
+{
+    SmpException::ExpectTrue( !pLockedPixels_, "Pixels are locked: UnlockPixels() must be called first" );
+}
+
+JSObject* JsGdiBitmap::Constructor( JSContext* cx, JsGdiBitmap* other )
+{
+    SmpException::ExpectTrue( other, "Invalid argument type" );
+    other->EnsureNotLocked();
+
+    if ( other->IsShareable() )
+    {
+        return other->CreateShared( cx );
+    }
+
+    auto pGdi = other->GdiBitmap();
+
+    std::unique_ptr<Gdiplus::Bitmap> img( pGdi->Clone( 0, 0, pGdi->GetWidth(), pGdi->GetHeight(), PixelFormat32bppPARGB ) );
+    smp::error::CheckGdiPlusObject( img, pGdi );
+
+    return JsGdiBitmap::CreateJs( cx, std::move( img ) );
+}
+
+std::uint32_t JsGdiBitmap::get_Height()
+{
+    return pGdi_->GetHeight();
+}
+
+std::uint32_t JsGdiBitmap::get_Width()
+{
+    return pGdi_->GetWidth();
+}
+
+JSObject* JsGdiBitmap::ApplyAlpha( uint8_t alpha )
+{
+    EnsureNotLocked();
+
+    std::unique_ptr<Gdiplus::Bitmap> out( pGdi_->Clone( 0, 0, pGdi_->GetWidth(), pGdi_->GetHeight(), PixelFormat32bppPARGB ) );
+    smp::error::CheckGdiPlusObject( out, pGdi_.get() );
+
+    ModifyPixels( *out, [alpha]( const auto& pixels ) {
+        smp::pixels::ScaleAlpha( pixels, alpha );
+    } );
+
+    return JsGdiBitmap::CreateJs( pJsCtx_, std::move( out ) );
+}
+
+void JsGdiBitmap::ApplyEffect( uint32_t effect, int32_t value, uint32_t colour )
+{
+    // validated before the bitmap is copied and locked
+    SmpException::ExpectTrue( effect <= 4, "Unknown effect: {}", effect );
+
+    EnsureUnique();
+    ModifyPixels( *pGdi_, [effect, value, colour]( const auto& pixels ) {
+        switch ( effect )
+        {
+        case 0:
+        { // greyscale
+            smp::pixels::Greyscale( pixels );
+            break;
+        }
+        case 1:
+        { // invert
+            smp::pixels::Invert( pixels );
+            break;
+        }
+        case 2:
+        { // brightness
+            smp::pixels::AdjustBrightness( pixels, std::clamp( value, -255, 255 ) );
+            break;
+        }
+        case 3:
+        { // contrast: value is in percents
+            smp::pixels::AdjustContrast( pixels, static_cast<uint32_t>( std::clamp( value, 0, 12799 ) ) * 256 / 100 );
+            break;
+        }
+        case 4:
+        { // tint: value is tint strength
+            smp::pixels::Tint( pixels, colour, static_cast<uint8_t>( std::clamp( value, 0, 255 ) ) );
+            break;
+        }
+        default:
+        {
+            assert( false );
+            break;
+        }
+        }
+    } );
+}
+
+void JsGdiBitmap::ApplyEffectWithOpt( size_t optArgCount, uint32_t effect, int32_t value, uint32_t colour )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return ApplyEffect( effect, value, colour );
+    case 1:
+        return ApplyEffect( effect, value );
+    case 2:
+        return ApplyEffect( effect );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+void JsGdiBitmap::ApplyMask( JsGdiBitmap* mask )
+{
+    SmpException::ExpectTrue( mask, "mask argument is null" );
+
+    mask->EnsureNotLocked();
+
+    Gdiplus::Bitmap* pBitmapMask = mask->GdiBitmap();
+    assert( pBitmapMask );
+
+    EnsureUnique();
+    ApplyImageMask( *pGdi_, *pBitmapMask );
+}
+
+JSObject* JsGdiBitmap::ApplyMaskAsync( uint32_t hWnd, JsGdiBitmap* mask )
+{
+    SmpException::ExpectTrue( mask, "mask argument is null" );
+
+    EnsureNotLocked();
+    mask->EnsureNotLocked();
+
+    Gdiplus::Bitmap* pBitmapMask = mask->GdiBitmap();
+    assert( pBitmapMask );
+
+    auto pSnapshot = CreateSnapshot( *pGdi_ );
+    auto pMaskSnapshot = CreateSnapshot( *pBitmapMask );
+    const auto inFlightBytes = 2 * GetPixelDataSize( pGdi_->GetWidth(), pGdi_->GetHeight() );
+
+    return mozjs::async_bitmap::GetBitmapPromise( pJsCtx_,
+                                                  reinterpret_cast<HWND>( hWnd ),
+                                                  inFlightBytes,
+                                                  MakeAsyncTask( [pSnapshot = std::move( pSnapshot ), pMaskSnapshot = std::move( pMaskSnapshot )]() mutable {
+                                                      ApplyImageMask( *pSnapshot, *pMaskSnapshot );
+                                                      return std::move( pSnapshot );
+                                                  } ) );
+}
+
+JSObject* JsGdiBitmap::Clone( float x, float y, float w, float h )
+{
+    EnsureNotLocked();
+
+    if ( IsShareable()
+         && x == 0 && y == 0
+         && w == static_cast<float>( pGdi_->GetWidth() ) && h == static_cast<float>( pGdi_->GetHeight() ) )
+    {
+        return CreateShared( pJsCtx_ );
+    }
+
+    std::unique_ptr<Gdiplus::Bitmap> img( pGdi_->Clone( x, y, w, h, PixelFormat32bppPARGB ) );
+    smp::error::CheckGdiPlusObject( img, pGdi_.get() );
+
+    return JsGdiBitmap::CreateJs( pJsCtx_, std::move( img ) );
+}
+
+JSObject* JsGdiBitmap::CreateRawBitmap()
+{
+    EnsureNotLocked();
+    return JsGdiRawBitmap::CreateJs( pJsCtx_, pGdi_.get() );
+}
+
+JSObject* JsGdiBitmap::GetColourScheme( uint32_t count )
+{
+    EnsureNotLocked();
+
+    const auto colours = CalculateColourScheme( *pGdi_, count );
+
+    JS::RootedValue jsValue( pJsCtx_ );
+    convert::to_js::ToArrayValue(
+        pJsCtx_,
+        colours,
+        []( const auto& vec, auto index ) {
+            return vec[index];
+        },
+        &jsValue );
+
+    return &jsValue.toObject();
+}
+
+JSObject* JsGdiBitmap::GetColourSchemeAsync( uint32_t hWnd, uint32_t count )
+{
+    EnsureNotLocked();
+
+    auto pSnapshot = CreateSnapshot( *pGdi_ );
+    const auto inFlightBytes = GetPixelDataSize( pGdi_->GetWidth(), pGdi_->GetHeight() );
+
+    return mozjs::async_bitmap::GetBitmapPromise( pJsCtx_,
+                                                  reinterpret_cast<HWND>( hWnd ),
+                                                  inFlightBytes,
+                                                  MakeAsyncTask( [pSnapshot = std::move( pSnapshot ), count] {
+                                                      return CalculateColourScheme( *pSnapshot, count );
+                                                  } ) );
+}
+
+std::u8string JsGdiBitmap::GetColourSchemeJSON( uint32_t count )
+{
+    EnsureNotLocked();
+    return CalculateColourSchemeJson( *pGdi_, count );
+}
+
+JSObject* JsGdiBitmap::GetColourSchemeJSONAsync( uint32_t hWnd, uint32_t count )
+{
+    EnsureNotLocked();
+
+    auto pSnapshot = CreateSnapshot( *pGdi_ );
+    const auto inFlightBytes = GetPixelDataSize( pGdi_->GetWidth(), pGdi_->GetHeight() );
+
+    return mozjs::async_bitmap::GetBitmapPromise( pJsCtx_,
+                                                  reinterpret_cast<HWND>( hWnd ),
+                                                  inFlightBytes,
+                                                  MakeAsyncTask( [pSnapshot = std::move( pSnapshot ), count] {
+                                                      return CalculateColourSchemeJson( *pSnapshot, count );
+                                                  } ) );
+}
+
+JSObject* JsGdiBitmap::GetGraphics()
+{
+    EnsureUnique();
+    hasGraphics_ = true;
+
+    std::unique_ptr<Gdiplus::Graphics> g( new Gdiplus::Graphics( pGdi_.get() ) );
+    smp::error::CheckGdiPlusObject( g );
+
+    JS::RootedObject jsObject( pJsCtx_, JsGdiGraphics::CreateJs( pJsCtx_ ) );
+
+    JsGdiGraphics* pNativeObject = GetInnerInstancePrivate<JsGdiGraphics>( pJsCtx_, jsObject );
+    SmpException::ExpectTrue( pNativeObject, "Internal error: failed to get JsGdiGraphics object" );
+
+    pNativeObject->SetGraphicsObject( g.release() );
+
+    return jsObject;
+}
+
+JSObject* JsGdiBitmap::LockPixels( bool premultiplied )
+{
+    SmpException::ExpectTrue( !pLockedPixels_, "Pixels are already locked" );
+
+    EnsureUnique();
+
+    auto pLockedPixels = std::make_shared<LockedPixels>( pGdi_, ( premultiplied ? PixelFormat32bppPARGB : PixelFormat32bppARGB ) );
+    const auto size = pLockedPixels->GetSize();
+    SmpException::ExpectTrue( size <= static_cast<size_t>( std::numeric_limits<int32_t>::max() ), "Image is too big: {} bytes", size );
+
+    // ArrayBuffer references the lock too: bitmap memory stays valid even if this object is finalized before the buffer
+    auto pBufferRef = std::make_unique<std::shared_ptr<LockedPixels>>( pLockedPixels );
+    JS::RootedObject jsBuffer( pJsCtx_, JS_NewExternalArrayBuffer( pJsCtx_, size, pLockedPixels->GetData(), FreeLockedPixels, pBufferRef.get() ) );
+    JsException::ExpectTrue( jsBuffer );
+    // ownership was transferred only on success
+    (void)pBufferRef.release();
+
+    JS::RootedObject jsArray( pJsCtx_, JS_NewUint8ClampedArrayWithBuffer( pJsCtx_, jsBuffer, 0, static_cast<int32_t>( size ) ) );
+    if ( !jsArray )
+    { // buffer is not reachable from JS, so it's safe to release the memory before it is finalized
+        pLockedPixels->Unlock();
+        throw JsException();
+    }
+
+    pLockedPixels_ = std::move( pLockedPixels );
+    jsLockedBuffer_ = jsBuffer;
+
+    return jsArray;
+}
+
+JSObject* JsGdiBitmap::LockPixelsWithOpt( size_t optArgCount, bool premultiplied )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return LockPixels( premultiplied );
+    case 1:
+        return LockPixels();
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+void JsGdiBitmap::ReleaseGraphics( JsGdiGraphics* graphics )
+{
+    if ( !graphics )
+    { // Not an error
+        return;
+    }
+
+    auto pGdiGraphics = graphics->GetGraphicsObject();
+    graphics->SetGraphicsObject( nullptr );
+    if ( pGdiGraphics )
+    {
+        delete pGdiGraphics;
+    }
+}
+
+JSObject* JsGdiBitmap::Resize( uint32_t w, uint32_t h, uint32_t interpolationMode )
+{
+    EnsureNotLocked();
+    return JsGdiBitmap::CreateJs( pJsCtx_, ResizeImage( *pGdi_, w, h, interpolationMode ) );
+}
+
+JSObject* JsGdiBitmap::ResizeWithOpt( size_t optArgCount, uint32_t w, uint32_t h, uint32_t interpolationMode )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return Resize( w, h, interpolationMode );
+    case 1:
+        return Resize( w, h );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+JSObject* JsGdiBitmap::ResizeAsync( uint32_t hWnd, uint32_t w, uint32_t h, uint32_t interpolationMode )
+{
+    EnsureNotLocked();
+
+    auto pSnapshot = CreateSnapshot( *pGdi_ );
+    const auto inFlightBytes = GetPixelDataSize( pGdi_->GetWidth(), pGdi_->GetHeight() ) + GetPixelDataSize( w, h );
+
+    return mozjs::async_bitmap::GetBitmapPromise( pJsCtx_,
+                                                  reinterpret_cast<HWND>( hWnd ),
+                                                  inFlightBytes,
+                                                  MakeAsyncTask( [pSnapshot = std::move( pSnapshot ), w, h, interpolationMode] {
+                                                      return ResizeImage( *pSnapshot, w, h, interpolationMode );
+                                                  } ) );
+}
+
+JSObject* JsGdiBitmap::ResizeAsyncWithOpt( size_t optArgCount, uint32_t hWnd, uint32_t w, uint32_t h, uint32_t interpolationMode )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return ResizeAsync( hWnd, w, h, interpolationMode );
+    case 1:
+        return ResizeAsync( hWnd, w, h );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+void JsGdiBitmap::RotateFlip( uint32_t mode )
+{
+    EnsureUnique();
+
+    Gdiplus::Status gdiRet = pGdi_->RotateFlip( (Gdiplus::RotateFlipType)mode );
+    smp::error::CheckGdi( gdiRet, "RotateFlip" );
+}
+
+JSObject* JsGdiBitmap::RotateFlipAsync( uint32_t hWnd, uint32_t mode )
+{
+    EnsureNotLocked();
+
+    auto pSnapshot = CreateSnapshot( *pGdi_ );
+    const auto inFlightBytes = GetPixelDataSize( pGdi_->GetWidth(), pGdi_->GetHeight() );
+
+    return mozjs::async_bitmap::GetBitmapPromise( pJsCtx_,
+                                                  reinterpret_cast<HWND>( hWnd ),
+                                                  inFlightBytes,
+                                                  MakeAsyncTask( [pSnapshot = std::move( pSnapshot ), mode]() mutable {
+                                                      Gdiplus::Status gdiRet = pSnapshot->RotateFlip( (Gdiplus::RotateFlipType)mode );
+                                                      smp::error::CheckGdi( gdiRet, "RotateFlip" );
+
+                                                      return std::move( pSnapshot );
+                                                  } ) );
+}
+
+bool JsGdiBitmap::SaveAs( const std::wstring& path, const std::wstring& format )
+{
+    EnsureNotLocked();
+    return SaveImage( *pGdi_, path, format );
+}
+
+bool JsGdiBitmap::SaveAsWithOpt( size_t optArgCount, const std::wstring& path, const std::wstring& format /* ='image/png' */ )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return SaveAs( path, format );
+    case 1:
+        return SaveAs( path );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+JSObject* JsGdiBitmap::SaveAsAsync( uint32_t hWnd, const std::wstring& path, const std::wstring& format )
+{
+    EnsureNotLocked();
+
+    auto pSnapshot = CreateSnapshot( *pGdi_ );
+    const auto inFlightBytes = GetPixelDataSize( pGdi_->GetWidth(), pGdi_->GetHeight() );
+
+    return mozjs::async_bitmap::GetBitmapPromise( pJsCtx_,
+                                                  reinterpret_cast<HWND>( hWnd ),
+                                                  inFlightBytes,
+                                                  MakeAsyncTask( [pSnapshot = std::move( pSnapshot ), path, format] {
+                                                      return SaveImage( *pSnapshot, path, format );
+                                                  } ) );
+}
+
+JSObject* JsGdiBitmap::SaveAsAsyncWithOpt( size_t optArgCount, uint32_t hWnd, const std::wstring& path, const std::wstring& format )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return SaveAsAsync( hWnd, path, format );
+    case 1:
+        return SaveAsAsync( hWnd, path );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+void JsGdiBitmap::StackBlur( uint32_t radius )
+{
+    EnsureUnique();
+    smp::utils::stack_blur_filter( *pGdi_, radius );
+}
+
+JSObject* JsGdiBitmap::StackBlurAsync( uint32_t hWnd, uint32_t radius )
+{
+    EnsureNotLocked();
+
+    auto pSnapshot = CreateSnapshot( *pGdi_ );
+    const auto inFlightBytes = GetPixelDataSize( pGdi_->GetWidth(), pGdi_->GetHeight() );
+
+    return mozjs::async_bitmap::GetBitmapPromise( pJsCtx_,
+                                                  reinterpret_cast<HWND>( hWnd ),
+                                                  inFlightBytes,
+                                                  MakeAsyncTask( [pSnapshot = std::move( pSnapshot ), radius]() mutable {
+                                                      smp::utils::stack_blur_filter( *pSnapshot, radius );
+                                                      return std::move( pSnapshot );
+                                                  } ) );
+}
+
+void JsGdiBitmap::UnlockPixels()
+{
+    if ( !pLockedPixels_ )
+    { // Not an error
+        return;
+    }
+
+    JS::RootedObject jsBuffer( pJsCtx_, jsLockedBuffer_ );
+    jsLockedBuffer_ = nullptr;
+    auto pLockedPixels = std::move( pLockedPixels_ );
+
+    // detach first, so that script can't access the memory after unlock
+    if ( !JS_DetachArrayBuffer( pJsCtx_, jsBuffer ) )
+    {
+        throw JsException();
+    }
+
+    pLockedPixels->Unlock();
+}
+
+void JsGdiBitmap::EnsureUnique()
+{
+    EnsureNotLocked();
+
+    if ( !isExternal_ && pGdi_.use_count() == 1 )
+    {
+        return;
+    }
+
+    std::unique_ptr<Gdiplus::Bitmap> img( pGdi_->Clone( 0, 0, pGdi_->GetWidth(), pGdi_->GetHeight(), pGdi_->GetPixelFormat() ) );
+    smp::error::CheckGdiPlusObject( img, pGdi_.get() );
+
+    pPixelsCharge_ = std::make_shared<PixelsCharge>( pJsCtx_, GetPixelDataSize( *img ) );
+    pGdi_ = std::move( img );
+    isExternal_ = false;
+}
+
+bool JsGdiBitmap::IsShareable() const
+{ // other pixel formats are converted on copy, so they can't be shared
+    return ( !hasGraphics_ && !pLockedPixels_ && pGdi_->GetPixelFormat() == PixelFormat32bppPARGB );
+}
+
+JSObject* JsGdiBitmap::CreateShared( JSContext* cx )
+{
+    return JsGdiBitmap::CreateJsFromNative( cx, std::unique_ptr<JsGdiBitmap>( new JsGdiBitmap( cx, pGdi_, isExternal_, pPixelsCharge_ ) ) );
+}
+
+void JsGdiBitmap::FreeLockedPixels( void* /*pContents*/, void* pUserData )
+{
+    delete static_cast<std::shared_ptr<LockedPixels>*>( pUserData );
 }
 
 } // namespace mozjs
@@ -38,41 +38,98 @@ public:
     ~JsGdiBitmap();
 
     static std::unique_ptr<JsGdiBitmap> CreateNative( JSContext* cx, std::unique_ptr<Gdiplus::Bitmap> gdiBitmap );
+    /// @brief Creates an object that shares pixels with other owners of `gdiBitmap`.
+    /// @details Shared pixels are copied on the first modification.
+    /// @param isExternal Bitmap might be referenced outside of GdiBitmap objects (e.g. by other threads)
+    static std::unique_ptr<JsGdiBitmap> CreateNative( JSContext* cx, std::shared_ptr<Gdiplus::Bitmap> gdiBitmap, bool isExternal = true );
+    /// @details Pixels are accounted separately, see PixelsCharge
     static size_t GetInternalSize( const std::unique_ptr<Gdiplus::Bitmap>& gdiBitmap );
+    /// @details Pixels are accounted separately, see PixelsCharge
+    static size_t GetInternalSize( const std::shared_ptr<Gdiplus::Bitmap>& gdiBitmap, bool isExternal = true );
+
+    static void Trace( JSTracer* trc, JSObject* obj );
 
 public:
     Gdiplus::Bitmap* GdiBitmap() const;
+    /// @brief Must be called before any use of the bitmap: GdiPlus can't access pixels while they are locked.
+    /// @throw smp::SmpException
+    void EnsureNotLocked() const;
 
 public: // ctor
     static JSObject* Constructor( JSContext* cx, JsGdiBitmap* other );
 
 public: //methods
     JSObject* ApplyAlpha( uint8_t alpha );
+    void ApplyEffect( uint32_t effect, int32_t value = 0, uint32_t colour = 0 );
+    void ApplyEffectWithOpt( size_t optArgCount, uint32_t effect, int32_t value, uint32_t colour );
     void ApplyMask( JsGdiBitmap* mask );
+    JSObject* ApplyMaskAsync( uint32_t hWnd, JsGdiBitmap* mask );
     JSObject* Clone( float x, float y, float w, float h );
     JSObject* CreateRawBitmap();
     JSObject* GetColourScheme( uint32_t count );
+    JSObject* GetColourSchemeAsync( uint32_t hWnd, uint32_t count );
     std::u8string GetColourSchemeJSON( uint32_t count );
+    JSObject* GetColourSchemeJSONAsync( uint32_t hWnd, uint32_t count );
     JSObject* GetGraphics();
+    JSObject* LockPixels( bool premultiplied = true );
+    JSObject* LockPixelsWithOpt( size_t optArgCount, bool premultiplied );
     void ReleaseGraphics( JsGdiGraphics* graphics );
     JSObject* Resize( uint32_t w, uint32_t h, uint32_t interpolationMode = 0 );
     JSObject* ResizeWithOpt( size_t optArgCount, uint32_t w, uint32_t h, uint32_t interpolationMode );
+    JSObject* ResizeAsync( uint32_t hWnd, uint32_t w, uint32_t h, uint32_t interpolationMode = 0 );
+    JSObject* ResizeAsyncWithOpt( size_t optArgCount, uint32_t hWnd, uint32_t w, uint32_t h, uint32_t interpolationMode );
     void RotateFlip( uint32_t mode );
+    JSObject* RotateFlipAsync( uint32_t hWnd, uint32_t mode );
     bool SaveAs( const std::wstring& path, const std::wstring& format = L"image/png" );
     bool SaveAsWithOpt( size_t optArgCount, const std::wstring& path, const std::wstring& format );
+    JSObject* SaveAsAsync( uint32_t hWnd, const std::wstring& path, const std::wstring& format = L"image/png" );
+    JSObject* SaveAsAsyncWithOpt( size_t optArgCount, uint32_t hWnd, const std::wstring& path, const std::wstring& format );
     void StackBlur( uint32_t radius );
+    JSObject* StackBlurAsync( uint32_t hWnd, uint32_t radius );
+    void UnlockPixels();
 
 public: // props
     std::uint32_t get_Height();
     std::uint32_t get_Width();
 
 private:
-    JsGdiBitmap( JSContext* cx, std::unique_ptr<Gdiplus::Bitmap> gdiBitmap );
+    class LockedPixels;
+    class PixelsCharge;
+
+private:
+    /// @param pPixelsCharge Charge of the object that shares pixels with this one, a new one is created if null
+    JsGdiBitmap( JSContext* cx, std::shared_ptr<Gdiplus::Bitmap> gdiBitmap, bool isExternal, std::shared_ptr<PixelsCharge> pPixelsCharge = nullptr );
+
+    /// @brief Releases the lock held by ArrayBuffer, see JS::BufferContentsFreeFunc
+    static void FreeLockedPixels( void* pContents, void* pUserData );
+
+    /// @brief Detaches pixels from other owners: must be called before any modification of the bitmap.
+    /// @throw smp::SmpException
+    void EnsureUnique();
+    /// @return true, if pixels can be shared with other GdiBitmap objects instead of being copied
+    bool IsShareable() const;
+    /// @brief Creates an object that shares pixels (and their charge) with this one
+    /// @throw smp::SmpException
+    /// @throw smp::JsException
+    JSObject* CreateShared( JSContext* cx );
 
 private:
     JSContext* pJsCtx_ = nullptr;
-    ;
-    std::unique_ptr<Gdiplus::Bitmap> pGdi_;
+
+    std::shared_ptr<Gdiplus::Bitmap> pGdi_;
+    /// @brief Shared by all objects of the panel that share `pGdi_`
+    std::shared_ptr<PixelsCharge> pPixelsCharge_;
+    /// @brief Bitmap might be referenced outside of GdiBitmap objects,
+    ///        so its use count can't be used to check the ownership
+    bool isExternal_ = false;
+    /// @brief Bitmap has been exposed via GetGraphics(),
+    ///        hence it might be modified at any time and must not be shared
+    bool hasGraphics_ = false;
+
+    /// @brief Pixels that are exposed to JS via LockPixels()
+    std::shared_ptr<LockedPixels> pLockedPixels_;
+    /// @brief ArrayBuffer that references locked pixels: detached on UnlockPixels()
+    JS::Heap<JSObject*> jsLockedBuffer_;
 };
 
 } // namespace mozjs
@@ -0,0 +1,551 @@
+#include <stdafx.h>
+#include "gdi_draw_list.h"
+
+#include <js_engine/js_to_native_invoker.h>
+#include <js_objects/gdi_bitmap.h>
+#include <js_objects/gdi_font.h>
+#include <js_objects/gdi_graphics.h>
+#include <js_utils/js_error_helper.h>
+#include <js_utils/js_object_helper.h>
+#include <utils/gdi_error_helpers.h>
+
+using namespace smp;
+
+namespace
+{
+
+using namespace mozjs;
+
+JSClassOps jsOps = {
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    JsGdiDrawList::FinalizeJsObject,
+    nullptr,
+    nullptr,
+    nullptr,
+    JsGdiDrawList::Trace
+};
+
+JSClass jsClass = {
+    "GdiDrawList",
+    JSCLASS_HAS_PRIVATE | JSCLASS_FOREGROUND_FINALIZE, // traced JS::Heap members must be destroyed on the main thread
+    &jsOps
+};
+
+MJS_DEFINE_JS_FN_FROM_NATIVE( Clear, JsGdiDrawList::Clear )
+MJS_DEFINE_JS_FN_FROM_NATIVE( DrawEllipse, JsGdiDrawList::DrawEllipse )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( DrawImage, JsGdiDrawList::DrawImage, JsGdiDrawList::DrawImageWithOpt, 2 )
+MJS_DEFINE_JS_FN_FROM_NATIVE( DrawLine, JsGdiDrawList::DrawLine )
+MJS_DEFINE_JS_FN_FROM_NATIVE( DrawRect, JsGdiDrawList::DrawRect )
+MJS_DEFINE_JS_FN_FROM_NATIVE( DrawRoundRect, JsGdiDrawList::DrawRoundRect )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( DrawString, JsGdiDrawList::DrawString, JsGdiDrawList::DrawStringWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE( FillEllipse, JsGdiDrawList::FillEllipse )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( FillGradRect, JsGdiDrawList::FillGradRect, JsGdiDrawList::FillGradRectWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE( FillRoundRect, JsGdiDrawList::FillRoundRect )
+MJS_DEFINE_JS_FN_FROM_NATIVE( FillSolidRect, JsGdiDrawList::FillSolidRect )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( SetInterpolationMode, JsGdiDrawList::SetInterpolationMode, JsGdiDrawList::SetInterpolationModeWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( SetSmoothingMode, JsGdiDrawList::SetSmoothingMode, JsGdiDrawList::SetSmoothingModeWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( SetTextRenderingHint, JsGdiDrawList::SetTextRenderingHint, JsGdiDrawList::SetTextRenderingHintWithOpt, 1 )
+
+const JSFunctionSpec jsFunctions[] = {
+    JS_FN( "Clear", Clear, 0, DefaultPropsFlags() ),
+    JS_FN( "DrawEllipse", DrawEllipse, 6, DefaultPropsFlags() ),
+    JS_FN( "DrawImage", DrawImage, 9, DefaultPropsFlags() ),
+    JS_FN( "DrawLine", DrawLine, 6, DefaultPropsFlags() ),
+    JS_FN( "DrawRect", DrawRect, 6, DefaultPropsFlags() ),
+    JS_FN( "DrawRoundRect", DrawRoundRect, 8, DefaultPropsFlags() ),
+    JS_FN( "DrawString", DrawString, 7, DefaultPropsFlags() ),
+    JS_FN( "FillEllipse", FillEllipse, 5, DefaultPropsFlags() ),
+    JS_FN( "FillGradRect", FillGradRect, 7, DefaultPropsFlags() ),
+    JS_FN( "FillRoundRect", FillRoundRect, 7, DefaultPropsFlags() ),
+    JS_FN( "FillSolidRect", FillSolidRect, 5, DefaultPropsFlags() ),
+    JS_FN( "SetInterpolationMode", SetInterpolationMode, 0, DefaultPropsFlags() ),
+    JS_FN( "SetSmoothingMode", SetSmoothingMode, 0, DefaultPropsFlags() ),
+    JS_FN( "SetTextRenderingHint", SetTextRenderingHint, 0, DefaultPropsFlags() ),
+    JS_FS_END
+};
+
+MJS_DEFINE_JS_FN_FROM_NATIVE( get_Count, JsGdiDrawList::get_Count )
+
+const JSPropertySpec jsProperties[] = {
+    JS_PSG( "Count", get_Count, DefaultPropsFlags() ),
+    JS_PS_END
+};
+
+} // namespace
+
+namespace mozjs
+{
+
+const JSClass JsGdiDrawList::JsClass = jsClass;
+const JSFunctionSpec* JsGdiDrawList::JsFunctions = jsFunctions;
+const JSPropertySpec* JsGdiDrawList::JsProperties = jsProperties;
+const JsPrototypeId JsGdiDrawList::PrototypeId = JsPrototypeId::GdiDrawList;
+
+JsGdiDrawList::JsGdiDrawList( JSContext* cx )
+    : pJsCtx_( cx )
+{
+}
+
+JsGdiDrawList::~JsGdiDrawList()
+{
+}
+
+std::unique_ptr<JsGdiDrawList>
+JsGdiDrawList::CreateNative( JSContext* cx )
+{
+    return std::unique_ptr<JsGdiDrawList>( new JsGdiDrawList( cx ) );
+}
+
+size_t JsGdiDrawList::GetInternalSize()
+{ // list is empty on creation: the size is updated as commands are recorded, see AddCommand()
+    return 0;
+}
+
+void JsGdiDrawList::Trace( JSTracer* trc, JSObject* obj )
+{
+    auto pNative = static_cast<JsGdiDrawList*>( JS_GetPrivate( obj ) );
+    if ( !pNative )
+    {
+        return;
+    }
+
+    for ( auto& jsResource: pNative->jsResources_ )
+    {
+        JS::TraceEdge( trc, &jsResource, "GdiDrawList: resource" );
+    }
+}
+
+void JsGdiDrawList::Execute( Gdiplus::Graphics& graphics )
+{
+    Gdiplus::Status gdiRet = Gdiplus::Ok;
+    for ( const auto& command: commands_ )
+    {
+        switch ( command.type )
+        {
+        case CommandType::DrawEllipse:
+        {
+            gdiRet = graphics.DrawEllipse( pens_[command.styleIdx].get(), command.rect );
+            smp::error::CheckGdi( gdiRet, "DrawEllipse" );
+            break;
+        }
+        case CommandType::DrawImage:
+        {
+            // pixels might have been locked after the command was recorded
+            images_[command.dataIdx]->EnsureNotLocked();
+
+            Gdiplus::Bitmap* img = images_[command.dataIdx]->GdiBitmap();
+            assert( img );
+
+            JsGdiGraphics::DrawImageImpl( graphics, *img, command.rect, command.srcRect, command.angle, static_cast<uint8_t>( command.value ) );
+            break;
+        }
+        case CommandType::DrawLine:
+        {
+            const auto& rect = command.rect;
+            gdiRet = graphics.DrawLine( pens_[command.styleIdx].get(), rect.X, rect.Y, rect.Width, rect.Height );
+            smp::error::CheckGdi( gdiRet, "DrawLine" );
+            break;
+        }
+        case CommandType::DrawPath:
+        {
+            gdiRet = graphics.DrawPath( pens_[command.styleIdx].get(), paths_[command.dataIdx].get() );
+            smp::error::CheckGdi( gdiRet, "DrawPath" );
+            break;
+        }
+        case CommandType::DrawRect:
+        {
+            const auto& rect = command.rect;
+            gdiRet = graphics.DrawRectangle( pens_[command.styleIdx].get(), rect.X, rect.Y, rect.Width, rect.Height );
+            smp::error::CheckGdi( gdiRet, "DrawRectangle" );
+            break;
+        }
+        case CommandType::DrawString:
+        {
+            Gdiplus::Font* pGdiFont = fonts_[command.fontIdx]->GdiFont();
+            SmpException::ExpectTrue( pGdiFont, "Internal error: GdiFont is null" );
+
+            gdiRet = graphics.DrawString( texts_[command.dataIdx].c_str(), -1, pGdiFont, command.rect, stringFormats_[command.formatIdx].get(), brushes_[command.styleIdx].get() );
+            smp::error::CheckGdi( gdiRet, "DrawString" );
+            break;
+        }
+        case CommandType::FillEllipse:
+        {
+            gdiRet = graphics.FillEllipse( brushes_[command.styleIdx].get(), command.rect );
+            smp::error::CheckGdi( gdiRet, "FillEllipse" );
+            break;
+        }
+        case CommandType::FillPath:
+        {
+            gdiRet = graphics.FillPath( brushes_[command.styleIdx].get(), paths_[command.dataIdx].get() );
+            smp::error::CheckGdi( gdiRet, "FillPath" );
+            break;
+        }
+        case CommandType::FillRect:
+        {
+            gdiRet = graphics.FillRectangle( brushes_[command.styleIdx].get(), command.rect );
+            smp::error::CheckGdi( gdiRet, "FillRectangle" );
+            break;
+        }
+        case CommandType::SetInterpolationMode:
+        {
+            gdiRet = graphics.SetInterpolationMode( (Gdiplus::InterpolationMode)command.value );
+            smp::error::CheckGdi( gdiRet, "SetInterpolationMode" );
+            break;
+        }
+        case CommandType::SetSmoothingMode:
+        {
+            gdiRet = graphics.SetSmoothingMode( (Gdiplus::SmoothingMode)command.value );
+            smp::error::CheckGdi( gdiRet, "SetSmoothingMode" );
+            break;
+        }
+        case CommandType::SetTextRenderingHint:
+        {
+            gdiRet = graphics.SetTextRenderingHint( (Gdiplus::TextRenderingHint)command.value );
+            smp::error::CheckGdi( gdiRet, "SetTextRenderingHint" );
+            break;
+        }
+        default:
+        {
+            assert( 0 );
+            break;
+        }
+        }
+    }
+}
+
+void JsGdiDrawList::Clear()
+{
+    commands_.clear();
+
+    brushes_.clear();
+    solidBrushIndices_.clear();
+    pens_.clear();
+    penIndices_.clear();
+    stringFormats_.clear();
+    stringFormatIndices_.clear();
+    paths_.clear();
+    texts_.clear();
+
+    fonts_.clear();
+    fontIndices_.clear();
+    images_.clear();
+    imageIndices_.clear();
+    jsResources_.clear();
+}
+
+void JsGdiDrawList::DrawEllipse( float x, float y, float w, float h, float line_width, uint32_t colour )
+{
+    Command command{ CommandType::DrawEllipse, Gdiplus::RectF{ x, y, w, h } };
+    command.styleIdx = GetPen( colour, line_width );
+    AddCommand( command );
+}
+
+void JsGdiDrawList::DrawImage( JS::HandleValue image,
+                               float dstX, float dstY, float dstW, float dstH,
+                               float srcX, float srcY, float srcW, float srcH,
+                               float angle, uint8_t alpha )
+{
+    Command command{ CommandType::DrawImage, Gdiplus::RectF{ dstX, dstY, dstW, dstH } };
+    command.srcRect = Gdiplus::RectF{ srcX, srcY, srcW, srcH };
+    command.angle = angle;
+    command.value = alpha;
+    command.dataIdx = GetResource( image, images_, imageIndices_, "image" );
+    AddCommand( command );
+}
+
+void JsGdiDrawList::DrawImageWithOpt( size_t optArgCount, JS::HandleValue image,
+                                      float dstX, float dstY, float dstW, float dstH,
+                                      float srcX, float srcY, float srcW, float srcH,
+                                      float angle, uint8_t alpha )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return DrawImage( image, dstX, dstY, dstW, dstH, srcX, srcY, srcW, srcH, angle, alpha );
+    case 1:
+        return DrawImage( image, dstX, dstY, dstW, dstH, srcX, srcY, srcW, srcH, angle );
+    case 2:
+        return DrawImage( image, dstX, dstY, dstW, dstH, srcX, srcY, srcW, srcH );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+void JsGdiDrawList::DrawLine( float x1, float y1, float x2, float y2, float line_width, uint32_t colour )
+{
+    Command command{ CommandType::DrawLine, Gdiplus::RectF{ x1, y1, x2, y2 } };
+    command.styleIdx = GetPen( colour, line_width );
+    AddCommand( command );
+}
+
+void JsGdiDrawList::DrawRect( float x, float y, float w, float h, float line_width, uint32_t colour )
+{
+    Command command{ CommandType::DrawRect, Gdiplus::RectF{ x, y, w, h } };
+    command.styleIdx = GetPen( colour, line_width );
+    AddCommand( command );
+}
+
+void JsGdiDrawList::DrawRoundRect( float x, float y, float w, float h, float arc_width, float arc_height, float line_width, uint32_t colour )
+{
+    SmpException::ExpectTrue( 2 * arc_width <= w && 2 * arc_height <= h, "Arc argument has invalid value" );
+
+    auto pPath = std::make_unique<Gdiplus::GraphicsPath>();
+    JsGdiGraphics::GetRoundRectPath( *pPath, Gdiplus::RectF{ x, y, w, h }, arc_width, arc_height );
+
+    Command command{ CommandType::DrawPath };
+    command.styleIdx = GetPen( colour, line_width, true );
+    command.dataIdx = AddPath( std::move( pPath ) );
+    AddCommand( command );
+}
+
+void JsGdiDrawList::DrawString( const std::wstring& str, JS::HandleValue font, uint32_t colour, float x, float y, float w, float h, uint32_t flags )
+{
+    Command command{ CommandType::DrawString, Gdiplus::RectF{ x, y, w, h } };
+    command.fontIdx = GetResource( font, fonts_, fontIndices_, "font" );
+    command.styleIdx = GetSolidBrush( colour );
+    command.formatIdx = GetStringFormat( flags );
+    command.dataIdx = static_cast<uint32_t>( texts_.size() );
+    texts_.emplace_back( str );
+    AddCommand( command );
+}
+
+void JsGdiDrawList::DrawStringWithOpt( size_t optArgCount, const std::wstring& str, JS::HandleValue font, uint32_t colour,
+                                       float x, float y, float w, float h,
+                                       uint32_t flags )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return DrawString( str, font, colour, x, y, w, h, flags );
+    case 1:
+        return DrawString( str, font, colour, x, y, w, h );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+void JsGdiDrawList::FillEllipse( float x, float y, float w, float h, uint32_t colour )
+{
+    Command command{ CommandType::FillEllipse, Gdiplus::RectF{ x, y, w, h } };
+    command.styleIdx = GetSolidBrush( colour );
+    AddCommand( command );
+}
+
+void JsGdiDrawList::FillGradRect( float x, float y, float w, float h, float angle, uint32_t colour1, uint32_t colour2, float focus )
+{
+    const Gdiplus::RectF rect{ x, y, w, h };
+    auto pBrush = std::make_unique<Gdiplus::LinearGradientBrush>( rect, colour1, colour2, angle, TRUE );
+    smp::error::CheckGdiPlusObject( pBrush );
+
+    Gdiplus::Status gdiRet = pBrush->SetBlendTriangularShape( focus );
+    smp::error::CheckGdi( gdiRet, "SetBlendTriangularShape" );
+
+    // gradient depends on the rect, so there is no point in sharing it
+    Command command{ CommandType::FillRect, rect };
+    command.styleIdx = static_cast<uint32_t>( brushes_.size() );
+    brushes_.emplace_back( std::move( pBrush ) );
+    AddCommand( command );
+}
+
+void JsGdiDrawList::FillGradRectWithOpt( size_t optArgCount, float x, float y, float w, float h, float angle, uint32_t colour1, uint32_t colour2, float focus )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return FillGradRect( x, y, w, h, angle, colour1, colour2, focus );
+    case 1:
+        return FillGradRect( x, y, w, h, angle, colour1, colour2 );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+void JsGdiDrawList::FillRoundRect( float x, float y, float w, float h, float arc_width, float arc_height, uint32_t colour )
+{
+    SmpException::ExpectTrue( 2 * arc_width <= w && 2 * arc_height <= h, "Arc argument has invalid value" );
+
+    auto pPath = std::make_unique<Gdiplus::GraphicsPath>();
+    JsGdiGraphics::GetRoundRectPath( *pPath, Gdiplus::RectF{ x, y, w, h }, arc_width, arc_height );
+
+    Command command{ CommandType::FillPath };
+    command.styleIdx = GetSolidBrush( colour );
+    command.dataIdx = AddPath( std::move( pPath ) );
+    AddCommand( command );
+}
+
+void JsGdiDrawList::FillSolidRect( float x, float y, float w, float h, uint32_t colour )
+{
+    Command command{ CommandType::FillRect, Gdiplus::RectF{ x, y, w, h } };
+    command.styleIdx = GetSolidBrush( colour );
+    AddCommand( command );
+}
+
+void JsGdiDrawList::SetInterpolationMode( uint32_t mode )
+{
+    Command command{ CommandType::SetInterpolationMode };
+    command.value = mode;
+    AddCommand( command );
+}
+
+void JsGdiDrawList::SetInterpolationModeWithOpt( size_t optArgCount, uint32_t mode )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return SetInterpolationMode( mode );
+    case 1:
+        return SetInterpolationMode();
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+void JsGdiDrawList::SetSmoothingMode( uint32_t mode )
+{
+    Command command{ CommandType::SetSmoothingMode };
+    command.value = mode;
+    AddCommand( command );
+}
+
+void JsGdiDrawList::SetSmoothingModeWithOpt( size_t optArgCount, uint32_t mode )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return SetSmoothingMode( mode );
+    case 1:
+        return SetSmoothingMode();
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+void JsGdiDrawList::SetTextRenderingHint( uint32_t mode )
+{
+    Command command{ CommandType::SetTextRenderingHint };
+    command.value = mode;
+    AddCommand( command );
+}
+
+void JsGdiDrawList::SetTextRenderingHintWithOpt( size_t optArgCount, uint32_t mode )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return SetTextRenderingHint( mode );
+    case 1:
+        return SetTextRenderingHint();
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+uint32_t JsGdiDrawList::get_Count()
+{
+    return static_cast<uint32_t>( commands_.size() );
+}
+
+void JsGdiDrawList::AddCommand( const Command& command )
+{
+    const auto oldCapacity = commands_.capacity();
+    commands_.emplace_back( command );
+    if ( commands_.capacity() != oldCapacity )
+    { // reported only on reallocation, since it's the command buffer that dominates the size
+        UpdateNativeObjectSize( pJsCtx_, commands_.capacity() * sizeof( Command ) );
+    }
+}
+
+uint32_t JsGdiDrawList::GetSolidBrush( uint32_t colour )
+{
+    if ( const auto it = solidBrushIndices_.find( colour ); it != solidBrushIndices_.cend() )
+    {
+        return it->second;
+    }
+
+    auto pBrush = std::make_unique<Gdiplus::SolidBrush>( colour );
+    smp::error::CheckGdiPlusObject( pBrush );
+
+    const auto idx = static_cast<uint32_t>( brushes_.size() );
+    brushes_.emplace_back( std::move( pBrush ) );
+    solidBrushIndices_.try_emplace( colour, idx );
+
+    return idx;
+}
+
+uint32_t JsGdiDrawList::GetPen( uint32_t colour, float lineWidth, bool hasRoundCaps )
+{
+    const auto key = std::make_tuple( colour, lineWidth, hasRoundCaps );
+    if ( const auto it = penIndices_.find( key ); it != penIndices_.cend() )
+    {
+        return it->second;
+    }
+
+    auto pPen = std::make_unique<Gdiplus::Pen>( colour, lineWidth );
+    smp::error::CheckGdiPlusObject( pPen );
+
+    if ( hasRoundCaps )
+    {
+        Gdiplus::Status gdiRet = pPen->SetStartCap( Gdiplus::LineCapRound );
+        smp::error::CheckGdi( gdiRet, "SetStartCap" );
+
+        gdiRet = pPen->SetEndCap( Gdiplus::LineCapRound );
+        smp::error::CheckGdi( gdiRet, "SetEndCap" );
+    }
+
+    const auto idx = static_cast<uint32_t>( pens_.size() );
+    pens_.emplace_back( std::move( pPen ) );
+    penIndices_.try_emplace( key, idx );
+
+    return idx;
+}
+
+uint32_t JsGdiDrawList::GetStringFormat( uint32_t flags )
+{
+    if ( const auto it = stringFormatIndices_.find( flags ); it != stringFormatIndices_.cend() )
+    {
+        return it->second;
+    }
+
+    auto pFormat = std::make_unique<Gdiplus::StringFormat>( Gdiplus::StringFormat::GenericTypographic() );
+    smp::error::CheckGdiPlusObject( pFormat );
+    JsGdiGraphics::SetStringFormatFlags( *pFormat, flags );
+
+    const auto idx = static_cast<uint32_t>( stringFormats_.size() );
+    stringFormats_.emplace_back( std::move( pFormat ) );
+    stringFormatIndices_.try_emplace( flags, idx );
+
+    return idx;
+}
+
+uint32_t JsGdiDrawList::AddPath( std::unique_ptr<Gdiplus::GraphicsPath> pPath )
+{
+    const auto idx = static_cast<uint32_t>( paths_.size() );
+    paths_.emplace_back( std::move( pPath ) );
+    return idx;
+}
+
+template <typename T>
+uint32_t JsGdiDrawList::GetResource( JS::HandleValue jsValue, std::vector<T*>& natives, std::unordered_map<T*, uint32_t>& indices, const char* argName )
+{
+    T* pNative = GetInnerInstancePrivate<T>( pJsCtx_, jsValue );
+    SmpException::ExpectTrue( pNative, "{} argument is not a {} object", argName, T::JsClass.name );
+
+    if ( const auto it = indices.find( pNative ); it != indices.cend() )
+    {
+        return it->second;
+    }
+
+    const auto idx = static_cast<uint32_t>( natives.size() );
+    natives.emplace_back( pNative );
+    indices.try_emplace( pNative, idx );
+    jsResources_.emplace_back( &jsValue.toObject() );
+
+    return idx;
+}
+
+} // namespace mozjs
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <js_objects/object_base.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+class JSObject;
+struct JSContext;
+struct JSClass;
+
+namespace mozjs
+{
+
+class JsGdiBitmap;
+class JsGdiFont;
+
+/// @brief Recorded list of drawing commands, see JsGdiGraphics::Replay.
+/// @details GDI+ objects (brushes, pens, string formats, paths) are created once during recording
+///          and are shared by all commands of the list.
+///          Fonts and images that are used by the list are kept alive while the list exists.
+class JsGdiDrawList
+    : public JsObjectBase<JsGdiDrawList>
+{
+public:
+    static constexpr bool HasProto = true;
+    static constexpr bool HasGlobalProto = false;
+    static constexpr bool HasProxy = false;
+    static constexpr bool HasPostCreate = false;
+
+    static const JSClass JsClass;
+    static const JSFunctionSpec* JsFunctions;
+    static const JSPropertySpec* JsProperties;
+    static const JsPrototypeId PrototypeId;
+
+public:
+    ~JsGdiDrawList();
+
+    static std::unique_ptr<JsGdiDrawList> CreateNative( JSContext* cx );
+    static size_t GetInternalSize();
+
+    static void Trace( JSTracer* trc, JSObject* obj );
+
+public:
+    /// @throw smp::SmpException
+    void Execute( Gdiplus::Graphics& graphics );
+
+public:
+    void Clear();
+    void DrawEllipse( float x, float y, float w, float h, float line_width, uint32_t colour );
+    void DrawImage( JS::HandleValue image,
+                    float dstX, float dstY, float dstW, float dstH,
+                    float srcX, float srcY, float srcW, float srcH,
+                    float angle = 0, uint8_t alpha = 255 );
+    void DrawImageWithOpt( size_t optArgCount, JS::HandleValue image,
+                           float dstX, float dstY, float dstW, float dstH,
+                           float srcX, float srcY, float srcW, float srcH,
+                           float angle, uint8_t alpha );
+    void DrawLine( float x1, float y1, float x2, float y2, float line_width, uint32_t colour );
+    void DrawRect( float x, float y, float w, float h, float line_width, uint32_t colour );
+    void DrawRoundRect( float x, float y, float w, float h, float arc_width, float arc_height, float line_width, uint32_t colour );
+    void DrawString( const std::wstring& str, JS::HandleValue font, uint32_t colour,
+                     float x, float y, float w, float h,
+                     uint32_t flags = 0 );
+    void DrawStringWithOpt( size_t optArgCount, const std::wstring& str, JS::HandleValue font, uint32_t colour,
+                            float x, float y, float w, float h,
+                            uint32_t flags );
+    void FillEllipse( float x, float y, float w, float h, uint32_t colour );
+    void FillGradRect( float x, float y, float w, float h,
+                       float angle, uint32_t colour1, uint32_t colour2, float focus = 1 );
+    void FillGradRectWithOpt( size_t optArgCount,
+                              float x, float y, float w, float h,
+                              float angle, uint32_t colour1, uint32_t colour2, float focus );
+    void FillRoundRect( float x, float y, float w, float h, float arc_width, float arc_height, uint32_t colour );
+    void FillSolidRect( float x, float y, float w, float h, uint32_t colour );
+    void SetInterpolationMode( uint32_t mode = 0 );
+    void SetInterpolationModeWithOpt( size_t optArgCount, uint32_t mode );
+    void SetSmoothingMode( uint32_t mode = 0 );
+    void SetSmoothingModeWithOpt( size_t optArgCount, uint32_t mode );
+    void SetTextRenderingHint( uint32_t mode = 0 );
+    void SetTextRenderingHintWithOpt( size_t optArgCount, uint32_t mode );
+
+public:
+    uint32_t get_Count();
+
+private:
+    JsGdiDrawList( JSContext* cx );
+
+    enum class CommandType : uint8_t
+    {
+        DrawImage,
+        DrawLine,
+        DrawPath,
+        DrawEllipse,
+        DrawRect,
+        DrawString,
+        FillEllipse,
+        FillPath,
+        FillRect,
+        SetInterpolationMode,
+        SetSmoothingMode,
+        SetTextRenderingHint
+    };
+
+    struct Command
+    {
+        CommandType type;
+        /// @brief `DrawLine`: (x1, y1, x2, y2)
+        Gdiplus::RectF rect;
+        Gdiplus::RectF srcRect; ///< `DrawImage` only
+        float angle = 0;        ///< `DrawImage` only
+        uint32_t value = 0;     ///< mode for `Set*`, alpha for `DrawImage`
+        uint32_t styleIdx = 0;  ///< pen for `Draw*` shapes, brush for `Fill*` and `DrawString`
+        uint32_t dataIdx = 0;   ///< path for `*Path`, text for `DrawString`, image for `DrawImage`
+        uint32_t fontIdx = 0;   ///< `DrawString` only
+        uint32_t formatIdx = 0; ///< `DrawString` only
+    };
+
+    void AddCommand( const Command& command );
+    uint32_t GetSolidBrush( uint32_t colour );
+    uint32_t GetPen( uint32_t colour, float lineWidth, bool hasRoundCaps = false );
+    uint32_t GetStringFormat( uint32_t flags );
+    uint32_t AddPath( std::unique_ptr<Gdiplus::GraphicsPath> pPath );
+    /// @throw smp::SmpException
+    template <typename T>
+    uint32_t GetResource( JS::HandleValue jsValue, std::vector<T*>& natives, std::unordered_map<T*, uint32_t>& indices, const char* argName );
+
+private:
+    JSContext* pJsCtx_ = nullptr;
+
+    std::vector<Command> commands_;
+
+    std::vector<std::unique_ptr<Gdiplus::Brush>> brushes_;
+    std::unordered_map<uint32_t, uint32_t> solidBrushIndices_;
+    std::vector<std::unique_ptr<Gdiplus::Pen>> pens_;
+    std::map<std::tuple<uint32_t, float, bool>, uint32_t> penIndices_;
+    std::vector<std::unique_ptr<Gdiplus::StringFormat>> stringFormats_;
+    std::unordered_map<uint32_t, uint32_t> stringFormatIndices_;
+    std::vector<std::unique_ptr<Gdiplus::GraphicsPath>> paths_;
+    std::vector<std::wstring> texts_;
+
+    std::vector<JsGdiFont*> fonts_;
+    std::unordered_map<JsGdiFont*, uint32_t> fontIndices_;
+    std::vector<JsGdiBitmap*> images_;
+    std::unordered_map<JsGdiBitmap*, uint32_t> imageIndices_;
+    /// @brief JS objects of fonts and images: traced so that they are not collected while being used
+    std::vector<JS::Heap<JSObject*>> jsResources_;
+};
+
+} // namespace mozjs
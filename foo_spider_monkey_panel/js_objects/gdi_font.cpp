@@ -4,11 +4,8 @@
 #include <js_engine/js_to_native_invoker.h>
 #include <js_utils/js_error_helper.h>
 #include <js_utils/js_object_helper.h>
+#include <utils/font_cache.h>
 #include <utils/gdi_error_helpers.h>
-#include <utils/scope_helpers.h>
-#include <utils/winapi_error_helpers.h>
-
-// TODO: add font caching
 
 using namespace smp;
 
@@ -41,12 +38,18 @@ const JSFunctionSpec jsFunctions[] = {
     JS_FS_END
 };
 
+MJS_DEFINE_JS_FN_FROM_NATIVE( get_Ascent, JsGdiFont::get_Ascent )
+MJS_DEFINE_JS_FN_FROM_NATIVE( get_AvgCharWidth, JsGdiFont::get_AvgCharWidth )
+MJS_DEFINE_JS_FN_FROM_NATIVE( get_Descent, JsGdiFont::get_Descent )
 MJS_DEFINE_JS_FN_FROM_NATIVE( get_Height, JsGdiFont::get_Height )
 MJS_DEFINE_JS_FN_FROM_NATIVE( get_Name, JsGdiFont::get_Name )
 MJS_DEFINE_JS_FN_FROM_NATIVE( get_Size, JsGdiFont::get_Size )
 MJS_DEFINE_JS_FN_FROM_NATIVE( get_Style, JsGdiFont::get_Style )
 
 const JSPropertySpec jsProperties[] = {
+    JS_PSG( "Ascent", get_Ascent, DefaultPropsFlags() ),
+    JS_PSG( "AvgCharWidth", get_AvgCharWidth, DefaultPropsFlags() ),
+    JS_PSG( "Descent", get_Descent, DefaultPropsFlags() ),
     JS_PSG( "Height", get_Height, DefaultPropsFlags() ),
     JS_PSG( "Name", get_Name, DefaultPropsFlags() ),
     JS_PSG( "Size", get_Size, DefaultPropsFlags() ),
@@ -67,80 +70,44 @@ const JSPropertySpec* JsGdiFont::JsProperties = jsProperties;
 const JsPrototypeId JsGdiFont::PrototypeId = JsPrototypeId::GdiFont;
 const JSNative JsGdiFont::JsConstructor = ::GdiFont_Constructor;
 
-JsGdiFont::JsGdiFont( JSContext* cx, std::unique_ptr<Gdiplus::Font> gdiFont, HFONT hFont, bool isManaged )
+JsGdiFont::JsGdiFont( JSContext* cx, std::shared_ptr<const smp::utils::CachedFont> pFont )
     : pJsCtx_( cx )
-    , isManaged_( isManaged )
-    , hFont_( hFont )
-    , pGdi_( std::move( gdiFont ) )
+    , pFont_( pFont )
 {
-    assert( pGdi_.get() );
-    assert( hFont_ );
+    assert( pFont_ );
 }
 
 JsGdiFont::~JsGdiFont()
 {
-    if ( hFont_ && isManaged_ )
-    {
-        DeleteFont( hFont_ );
-    }
 }
 
 std::unique_ptr<JsGdiFont>
-JsGdiFont::CreateNative( JSContext* cx, std::unique_ptr<Gdiplus::Font> pGdiFont, HFONT hFont, bool isManaged )
+JsGdiFont::CreateNative( JSContext* cx, std::shared_ptr<const smp::utils::CachedFont> pFont )
 {
-    SmpException::ExpectTrue( !!pGdiFont, "Internal error: Gdiplus::Font object is null" );
-    SmpException::ExpectTrue( hFont, "Internal error: HFONT object is null" );
+    SmpException::ExpectTrue( !!pFont, "Internal error: font object is null" );
 
-    return std::unique_ptr<JsGdiFont>( new JsGdiFont( cx, std::move( pGdiFont ), hFont, isManaged ) );
+    return std::unique_ptr<JsGdiFont>( new JsGdiFont( cx, pFont ) );
 }
 
-size_t JsGdiFont::GetInternalSize( const std::unique_ptr<Gdiplus::Font>& /*gdiFont*/, HFONT /*hFont*/, bool isManaged )
-{
-    return sizeof( Gdiplus::Font ) + ( isManaged ? sizeof( LOGFONT ) : 0 );
+size_t JsGdiFont::GetInternalSize( const std::shared_ptr<const smp::utils::CachedFont>& /*pFont*/ )
+{ // font data is shared between objects, but it's still reported for each of them,
+  // so that GC is triggered as if every object owned its font
+    return sizeof( smp::utils::CachedFont ) + sizeof( Gdiplus::Font ) + sizeof( LOGFONT );
 }
 
 Gdiplus::Font* JsGdiFont::GdiFont() const
 {
-    return pGdi_.get();
+    return pFont_->GetGdiFont();
 }
 
 HFONT JsGdiFont::GetHFont() const
 {
-    return hFont_;
+    return pFont_->GetHFont();
 }
 
 JSObject* JsGdiFont::Constructor( JSContext* cx, const std::wstring& fontName, float pxSize, uint32_t style )
 {
-    std::unique_ptr<Gdiplus::Font> pGdiFont( new Gdiplus::Font( fontName.c_str(), pxSize, style, Gdiplus::UnitPixel ) );
-    smp::error::CheckGdiPlusObject( pGdiFont );
-
-    // Generate HFONT
-    // The benefit of replacing Gdiplus::Font::GetLogFontW is that you can get it work with CCF/OpenType fonts.
-    HFONT hFont = CreateFont(
-        -(int)pxSize,
-        0,
-        0,
-        0,
-        ( style & Gdiplus::FontStyleBold ) ? FW_BOLD : FW_NORMAL,
-        ( style & Gdiplus::FontStyleItalic ) ? TRUE : FALSE,
-        ( style & Gdiplus::FontStyleUnderline ) ? TRUE : FALSE,
-        ( style & Gdiplus::FontStyleStrikeout ) ? TRUE : FALSE,
-        DEFAULT_CHARSET,
-        OUT_DEFAULT_PRECIS,
-        CLIP_DEFAULT_PRECIS,
-        DEFAULT_QUALITY,
-        DEFAULT_PITCH | FF_DONTCARE,
-        fontName.c_str() );
-    smp::error::CheckWinApi( !!hFont, "CreateFont" );
-    utils::final_action autoFont( [hFont]() {
-        DeleteObject( hFont );
-    } );
-
-    JS::RootedObject jsObject( cx, JsGdiFont::CreateJs( cx, std::move( pGdiFont ), hFont, true ) );
-    assert( jsObject );
-
-    autoFont.cancel();
-    return jsObject;
+    return JsGdiFont::CreateJs( cx, smp::utils::FontCache::GetInstance().GetFont( fontName, pxSize, style ) );
 }
 
 JSObject* JsGdiFont::ConstructorWithOpt( JSContext* cx, size_t optArgCount, const std::wstring& fontName, float pxSize, uint32_t style )
@@ -156,19 +123,31 @@ JSObject* JsGdiFont::ConstructorWithOpt( JSContext* cx, size_t optArgCount, cons
     }
 }
 
-uint32_t JsGdiFont::get_Height() const
+uint32_t JsGdiFont::get_Ascent() const
+{
+    return pFont_->GetMetrics().ascent;
+}
+
+uint32_t JsGdiFont::get_AvgCharWidth() const
 {
-    Gdiplus::Bitmap img( 1, 1, PixelFormat32bppPARGB );
-    Gdiplus::Graphics g( &img );
+    return pFont_->GetMetrics().avgCharWidth;
+}
 
-    return static_cast<uint32_t>( pGdi_->GetHeight( &g ) );
+uint32_t JsGdiFont::get_Descent() const
+{
+    return pFont_->GetMetrics().descent;
+}
+
+uint32_t JsGdiFont::get_Height() const
+{
+    return pFont_->GetMetrics().height;
 }
 
 std::wstring JsGdiFont::get_Name() const
 {
     Gdiplus::FontFamily fontFamily;
     WCHAR name[LF_FACESIZE] = { 0 };
-    Gdiplus::Status gdiRet = pGdi_->GetFamily( &fontFamily );
+    Gdiplus::Status gdiRet = pFont_->GetGdiFont()->GetFamily( &fontFamily );
     smp::error::CheckGdi( gdiRet, "GetFamily" );
 
     gdiRet = fontFamily.GetFamilyName( name, LANG_NEUTRAL );
@@ -179,12 +158,12 @@ std::wstring JsGdiFont::get_Name() const
 
 float JsGdiFont::get_Size() const
 {
-    return pGdi_->GetSize();
+    return pFont_->GetGdiFont()->GetSize();
 }
 
 uint32_t JsGdiFont::get_Style() const
 {
-    return pGdi_->GetStyle();
+    return pFont_->GetGdiFont()->GetStyle();
 }
 
 } // namespace mozjs
@@ -2,6 +2,7 @@
 
 #include <js_objects/object_base.h>
 
+#include <memory>
 #include <optional>
 
 class JSObject;
@@ -15,6 +16,11 @@ namespace Gdiplus
 class Font;
 }
 
+namespace smp::utils
+{
+class CachedFont;
+}
+
 namespace mozjs
 {
 
@@ -36,8 +42,8 @@ public:
 public:
     ~JsGdiFont();
 
-    static std::unique_ptr<JsGdiFont> CreateNative( JSContext* cx, std::unique_ptr<Gdiplus::Font> gdiFont, HFONT hFont, bool isManaged );
-    static size_t GetInternalSize( const std::unique_ptr<Gdiplus::Font>& gdiFont, HFONT hFont, bool isManaged );
+    static std::unique_ptr<JsGdiFont> CreateNative( JSContext* cx, std::shared_ptr<const smp::utils::CachedFont> pFont );
+    static size_t GetInternalSize( const std::shared_ptr<const smp::utils::CachedFont>& pFont );
 
 public:
     Gdiplus::Font* GdiFont() const;
@@ -48,19 +54,20 @@ public: // ctor
     static JSObject* ConstructorWithOpt( JSContext* cx, size_t optArgCount, const std::wstring& fontName, float pxSize, uint32_t style );
 
 public: // props
+    uint32_t get_Ascent() const;
+    uint32_t get_AvgCharWidth() const;
+    uint32_t get_Descent() const;
     uint32_t get_Height() const;
     std::wstring get_Name() const;
     float get_Size() const;
     uint32_t get_Style() const;
 
 private:
-    JsGdiFont( JSContext* cx, std::unique_ptr<Gdiplus::Font> gdiFont, HFONT hFont, bool isManaged );
+    JsGdiFont( JSContext* cx, std::shared_ptr<const smp::utils::CachedFont> pFont );
 
 private:
     JSContext* pJsCtx_ = nullptr;
-    bool isManaged_;
-    std::unique_ptr<Gdiplus::Font> pGdi_;
-    HFONT hFont_ = nullptr;
+    std::shared_ptr<const smp::utils::CachedFont> pFont_;
 };
 
 } // namespace mozjs
@@ -5,6 +5,7 @@
 #include <js_engine/js_to_native_invoker.h>
 #include <js_objects/gdi_font.h>
 #include <js_objects/gdi_bitmap.h>
+#include <js_objects/gdi_draw_list.h>
 #include <js_objects/gdi_raw_bitmap.h>
 #include <js_objects/measure_string_info.h>
 #include <js_utils/js_error_helper.h>
@@ -13,6 +14,7 @@
 #include <utils/winapi_error_helpers.h>
 #include <utils/scope_helpers.h>
 #include <utils/text_helpers.h>
+#include <utils/trace_recorder.h>
 #include <utils/colour_helpers.h>
 
 using namespace smp;
@@ -61,6 +63,7 @@ MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( GdiAlphaBlend, JsGdiGraphics::GdiAlphaBle
 MJS_DEFINE_JS_FN_FROM_NATIVE( GdiDrawBitmap, JsGdiGraphics::GdiDrawBitmap )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( GdiDrawText, JsGdiGraphics::GdiDrawText, JsGdiGraphics::GdiDrawTextWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( MeasureString, JsGdiGraphics::MeasureString, JsGdiGraphics::MeasureStringWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE( Replay, JsGdiGraphics::Replay )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( SetInterpolationMode, JsGdiGraphics::SetInterpolationMode, JsGdiGraphics::SetInterpolationModeWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( SetSmoothingMode, JsGdiGraphics::SetSmoothingMode, JsGdiGraphics::SetSmoothingModeWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( SetTextRenderingHint, JsGdiGraphics::SetTextRenderingHint, JsGdiGraphics::SetTextRenderingHintWithOpt, 1 )
@@ -85,6 +88,7 @@ const JSFunctionSpec jsFunctions[] = {
     JS_FN( "GdiDrawBitmap", GdiDrawBitmap, 9, DefaultPropsFlags() ),
     JS_FN( "GdiDrawText", GdiDrawText, 7, DefaultPropsFlags() ),
     JS_FN( "MeasureString", MeasureString, 6, DefaultPropsFlags() ),
+    JS_FN( "Replay", Replay, 1, DefaultPropsFlags() ),
     JS_FN( "SetInterpolationMode", SetInterpolationMode, 0, DefaultPropsFlags() ),
     JS_FN( "SetSmoothingMode", SetSmoothingMode, 0, DefaultPropsFlags() ),
     JS_FN( "SetTextRenderingHint", SetTextRenderingHint, 0, DefaultPropsFlags() ),
@@ -126,14 +130,49 @@ size_t JsGdiGraphics::GetInternalSize()
     return 0;
 }
 
-Gdiplus::Graphics* JsGdiGraphics::GetGraphicsObject() const
+Gdiplus::Graphics* JsGdiGraphics::GetGraphicsObject()
 {
+    ReleaseHdc();
     return pGdi_;
 }
 
-void JsGdiGraphics::SetGraphicsObject( Gdiplus::Graphics* graphics )
+void JsGdiGraphics::SetGraphicsObject( Gdiplus::Graphics* graphics, bool cacheHdc )
 {
+    if ( pGdi_ )
+    {
+        ReleaseHdc();
+        SMP_TRACE_COUNTER( "paint", "GDI+ flushes", hdcAcquireCount_ );
+    }
+
+    hdcAcquireCount_ = 0;
+    solidBrushes_.clear();
+    pens_.clear();
+    stringFormats_.clear();
+
     pGdi_ = graphics;
+    cacheHdc_ = cacheHdc;
+}
+
+HDC JsGdiGraphics::GetHdc()
+{
+    SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
+
+    if ( !hDc_ )
+    {
+        hDc_ = pGdi_->GetHDC();
+        SmpException::ExpectTrue( hDc_, "Internal error: failed to get HDC" );
+        ++hdcAcquireCount_;
+    }
+
+    return hDc_;
+}
+
+void JsGdiGraphics::ReleaseUncachedHdc()
+{
+    if ( !cacheHdc_ )
+    {
+        ReleaseHdc();
+    }
 }
 
 uint32_t JsGdiGraphics::CalcTextHeight( const std::wstring& str, JsGdiFont* font )
@@ -141,8 +180,8 @@ uint32_t JsGdiGraphics::CalcTextHeight( const std::wstring& str, JsGdiFont* font
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
     SmpException::ExpectTrue( font, "font argument is null" );
 
-    const HDC hDc = pGdi_->GetHDC();
-    smp::utils::final_action autoHdcReleaser( [hDc, pGdi = pGdi_] { pGdi->ReleaseHDC( hDc ); } );
+    const HDC hDc = GetHdc();
+    utils::final_action autoHdc( [&] { ReleaseUncachedHdc(); } );
     gdi::ObjectSelector autoFont( hDc, font->GetHFont() );
 
     return smp::utils::get_text_height( hDc, str );
@@ -153,8 +192,8 @@ uint32_t JsGdiGraphics::CalcTextWidth( const std::wstring& str, JsGdiFont* font
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
     SmpException::ExpectTrue( font, "font argument is null" );
 
-    const HDC hDc = pGdi_->GetHDC();
-    smp::utils::final_action autoHdcReleaser( [hDc, pGdi = pGdi_] { pGdi->ReleaseHDC( hDc ); } );
+    const HDC hDc = GetHdc();
+    utils::final_action autoHdc( [&] { ReleaseUncachedHdc(); } );
     gdi::ObjectSelector autoFont( hDc, font->GetHFont() );
 
     return smp::utils::get_text_width( hDc, str );
@@ -164,8 +203,9 @@ void JsGdiGraphics::DrawEllipse( float x, float y, float w, float h, float line_
 {
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
 
-    Gdiplus::Pen pen( colour, line_width );
-    Gdiplus::Status gdiRet = pGdi_->DrawEllipse( &pen, x, y, w, h );
+    ReleaseHdc();
+
+    Gdiplus::Status gdiRet = pGdi_->DrawEllipse( &GetPen( colour, line_width ), x, y, w, h );
     smp::error::CheckGdi( gdiRet, "DrawEllipse" );
 }
 
@@ -176,22 +216,32 @@ void JsGdiGraphics::DrawImage( JsGdiBitmap* image,
 {
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
     SmpException::ExpectTrue( image, "image argument is null" );
+    image->EnsureNotLocked();
 
     Gdiplus::Bitmap* img = image->GdiBitmap();
     assert( img );
+
+    ReleaseHdc();
+    DrawImageImpl( *pGdi_, *img, Gdiplus::RectF( dstX, dstY, dstW, dstH ), Gdiplus::RectF( srcX, srcY, srcW, srcH ), angle, alpha );
+}
+
+void JsGdiGraphics::DrawImageImpl( Gdiplus::Graphics& graphics, Gdiplus::Bitmap& img,
+                                   const Gdiplus::RectF& dstRect, const Gdiplus::RectF& srcRect,
+                                   float angle, uint8_t alpha )
+{
     Gdiplus::Matrix oldMatrix;
 
     Gdiplus::Status gdiRet;
     if ( angle != 0.0 )
     {
         Gdiplus::Matrix m;
-        gdiRet = m.RotateAt( angle, Gdiplus::PointF{ dstX + dstW / 2, dstY + dstH / 2 } );
+        gdiRet = m.RotateAt( angle, Gdiplus::PointF{ dstRect.X + dstRect.Width / 2, dstRect.Y + dstRect.Height / 2 } );
         smp::error::CheckGdi( gdiRet, "RotateAt" );
 
-        gdiRet = pGdi_->GetTransform( &oldMatrix );
+        gdiRet = graphics.GetTransform( &oldMatrix );
         smp::error::CheckGdi( gdiRet, "GetTransform" );
 
-        gdiRet = pGdi_->SetTransform( &m );
+        gdiRet = graphics.SetTransform( &m );
         smp::error::CheckGdi( gdiRet, "SetTransform" );
     }
 
@@ -206,18 +256,18 @@ void JsGdiGraphics::DrawImage( JsGdiBitmap* image,
         gdiRet = ia.SetColorMatrix( &cm );
         smp::error::CheckGdi( gdiRet, "SetColorMatrix" );
 
-        gdiRet = pGdi_->DrawImage( img, Gdiplus::RectF( dstX, dstY, dstW, dstH ), srcX, srcY, srcW, srcH, Gdiplus::UnitPixel, &ia );
+        gdiRet = graphics.DrawImage( &img, dstRect, srcRect.X, srcRect.Y, srcRect.Width, srcRect.Height, Gdiplus::UnitPixel, &ia );
         smp::error::CheckGdi( gdiRet, "DrawImage" );
     }
     else
     {
-        gdiRet = pGdi_->DrawImage( img, Gdiplus::RectF( dstX, dstY, dstW, dstH ), srcX, srcY, srcW, srcH, Gdiplus::UnitPixel );
+        gdiRet = graphics.DrawImage( &img, dstRect, srcRect.X, srcRect.Y, srcRect.Width, srcRect.Height, Gdiplus::UnitPixel );
         smp::error::CheckGdi( gdiRet, "DrawImage" );
     }
 
     if ( angle != 0.0 )
     {
-        gdiRet = pGdi_->SetTransform( &oldMatrix );
+        gdiRet = graphics.SetTransform( &oldMatrix );
         smp::error::CheckGdi( gdiRet, "SetTransform" );
     }
 }
@@ -244,8 +294,9 @@ void JsGdiGraphics::DrawLine( float x1, float y1, float x2, float y2, float line
 {
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
 
-    Gdiplus::Pen pen( colour, line_width );
-    Gdiplus::Status gdiRet = pGdi_->DrawLine( &pen, x1, y1, x2, y2 );
+    ReleaseHdc();
+
+    Gdiplus::Status gdiRet = pGdi_->DrawLine( &GetPen( colour, line_width ), x1, y1, x2, y2 );
     smp::error::CheckGdi( gdiRet, "DrawLine" );
 }
 
@@ -256,8 +307,9 @@ void JsGdiGraphics::DrawPolygon( uint32_t colour, float line_width, JS::HandleVa
     std::vector<Gdiplus::PointF> gdiPoints;
     ParsePoints( points, gdiPoints );
 
-    Gdiplus::Pen pen( colour, line_width );
-    Gdiplus::Status gdiRet = pGdi_->DrawPolygon( &pen, gdiPoints.data(), gdiPoints.size() );
+    ReleaseHdc();
+
+    Gdiplus::Status gdiRet = pGdi_->DrawPolygon( &GetPen( colour, line_width ), gdiPoints.data(), gdiPoints.size() );
     smp::error::CheckGdi( gdiRet, "DrawPolygon" );
 }
 
@@ -265,8 +317,9 @@ void JsGdiGraphics::DrawRect( float x, float y, float w, float h, float line_wid
 {
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
 
-    Gdiplus::Pen pen( colour, line_width );
-    Gdiplus::Status gdiRet = pGdi_->DrawRectangle( &pen, x, y, w, h );
+    ReleaseHdc();
+
+    Gdiplus::Status gdiRet = pGdi_->DrawRectangle( &GetPen( colour, line_width ), x, y, w, h );
     smp::error::CheckGdi( gdiRet, "DrawRectangle" );
 }
 
@@ -275,17 +328,12 @@ void JsGdiGraphics::DrawRoundRect( float x, float y, float w, float h, float arc
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
     SmpException::ExpectTrue( 2 * arc_width <= w && 2 * arc_height <= h, "Arc argument has invalid value" );
 
-    Gdiplus::Pen pen( colour, line_width );
+    ReleaseHdc();
+
     Gdiplus::GraphicsPath gp;
     GetRoundRectPath( gp, Gdiplus::RectF{ x, y, w, h }, arc_width, arc_height );
 
-    Gdiplus::Status gdiRet = pen.SetStartCap( Gdiplus::LineCapRound );
-    smp::error::CheckGdi( gdiRet, "SetStartCap" );
-
-    gdiRet = pen.SetEndCap( Gdiplus::LineCapRound );
-    smp::error::CheckGdi( gdiRet, "SetEndCap" );
-
-    gdiRet = pGdi_->DrawPath( &pen, &gp );
+    Gdiplus::Status gdiRet = pGdi_->DrawPath( &GetPen( colour, line_width, true ), &gp );
     smp::error::CheckGdi( gdiRet, "DrawPath" );
 }
 
@@ -297,25 +345,9 @@ void JsGdiGraphics::DrawString( const std::wstring& str, JsGdiFont* font, uint32
     Gdiplus::Font* pGdiFont = font->GdiFont();
     SmpException::ExpectTrue( pGdiFont, "Internal error: GdiFont is null" );
 
-    Gdiplus::SolidBrush br( colour );
-    Gdiplus::StringFormat fmt( Gdiplus::StringFormat::GenericTypographic() );
-
-    if ( flags != 0 )
-    {
-        Gdiplus::Status gdiRet = fmt.SetAlignment( ( Gdiplus::StringAlignment )( ( flags >> 28 ) & 0x3 ) ); //0xf0000000
-        smp::error::CheckGdi( gdiRet, "SetAlignment" );
-
-        gdiRet = fmt.SetLineAlignment( ( Gdiplus::StringAlignment )( ( flags >> 24 ) & 0x3 ) ); //0x0f000000
-        smp::error::CheckGdi( gdiRet, "SetLineAlignment" );
-
-        gdiRet = fmt.SetTrimming( ( Gdiplus::StringTrimming )( ( flags >> 20 ) & 0x7 ) ); //0x00f00000
-        smp::error::CheckGdi( gdiRet, "SetTrimming" );
-
-        gdiRet = fmt.SetFormatFlags( ( Gdiplus::StringFormatFlags )( flags & 0x7FFF ) ); //0x0000ffff
-        smp::error::CheckGdi( gdiRet, "SetFormatFlags" );
-    }
+    ReleaseHdc();
 
-    Gdiplus::Status gdiRet = pGdi_->DrawString( str.c_str(), -1, pGdiFont, Gdiplus::RectF( x, y, w, h ), &fmt, &br );
+    Gdiplus::Status gdiRet = pGdi_->DrawString( str.c_str(), -1, pGdiFont, Gdiplus::RectF( x, y, w, h ), &GetStringFormat( flags ), &GetSolidBrush( colour ) );
     smp::error::CheckGdi( gdiRet, "DrawString" );
 }
 
@@ -341,8 +373,8 @@ JSObject* JsGdiGraphics::EstimateLineWrap( const std::wstring& str, JsGdiFont* f
 
     std::vector<smp::utils::wrapped_item> result;
     {
-        const HDC hDc = pGdi_->GetHDC();
-        smp::utils::final_action autoHdcReleaser( [hDc, pGdi = pGdi_] { pGdi->ReleaseHDC( hDc ); } );
+        const HDC hDc = GetHdc();
+        utils::final_action autoHdc( [&] { ReleaseUncachedHdc(); } );
         gdi::ObjectSelector autoFont( hDc, font->GetHFont() );
 
         result = smp::utils::estimate_line_wrap( hDc, str, max_width );
@@ -376,8 +408,9 @@ void JsGdiGraphics::FillEllipse( float x, float y, float w, float h, uint32_t co
 {
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
 
-    Gdiplus::SolidBrush br( colour );
-    Gdiplus::Status gdiRet = pGdi_->FillEllipse( &br, x, y, w, h );
+    ReleaseHdc();
+
+    Gdiplus::Status gdiRet = pGdi_->FillEllipse( &GetSolidBrush( colour ), x, y, w, h );
     smp::error::CheckGdi( gdiRet, "FillEllipse" );
 }
 
@@ -385,6 +418,8 @@ void JsGdiGraphics::FillGradRect( float x, float y, float w, float h, float angl
 {
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
 
+    ReleaseHdc();
+
     const Gdiplus::RectF rect{ x, y, w, h };
     Gdiplus::LinearGradientBrush brush( rect, colour1, colour2, angle, TRUE );
     Gdiplus::Status gdiRet = brush.SetBlendTriangularShape( focus );
@@ -414,8 +449,9 @@ void JsGdiGraphics::FillPolygon( uint32_t colour, uint32_t fillmode, JS::HandleV
     std::vector<Gdiplus::PointF> gdiPoints;
     ParsePoints( points, gdiPoints );
 
-    Gdiplus::SolidBrush br( colour );
-    Gdiplus::Status gdiRet = pGdi_->FillPolygon( &br, gdiPoints.data(), gdiPoints.size(), (Gdiplus::FillMode)fillmode );
+    ReleaseHdc();
+
+    Gdiplus::Status gdiRet = pGdi_->FillPolygon( &GetSolidBrush( colour ), gdiPoints.data(), gdiPoints.size(), (Gdiplus::FillMode)fillmode );
     smp::error::CheckGdi( gdiRet, "FillPolygon" );
 }
 
@@ -425,12 +461,13 @@ void JsGdiGraphics::FillRoundRect( float x, float y, float w, float h, float arc
 
     SmpException::ExpectTrue( 2 * arc_width <= w && 2 * arc_height <= h, "Arc argument has invalid value" );
 
-    Gdiplus::SolidBrush br( colour );
+    ReleaseHdc();
+
     Gdiplus::GraphicsPath gp;
     const Gdiplus::RectF rect{ x, y, w, h };
     GetRoundRectPath( gp, rect, arc_width, arc_height );
 
-    Gdiplus::Status gdiRet = pGdi_->FillPath( &br, &gp );
+    Gdiplus::Status gdiRet = pGdi_->FillPath( &GetSolidBrush( colour ), &gp );
     smp::error::CheckGdi( gdiRet, "FillPath" );
 }
 
@@ -438,8 +475,9 @@ void JsGdiGraphics::FillSolidRect( float x, float y, float w, float h, uint32_t
 {
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
 
-    Gdiplus::SolidBrush brush( colour );
-    Gdiplus::Status gdiRet = pGdi_->FillRectangle( &brush, x, y, w, h );
+    ReleaseHdc();
+
+    Gdiplus::Status gdiRet = pGdi_->FillRectangle( &GetSolidBrush( colour ), x, y, w, h );
     smp::error::CheckGdi( gdiRet, "FillRectangle" );
 }
 
@@ -454,8 +492,8 @@ void JsGdiGraphics::GdiAlphaBlend( JsGdiRawBitmap* bitmap,
     const HDC srcDc = bitmap->GetHDC();
     assert( srcDc );
 
-    const HDC hDc = pGdi_->GetHDC();
-    utils::final_action autoHdcReleaser( [pGdi = pGdi_, hDc]() { pGdi->ReleaseHDC( hDc ); } );
+    const HDC hDc = GetHdc();
+    utils::final_action autoHdc( [&] { ReleaseUncachedHdc(); } );
 
     BOOL bRet = ::GdiAlphaBlend( hDc, dstX, dstY, dstW, dstH, srcDc, srcX, srcY, srcW, srcH, BLENDFUNCTION{ AC_SRC_OVER, 0, alpha, AC_SRC_ALPHA } );
     smp::error::CheckWinApi( bRet, "GdiAlphaBlend" );
@@ -487,8 +525,8 @@ void JsGdiGraphics::GdiDrawBitmap( JsGdiRawBitmap* bitmap,
     HDC srcDc = bitmap->GetHDC();
     assert( srcDc );
 
-    HDC hDc = pGdi_->GetHDC();
-    utils::final_action autoHdcReleaser( [pGdi = pGdi_, hDc]() { pGdi->ReleaseHDC( hDc ); } );
+    const HDC hDc = GetHdc();
+    utils::final_action autoHdc( [&] { ReleaseUncachedHdc(); } );
 
     BOOL bRet;
     if ( dstW == srcW && dstH == srcH )
@@ -514,8 +552,8 @@ void JsGdiGraphics::GdiDrawText( const std::wstring& str, JsGdiFont* font, uint3
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
     SmpException::ExpectTrue( font, "font argument is null" );
 
-    const HDC hDc = pGdi_->GetHDC();
-    utils::final_action autoHdcReleaser( [pGdi = pGdi_, hDc] { pGdi->ReleaseHDC( hDc ); } );
+    const HDC hDc = GetHdc();
+    utils::final_action autoHdc( [&] { ReleaseUncachedHdc(); } );
     gdi::ObjectSelector autoFont( hDc, font->GetHFont() );
 
     RECT rc{ x, y, static_cast<LONG>( x + w ), static_cast<LONG>( y + h ) };
@@ -584,19 +622,12 @@ JSObject* JsGdiGraphics::MeasureString( const std::wstring& str, JsGdiFont* font
     Gdiplus::Font* fn = font->GdiFont();
     assert( fn );
 
-    Gdiplus::StringFormat fmt = Gdiplus::StringFormat::GenericTypographic();
-    if ( flags != 0 )
-    {
-        fmt.SetAlignment( ( Gdiplus::StringAlignment )( ( flags >> 28 ) & 0x3 ) );     //0xf0000000
-        fmt.SetLineAlignment( ( Gdiplus::StringAlignment )( ( flags >> 24 ) & 0x3 ) ); //0x0f000000
-        fmt.SetTrimming( ( Gdiplus::StringTrimming )( ( flags >> 20 ) & 0x7 ) );       //0x00f00000
-        fmt.SetFormatFlags( ( Gdiplus::StringFormatFlags )( flags & 0x7FFF ) );        //0x0000ffff
-    }
+    ReleaseHdc();
 
     Gdiplus::RectF bound;
     int chars, lines;
 
-    Gdiplus::Status gdiRet = pGdi_->MeasureString( str.c_str(), -1, fn, Gdiplus::RectF( x, y, w, h ), &fmt, &bound, &chars, &lines );
+    Gdiplus::Status gdiRet = pGdi_->MeasureString( str.c_str(), -1, fn, Gdiplus::RectF( x, y, w, h ), &GetStringFormat( flags ), &bound, &chars, &lines );
     smp::error::CheckGdi( gdiRet, "MeasureString" );
 
     return JsMeasureStringInfo::CreateJs( pJsCtx_, bound.X, bound.Y, bound.Width, bound.Height, lines, chars );
@@ -617,10 +648,21 @@ JSObject* JsGdiGraphics::MeasureStringWithOpt( size_t optArgCount, const std::ws
     }
 }
 
+void JsGdiGraphics::Replay( JsGdiDrawList* drawList )
+{
+    SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
+    SmpException::ExpectTrue( drawList, "drawList argument is null" );
+
+    ReleaseHdc();
+    drawList->Execute( *pGdi_ );
+}
+
 void JsGdiGraphics::SetInterpolationMode( uint32_t mode )
 {
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
 
+    ReleaseHdc();
+
     Gdiplus::Status gdiRet = pGdi_->SetInterpolationMode( (Gdiplus::InterpolationMode)mode );
     smp::error::CheckGdi( gdiRet, "SetInterpolationMode" );
 }
@@ -642,6 +684,8 @@ void JsGdiGraphics::SetSmoothingMode( uint32_t mode )
 {
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
 
+    ReleaseHdc();
+
     Gdiplus::Status gdiRet = pGdi_->SetSmoothingMode( (Gdiplus::SmoothingMode)mode );
     smp::error::CheckGdi( gdiRet, "SetSmoothingMode" );
 }
@@ -663,6 +707,8 @@ void JsGdiGraphics::SetTextRenderingHint( uint32_t mode )
 {
     SmpException::ExpectTrue( pGdi_, "Internal error: Gdiplus::Graphics object is null" );
 
+    ReleaseHdc();
+
     Gdiplus::Status gdiRet = pGdi_->SetTextRenderingHint( (Gdiplus::TextRenderingHint)mode );
     smp::error::CheckGdi( gdiRet, "SetTextRenderingHint" );
 }
@@ -712,6 +758,90 @@ void JsGdiGraphics::GetRoundRectPath( Gdiplus::GraphicsPath& gp, const Gdiplus::
     smp::error::CheckGdi( gdiRet, "CloseFigure" );
 }
 
+void JsGdiGraphics::SetStringFormatFlags( Gdiplus::StringFormat& fmt, uint32_t flags )
+{
+    if ( !flags )
+    {
+        return;
+    }
+
+    Gdiplus::Status gdiRet = fmt.SetAlignment( ( Gdiplus::StringAlignment )( ( flags >> 28 ) & 0x3 ) ); //0xf0000000
+    smp::error::CheckGdi( gdiRet, "SetAlignment" );
+
+    gdiRet = fmt.SetLineAlignment( ( Gdiplus::StringAlignment )( ( flags >> 24 ) & 0x3 ) ); //0x0f000000
+    smp::error::CheckGdi( gdiRet, "SetLineAlignment" );
+
+    gdiRet = fmt.SetTrimming( ( Gdiplus::StringTrimming )( ( flags >> 20 ) & 0x7 ) ); //0x00f00000
+    smp::error::CheckGdi( gdiRet, "SetTrimming" );
+
+    gdiRet = fmt.SetFormatFlags( ( Gdiplus::StringFormatFlags )( flags & 0x7FFF ) ); //0x0000ffff
+    smp::error::CheckGdi( gdiRet, "SetFormatFlags" );
+}
+
+void JsGdiGraphics::ReleaseHdc()
+{
+    if ( !hDc_ )
+    {
+        return;
+    }
+
+    assert( pGdi_ );
+    pGdi_->ReleaseHDC( hDc_ );
+    hDc_ = nullptr;
+}
+
+Gdiplus::SolidBrush& JsGdiGraphics::GetSolidBrush( uint32_t colour )
+{
+    auto& pBrush = solidBrushes_[colour];
+    if ( !pBrush )
+    {
+        auto pNewBrush = std::make_unique<Gdiplus::SolidBrush>( colour );
+        smp::error::CheckGdiPlusObject( pNewBrush );
+
+        pBrush = std::move( pNewBrush );
+    }
+
+    return *pBrush;
+}
+
+Gdiplus::Pen& JsGdiGraphics::GetPen( uint32_t colour, float lineWidth, bool hasRoundCaps )
+{
+    auto& pPen = pens_[std::make_tuple( colour, lineWidth, hasRoundCaps )];
+    if ( !pPen )
+    {
+        auto pNewPen = std::make_unique<Gdiplus::Pen>( colour, lineWidth );
+        smp::error::CheckGdiPlusObject( pNewPen );
+
+        if ( hasRoundCaps )
+        {
+            Gdiplus::Status gdiRet = pNewPen->SetStartCap( Gdiplus::LineCapRound );
+            smp::error::CheckGdi( gdiRet, "SetStartCap" );
+
+            gdiRet = pNewPen->SetEndCap( Gdiplus::LineCapRound );
+            smp::error::CheckGdi( gdiRet, "SetEndCap" );
+        }
+
+        pPen = std::move( pNewPen );
+    }
+
+    return *pPen;
+}
+
+Gdiplus::StringFormat& JsGdiGraphics::GetStringFormat( uint32_t flags )
+{
+    auto& pFormat = stringFormats_[flags];
+    if ( !pFormat )
+    {
+        auto pNewFormat = std::make_unique<Gdiplus::StringFormat>( Gdiplus::StringFormat::GenericTypographic() );
+        smp::error::CheckGdiPlusObject( pNewFormat );
+        SetStringFormatFlags( *pNewFormat, flags );
+
+        pFormat = std::move( pNewFormat );
+    }
+
+    return *pFormat;
+}
+
 void JsGdiGraphics::ParsePoints( JS::HandleValue jsValue, std::vector<Gdiplus::PointF>& gdiPoints )
 {
     bool isX = true;
@@ -2,7 +2,11 @@
 
 #include <js_objects/object_base.h>
 
+#include <map>
+#include <memory>
 #include <optional>
+#include <tuple>
+#include <unordered_map>
 
 class JSObject;
 struct JSContext;
@@ -17,6 +21,7 @@ namespace mozjs
 
 class JsGdiFont;
 class JsGdiBitmap;
+class JsGdiDrawList;
 class JsGdiRawBitmap;
 
 class JsGdiGraphics
@@ -40,8 +45,30 @@ public:
     static size_t GetInternalSize();
 
 public:
-    Gdiplus::Graphics* GetGraphicsObject() const;
-    void SetGraphicsObject( Gdiplus::Graphics* graphics );
+    /// @brief Returns graphics object for direct usage (HDC is released if needed).
+    Gdiplus::Graphics* GetGraphicsObject();
+    /// @brief Sets new graphics object (e.g. for the next `on_paint`).
+    /// @details Releases HDC and clears cached GDI+ objects of the previous graphics object.
+    /// @param cacheHdc Whether HDC should be kept acquired between calls (see GetHdc).
+    ///                 Must not be used for the graphics of a bitmap: bitmap is locked while its HDC is acquired.
+    void SetGraphicsObject( Gdiplus::Graphics* graphics, bool cacheHdc = false );
+    /// @brief Returns HDC of the graphics object.
+    /// @details If HDC caching is enabled, HDC is kept acquired until a GDI+ method is called (or graphics object is changed),
+    ///          so that a run of consecutive GDI calls causes only a single GDI+ flush.
+    ///          Otherwise ReleaseUncachedHdc must be called when HDC is no longer needed.
+    /// @throw smp::SmpException
+    HDC GetHdc();
+    /// @brief Releases HDC, unless HDC caching is enabled.
+    void ReleaseUncachedHdc();
+
+    /// @throw smp::SmpException
+    static void DrawImageImpl( Gdiplus::Graphics& graphics, Gdiplus::Bitmap& img,
+                               const Gdiplus::RectF& dstRect, const Gdiplus::RectF& srcRect,
+                               float angle, uint8_t alpha );
+    /// @throw smp::SmpException
+    static void GetRoundRectPath( Gdiplus::GraphicsPath& gp, const Gdiplus::RectF& rect, float arc_width, float arc_height );
+    /// @throw smp::SmpException
+    static void SetStringFormatFlags( Gdiplus::StringFormat& fmt, uint32_t flags );
 
 public:
     uint32_t CalcTextHeight( const std::wstring& str, JsGdiFont* font );
@@ -98,6 +125,7 @@ public:
     JSObject* MeasureStringWithOpt( size_t optArgCount, const std::wstring& str, JsGdiFont* font,
                                     float x, float y, float w, float h,
                                     uint32_t flags );
+    void Replay( JsGdiDrawList* drawList );
     void SetInterpolationMode( uint32_t mode = 0 );
     void SetInterpolationModeWithOpt( size_t optArgCount, uint32_t mode );
     void SetSmoothingMode( uint32_t mode = 0 );
@@ -108,12 +136,31 @@ public:
 private:
     JsGdiGraphics( JSContext* cx );
 
-    void GetRoundRectPath( Gdiplus::GraphicsPath& gp, const Gdiplus::RectF& rect, float arc_width, float arc_height );
     void ParsePoints( JS::HandleValue jsValue, std::vector<Gdiplus::PointF>& gdiPoints );
 
+    /// @brief Must be called before any GDI+ operation on pGdi_
+    void ReleaseHdc();
+
+    /// @throw smp::SmpException
+    Gdiplus::SolidBrush& GetSolidBrush( uint32_t colour );
+    /// @throw smp::SmpException
+    Gdiplus::Pen& GetPen( uint32_t colour, float lineWidth, bool hasRoundCaps = false );
+    /// @throw smp::SmpException
+    Gdiplus::StringFormat& GetStringFormat( uint32_t flags );
+
 private:
     JSContext* pJsCtx_ = nullptr;
     Gdiplus::Graphics* pGdi_ = nullptr;
+
+    HDC hDc_ = nullptr;
+    bool cacheHdc_ = false;
+    /// @brief Amount of GetHDC calls (i.e. GDI+ flushes) for the current graphics object
+    uint32_t hdcAcquireCount_ = 0;
+
+    // GDI+ objects are cached only while the graphics object is set (i.e. for the duration of `on_paint`)
+    std::unordered_map<uint32_t, std::unique_ptr<Gdiplus::SolidBrush>> solidBrushes_;
+    std::map<std::tuple<uint32_t, float, bool>, std::unique_ptr<Gdiplus::Pen>> pens_;
+    std::unordered_map<uint32_t, std::unique_ptr<Gdiplus::StringFormat>> stringFormats_;
 };
 
 } // namespace mozjs
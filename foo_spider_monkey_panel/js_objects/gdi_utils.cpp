@@ -5,9 +5,12 @@
 #include <js_engine/js_to_native_invoker.h>
 #include <js_objects/gdi_font.h>
 #include <js_objects/gdi_bitmap.h>
+#include <js_objects/gdi_draw_list.h>
 #include <js_utils/js_error_helper.h>
 #include <js_utils/js_object_helper.h>
 #include <js_utils/js_image_helpers.h>
+#include <utils/background_snapshot.h>
+#include <utils/font_cache.h>
 #include <utils/gdi_helpers.h>
 #include <utils/gdi_error_helpers.h>
 #include <utils/scope_helpers.h>
@@ -41,15 +44,23 @@ JSClass jsClass = {
     &jsOps
 };
 
+MJS_DEFINE_JS_FN_FROM_NATIVE( CreateDrawList, JsGdiUtils::CreateDrawList )
 MJS_DEFINE_JS_FN_FROM_NATIVE( CreateImage, JsGdiUtils::CreateImage )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( CreateImageFromBuffer, JsGdiUtils::CreateImageFromBuffer, JsGdiUtils::CreateImageFromBufferWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( Font, JsGdiUtils::Font, JsGdiUtils::FontWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE( GetBackgroundSnapshotStats, JsGdiUtils::GetBackgroundSnapshotStats )
+MJS_DEFINE_JS_FN_FROM_NATIVE( GetFontCacheStats, JsGdiUtils::GetFontCacheStats )
 MJS_DEFINE_JS_FN_FROM_NATIVE( Image, JsGdiUtils::Image )
 MJS_DEFINE_JS_FN_FROM_NATIVE( LoadImageAsync, JsGdiUtils::LoadImageAsync )
 MJS_DEFINE_JS_FN_FROM_NATIVE( LoadImageAsyncV2, JsGdiUtils::LoadImageAsyncV2 )
 
 const JSFunctionSpec jsFunctions[] = {
+    JS_FN( "CreateDrawList", CreateDrawList, 0, DefaultPropsFlags() ),
     JS_FN( "CreateImage", CreateImage, 2, DefaultPropsFlags() ),
+    JS_FN( "CreateImageFromBuffer", CreateImageFromBuffer, 3, DefaultPropsFlags() ),
     JS_FN( "Font", Font, 2, DefaultPropsFlags() ),
+    JS_FN( "GetBackgroundSnapshotStats", GetBackgroundSnapshotStats, 0, DefaultPropsFlags() ),
+    JS_FN( "GetFontCacheStats", GetFontCacheStats, 0, DefaultPropsFlags() ),
     JS_FN( "Image", Image, 1, DefaultPropsFlags() ),
     JS_FN( "LoadImageAsync", LoadImageAsync, 2, DefaultPropsFlags() ),
     JS_FN( "LoadImageAsyncV2", LoadImageAsyncV2, 2, DefaultPropsFlags() ),
@@ -89,6 +100,11 @@ size_t JsGdiUtils::GetInternalSize()
     return 0;
 }
 
+JSObject* JsGdiUtils::CreateDrawList()
+{
+    return JsGdiDrawList::CreateJs( pJsCtx_ );
+}
+
 JSObject* JsGdiUtils::CreateImage( uint32_t w, uint32_t h )
 {
     std::unique_ptr<Gdiplus::Bitmap> img( new Gdiplus::Bitmap( w, h, PixelFormat32bppPARGB ) );
@@ -97,6 +113,58 @@ JSObject* JsGdiUtils::CreateImage( uint32_t w, uint32_t h )
     return JsGdiBitmap::CreateJs( pJsCtx_, std::move( img ) );
 }
 
+JSObject* JsGdiUtils::CreateImageFromBuffer( uint32_t w, uint32_t h, JS::HandleValue buffer, bool premultiplied )
+{
+    SmpException::ExpectTrue( buffer.isObject() && JS_IsArrayBufferViewObject( &buffer.toObject() ), "buffer argument is not a typed array" );
+
+    JS::RootedObject jsArray( pJsCtx_, &buffer.toObject() );
+    const uint64_t byteLength = JS_GetArrayBufferViewByteLength( jsArray );
+    const uint64_t expectedByteLength = static_cast<uint64_t>( w ) * h * 4;
+    SmpException::ExpectTrue( byteLength == expectedByteLength,
+                              "Buffer size does not match image dimensions: expected {} bytes, got {}",
+                              expectedByteLength,
+                              byteLength );
+
+    std::unique_ptr<Gdiplus::Bitmap> img( new Gdiplus::Bitmap( w, h, PixelFormat32bppPARGB ) );
+    smp::error::CheckGdiPlusObject( img );
+
+    {
+        JS::AutoCheckCannotGC nogc;
+        bool isShared;
+        void* pJsData = JS_GetArrayBufferViewData( jsArray, &isShared, nogc );
+
+        Gdiplus::BitmapData bmpdata{};
+        bmpdata.Width = w;
+        bmpdata.Height = h;
+        bmpdata.Stride = static_cast<int>( w * 4 );
+        bmpdata.PixelFormat = ( premultiplied ? PixelFormat32bppPARGB : PixelFormat32bppARGB );
+        bmpdata.Scan0 = pJsData;
+
+        // pixels are copied (and premultiplied, if needed) by GDI+ on unlock
+        const Gdiplus::Rect rect{ 0, 0, static_cast<int>( w ), static_cast<int>( h ) };
+        Gdiplus::Status gdiRet = img->LockBits( &rect, Gdiplus::ImageLockModeWrite | Gdiplus::ImageLockModeUserInputBuf, bmpdata.PixelFormat, &bmpdata );
+        smp::error::CheckGdi( gdiRet, "LockBits" );
+
+        gdiRet = img->UnlockBits( &bmpdata );
+        smp::error::CheckGdi( gdiRet, "UnlockBits" );
+    }
+
+    return JsGdiBitmap::CreateJs( pJsCtx_, std::move( img ) );
+}
+
+JSObject* JsGdiUtils::CreateImageFromBufferWithOpt( size_t optArgCount, uint32_t w, uint32_t h, JS::HandleValue buffer, bool premultiplied )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return CreateImageFromBuffer( w, h, buffer, premultiplied );
+    case 1:
+        return CreateImageFromBuffer( w, h, buffer );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
 JSObject* JsGdiUtils::Font( const std::wstring& fontName, float pxSize, uint32_t style )
 {
     return JsGdiFont::Constructor( pJsCtx_, fontName, pxSize, style );
@@ -115,6 +183,38 @@ JSObject* JsGdiUtils::FontWithOpt( size_t optArgCount, const std::wstring& fontN
     }
 }
 
+JSObject* JsGdiUtils::GetBackgroundSnapshotStats()
+{
+    const auto stats = smp::gdi::BackgroundSnapshotCache::GetInstance().GetStats();
+
+    JS::RootedObject jsResult( pJsCtx_, JS_NewPlainObject( pJsCtx_ ) );
+    if ( !jsResult
+         || !JS_DefineProperty( pJsCtx_, jsResult, "reuses", static_cast<double>( stats.reuseCount ), DefaultPropsFlags() )
+         || !JS_DefineProperty( pJsCtx_, jsResult, "recaptures", static_cast<double>( stats.recaptureCount ), DefaultPropsFlags() )
+         || !JS_DefineProperty( pJsCtx_, jsResult, "count", static_cast<uint32_t>( stats.snapshotCount ), DefaultPropsFlags() ) )
+    {
+        throw JsException();
+    }
+
+    return jsResult;
+}
+
+JSObject* JsGdiUtils::GetFontCacheStats()
+{
+    const auto stats = smp::utils::FontCache::GetInstance().GetStats();
+
+    JS::RootedObject jsResult( pJsCtx_, JS_NewPlainObject( pJsCtx_ ) );
+    if ( !jsResult
+         || !JS_DefineProperty( pJsCtx_, jsResult, "hits", static_cast<double>( stats.hitCount ), DefaultPropsFlags() )
+         || !JS_DefineProperty( pJsCtx_, jsResult, "misses", static_cast<double>( stats.missCount ), DefaultPropsFlags() )
+         || !JS_DefineProperty( pJsCtx_, jsResult, "count", static_cast<uint32_t>( stats.fontCount ), DefaultPropsFlags() ) )
+    {
+        throw JsException();
+    }
+
+    return jsResult;
+}
+
 JSObject* JsGdiUtils::Image( const std::wstring& path )
 {
     std::unique_ptr<Gdiplus::Bitmap> img = smp::image::LoadImage( path );
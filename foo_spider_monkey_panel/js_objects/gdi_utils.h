@@ -31,9 +31,14 @@ public:
     static size_t GetInternalSize();
 
 public:
+    JSObject* CreateDrawList();
     JSObject* CreateImage( uint32_t w, uint32_t h );
+    JSObject* CreateImageFromBuffer( uint32_t w, uint32_t h, JS::HandleValue buffer, bool premultiplied = false );
+    JSObject* CreateImageFromBufferWithOpt( size_t optArgCount, uint32_t w, uint32_t h, JS::HandleValue buffer, bool premultiplied );
     JSObject* Font( const std::wstring& fontName, float pxSize, uint32_t style = 0 );
     JSObject* FontWithOpt( size_t optArgCount, const std::wstring& fontName, float pxSize, uint32_t style );
+    JSObject* GetBackgroundSnapshotStats();
+    JSObject* GetFontCacheStats();
     JSObject* Image( const std::wstring& path );
     std::uint32_t LoadImageAsync( uint32_t hWnd, const std::wstring& path );
     JSObject* LoadImageAsyncV2( uint32_t hWnd, const std::wstring& path );
@@ -0,0 +1,162 @@
+#include <stdafx.h>
+#include "active_x_type_cache.h"
+
+#include <utils/scope_helpers.h>
+#include <utils/winapi_error_helpers.h>
+
+using namespace smp;
+
+namespace mozjs
+{
+
+size_t ActiveXTypeCache::GuidHasher::operator()( const GUID& guid ) const noexcept
+{
+    const uint64_t guid64_1 =
+        ( static_cast<uint64_t>( guid.Data1 ) << 32 )
+        | ( static_cast<uint64_t>( guid.Data2 ) << 16 )
+        | guid.Data3;
+    uint64_t guid64_2;
+    memcpy( &guid64_2, guid.Data4, sizeof( guid.Data4 ) );
+
+    std::hash<std::uint64_t> hash;
+    return hash( guid64_1 ) ^ hash( guid64_2 );
+}
+
+ActiveXTypeCache& ActiveXTypeCache::Get()
+{
+    static ActiveXTypeCache atc;
+    return atc;
+}
+
+std::shared_ptr<ActiveXTypeCache::MemberMap> ActiveXTypeCache::GetMembers( ITypeInfo* pTypeInfo )
+{
+    assert( core_api::is_main_thread() );
+    assert( pTypeInfo );
+
+    TYPEATTR* pAttr = nullptr;
+    HRESULT hr = pTypeInfo->GetTypeAttr( &pAttr );
+    smp::error::CheckHR( hr, "GetTypeAttr" );
+
+    const GUID typeGuid = pAttr->guid;
+    pTypeInfo->ReleaseTypeAttr( pAttr );
+
+    const bool canCache = ( typeGuid != GUID_NULL && typeGuid != IID_IDispatch );
+    if ( canCache )
+    {
+        if ( auto it = typeMembers_.find( typeGuid ); it != typeMembers_.cend() )
+        {
+            return it->second;
+        }
+    }
+
+    auto pMembers = std::make_shared<MemberMap>();
+    ParseTypeInfoRecursive( pTypeInfo, *pMembers );
+
+    if ( canCache )
+    {
+        typeMembers_.emplace( typeGuid, pMembers );
+    }
+
+    return pMembers;
+}
+
+void ActiveXTypeCache::ParseTypeInfoRecursive( ITypeInfo* pTypeInfo, MemberMap& members )
+{
+    TYPEATTR* pAttr = nullptr;
+    HRESULT hr = pTypeInfo->GetTypeAttr( &pAttr );
+    smp::error::CheckHR( hr, "GetTypeAttr" );
+
+    utils::final_action autoTypeAttr( [pTypeInfo, pAttr] {
+        pTypeInfo->ReleaseTypeAttr( pAttr );
+    } );
+
+    // memid of dispinterface and dual interface members is the same as DISPID returned by GetIDsOfNames
+    const bool hasStableDispIds = ( TKIND_DISPATCH == pAttr->typekind || ( pAttr->wTypeFlags & TYPEFLAG_FDUAL ) );
+    ParseTypeInfo( pTypeInfo, hasStableDispIds, members );
+
+    if ( !( pAttr->wTypeFlags & TYPEFLAG_FRESTRICTED )
+         && ( TKIND_DISPATCH == pAttr->typekind || TKIND_INTERFACE == pAttr->typekind )
+         && pAttr->cImplTypes )
+    {
+        for ( auto i: ranges::view::indices( pAttr->cImplTypes ) )
+        {
+            HREFTYPE hRef = 0;
+            hr = pTypeInfo->GetRefTypeOfImplType( i, &hRef );
+            smp::error::CheckHR( hr, "GetRefTypeOfImplType" );
+
+            ITypeInfo* pTypeInfoCur = nullptr;
+            hr = pTypeInfo->GetRefTypeInfo( hRef, &pTypeInfoCur );
+            if ( SUCCEEDED( hr ) && pTypeInfoCur )
+            {
+                utils::final_action autoTypeInfo( [pTypeInfoCur] {
+                    pTypeInfoCur->Release();
+                } );
+
+                ParseTypeInfoRecursive( pTypeInfoCur, members );
+            }
+        }
+    }
+}
+
+void ActiveXTypeCache::ParseTypeInfo( ITypeInfo* pTypeInfo, bool hasStableDispIds, MemberMap& members )
+{
+    const auto setDispId = [hasStableDispIds]( MemberInfo& member, MEMBERID memId ) {
+        if ( hasStableDispIds && !member.hasDispId )
+        {
+            member.hasDispId = true;
+            member.dispId = memId;
+        }
+    };
+
+    VARDESC* vardesc;
+    for ( size_t i = 0; pTypeInfo->GetVarDesc( i, &vardesc ) == S_OK; ++i )
+    {
+        _bstr_t name;
+        if ( pTypeInfo->GetDocumentation( vardesc->memid, name.GetAddress(), nullptr, nullptr, nullptr ) == S_OK )
+        {
+            if ( !( vardesc->wVarFlags & VARFLAG_FRESTRICTED )
+                 && !( vardesc->wVarFlags & VARFLAG_FHIDDEN ) )
+            {
+                auto& member = members[name.GetBSTR()];
+                member.isGet = true;
+                member.isPut = true;
+                setDispId( member, vardesc->memid );
+            }
+        }
+        pTypeInfo->ReleaseVarDesc( vardesc );
+    }
+
+    FUNCDESC* funcdesc;
+    for ( size_t i = 0; pTypeInfo->GetFuncDesc( i, &funcdesc ) == S_OK; ++i )
+    {
+        _bstr_t name;
+        if ( pTypeInfo->GetDocumentation( funcdesc->memid, name.GetAddress(), nullptr, nullptr, nullptr ) == S_OK )
+        {
+            if ( !( funcdesc->wFuncFlags & FUNCFLAG_FRESTRICTED )
+                 && !( funcdesc->wFuncFlags & FUNCFLAG_FHIDDEN ) )
+            {
+                auto& member = members[name.GetBSTR()];
+                if ( INVOKE_PROPERTYPUT == funcdesc->invkind )
+                {
+                    member.isPut = true;
+                }
+                if ( INVOKE_PROPERTYPUTREF == funcdesc->invkind )
+                {
+                    member.isPutRef = true;
+                }
+                if ( INVOKE_PROPERTYGET == funcdesc->invkind )
+                {
+                    member.isGet = true;
+                }
+                if ( INVOKE_FUNC == funcdesc->invkind )
+                {
+                    member.isInvoke = true;
+                }
+                setDispId( member, funcdesc->memid );
+            }
+        }
+        pTypeInfo->ReleaseFuncDesc( funcdesc );
+    }
+}
+
+} // namespace mozjs
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <oleauto.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace mozjs
+{
+
+/// @brief Process-wide cache of ActiveX member tables.
+///        Type info is parsed only once per COM type (instead of once per ActiveXObject),
+///        so that objects of the same type share member flags and DISPIDs.
+class ActiveXTypeCache
+{
+public:
+    struct MemberInfo
+    {
+        bool isGet = false;
+        bool isPut = false;
+        bool isPutRef = false;
+        bool isInvoke = false;
+        bool hasDispId = false;
+        DISPID dispId{};
+    };
+
+    using MemberMap = std::unordered_map<std::wstring, MemberInfo>;
+
+public:
+    ~ActiveXTypeCache() = default;
+    ActiveXTypeCache( const ActiveXTypeCache& ) = delete;
+    ActiveXTypeCache& operator=( const ActiveXTypeCache& ) = delete;
+
+    static ActiveXTypeCache& Get();
+
+    /// @brief Returns member table for the type, parses type info if it's not cached yet.
+    /// @details Types without a valid GUID are not cached.
+    /// @throw smp::SmpException
+    std::shared_ptr<MemberMap> GetMembers( ITypeInfo* pTypeInfo );
+
+private:
+    ActiveXTypeCache() = default;
+
+    static void ParseTypeInfoRecursive( ITypeInfo* pTypeInfo, MemberMap& members );
+    static void ParseTypeInfo( ITypeInfo* pTypeInfo, bool hasStableDispIds, MemberMap& members );
+
+private:
+    struct GuidHasher
+    {
+        size_t operator()( const GUID& guid ) const noexcept;
+    };
+
+    std::unordered_map<GUID, std::shared_ptr<MemberMap>, GuidHasher> typeMembers_;
+};
+
+} // namespace mozjs
@@ -49,52 +49,48 @@ JS::Value FbProperties::GetProperty( const std::wstring& propName, JS::HandleVal
 {
     std::wstring trimmedPropName( smp::string::Trim<wchar_t>( propName ) );
 
-    bool hasProperty = false;
-    if ( properties_.count( trimmedPropName ) )
+    if ( auto it = properties_.find( trimmedPropName ); it != properties_.end() )
     {
-        hasProperty = true;
-    }
-    else
-    {
-        auto prop = parentPanel_.get_config_prop().get_config_item( trimmedPropName );
-        if ( prop )
-        {
-            hasProperty = true;
-
-            JS::RootedValue jsProp( pJsCtx_ );
-            DeserializeJsValue( pJsCtx_, *prop, &jsProp );
-            properties_.emplace( trimmedPropName, std::make_unique<HeapElement>( jsProp ) );
-        }
+        return it->second->value.get();
     }
 
-    if ( !hasProperty )
+    auto prop = parentPanel_.get_config_prop().get_config_item( trimmedPropName );
+    if ( !prop )
     {
         if ( propDefaultValue.isNullOrUndefined() )
-        { // Not a error: user does not want to set default value            
+        { // Not a error: user does not want to set default value
             return JS::NullValue();
         }
 
         SetProperty( trimmedPropName, propDefaultValue );
+
+        prop = parentPanel_.get_config_prop().get_config_item( trimmedPropName );
+        assert( prop );
     }
 
-    return properties_[trimmedPropName]->value.get();
+    // Value is decoded only on the first call: structured values are not copied either,
+    // their changes are not saved until SetProperty (which also drops the cached value).
+    JS::RootedValue jsProp( pJsCtx_ );
+    DeserializeJsValue( pJsCtx_, *prop, &jsProp );
+    properties_.emplace( trimmedPropName, std::make_unique<HeapElement>( jsProp ) );
+
+    return jsProp;
 }
 
 void FbProperties::SetProperty( const std::wstring& propName, JS::HandleValue propValue )
 {
     std::wstring trimmedPropName( smp::string::Trim<wchar_t>( propName ) );
 
+    // cached value is refilled by GetProperty
+    properties_.erase( trimmedPropName );
+
     if ( propValue.isNullOrUndefined() )
     {
         parentPanel_.get_config_prop().remove_config_item( trimmedPropName );
-        properties_.erase( trimmedPropName );
         return;
     }
 
-    auto serializedValue = SerializeJsValue( pJsCtx_, propValue );
-
-    properties_.insert_or_assign( trimmedPropName, std::make_unique<HeapElement>( propValue ) );
-    parentPanel_.get_config_prop().set_config_item( trimmedPropName, serializedValue );
+    parentPanel_.get_config_prop().set_config_item( trimmedPropName, SerializeJsValue( pJsCtx_, propValue ) );
 }
 
 void FbProperties::TraceHeapValue( JSTracer* trc, void* data )
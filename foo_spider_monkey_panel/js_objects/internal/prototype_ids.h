@@ -15,13 +15,16 @@ enum class JsPrototypeId
     FbFileInfo,
     FbMetadbHandle,
     FbMetadbHandleList,
+    FbMetadbHandleListView,
     FbPlaybackQueueItem,
     FbPlayingItemLocation,
     FbProfiler,
+    FbQuery,
     FbTitleFormat,
     FbTooltip,
     FbUiSelectionHolder,
     GdiBitmap,
+    GdiDrawList,
     GdiFont,
     GdiGraphics,
     GdiRawBitmap,
@@ -29,6 +32,7 @@ enum class JsPrototypeId
     MainMenuManager,
     MeasureStringInfo,
     MenuObject,
+    TextFileReader,
     ThemeManager,
     ProrototypeCount
 };
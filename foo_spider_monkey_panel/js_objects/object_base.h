@@ -189,6 +189,18 @@ public:
         }
     }
 
+protected:
+    /// @brief Updates the amount of memory that is accounted for the object,
+    ///        e.g. when it acquires or releases a big internal buffer.
+    void UpdateNativeObjectSize( JSContext* cx, size_t newSize )
+    {
+        auto pJsCompartment = static_cast<JsCompartmentInner*>( JS_GetCompartmentPrivate( js::GetContextCompartment( cx ) ) );
+        assert( pJsCompartment );
+        pJsCompartment->OnHeapDeallocate( nativeObjectSize_ );
+        nativeObjectSize_ = newSize;
+        pJsCompartment->OnHeapAllocate( nativeObjectSize_ );
+    }
+
 private:
     template <typename = typename std::enable_if_t<T::HasProto>>
     [[nodiscard]]
@@ -0,0 +1,175 @@
+#include <stdafx.h>
+#include "text_file_reader.h"
+
+#include <js_engine/js_to_native_invoker.h>
+#include <js_utils/js_error_helper.h>
+#include <js_utils/js_object_helper.h>
+#include <utils/text_file_reader.h>
+
+using namespace smp;
+
+namespace
+{
+
+using namespace mozjs;
+
+JSClassOps jsOps = {
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    JsTextFileReader::FinalizeJsObject,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr
+};
+
+JSClass jsClass = {
+    "TextFileReader",
+    DefaultClassFlags(),
+    &jsOps
+};
+
+MJS_DEFINE_JS_FN_FROM_NATIVE( Close, JsTextFileReader::Close )
+MJS_DEFINE_JS_FN_FROM_NATIVE( ReadChunk, JsTextFileReader::ReadChunk )
+MJS_DEFINE_JS_FN_FROM_NATIVE( ReadLine, JsTextFileReader::ReadLine )
+MJS_DEFINE_JS_FN_FROM_NATIVE( ReadLines, JsTextFileReader::ReadLines )
+MJS_DEFINE_JS_FN_FROM_NATIVE( Seek, JsTextFileReader::Seek )
+
+const JSFunctionSpec jsFunctions[] = {
+    JS_FN( "Close", Close, 0, DefaultPropsFlags() ),
+    JS_FN( "ReadChunk", ReadChunk, 1, DefaultPropsFlags() ),
+    JS_FN( "ReadLine", ReadLine, 0, DefaultPropsFlags() ),
+    JS_FN( "ReadLines", ReadLines, 2, DefaultPropsFlags() ),
+    JS_FN( "Seek", Seek, 1, DefaultPropsFlags() ),
+    JS_FS_END
+};
+
+MJS_DEFINE_JS_FN_FROM_NATIVE( get_CodePage, JsTextFileReader::get_CodePage )
+MJS_DEFINE_JS_FN_FROM_NATIVE( get_LineCount, JsTextFileReader::get_LineCount )
+MJS_DEFINE_JS_FN_FROM_NATIVE( get_LineIndex, JsTextFileReader::get_LineIndex )
+MJS_DEFINE_JS_FN_FROM_NATIVE( get_Size, JsTextFileReader::get_Size )
+
+const JSPropertySpec jsProperties[] = {
+    JS_PSG( "CodePage", get_CodePage, DefaultPropsFlags() ),
+    JS_PSG( "LineCount", get_LineCount, DefaultPropsFlags() ),
+    JS_PSG( "LineIndex", get_LineIndex, DefaultPropsFlags() ),
+    JS_PSG( "Size", get_Size, DefaultPropsFlags() ),
+    JS_PS_END
+};
+
+} // namespace
+
+namespace mozjs
+{
+
+const JSClass JsTextFileReader::JsClass = jsClass;
+const JSFunctionSpec* JsTextFileReader::JsFunctions = jsFunctions;
+const JSPropertySpec* JsTextFileReader::JsProperties = jsProperties;
+const JsPrototypeId JsTextFileReader::PrototypeId = JsPrototypeId::TextFileReader;
+
+JsTextFileReader::JsTextFileReader( JSContext* cx, std::unique_ptr<smp::file::TextFileReader> pReader )
+    : pJsCtx_( cx )
+    , pReader_( std::move( pReader ) )
+{
+}
+
+JsTextFileReader::~JsTextFileReader()
+{
+}
+
+std::unique_ptr<JsTextFileReader>
+JsTextFileReader::CreateNative( JSContext* cx, const std::u8string& path, uint32_t codepage )
+{
+    return std::unique_ptr<JsTextFileReader>( new JsTextFileReader( cx, std::make_unique<smp::file::TextFileReader>( path, codepage ) ) );
+}
+
+size_t JsTextFileReader::GetInternalSize( const std::u8string& /*path*/, uint32_t /*codepage*/ )
+{
+    return sizeof( smp::file::TextFileReader );
+}
+
+void JsTextFileReader::Close()
+{
+    pReader_.reset();
+}
+
+JS::Value JsTextFileReader::ReadChunk( uint32_t maxSize )
+{
+    const auto chunkOpt = GetReader().ReadChunk( maxSize );
+    if ( !chunkOpt )
+    {
+        return JS::NullValue();
+    }
+
+    JS::RootedValue jsValue( pJsCtx_ );
+    convert::to_js::ToValue( pJsCtx_, *chunkOpt, &jsValue );
+
+    return jsValue;
+}
+
+JS::Value JsTextFileReader::ReadLine()
+{
+    const auto lineOpt = GetReader().ReadLine();
+    if ( !lineOpt )
+    {
+        return JS::NullValue();
+    }
+
+    JS::RootedValue jsValue( pJsCtx_ );
+    convert::to_js::ToValue( pJsCtx_, *lineOpt, &jsValue );
+
+    return jsValue;
+}
+
+JSObject* JsTextFileReader::ReadLines( uint32_t start, uint32_t count )
+{
+    const auto lines = GetReader().ReadLines( start, count );
+
+    JS::RootedValue jsValue( pJsCtx_ );
+    convert::to_js::ToArrayValue(
+        pJsCtx_,
+        lines,
+        []( const auto& vec, auto index ) -> const auto& {
+            return vec[index];
+        },
+        &jsValue );
+
+    return &jsValue.toObject();
+}
+
+void JsTextFileReader::Seek( uint32_t lineIdx )
+{
+    GetReader().Seek( lineIdx );
+}
+
+uint32_t JsTextFileReader::get_CodePage()
+{
+    return GetReader().GetCodepage();
+}
+
+uint32_t JsTextFileReader::get_LineCount()
+{
+    return static_cast<uint32_t>( GetReader().GetLineCount() );
+}
+
+uint32_t JsTextFileReader::get_LineIndex()
+{
+    return static_cast<uint32_t>( GetReader().GetCurrentLine() );
+}
+
+uint64_t JsTextFileReader::get_Size()
+{
+    return GetReader().GetSize();
+}
+
+smp::file::TextFileReader& JsTextFileReader::GetReader()
+{
+    SmpException::ExpectTrue( !!pReader_, "File is already closed" );
+    return *pReader_;
+}
+
+} // namespace mozjs
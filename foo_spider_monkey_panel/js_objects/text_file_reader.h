@@ -0,0 +1,64 @@
+#pragma once
+
+#include <js_objects/object_base.h>
+
+#include <memory>
+#include <string>
+
+class JSObject;
+struct JSContext;
+struct JSClass;
+
+namespace smp::file
+{
+class TextFileReader;
+}
+
+namespace mozjs
+{
+
+class JsTextFileReader
+    : public JsObjectBase<JsTextFileReader>
+{
+public:
+    static constexpr bool HasProto = true;
+    static constexpr bool HasGlobalProto = false;
+    static constexpr bool HasProxy = false;
+    static constexpr bool HasPostCreate = false;
+
+    static const JSClass JsClass;
+    static const JSFunctionSpec* JsFunctions;
+    static const JSPropertySpec* JsProperties;
+    static const JsPrototypeId PrototypeId;
+
+public:
+    ~JsTextFileReader();
+
+    static std::unique_ptr<JsTextFileReader> CreateNative( JSContext* cx, const std::u8string& path, uint32_t codepage );
+    static size_t GetInternalSize( const std::u8string& path, uint32_t codepage );
+
+public:
+    void Close();
+    JS::Value ReadChunk( uint32_t maxSize );
+    JS::Value ReadLine();
+    JSObject* ReadLines( uint32_t start, uint32_t count );
+    void Seek( uint32_t lineIdx );
+
+public:
+    uint32_t get_CodePage();
+    uint32_t get_LineCount();
+    uint32_t get_LineIndex();
+    uint64_t get_Size();
+
+private:
+    JsTextFileReader( JSContext* cx, std::unique_ptr<smp::file::TextFileReader> pReader );
+
+    /// @throw smp::SmpException
+    smp::file::TextFileReader& GetReader();
+
+private:
+    JSContext* pJsCtx_ = nullptr;
+    std::unique_ptr<smp::file::TextFileReader> pReader_;
+};
+
+} // namespace mozjs
@@ -106,11 +106,8 @@ void JsThemeManager::DrawThemeBackground( JsGdiGraphics* gr,
 {
     SmpException::ExpectTrue( gr, "gr argument is null" );
 
-    Gdiplus::Graphics* graphics = gr->GetGraphicsObject();
-    assert( graphics );
-
-    HDC dc = graphics->GetHDC();
-    utils::final_action autoHdcReleaser( [graphics, dc]() { graphics->ReleaseHDC( dc ); } );
+    const HDC dc = gr->GetHdc();
+    utils::final_action autoHdc( [gr] { gr->ReleaseUncachedHdc(); } );
 
     const RECT rc{ x, y, static_cast<LONG>( x + w ), static_cast<LONG>( y + h ) };
     const RECT clip_rc{ clip_x, clip_y, static_cast<LONG>( clip_x + clip_y ), static_cast<LONG>( clip_w + clip_h ) };
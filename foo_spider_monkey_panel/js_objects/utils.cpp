@@ -4,9 +4,11 @@
 #include <js_engine/js_to_native_invoker.h>
 #include <js_objects/fb_metadb_handle.h>
 #include <js_objects/gdi_bitmap.h>
+#include <js_objects/text_file_reader.h>
 #include <js_utils/js_error_helper.h>
 #include <js_utils/js_object_helper.h>
 #include <js_utils/js_art_helpers.h>
+#include <js_utils/js_file_helpers.h>
 #include <utils/gdi_error_helpers.h>
 #include <utils/winapi_error_helpers.h>
 #include <utils/art_helpers.h>
@@ -65,15 +67,21 @@ MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( GetAlbumArtV2, JsUtils::GetAlbumArtV2, Js
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetSysColour, JsUtils::GetSysColour );
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetSystemMetrics, JsUtils::GetSystemMetrics );
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( Glob, JsUtils::Glob, JsUtils::GlobWithOpt, 2 );
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( GlobAsync, JsUtils::GlobAsync, JsUtils::GlobAsyncWithOpt, 2 );
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( InputBox, JsUtils::InputBox, JsUtils::InputBoxWithOpt, 2 );
 MJS_DEFINE_JS_FN_FROM_NATIVE( IsKeyPressed, JsUtils::IsKeyPressed );
 MJS_DEFINE_JS_FN_FROM_NATIVE( MapString, JsUtils::MapString );
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( OpenTextFile, JsUtils::OpenTextFile, JsUtils::OpenTextFileWithOpt, 1 );
 MJS_DEFINE_JS_FN_FROM_NATIVE( PathWildcardMatch, JsUtils::PathWildcardMatch );
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( ReadINI, JsUtils::ReadINI, JsUtils::ReadINIWithOpt, 1 );
+MJS_DEFINE_JS_FN_FROM_NATIVE( ReadBinaryFileAsync, JsUtils::ReadBinaryFileAsync );
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( ReadTextFile, JsUtils::ReadTextFile, JsUtils::ReadTextFileWithOpt, 1 );
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( ReadTextFileAsync, JsUtils::ReadTextFileAsync, JsUtils::ReadTextFileAsyncWithOpt, 1 );
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( ShowHtmlDialog, JsUtils::ShowHtmlDialog, JsUtils::ShowHtmlDialogWithOpt, 1 );
+MJS_DEFINE_JS_FN_FROM_NATIVE( StatAsync, JsUtils::StatAsync );
 MJS_DEFINE_JS_FN_FROM_NATIVE( WriteINI, JsUtils::WriteINI );
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( WriteTextFile, JsUtils::WriteTextFile, JsUtils::WriteTextFileWithOpt, 1 );
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( WriteTextFileAsync, JsUtils::WriteTextFileAsync, JsUtils::WriteTextFileAsyncWithOpt, 1 );
 
 const JSFunctionSpec jsFunctions[] = {
     JS_FN( "CheckComponent", CheckComponent, 1, DefaultPropsFlags() ),
@@ -89,15 +97,21 @@ const JSFunctionSpec jsFunctions[] = {
     JS_FN( "GetSysColour", GetSysColour, 1, DefaultPropsFlags() ),
     JS_FN( "GetSystemMetrics", GetSystemMetrics, 1, DefaultPropsFlags() ),
     JS_FN( "Glob", Glob, 1, DefaultPropsFlags() ),
+    JS_FN( "GlobAsync", GlobAsync, 2, DefaultPropsFlags() ),
     JS_FN( "InputBox", InputBox, 3, DefaultPropsFlags() ),
     JS_FN( "IsKeyPressed", IsKeyPressed, 1, DefaultPropsFlags() ),
     JS_FN( "MapString", MapString, 3, DefaultPropsFlags() ),
+    JS_FN( "OpenTextFile", OpenTextFile, 1, DefaultPropsFlags() ),
     JS_FN( "PathWildcardMatch", PathWildcardMatch, 2, DefaultPropsFlags() ),
     JS_FN( "ReadINI", ReadINI, 3, DefaultPropsFlags() ),
+    JS_FN( "ReadBinaryFileAsync", ReadBinaryFileAsync, 2, DefaultPropsFlags() ),
     JS_FN( "ReadTextFile", ReadTextFile, 1, DefaultPropsFlags() ),
+    JS_FN( "ReadTextFileAsync", ReadTextFileAsync, 2, DefaultPropsFlags() ),
     JS_FN( "ShowHtmlDialog", ShowHtmlDialog, 3, DefaultPropsFlags() ),
+    JS_FN( "StatAsync", StatAsync, 2, DefaultPropsFlags() ),
     JS_FN( "WriteINI", WriteINI, 4, DefaultPropsFlags() ),
     JS_FN( "WriteTextFile", WriteTextFile, 2, DefaultPropsFlags() ),
+    JS_FN( "WriteTextFileAsync", WriteTextFileAsync, 3, DefaultPropsFlags() ),
     JS_FS_END
 };
 
@@ -360,7 +374,7 @@ JSObject* JsUtils::GetAlbumArtAsyncV2WithOpt( size_t optArgCount, uint32_t hWnd,
 
 JSObject* JsUtils::GetAlbumArtEmbedded( const std::u8string& rawpath, uint32_t art_id )
 {
-    std::unique_ptr<Gdiplus::Bitmap> artImage( smp::art::GetBitmapFromEmbeddedData( rawpath, art_id ) );
+    std::shared_ptr<Gdiplus::Bitmap> artImage( smp::art::GetBitmapFromEmbeddedData( rawpath, art_id ) );
     if ( !artImage )
     { // Not an error: no art found
         return nullptr;
@@ -386,7 +400,7 @@ JSObject* JsUtils::GetAlbumArtV2( JsFbMetadbHandle* handle, uint32_t art_id, boo
 {
     SmpException::ExpectTrue( handle, "handle argument is null" );
 
-    std::unique_ptr<Gdiplus::Bitmap> artImage( smp::art::GetBitmapFromMetadb( handle->GetHandle(), art_id, need_stub, false, nullptr ) );
+    std::shared_ptr<Gdiplus::Bitmap> artImage( smp::art::GetBitmapFromMetadb( handle->GetHandle(), art_id, need_stub, false, nullptr ) );
     if ( !artImage )
     { // Not an error: no art found
         return nullptr;
@@ -425,22 +439,7 @@ uint32_t JsUtils::GetSystemMetrics( uint32_t index )
 
 JSObject* JsUtils::Glob( const std::u8string& pattern, uint32_t exc_mask, uint32_t inc_mask )
 {
-    std::vector<std::u8string> files;
-    {
-        std::unique_ptr<uFindFile> ff( uFindFirstFile( pattern.c_str() ) );
-        if ( ff )
-        {
-            const std::u8string dir( pattern.c_str(), pfc::scan_filename( pattern.c_str() ) );
-            do
-            {
-                const DWORD attr = ff->GetAttributes();
-                if ( ( attr & inc_mask ) && !( attr & exc_mask ) )
-                {
-                    files.emplace_back( dir + ff->GetFileName() );
-                }
-            } while ( ff->FindNext() );
-        }
-    }
+    const auto files = smp::file::Glob( pattern, exc_mask, inc_mask );
 
     JS::RootedValue jsValue( pJsCtx_ );
     convert::to_js::ToArrayValue(
@@ -469,6 +468,27 @@ JSObject* JsUtils::GlobWithOpt( size_t optArgCount, const std::u8string& pattern
     }
 }
 
+JSObject* JsUtils::GlobAsync( uint32_t hWnd, const std::u8string& pattern, uint32_t exc_mask, uint32_t inc_mask )
+{
+    // Such cast will work only on x86
+    return mozjs::async_file::GetGlobPromise( pJsCtx_, reinterpret_cast<HWND>( hWnd ), pattern, exc_mask, inc_mask );
+}
+
+JSObject* JsUtils::GlobAsyncWithOpt( size_t optArgCount, uint32_t hWnd, const std::u8string& pattern, uint32_t exc_mask, uint32_t inc_mask )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return GlobAsync( hWnd, pattern, exc_mask, inc_mask );
+    case 1:
+        return GlobAsync( hWnd, pattern, exc_mask );
+    case 2:
+        return GlobAsync( hWnd, pattern );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
 std::u8string JsUtils::InputBox( uint32_t hWnd, const std::u8string& prompt, const std::u8string& caption, const std::u8string& def, bool error_on_cancel )
 {
     if ( modal_dialog_scope::can_create() )
@@ -550,6 +570,24 @@ std::wstring JsUtils::MapString( const std::wstring& str, uint32_t lcid, uint32_
     return dst;
 }
 
+JSObject* JsUtils::OpenTextFile( const std::u8string& filePath, uint32_t codepage )
+{
+    return JsTextFileReader::CreateJs( pJsCtx_, filePath, codepage );
+}
+
+JSObject* JsUtils::OpenTextFileWithOpt( size_t optArgCount, const std::u8string& filePath, uint32_t codepage )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return OpenTextFile( filePath, codepage );
+    case 1:
+        return OpenTextFile( filePath );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
 bool JsUtils::PathWildcardMatch( const std::wstring& pattern, const std::wstring& str )
 {
     return PathMatchSpec( str.c_str(), pattern.c_str() );
@@ -588,6 +626,12 @@ std::wstring JsUtils::ReadINIWithOpt( size_t optArgCount, const std::wstring& fi
     }
 }
 
+JSObject* JsUtils::ReadBinaryFileAsync( uint32_t hWnd, const std::wstring& filePath )
+{
+    // Such cast will work only on x86
+    return mozjs::async_file::GetReadBinaryFilePromise( pJsCtx_, reinterpret_cast<HWND>( hWnd ), filePath );
+}
+
 std::wstring JsUtils::ReadTextFile( const std::u8string& filePath, uint32_t codepage )
 {
     return smp::file::ReadFileW( filePath, codepage );
@@ -606,6 +650,25 @@ std::wstring JsUtils::ReadTextFileWithOpt( size_t optArgCount, const std::u8stri
     }
 }
 
+JSObject* JsUtils::ReadTextFileAsync( uint32_t hWnd, const std::u8string& filePath, uint32_t codepage )
+{
+    // Such cast will work only on x86
+    return mozjs::async_file::GetReadTextFilePromise( pJsCtx_, reinterpret_cast<HWND>( hWnd ), filePath, codepage );
+}
+
+JSObject* JsUtils::ReadTextFileAsyncWithOpt( size_t optArgCount, uint32_t hWnd, const std::u8string& filePath, uint32_t codepage )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return ReadTextFileAsync( hWnd, filePath, codepage );
+    case 1:
+        return ReadTextFileAsync( hWnd, filePath );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
 JS::Value JsUtils::ShowHtmlDialog( uint32_t hWnd, const std::wstring& htmlCode, JS::HandleValue options )
 {
     if ( modal_dialog_scope::can_create() )
@@ -644,6 +707,12 @@ JS::Value JsUtils::ShowHtmlDialogWithOpt( size_t optArgCount, uint32_t hWnd, con
     }
 }
 
+JSObject* JsUtils::StatAsync( uint32_t hWnd, const std::wstring& path )
+{
+    // Such cast will work only on x86
+    return mozjs::async_file::GetStatPromise( pJsCtx_, reinterpret_cast<HWND>( hWnd ), path );
+}
+
 bool JsUtils::WriteINI( const std::wstring& filename, const std::wstring& section, const std::wstring& key, const std::wstring& val )
 {
     return WritePrivateProfileString( section.c_str(), key.c_str(), val.c_str(), filename.c_str() );
@@ -669,6 +738,25 @@ bool JsUtils::WriteTextFileWithOpt( size_t optArgCount, const std::wstring& file
     }
 }
 
+JSObject* JsUtils::WriteTextFileAsync( uint32_t hWnd, const std::wstring& filename, const std::u8string& content, bool write_bom )
+{
+    // Such cast will work only on x86
+    return mozjs::async_file::GetWriteTextFilePromise( pJsCtx_, reinterpret_cast<HWND>( hWnd ), filename, content, write_bom );
+}
+
+JSObject* JsUtils::WriteTextFileAsyncWithOpt( size_t optArgCount, uint32_t hWnd, const std::wstring& filename, const std::u8string& content, bool write_bom )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return WriteTextFileAsync( hWnd, filename, content, write_bom );
+    case 1:
+        return WriteTextFileAsync( hWnd, filename, content );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
 std::u8string JsUtils::get_Version()
 {
     return SMP_VERSION;
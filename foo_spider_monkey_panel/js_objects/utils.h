@@ -50,20 +50,30 @@ public:
     uint32_t GetSystemMetrics( uint32_t index );
     JSObject* Glob( const std::u8string& pattern, uint32_t exc_mask = FILE_ATTRIBUTE_DIRECTORY, uint32_t inc_mask = 0xFFFFFFFF );
     JSObject* GlobWithOpt( size_t optArgCount, const std::u8string& pattern, uint32_t exc_mask, uint32_t inc_mask );
+    JSObject* GlobAsync( uint32_t hWnd, const std::u8string& pattern, uint32_t exc_mask = FILE_ATTRIBUTE_DIRECTORY, uint32_t inc_mask = 0xFFFFFFFF );
+    JSObject* GlobAsyncWithOpt( size_t optArgCount, uint32_t hWnd, const std::u8string& pattern, uint32_t exc_mask, uint32_t inc_mask );
     std::u8string InputBox( uint32_t hWnd, const std::u8string& prompt, const std::u8string& caption, const std::u8string& def = "", bool error_on_cancel = false );
     std::u8string InputBoxWithOpt( size_t optArgCount, uint32_t hWnd, const std::u8string& prompt, const std::u8string& caption, const std::u8string& def, bool error_on_cancel );
     bool IsKeyPressed( uint32_t vkey );
     std::wstring MapString( const std::wstring& str, uint32_t lcid, uint32_t flags );
+    JSObject* OpenTextFile( const std::u8string& filePath, uint32_t codepage = CP_ACP );
+    JSObject* OpenTextFileWithOpt( size_t optArgCount, const std::u8string& filePath, uint32_t codepage );
     bool PathWildcardMatch( const std::wstring& pattern, const std::wstring& str );
     std::wstring ReadINI( const std::wstring& filename, const std::wstring& section, const std::wstring& key, const std::wstring& defaultval = L"" );
     std::wstring ReadINIWithOpt( size_t optArgCount, const std::wstring& filename, const std::wstring& section, const std::wstring& key, const std::wstring& defaultval );
+    JSObject* ReadBinaryFileAsync( uint32_t hWnd, const std::wstring& filePath );
     std::wstring ReadTextFile( const std::u8string& filePath, uint32_t codepage = CP_ACP );
     std::wstring ReadTextFileWithOpt( size_t optArgCount, const std::u8string& filePath, uint32_t codepage );
+    JSObject* ReadTextFileAsync( uint32_t hWnd, const std::u8string& filePath, uint32_t codepage = CP_ACP );
+    JSObject* ReadTextFileAsyncWithOpt( size_t optArgCount, uint32_t hWnd, const std::u8string& filePath, uint32_t codepage );
     JS::Value ShowHtmlDialog( uint32_t hWnd, const std::wstring& htmlCode, JS::HandleValue options = JS::UndefinedHandleValue );
     JS::Value ShowHtmlDialogWithOpt( size_t optArgCount, uint32_t hWnd, const std::wstring& htmlCode, JS::HandleValue options );
+    JSObject* StatAsync( uint32_t hWnd, const std::wstring& path );
     bool WriteINI( const std::wstring& filename, const std::wstring& section, const std::wstring& key, const std::wstring& val );
     bool WriteTextFile( const std::wstring& filename, const std::u8string& content, bool write_bom = true );
     bool WriteTextFileWithOpt( size_t optArgCount, const std::wstring& filename, const std::u8string& content, bool write_bom );
+    JSObject* WriteTextFileAsync( uint32_t hWnd, const std::wstring& filename, const std::u8string& content, bool write_bom = true );
+    JSObject* WriteTextFileAsyncWithOpt( size_t optArgCount, uint32_t hWnd, const std::wstring& filename, const std::u8string& content, bool write_bom );
 
 public:
     std::u8string get_Version();
@@ -11,6 +11,9 @@
 #include <js_utils/js_error_helper.h>
 #include <js_utils/js_object_helper.h>
 #include <js_utils/js_property_helper.h>
+#include <utils/file_watcher.h>
+#include <utils/font_cache.h>
+#include <utils/library_query.h>
 #include <utils/scope_helpers.h>
 #include <utils/gdi_helpers.h>
 #include <utils/winapi_error_helpers.h>
@@ -59,17 +62,24 @@ MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( GetColourCUI, JsWindow::GetColourCUI, JsW
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetColourDUI, JsWindow::GetColourDUI )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( GetFontCUI, JsWindow::GetFontCUI, JsWindow::GetFontCUIWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE( GetFontDUI, JsWindow::GetFontDUI )
+MJS_DEFINE_JS_FN_FROM_NATIVE( GetMessageLatencyStats, JsWindow::GetMessageLatencyStats )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( GetProperty, JsWindow::GetProperty, JsWindow::GetPropertyWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE( NotifyOthers, JsWindow::NotifyOthers )
+MJS_DEFINE_JS_FN_FROM_NATIVE( PrintMessageLatencyStats, JsWindow::PrintMessageLatencyStats )
 MJS_DEFINE_JS_FN_FROM_NATIVE( Reload, JsWindow::Reload )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( Repaint, JsWindow::Repaint, JsWindow::RepaintWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( RepaintRect, JsWindow::RepaintRect, JsWindow::RepaintRectWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE( ResetMessageLatencyStats, JsWindow::ResetMessageLatencyStats )
 MJS_DEFINE_JS_FN_FROM_NATIVE( SetCursor, JsWindow::SetCursor )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( SetInterval, JsWindow::SetInterval, JsWindow::SetIntervalWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( SetProperty, JsWindow::SetProperty, JsWindow::SetPropertyWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( SetTimeout, JsWindow::SetTimeout, JsWindow::SetTimeoutWithOpt, 1 )
 MJS_DEFINE_JS_FN_FROM_NATIVE( ShowConfigure, JsWindow::ShowConfigure )
 MJS_DEFINE_JS_FN_FROM_NATIVE( ShowProperties, JsWindow::ShowProperties )
+MJS_DEFINE_JS_FN_FROM_NATIVE( UnwatchPath, JsWindow::UnwatchPath )
+MJS_DEFINE_JS_FN_FROM_NATIVE( UnwatchQuery, JsWindow::UnwatchQuery )
+MJS_DEFINE_JS_FN_FROM_NATIVE_WITH_OPT( WatchPath, JsWindow::WatchPath, JsWindow::WatchPathWithOpt, 1 )
+MJS_DEFINE_JS_FN_FROM_NATIVE( WatchQuery, JsWindow::WatchQuery )
 
 const JSFunctionSpec jsFunctions[] = {
     JS_FN( "ClearInterval", ClearInterval, 1, DefaultPropsFlags() ),
@@ -82,17 +92,24 @@ const JSFunctionSpec jsFunctions[] = {
     JS_FN( "GetColourDUI", GetColourDUI, 1, DefaultPropsFlags() ),
     JS_FN( "GetFontCUI", GetFontCUI, 1, DefaultPropsFlags() ),
     JS_FN( "GetFontDUI", GetFontDUI, 1, DefaultPropsFlags() ),
+    JS_FN( "GetMessageLatencyStats", GetMessageLatencyStats, 0, DefaultPropsFlags() ),
     JS_FN( "GetProperty", GetProperty, 1, DefaultPropsFlags() ),
     JS_FN( "NotifyOthers", NotifyOthers, 2, DefaultPropsFlags() ),
+    JS_FN( "PrintMessageLatencyStats", PrintMessageLatencyStats, 0, DefaultPropsFlags() ),
     JS_FN( "Reload", Reload, 0, DefaultPropsFlags() ),
     JS_FN( "Repaint", Repaint, 0, DefaultPropsFlags() ),
     JS_FN( "RepaintRect", RepaintRect, 4, DefaultPropsFlags() ),
+    JS_FN( "ResetMessageLatencyStats", ResetMessageLatencyStats, 0, DefaultPropsFlags() ),
     JS_FN( "SetCursor", SetCursor, 1, DefaultPropsFlags() ),
     JS_FN( "SetInterval", SetInterval, 2, DefaultPropsFlags() ),
     JS_FN( "SetProperty", SetProperty, 1, DefaultPropsFlags() ),
     JS_FN( "SetTimeout", SetTimeout, 2, DefaultPropsFlags() ),
     JS_FN( "ShowConfigure", ShowConfigure, 0, DefaultPropsFlags() ),
     JS_FN( "ShowProperties", ShowProperties, 0, DefaultPropsFlags() ),
+    JS_FN( "UnwatchPath", UnwatchPath, 1, DefaultPropsFlags() ),
+    JS_FN( "UnwatchQuery", UnwatchQuery, 1, DefaultPropsFlags() ),
+    JS_FN( "WatchPath", WatchPath, 1, DefaultPropsFlags() ),
+    JS_FN( "WatchQuery", WatchQuery, 1, DefaultPropsFlags() ),
     JS_FS_END
 };
 
@@ -185,6 +202,18 @@ void JsWindow::PrepareForGc()
         dropTargetHandler_->RevokeDragDrop();
         dropTargetHandler_.Release();
     }
+    for ( const auto& [watchId, pWatchId]: watchIds_ )
+    {
+        *pWatchId = 0;
+        smp::utils::FileWatcher::GetInstance().Unsubscribe( watchId );
+    }
+    watchIds_.clear();
+    for ( const auto& [watchId, pWatchId]: queryWatchIds_ )
+    {
+        *pWatchId = 0;
+        smp::utils::LibraryQueryManager::GetInstance().Unsubscribe( watchId );
+    }
+    queryWatchIds_.clear();
 
     isFinalized_ = true;
 }
@@ -378,13 +407,13 @@ JSObject* JsWindow::GetFontCUI( uint32_t type, const std::wstring& guidstr )
         return nullptr;
     }
 
-    std::unique_ptr<Gdiplus::Font> pGdiFont( new Gdiplus::Font( parentPanel_.GetHDC(), hFont.get() ) );
-    if ( !gdi::IsGdiPlusObjectValid( pGdiFont ) )
+    auto pFont = smp::utils::FontCache::GetInstance().GetFont( hFont.get() );
+    if ( !pFont )
     { // Not an error: font not found
         return nullptr;
     }
 
-    return JsGdiFont::CreateJs( pJsCtx_, std::move( pGdiFont ), hFont.release(), true );
+    return JsGdiFont::CreateJs( pJsCtx_, pFont );
 }
 
 JSObject* JsWindow::GetFontCUIWithOpt( size_t optArgCount, uint32_t type, const std::wstring& guidstr )
@@ -415,13 +444,60 @@ JSObject* JsWindow::GetFontDUI( uint32_t type )
         return nullptr;
     }
 
-    std::unique_ptr<Gdiplus::Font> pGdiFont( new Gdiplus::Font( parentPanel_.GetHDC(), hFont ) );
-    if ( !gdi::IsGdiPlusObjectValid( pGdiFont ) )
+    auto pFont = smp::utils::FontCache::GetInstance().GetFont( hFont );
+    if ( !pFont )
     { // Not an error: font not found
         return nullptr;
     }
 
-    return JsGdiFont::CreateJs( pJsCtx_, std::move( pGdiFont ), hFont, false );
+    return JsGdiFont::CreateJs( pJsCtx_, pFont );
+}
+
+JSObject* JsWindow::GetMessageLatencyStats()
+{
+    if ( isFinalized_ )
+    {
+        return nullptr;
+    }
+
+    const auto generateHistogramObject = [cx = pJsCtx_]( const smp::utils::HdrHistogram& histogram ) -> JSObject* {
+        JS::RootedObject jsHistogram( cx, JS_NewPlainObject( cx ) );
+        if ( !jsHistogram
+             || !JS_DefineProperty( cx, jsHistogram, "min", static_cast<double>( histogram.GetMin() ), DefaultPropsFlags() )
+             || !JS_DefineProperty( cx, jsHistogram, "mean", histogram.GetMean(), DefaultPropsFlags() )
+             || !JS_DefineProperty( cx, jsHistogram, "p50", static_cast<double>( histogram.GetValueAtPercentile( 50 ) ), DefaultPropsFlags() )
+             || !JS_DefineProperty( cx, jsHistogram, "p90", static_cast<double>( histogram.GetValueAtPercentile( 90 ) ), DefaultPropsFlags() )
+             || !JS_DefineProperty( cx, jsHistogram, "p99", static_cast<double>( histogram.GetValueAtPercentile( 99 ) ), DefaultPropsFlags() )
+             || !JS_DefineProperty( cx, jsHistogram, "max", static_cast<double>( histogram.GetMax() ), DefaultPropsFlags() ) )
+        {
+            throw JsException();
+        }
+        return jsHistogram;
+    };
+
+    JS::RootedObject jsResult( pJsCtx_, JS_NewPlainObject( pJsCtx_ ) );
+    JsException::ExpectTrue( jsResult );
+
+    JS::RootedObject jsQueue( pJsCtx_ );
+    JS::RootedObject jsHandler( pJsCtx_ );
+    JS::RootedObject jsMessageStats( pJsCtx_ );
+    for ( const auto& [msg, pStats]: parentPanel_.GetMessageLatencyStats().GetStats() )
+    {
+        jsQueue = generateHistogramObject( pStats->queueDelay );
+        jsHandler = generateHistogramObject( pStats->handlerTime );
+
+        jsMessageStats = JS_NewPlainObject( pJsCtx_ );
+        if ( !jsMessageStats
+             || !JS_DefineProperty( pJsCtx_, jsMessageStats, "count", static_cast<double>( pStats->queueDelay.GetCount() ), DefaultPropsFlags() )
+             || !JS_DefineProperty( pJsCtx_, jsMessageStats, "queue", jsQueue, DefaultPropsFlags() )
+             || !JS_DefineProperty( pJsCtx_, jsMessageStats, "handler", jsHandler, DefaultPropsFlags() )
+             || !JS_DefineProperty( pJsCtx_, jsResult, panel::MessageLatencyStats::GetMessageName( msg ).c_str(), jsMessageStats, DefaultPropsFlags() ) )
+        {
+            throw JsException();
+        }
+    }
+
+    return jsResult;
 }
 
 JS::Value JsWindow::GetProperty( const std::wstring& name, JS::HandleValue defaultval )
@@ -462,6 +538,19 @@ void JsWindow::NotifyOthers( const std::wstring& name, JS::HandleValue info )
         reinterpret_cast<LPARAM>( &info ) );
 }
 
+void JsWindow::PrintMessageLatencyStats()
+{
+    if ( isFinalized_ )
+    {
+        return;
+    }
+
+    FB2K_console_formatter() << fmt::format( SMP_NAME_WITH_VERSION ": message latency statistics for `{}`:\n{}",
+                                             get_Name(),
+                                             parentPanel_.GetMessageLatencyStats().GenerateReport() )
+                                    .c_str();
+}
+
 void JsWindow::Reload()
 {
     if ( isFinalized_ )
@@ -518,6 +607,16 @@ void JsWindow::RepaintRectWithOpt( size_t optArgCount, uint32_t x, uint32_t y, u
     }
 }
 
+void JsWindow::ResetMessageLatencyStats()
+{
+    if ( isFinalized_ )
+    {
+        return;
+    }
+
+    parentPanel_.GetMessageLatencyStats().Reset();
+}
+
 void JsWindow::SetCursor( uint32_t id )
 {
     if ( isFinalized_ )
@@ -625,6 +724,104 @@ void JsWindow::ShowProperties()
     panel::message_manager::instance().post_msg( parentPanel_.GetHWND(), static_cast<UINT>( InternalAsyncMessage::show_properties ) );
 }
 
+void JsWindow::UnwatchPath( uint32_t watchId )
+{
+    if ( isFinalized_ )
+    {
+        return;
+    }
+
+    const auto it = watchIds_.find( watchId );
+    if ( it == watchIds_.cend() )
+    { // Not an error: might have been already removed
+        return;
+    }
+
+    // drop changes that were already posted
+    *it->second = 0;
+    watchIds_.erase( it );
+
+    smp::utils::FileWatcher::GetInstance().Unsubscribe( watchId );
+}
+
+void JsWindow::UnwatchQuery( uint32_t watchId )
+{
+    if ( isFinalized_ )
+    {
+        return;
+    }
+
+    const auto it = queryWatchIds_.find( watchId );
+    if ( it == queryWatchIds_.cend() )
+    { // Not an error: might have been already removed
+        return;
+    }
+
+    // drop changes that were already posted
+    *it->second = 0;
+    queryWatchIds_.erase( it );
+
+    smp::utils::LibraryQueryManager::GetInstance().Unsubscribe( watchId );
+}
+
+uint32_t JsWindow::WatchPath( const std::wstring& path, bool recursive )
+{
+    if ( isFinalized_ )
+    {
+        return 0;
+    }
+
+    // watch id is not known until subscription is complete
+    auto pWatchId = std::make_shared<uint32_t>( 0 );
+    const auto watchId = smp::utils::FileWatcher::GetInstance().Subscribe(
+        std::filesystem::path( path ),
+        recursive,
+        [hWnd = parentPanel_.GetHWND(), pWatchId]( const std::vector<smp::utils::FileChangeEvent>& events ) {
+            panel::message_manager::instance().post_callback_msg( hWnd,
+                                                                  CallbackMessage::internal_file_changed,
+                                                                  std::make_unique<panel::CallbackDataImpl<std::shared_ptr<uint32_t>, std::vector<smp::utils::FileChangeEvent>>>( pWatchId, events ) );
+        } );
+    *pWatchId = watchId;
+    watchIds_.try_emplace( watchId, pWatchId );
+
+    return watchId;
+}
+
+uint32_t JsWindow::WatchPathWithOpt( size_t optArgCount, const std::wstring& path, bool recursive )
+{
+    switch ( optArgCount )
+    {
+    case 0:
+        return WatchPath( path, recursive );
+    case 1:
+        return WatchPath( path );
+    default:
+        throw SmpException( fmt::format( "Internal error: invalid number of optional arguments specified: {}", optArgCount ) );
+    }
+}
+
+uint32_t JsWindow::WatchQuery( const std::u8string& expression )
+{
+    if ( isFinalized_ )
+    {
+        return 0;
+    }
+
+    // watch id is not known until subscription is complete
+    auto pWatchId = std::make_shared<uint32_t>( 0 );
+    const auto watchId = smp::utils::LibraryQueryManager::GetInstance().Subscribe(
+        expression,
+        [hWnd = parentPanel_.GetHWND(), pWatchId]( const metadb_handle_list& added, const metadb_handle_list& removed ) {
+            panel::message_manager::instance().post_callback_msg( hWnd,
+                                                                  CallbackMessage::internal_library_query_changed,
+                                                                  std::make_unique<panel::CallbackDataImpl<std::shared_ptr<uint32_t>, metadb_handle_list, metadb_handle_list>>( pWatchId, added, removed ) );
+        } );
+    *pWatchId = watchId;
+    queryWatchIds_.try_emplace( watchId, pWatchId );
+
+    return watchId;
+}
+
 uint32_t JsWindow::get_DlgCode()
 {
     if ( isFinalized_ )
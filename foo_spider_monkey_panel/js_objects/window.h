@@ -2,6 +2,8 @@
 
 #include <js_objects/object_base.h>
 
+#include <map>
+#include <memory>
 #include <optional>
 
 class JSObject;
@@ -59,14 +61,17 @@ public: // methods
     JSObject* GetFontCUI( uint32_t type, const std::wstring& guidstr = L"" );
     JSObject* GetFontCUIWithOpt( size_t optArgCount, uint32_t type, const std::wstring& guidstr );
     JSObject* GetFontDUI( uint32_t type );
+    JSObject* GetMessageLatencyStats();
     JS::Value GetProperty( const std::wstring& name, JS::HandleValue defaultval = JS::NullHandleValue );
     JS::Value GetPropertyWithOpt( size_t optArgCount, const std::wstring& name, JS::HandleValue defaultval );
     void NotifyOthers( const std::wstring& name, JS::HandleValue info );
+    void PrintMessageLatencyStats();
     void Reload();
     void Repaint( bool force = false );
     void RepaintWithOpt( size_t optArgCount, bool force );
     void RepaintRect( uint32_t x, uint32_t y, uint32_t w, uint32_t h, bool force = false );
     void RepaintRectWithOpt( size_t optArgCount, uint32_t x, uint32_t y, uint32_t w, uint32_t h, bool force );
+    void ResetMessageLatencyStats();
     void SetCursor( uint32_t id );
     uint32_t SetInterval( JS::HandleValue func, uint32_t delay, JS::HandleValueArray funcArgs = JS::HandleValueArray{ JS::UndefinedHandleValue } );
     uint32_t SetIntervalWithOpt( size_t optArgCount, JS::HandleValue func, uint32_t delay, JS::HandleValueArray funcArgs );
@@ -76,6 +81,11 @@ public: // methods
     uint32_t SetTimeoutWithOpt( size_t optArgCount, JS::HandleValue func, uint32_t delay, JS::HandleValueArray funcArgs );
     void ShowConfigure();
     void ShowProperties();
+    void UnwatchPath( uint32_t watchId );
+    void UnwatchQuery( uint32_t watchId );
+    uint32_t WatchPath( const std::wstring& path, bool recursive = false );
+    uint32_t WatchPathWithOpt( size_t optArgCount, const std::wstring& path, bool recursive );
+    uint32_t WatchQuery( const std::u8string& expression );
 
 public: // props
     uint32_t get_DlgCode();
@@ -122,6 +132,11 @@ private:
     bool isPanelDefined_ = false;
     std::unique_ptr<FbProperties> fbProperties_;
     CComPtr<smp::com::IDropTargetImpl> dropTargetHandler_;
+    /// @brief Values are shared with queued `on_file_changed` messages: set to 0 on unwatch,
+    ///        so that changes which were already posted are not delivered
+    std::map<uint32_t, std::shared_ptr<uint32_t>> watchIds_;
+    /// @brief Same as `watchIds_`, but for `on_library_query_changed` messages
+    std::map<uint32_t, std::shared_ptr<uint32_t>> queryWatchIds_;
 };
 
 } // namespace mozjs
@@ -6,10 +6,13 @@
 
 #include <js_engine/js_container.h>
 #include <utils/art_helpers.h>
+#include <utils/background_snapshot.h>
 #include <utils/error_popup.h>
+#include <utils/file_watcher.h>
 #include <utils/gdi_helpers.h>
 #include <utils/image_helpers.h>
 #include <utils/scope_helpers.h>
+#include <utils/trace_recorder.h>
 
 #include <message_manager.h>
 #include <drop_action_params.h>
@@ -98,10 +101,12 @@ LRESULT js_panel_window::on_message( HWND hwnd, UINT msg, WPARAM wp, LPARAM lp )
             auto optMessage = message_manager::instance().ClaimAsyncMessage( hWnd_, msg, wp, lp );
             if ( optMessage )
             {
-                const auto [asyncMsg, asyncWp, asyncLp] = *optMessage;
+                const auto [asyncMsg, asyncWp, asyncLp, postTime] = *optMessage;
+                const auto claimTime = std::chrono::steady_clock::now();
                 auto retVal = process_async_messages( asyncMsg, asyncWp, asyncLp );
                 if ( retVal )
                 {
+                    messageLatencyStats_.Record( asyncMsg, claimTime - postTime, std::chrono::steady_clock::now() - claimTime );
                     return *retVal;
                 }
             }
@@ -201,8 +206,18 @@ std::optional<LRESULT> js_panel_window::process_window_messages( UINT msg, WPARA
     {
     case WM_DISPLAYCHANGE:
     case WM_THEMECHANGED:
+        gdi::BackgroundSnapshotCache::GetInstance().InvalidateAll();
         update_script();
         return 0;
+    case WM_SYSCOLORCHANGE:
+    {
+        gdi::BackgroundSnapshotCache::GetInstance().InvalidateAll();
+        if ( get_pseudo_transparent() )
+        {
+            message_manager::instance().post_msg( hWnd_, static_cast<UINT>( InternalAsyncMessage::refresh_bg ) );
+        }
+        return 0;
+    }
 
     case WM_ERASEBKGND:
     {
@@ -215,13 +230,15 @@ std::optional<LRESULT> js_panel_window::process_window_messages( UINT msg, WPARA
         {
             return std::nullopt;
         }
+
+        // layout must be up to date before painting
+        flush_size_update();
+
         isPaintInProgress_ = true;
 
         if ( get_pseudo_transparent() && isBgRepaintNeeded_ )
         { // Two pass redraw: paint BG > Repaint() > paint FG
-            RECT rc;
-            GetUpdateRect( hWnd_, &rc, FALSE );
-            RepaintBackground( &rc ); ///< Calls Repaint() inside
+            RepaintBackground(); ///< Might call Repaint() inside
 
             isBgRepaintNeeded_ = false;
             isPaintInProgress_ = false;
@@ -249,7 +266,7 @@ std::optional<LRESULT> js_panel_window::process_window_messages( UINT msg, WPARA
     {
         RECT rect;
         GetClientRect( hWnd_, &rect );
-        on_size( rect.right - rect.left, rect.bottom - rect.top );
+        queue_size_update( rect.right - rect.left, rect.bottom - rect.top );
         if ( get_pseudo_transparent() )
         {
             message_manager::instance().post_msg( hWnd_, static_cast<UINT>( InternalAsyncMessage::refresh_bg ) );
@@ -416,21 +433,48 @@ std::optional<LRESULT> js_panel_window::process_callback_messages( CallbackMessa
         on_playback_time( callbackData );
         return 0;
     }
+    case CallbackMessage::fb_playlist_items_added:
+    {
+        on_playlist_items_added( callbackData );
+        return 0;
+    }
+    case CallbackMessage::fb_playlist_items_removed:
+    {
+        on_playlist_items_removed( callbackData );
+        return 0;
+    }
+    case CallbackMessage::fb_playlist_items_reordered:
+    {
+        on_playlist_items_reordered( callbackData );
+        return 0;
+    }
     case CallbackMessage::fb_volume_change:
     {
         on_volume_change( callbackData );
         return 0;
     }
+    case CallbackMessage::internal_file_changed:
+    {
+        on_file_changed( callbackData );
+        return 0;
+    }
     case CallbackMessage::internal_get_album_art_done:
     {
         on_get_album_art_done( callbackData );
         return 0;
     }
+    case CallbackMessage::internal_library_query_changed:
+    {
+        on_library_query_changed( callbackData );
+        return 0;
+    }
     case CallbackMessage::internal_load_image_done:
     {
         on_load_image_done( callbackData );
         return 0;
     }
+    case CallbackMessage::internal_bitmap_promise_done:
+    case CallbackMessage::internal_file_promise_done:
     case CallbackMessage::internal_load_image_promise_done:
     case CallbackMessage::internal_get_album_art_promise_done:
     case CallbackMessage::internal_timer_proc:
@@ -514,21 +558,6 @@ std::optional<LRESULT> js_panel_window::process_player_messages( PlayerMessage m
         on_playlist_item_ensure_visible( wp, lp );
         return 0;
     }
-    case PlayerMessage::fb_playlist_items_added:
-    {
-        on_playlist_items_added( wp );
-        return 0;
-    }
-    case PlayerMessage::fb_playlist_items_reordered:
-    {
-        on_playlist_items_reordered( wp );
-        return 0;
-    }
-    case PlayerMessage::fb_playlist_items_removed:
-    {
-        on_playlist_items_removed( wp, lp );
-        return 0;
-    }
     case PlayerMessage::fb_playlist_items_selection_change:
     {
         on_playlist_items_selection_change();
@@ -566,6 +595,11 @@ std::optional<LRESULT> js_panel_window::process_player_messages( PlayerMessage m
     }
     case PlayerMessage::ui_colours_changed:
     {
+        gdi::BackgroundSnapshotCache::GetInstance().InvalidateAll();
+        if ( get_pseudo_transparent() )
+        {
+            message_manager::instance().post_msg( hWnd_, static_cast<UINT>( InternalAsyncMessage::refresh_bg ) );
+        }
         on_colours_changed();
         return 0;
     }
@@ -670,6 +704,11 @@ std::optional<LRESULT> js_panel_window::process_internal_async_messages( Interna
         show_property_popup( hWnd_ );
         return 0;
     }
+    case InternalAsyncMessage::size_changed:
+    {
+        flush_size_update();
+        return 0;
+    }
     default:
     {
         return std::nullopt;
@@ -793,6 +832,11 @@ PanelInfo& js_panel_window::ScriptInfo()
     return m_script_info;
 }
 
+MessageLatencyStats& js_panel_window::GetMessageLatencyStats()
+{
+    return messageLatencyStats_;
+}
+
 t_size& js_panel_window::DlgCode()
 {
     return dlgCode_;
@@ -818,11 +862,11 @@ void js_panel_window::RepaintRect( const RECT& rect, bool force /*= false */ )
     RedrawWindow( hWnd_, &rect, nullptr, RDW_INVALIDATE | ( force ? RDW_UPDATENOW : 0 ) );
 }
 
-void js_panel_window::RepaintBackground( LPRECT lprcUpdate /*= nullptr */ )
+void js_panel_window::RepaintBackground()
 {
     HWND wnd_parent = GetAncestor( hWnd_, GA_PARENT );
 
-    if ( !wnd_parent || IsIconic( core_api::get_main_window() ) || !IsWindowVisible( hWnd_ ) )
+    if ( !wnd_parent || !pBitmapBg_ || IsIconic( core_api::get_main_window() ) || !IsWindowVisible( hWnd_ ) )
     {
         return;
     }
@@ -845,51 +889,34 @@ void js_panel_window::RepaintBackground( LPRECT lprcUpdate /*= nullptr */ )
         }
     }
 
-    RECT rect_child = { 0, 0, (LONG)width_, (LONG)height_ };
+    RECT rect_parent = { 0, 0, (LONG)width_, (LONG)height_ };
+    MapWindowPoints( hWnd_, wnd_parent, (LPPOINT)&rect_parent, 2 );
 
-    HRGN rgn_child = nullptr;
-    if ( lprcUpdate )
-    {
-        HRGN rgn = CreateRectRgnIndirect( lprcUpdate );
-        rgn_child = CreateRectRgnIndirect( &rect_child );
-        CombineRgn( rgn_child, rgn_child, rgn, RGN_DIFF );
-        DeleteRgn( rgn );
-    }
-    else
-    {
-        rgn_child = CreateRectRgn( 0, 0, 0, 0 );
-    }
-
-    POINT pt{ 0, 0 };
-    ClientToScreen( hWnd_, &pt );
-    ScreenToClient( wnd_parent, &pt );
-
-    RECT rect_parent;
-    CopyRect( &rect_parent, &rect_child );
-    ClientToScreen( hWnd_, (LPPOINT)&rect_parent );
-    ClientToScreen( hWnd_, (LPPOINT)&rect_parent + 1 );
-    ScreenToClient( wnd_parent, (LPPOINT)&rect_parent );
-    ScreenToClient( wnd_parent, (LPPOINT)&rect_parent + 1 );
-
-    // Force Repaint
-    SetWindowRgn( hWnd_, rgn_child, FALSE );
-    RedrawWindow( wnd_parent, &rect_parent, nullptr, RDW_INVALIDATE | RDW_ERASE | RDW_ERASENOW | RDW_UPDATENOW );
+    bool isCaptured = false;
+    const auto capture = [&] {
+        // Force Repaint of the parent area under the whole panel
+        SetWindowRgn( hWnd_, CreateRectRgn( 0, 0, 0, 0 ), FALSE );
+        RedrawWindow( wnd_parent, &rect_parent, nullptr, RDW_INVALIDATE | RDW_ERASE | RDW_ERASENOW | RDW_UPDATENOW );
+        isCaptured = true;
+    };
 
     {
         // Background bitmap
-        const HDC dc_parent = GetDC( wnd_parent );
-        const HDC hdc_bk = CreateCompatibleDC( dc_parent );
-        const HBITMAP old_bmp = SelectBitmap( hdc_bk, hBitmapBg_ );
+        const HDC hdc_bk = CreateCompatibleDC( hDc_ );
+        const HBITMAP old_bmp = SelectBitmap( hdc_bk, pBitmapBg_->GetHandle() );
 
         // Paint BK
-        BitBlt( hdc_bk, rect_child.left, rect_child.top, rect_child.right - rect_child.left, rect_child.bottom - rect_child.top, dc_parent, pt.x, pt.y, SRCCOPY );
+        gdi::BackgroundSnapshotCache::GetInstance().CopyBackground( wnd_parent, rect_parent, hdc_bk, capture );
 
         SelectBitmap( hdc_bk, old_bmp );
         DeleteDC( hdc_bk );
-        ReleaseDC( wnd_parent, dc_parent );
     }
 
-    DeleteRgn( rgn_child );
+    if ( !isCaptured )
+    {
+        return;
+    }
+
     SetWindowRgn( hWnd_, nullptr, FALSE );
     if ( smp::config::EdgeStyle::NO_EDGE != get_edge_style() )
     {
@@ -950,28 +977,48 @@ void js_panel_window::script_unload()
 
 void js_panel_window::create_context()
 {
-    delete_context();
+    auto& dibPool = gdi::DibPool::GetInstance();
 
-    hBitmap_ = CreateCompatibleBitmap( hDc_, width_, height_ );
+    // current bitmaps are reused, if they are still suitable
+    pBitmap_ = dibPool.Acquire( width_, height_, std::move( pBitmap_ ) );
 
     if ( get_pseudo_transparent() )
     {
-        hBitmapBg_ = CreateCompatibleBitmap( hDc_, width_, height_ );
+        pBitmapBg_ = dibPool.Acquire( width_, height_, std::move( pBitmapBg_ ) );
+    }
+    else
+    {
+        dibPool.Release( std::move( pBitmapBg_ ) );
     }
 }
 
 void js_panel_window::delete_context()
 {
-    if ( hBitmap_ )
+    auto& dibPool = gdi::DibPool::GetInstance();
+
+    dibPool.Release( std::move( pBitmap_ ) );
+    dibPool.Release( std::move( pBitmapBg_ ) );
+}
+
+void js_panel_window::queue_size_update( uint32_t w, uint32_t h )
+{
+    width_ = w;
+    height_ = h;
+
+    create_context();
+
+    if ( !isSizeUpdatePending_ )
     {
-        DeleteBitmap( hBitmap_ );
-        hBitmap_ = nullptr;
+        isSizeUpdatePending_ = true;
+        message_manager::instance().post_msg( hWnd_, static_cast<UINT>( InternalAsyncMessage::size_changed ) );
     }
+}
 
-    if ( hBitmapBg_ )
+void js_panel_window::flush_size_update()
+{
+    if ( isSizeUpdatePending_ )
     {
-        DeleteBitmap( hBitmapBg_ );
-        hBitmapBg_ = nullptr;
+        on_size( width_, height_ );
     }
 }
 
@@ -1111,6 +1158,20 @@ void js_panel_window::on_dsp_preset_changed()
     pJsContainer_->InvokeJsCallback( "on_dsp_preset_changed" );
 }
 
+void js_panel_window::on_file_changed( CallbackData& callbackData )
+{
+    auto& data = callbackData.GetData<std::shared_ptr<uint32_t>, std::vector<smp::utils::FileChangeEvent>>();
+    const auto watchId = *std::get<0>( data );
+    if ( !watchId )
+    { // path was unwatched after the message was posted
+        return;
+    }
+
+    pJsContainer_->InvokeJsCallback( "on_file_changed",
+                                     watchId,
+                                     std::get<1>( data ) );
+}
+
 void js_panel_window::on_focus( bool isFocused )
 {
     if ( isFocused )
@@ -1132,7 +1193,7 @@ void js_panel_window::on_font_changed()
 
 void js_panel_window::on_get_album_art_done( CallbackData& callbackData )
 {
-    auto& data = callbackData.GetData<metadb_handle_ptr, uint32_t, std::unique_ptr<Gdiplus::Bitmap>, std::u8string>();
+    auto& data = callbackData.GetData<metadb_handle_ptr, uint32_t, std::shared_ptr<Gdiplus::Bitmap>, std::u8string>();
     auto autoRet = pJsContainer_->InvokeJsCallback( "on_get_album_art_done",
                                                     std::get<0>( data ),
                                                     std::get<1>( data ),
@@ -1198,6 +1259,21 @@ void js_panel_window::on_library_items_removed( CallbackData& callbackData )
                                      std::get<0>( data ) );
 }
 
+void js_panel_window::on_library_query_changed( CallbackData& callbackData )
+{
+    auto& data = callbackData.GetData<std::shared_ptr<uint32_t>, metadb_handle_list, metadb_handle_list>();
+    const auto watchId = *std::get<0>( data );
+    if ( !watchId )
+    { // query was unwatched after the message was posted
+        return;
+    }
+
+    pJsContainer_->InvokeJsCallback( "on_library_query_changed",
+                                     watchId,
+                                     std::get<1>( data ),
+                                     std::get<2>( data ) );
+}
+
 void js_panel_window::on_main_menu( WPARAM wp )
 {
     pJsContainer_->InvokeJsCallback( "on_main_menu",
@@ -1380,14 +1456,16 @@ void js_panel_window::on_output_device_changed()
 
 void js_panel_window::on_paint( HDC dc, LPRECT lpUpdateRect )
 {
-    if ( !dc || !lpUpdateRect || !hBitmap_ )
+    if ( !dc || !lpUpdateRect || !pBitmap_ )
     {
         return;
     }
 
+    SMP_TRACE_SCOPE( "paint", "on_paint" );
+
     auto pMemDc = gdi::CreateUniquePtr( CreateCompatibleDC( dc ) );
     const HDC hMemDc = pMemDc.get();
-    gdi::ObjectSelector autoBmp( hMemDc, hBitmap_ );
+    gdi::ObjectSelector autoBmp( hMemDc, pBitmap_->GetHandle() );
 
     if ( mozjs::JsContainer::JsStatus::EngineFailed == pJsContainer_->GetStatus()
          || mozjs::JsContainer::JsStatus::Failed == pJsContainer_->GetStatus() )
@@ -1400,7 +1478,7 @@ void js_panel_window::on_paint( HDC dc, LPRECT lpUpdateRect )
         {
             const auto pBkDc = gdi::CreateUniquePtr( CreateCompatibleDC( dc ) );
             const HDC hBkDc = pBkDc.get();
-            gdi::ObjectSelector autoBgBmp( hBkDc, hBitmapBg_ );
+            gdi::ObjectSelector autoBgBmp( hBkDc, ( pBitmapBg_ ? pBitmapBg_->GetHandle() : nullptr ) );
 
             BitBlt( hMemDc,
                     lpUpdateRect->left,
@@ -1551,23 +1629,29 @@ void js_panel_window::on_playlist_item_ensure_visible( WPARAM wp, LPARAM lp )
                                      static_cast<uint32_t>( lp ) );
 }
 
-void js_panel_window::on_playlist_items_added( WPARAM wp )
+void js_panel_window::on_playlist_items_added( CallbackData& callbackData )
 {
+    auto& data = callbackData.GetData<t_size, uint32_t>();
     pJsContainer_->InvokeJsCallback( "on_playlist_items_added",
-                                     static_cast<uint32_t>( wp ) );
+                                     static_cast<uint32_t>( std::get<0>( data ) ),
+                                     std::get<1>( data ) );
 }
 
-void js_panel_window::on_playlist_items_removed( WPARAM wp, LPARAM lp )
+void js_panel_window::on_playlist_items_removed( CallbackData& callbackData )
 {
+    auto& data = callbackData.GetData<t_size, t_size, uint32_t>();
     pJsContainer_->InvokeJsCallback( "on_playlist_items_removed",
-                                     static_cast<uint32_t>( wp ),
-                                     static_cast<uint32_t>( lp ) );
+                                     static_cast<uint32_t>( std::get<0>( data ) ),
+                                     static_cast<uint32_t>( std::get<1>( data ) ),
+                                     std::get<2>( data ) );
 }
 
-void js_panel_window::on_playlist_items_reordered( WPARAM wp )
+void js_panel_window::on_playlist_items_reordered( CallbackData& callbackData )
 {
+    auto& data = callbackData.GetData<t_size, uint32_t>();
     pJsContainer_->InvokeJsCallback( "on_playlist_items_reordered",
-                                     static_cast<uint32_t>( wp ) );
+                                     static_cast<uint32_t>( std::get<0>( data ) ),
+                                     std::get<1>( data ) );
 }
 
 void js_panel_window::on_playlist_items_selection_change()
@@ -1606,8 +1690,8 @@ void js_panel_window::on_size( uint32_t w, uint32_t h )
 {
     width_ = w;
     height_ = h;
+    isSizeUpdatePending_ = false;
 
-    delete_context();
     create_context();
 
     pJsContainer_->InvokeJsCallback( "on_size",
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <config.h>
+#include <message_latency_stats.h>
 #include <panel_info.h>
 #include <panel_tooltip_param.h>
 #include <user_message.h>
+#include <utils/dib_pool.h>
 
 #include <queue>
 
@@ -70,6 +72,7 @@ public:
     int GetWidth() const;
     PanelTooltipParam& GetPanelTooltipParam();
     PanelInfo& ScriptInfo();
+    MessageLatencyStats& GetMessageLatencyStats();
 
     t_size& DlgCode();
     PanelType GetPanelType() const;
@@ -80,7 +83,7 @@ public:
     void RepaintRect( LONG x, LONG y, LONG w, LONG h, bool force = false );
     void RepaintRect( const RECT& rect, bool force = false );
     /// @details Calls Repaint inside
-    void RepaintBackground( LPRECT lprcUpdate = nullptr );
+    void RepaintBackground();
 
 private:
     const PanelType panelType_;
@@ -93,12 +96,13 @@ private:
 
     uint32_t height_ = 0;         // Used externally as well
     uint32_t width_ = 0;          // Used externally as well
-    HBITMAP hBitmap_ = nullptr;   // used only internally
-    HBITMAP hBitmapBg_ = nullptr; // used only internally
+    std::unique_ptr<smp::gdi::DibSection> pBitmap_;   // used only internally
+    std::unique_ptr<smp::gdi::DibSection> pBitmapBg_; // used only internally
 
     bool isBgRepaintNeeded_ = false;           // used only internally
     bool isPaintInProgress_ = false;           // used only internally
     bool isMouseTracked_ = false;              // used only internally
+    bool isSizeUpdatePending_ = false;         // used only internally
     ui_selection_holder::ptr selectionHolder_; // used only internally
 
     t_size dlgCode_ = 0;                   // modified only from external
@@ -106,11 +110,17 @@ private:
     POINT minSize_ = { 0, 0 };             // modified only from external
     PanelTooltipParam panelTooltipParam_;  // modified only from external
 
+    MessageLatencyStats messageLatencyStats_;
+
 private:
     bool script_load();
     void script_unload();
     void create_context();
     void delete_context();
+    /// @brief Resizes the backbuffer immediately, but `on_size` callback is coalesced:
+    ///        it is invoked only once for all the size changes before the next message loop iteration (or paint).
+    void queue_size_update( uint32_t w, uint32_t h );
+    void flush_size_update();
 
     // Internal callbacks
     void on_context_menu( int x, int y );
@@ -130,6 +140,7 @@ private:
     void on_drag_leave();
     void on_drag_over( LPARAM lp );
     void on_dsp_preset_changed();
+    void on_file_changed( CallbackData& callbackData );
     void on_focus( bool isFocused );
     void on_font_changed();
     void on_get_album_art_done( CallbackData& callbackData );
@@ -140,6 +151,7 @@ private:
     void on_library_items_added( CallbackData& callbackData );
     void on_library_items_changed( CallbackData& callbackData );
     void on_library_items_removed( CallbackData& callbackData );
+    void on_library_query_changed( CallbackData& callbackData );
     void on_load_image_done( CallbackData& callbackData );
     void on_main_menu( WPARAM wp );
     void on_metadb_changed( CallbackData& callbackData );
@@ -168,9 +180,9 @@ private:
     void on_playback_stop( WPARAM wp );
     void on_playback_time( CallbackData& callbackData );
     void on_playlist_item_ensure_visible( WPARAM wp, LPARAM lp );
-    void on_playlist_items_added( WPARAM wp );
-    void on_playlist_items_removed( WPARAM wp, LPARAM lp );
-    void on_playlist_items_reordered( WPARAM wp );
+    void on_playlist_items_added( CallbackData& callbackData );
+    void on_playlist_items_removed( CallbackData& callbackData );
+    void on_playlist_items_reordered( CallbackData& callbackData );
     void on_playlist_items_selection_change();
     void on_playlist_stop_after_current_changed( WPARAM wp );
     void on_playlist_switch();
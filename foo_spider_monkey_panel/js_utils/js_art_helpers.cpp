@@ -34,14 +34,14 @@ public:
                     JS::HandleValue jsPromise );
     ~JsAlbumArtTask() override = default;
 
-    void SetData( std::unique_ptr<Gdiplus::Bitmap> image,
+    void SetData( std::shared_ptr<Gdiplus::Bitmap> image,
                   const std::u8string& path );
 
 private:
     bool InvokeJsImpl( JSContext* cx, JS::HandleObject jsGlobal, JS::HandleValue jsPromiseValue ) override;
 
 private:
-    std::unique_ptr<Gdiplus::Bitmap> image_;
+    std::shared_ptr<Gdiplus::Bitmap> image_;
     std::u8string path_;
 };
 
@@ -113,7 +113,7 @@ void AlbumArtV2FetchTask::operator()()
     }
 
     std::u8string imagePath;
-    std::unique_ptr<Gdiplus::Bitmap> bitmap = smp::art::GetBitmapFromMetadbOrEmbed( handle_, artId_, needStub_, onlyEmbed_, noLoad_, &imagePath );
+    std::shared_ptr<Gdiplus::Bitmap> bitmap = smp::art::GetBitmapFromMetadbOrEmbed( handle_, artId_, needStub_, onlyEmbed_, noLoad_, &imagePath );
 
     jsTask_->SetData( std::move( bitmap ), imagePath );
 
@@ -130,7 +130,7 @@ JsAlbumArtTask::JsAlbumArtTask( JSContext* cx,
 {
 }
 
-void JsAlbumArtTask::SetData( std::unique_ptr<Gdiplus::Bitmap> image, const std::u8string& path )
+void JsAlbumArtTask::SetData( std::shared_ptr<Gdiplus::Bitmap> image, const std::u8string& path )
 {
     image_ = std::move( image );
     path_ = path;
@@ -0,0 +1,167 @@
+#include <stdafx.h>
+#include "js_bitmap_helpers.h"
+
+#include <js_engine/js_compartment_inner.h>
+#include <js_objects/global_object.h>
+#include <js_utils/js_error_helper.h>
+#include <js_utils/js_async_task.h>
+#include <utils/thread_pool.h>
+#include <convert/native_to_js.h>
+
+#include <user_message.h>
+#include <message_manager.h>
+
+using namespace smp;
+
+namespace
+{
+
+using namespace mozjs;
+using namespace mozjs::async_bitmap;
+
+class JsBitmapPromiseTask
+    : public JsAsyncTaskImpl<JS::HandleValue>
+{
+public:
+    JsBitmapPromiseTask( JSContext* cx,
+                         JS::HandleValue jsPromise,
+                         uint32_t inFlightBytes );
+    ~JsBitmapPromiseTask() override = default;
+
+    /// @details Executed off main thread
+    void SetResult( TaskResult result );
+    /// @details Executed off main thread
+    void SetError( std::exception_ptr pException );
+
+private:
+    bool InvokeJsImpl( JSContext* cx, JS::HandleObject jsGlobal, JS::HandleValue jsPromiseValue ) override;
+
+private:
+    uint32_t inFlightBytes_;
+    std::optional<TaskResult> result_;
+    std::exception_ptr pException_;
+};
+
+JsBitmapPromiseTask::JsBitmapPromiseTask( JSContext* cx,
+                                          JS::HandleValue jsPromise,
+                                          uint32_t inFlightBytes )
+    : JsAsyncTaskImpl( cx, jsPromise )
+    , inFlightBytes_( inFlightBytes )
+{
+    auto pJsCompartment = static_cast<JsCompartmentInner*>( JS_GetCompartmentPrivate( js::GetContextCompartment( cx ) ) );
+    assert( pJsCompartment );
+    pJsCompartment->OnHeapAllocate( inFlightBytes_ );
+}
+
+void JsBitmapPromiseTask::SetResult( TaskResult result )
+{
+    result_.emplace( std::move( result ) );
+}
+
+void JsBitmapPromiseTask::SetError( std::exception_ptr pException )
+{
+    pException_ = pException;
+}
+
+bool JsBitmapPromiseTask::InvokeJsImpl( JSContext* cx, JS::HandleObject, JS::HandleValue jsPromiseValue )
+{
+    // in-flight memory is released only here: if the task is cancelled, then the compartment is already gone
+    auto pJsCompartment = static_cast<JsCompartmentInner*>( JS_GetCompartmentPrivate( js::GetContextCompartment( cx ) ) );
+    assert( pJsCompartment );
+    pJsCompartment->OnHeapDeallocate( inFlightBytes_ );
+
+    JS::RootedObject jsPromise( cx, &jsPromiseValue.toObject() );
+
+    try
+    {
+        if ( pException_ )
+        {
+            std::rethrow_exception( pException_ );
+        }
+        assert( result_ );
+
+        JS::RootedValue jsResult( cx );
+        std::visit( [cx, &jsResult]( auto& result ) {
+            using T = std::decay_t<decltype( result )>;
+            if constexpr ( std::is_same_v<T, std::vector<uint32_t>> )
+            {
+                convert::to_js::ToArrayValue(
+                    cx,
+                    result,
+                    []( const auto& vec, auto index ) {
+                        return vec[index];
+                    },
+                    &jsResult );
+            }
+            else if constexpr ( std::is_same_v<T, std::unique_ptr<Gdiplus::Bitmap>> )
+            {
+                convert::to_js::ToValue( cx, std::move( result ), &jsResult );
+            }
+            else
+            {
+                convert::to_js::ToValue( cx, result, &jsResult );
+            }
+        },
+                    *result_ );
+
+        (void)JS::ResolvePromise( cx, jsPromise, jsResult );
+    }
+    catch ( ... )
+    {
+        mozjs::error::ExceptionToJsError( cx );
+
+        JS::RootedValue jsError( cx );
+        (void)JS_GetPendingException( cx, &jsError );
+
+        JS::RejectPromise( cx, jsPromise, jsError );
+    }
+
+    return true;
+}
+
+} // namespace
+
+namespace mozjs::async_bitmap
+{
+
+JSObject* GetBitmapPromise( JSContext* cx, HWND hWnd, uint32_t inFlightBytes, Task task )
+{
+    SmpException::ExpectTrue( hWnd, "Invalid hWnd argument" );
+
+    JS::RootedObject jsPromise( cx, JS::NewPromiseObject( cx, nullptr ) );
+    JsException::ExpectTrue( jsPromise );
+
+    JS::RootedValue jsPromiseValue( cx, JS::ObjectValue( *jsPromise ) );
+    auto pJsTask = std::make_shared<JsBitmapPromiseTask>( cx, jsPromiseValue, inFlightBytes );
+
+    ThreadPool::GetInstance().AddTask( [hWnd, pJsTask, task = std::move( task )] {
+        if ( !pJsTask->IsCanceled() )
+        { // panel was unloaded: the task still might be executed and posted, since we don't block here
+            return;
+        }
+
+        try
+        {
+            pJsTask->SetResult( task() );
+        }
+        catch ( ... )
+        {
+            pJsTask->SetError( std::current_exception() );
+        }
+
+        if ( !pJsTask->IsCanceled() )
+        { // panel was unloaded while the task was being processed
+            return;
+        }
+
+        panel::message_manager::instance().post_callback_msg( hWnd,
+                                                              smp::CallbackMessage::internal_bitmap_promise_done,
+                                                              std::make_unique<
+                                                                  smp::panel::CallbackDataImpl<
+                                                                      std::shared_ptr<JsAsyncTask>>>( pJsTask ) );
+    } );
+
+    return jsPromise;
+}
+
+} // namespace mozjs::async_bitmap
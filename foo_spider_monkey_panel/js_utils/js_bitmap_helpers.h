@@ -0,0 +1,30 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+class JSObject;
+struct JSContext;
+
+namespace mozjs::async_bitmap
+{
+
+// Promise-returning counterparts of the synchronous GdiBitmap methods.
+// The work is performed in the thread pool on a snapshot of the bitmap,
+// results are delivered to the main thread via `hWnd` panel message queue.
+
+/// @brief Bitmap is converted to GdiBitmap, colours - to array of numbers
+using TaskResult = std::variant<std::unique_ptr<Gdiplus::Bitmap>, bool, std::vector<uint32_t>, std::u8string>;
+/// @details Executed off main thread, must throw only smp::SmpException
+using Task = std::function<TaskResult()>;
+
+/// @param inFlightBytes Memory that is held by the task (e.g. bitmap snapshots).
+///                      It is accounted as the panel memory until the promise is settled.
+/// @throw smp::SmpException
+/// @throw smp::JsException
+JSObject* GetBitmapPromise( JSContext* cx, HWND hWnd, uint32_t inFlightBytes, Task task );
+
+} // namespace mozjs::async_bitmap
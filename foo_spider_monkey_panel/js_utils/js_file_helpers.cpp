@@ -0,0 +1,348 @@
+#include <stdafx.h>
+#include "js_file_helpers.h"
+
+#include <js_objects/global_object.h>
+#include <js_utils/js_error_helper.h>
+#include <js_utils/js_async_task.h>
+#include <utils/file_helpers.h>
+#include <utils/scope_helpers.h>
+#include <utils/thread_pool.h>
+#include <utils/winapi_error_helpers.h>
+#include <convert/native_to_js.h>
+
+#include <user_message.h>
+#include <message_manager.h>
+
+#include <filesystem>
+
+using namespace smp;
+
+namespace
+{
+
+using namespace mozjs;
+
+/// @brief Memory is allocated with SpiderMonkey allocator,
+///        so that it can be adopted by ArrayBuffer as is.
+struct BinaryFileData
+{
+    std::unique_ptr<uint8_t, JS::FreePolicy> pData;
+    size_t size = 0;
+};
+
+struct FileStat
+{
+    bool exists = false;
+    bool isDirectory = false;
+    uint64_t size = 0;
+    uint32_t attributes = 0;
+    double created = 0;
+    double modified = 0;
+};
+
+template <typename T>
+class JsFilePromiseTask
+    : public JsAsyncTaskImpl<JS::HandleValue>
+{
+public:
+    /// @throw smp::SmpException
+    /// @throw smp::JsException
+    using ResultConverter = void ( * )( JSContext* cx, T& result, JS::MutableHandleValue jsResult );
+
+public:
+    JsFilePromiseTask( JSContext* cx,
+                       JS::HandleValue jsPromise,
+                       ResultConverter resultConverter );
+    ~JsFilePromiseTask() override = default;
+
+    /// @details Executed off main thread
+    void SetResult( T result );
+    /// @details Executed off main thread
+    void SetError( std::exception_ptr pException );
+
+private:
+    bool InvokeJsImpl( JSContext* cx, JS::HandleObject jsGlobal, JS::HandleValue jsPromiseValue ) override;
+
+private:
+    ResultConverter resultConverter_;
+    std::optional<T> result_;
+    std::exception_ptr pException_;
+};
+
+template <typename T>
+JsFilePromiseTask<T>::JsFilePromiseTask( JSContext* cx,
+                                         JS::HandleValue jsPromise,
+                                         ResultConverter resultConverter )
+    : JsAsyncTaskImpl( cx, jsPromise )
+    , resultConverter_( resultConverter )
+{
+}
+
+template <typename T>
+void JsFilePromiseTask<T>::SetResult( T result )
+{
+    result_.emplace( std::move( result ) );
+}
+
+template <typename T>
+void JsFilePromiseTask<T>::SetError( std::exception_ptr pException )
+{
+    pException_ = pException;
+}
+
+template <typename T>
+bool JsFilePromiseTask<T>::InvokeJsImpl( JSContext* cx, JS::HandleObject, JS::HandleValue jsPromiseValue )
+{
+    JS::RootedObject jsPromise( cx, &jsPromiseValue.toObject() );
+
+    try
+    {
+        if ( pException_ )
+        {
+            std::rethrow_exception( pException_ );
+        }
+        assert( result_ );
+
+        JS::RootedValue jsResult( cx );
+        resultConverter_( cx, *result_, &jsResult );
+
+        (void)JS::ResolvePromise( cx, jsPromise, jsResult );
+    }
+    catch ( ... )
+    {
+        mozjs::error::ExceptionToJsError( cx );
+
+        JS::RootedValue jsError( cx );
+        (void)JS_GetPendingException( cx, &jsError );
+
+        JS::RejectPromise( cx, jsPromise, jsError );
+    }
+
+    return true;
+}
+
+/// @param fileTask Executed off main thread, must throw only smp::SmpException
+template <typename T, typename F>
+JSObject* CreateFilePromise( JSContext* cx, HWND hWnd, typename JsFilePromiseTask<T>::ResultConverter resultConverter, F&& fileTask )
+{
+    static_assert( std::is_same_v<T, std::invoke_result_t<F>> );
+    SmpException::ExpectTrue( hWnd, "Invalid hWnd argument" );
+
+    JS::RootedObject jsPromise( cx, JS::NewPromiseObject( cx, nullptr ) );
+    JsException::ExpectTrue( jsPromise );
+
+    JS::RootedValue jsPromiseValue( cx, JS::ObjectValue( *jsPromise ) );
+    auto pJsTask = std::make_shared<JsFilePromiseTask<T>>( cx, jsPromiseValue, resultConverter );
+
+    ThreadPool::GetInstance().AddTask( [hWnd, pJsTask, fileTask = std::forward<F>( fileTask )] {
+        if ( !pJsTask->IsCanceled() )
+        { // the task still might be executed and posted, since we don't block here
+            return;
+        }
+
+        try
+        {
+            pJsTask->SetResult( fileTask() );
+        }
+        catch ( ... )
+        {
+            pJsTask->SetError( std::current_exception() );
+        }
+
+        panel::message_manager::instance().post_callback_msg( hWnd,
+                                                              smp::CallbackMessage::internal_file_promise_done,
+                                                              std::make_unique<
+                                                                  smp::panel::CallbackDataImpl<
+                                                                      std::shared_ptr<JsAsyncTask>>>( pJsTask ) );
+    } );
+
+    return jsPromise;
+}
+
+/// @throw smp::SmpException
+BinaryFileData ReadBinaryFile( const std::wstring& path )
+{
+    HANDLE hFile = CreateFile( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+    smp::error::CheckWinApi( ( INVALID_HANDLE_VALUE != hFile ), "CreateFile" );
+    utils::final_action autoFile( [hFile] {
+        CloseHandle( hFile );
+    } );
+
+    LARGE_INTEGER fileSize{};
+    BOOL bRet = GetFileSizeEx( hFile, &fileSize );
+    smp::error::CheckWinApi( bRet, "GetFileSizeEx" );
+    // ArrayBuffer can't be larger than that
+    SmpException::ExpectTrue( fileSize.QuadPart <= INT32_MAX, "File is too large: {} bytes", fileSize.QuadPart );
+
+    BinaryFileData fileData;
+    fileData.size = static_cast<size_t>( fileSize.QuadPart );
+    if ( !fileData.size )
+    {
+        return fileData;
+    }
+
+    fileData.pData.reset( js_pod_malloc<uint8_t>( fileData.size ) );
+    if ( !fileData.pData )
+    {
+        throw std::bad_alloc();
+    }
+
+    // Read directly into the buffer that will be adopted by ArrayBuffer:
+    // this way the data is copied only once (from the system cache).
+    size_t bytesRead = 0;
+    while ( bytesRead < fileData.size )
+    {
+        const auto chunkSize = static_cast<DWORD>( std::min<size_t>( fileData.size - bytesRead, 64 * 1024 * 1024 ) );
+        DWORD chunkBytesRead = 0;
+        bRet = ::ReadFile( hFile, fileData.pData.get() + bytesRead, chunkSize, &chunkBytesRead, nullptr );
+        smp::error::CheckWinApi( bRet, "ReadFile" );
+        SmpException::ExpectTrue( chunkBytesRead, "File was truncated while being read: {}", smp::unicode::ToU8( path ) );
+
+        bytesRead += chunkBytesRead;
+    }
+
+    return fileData;
+}
+
+double FileTimeToJsTime( const FILETIME& fileTime )
+{
+    // FILETIME: 100ns intervals since 1601-01-01, JS: ms since 1970-01-01
+    constexpr uint64_t kEpochDiff = 116444736000000000ULL;
+
+    const uint64_t time = ( static_cast<uint64_t>( fileTime.dwHighDateTime ) << 32 ) | fileTime.dwLowDateTime;
+    return ( time < kEpochDiff ? 0.0 : static_cast<double>( ( time - kEpochDiff ) / 10000 ) );
+}
+
+/// @throw smp::SmpException
+FileStat GetFileStat( const std::wstring& path )
+{
+    FileStat fileStat;
+
+    WIN32_FILE_ATTRIBUTE_DATA fileData{};
+    if ( !GetFileAttributesEx( path.c_str(), GetFileExInfoStandard, &fileData ) )
+    {
+        const auto errorCode = GetLastError();
+        if ( errorCode == ERROR_FILE_NOT_FOUND || errorCode == ERROR_PATH_NOT_FOUND )
+        { // Not an error: file does not exist
+            return fileStat;
+        }
+        smp::error::CheckWinApi( false, "GetFileAttributesEx" );
+    }
+
+    fileStat.exists = true;
+    fileStat.isDirectory = !!( fileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY );
+    fileStat.size = ( static_cast<uint64_t>( fileData.nFileSizeHigh ) << 32 ) | fileData.nFileSizeLow;
+    fileStat.attributes = fileData.dwFileAttributes;
+    fileStat.created = FileTimeToJsTime( fileData.ftCreationTime );
+    fileStat.modified = FileTimeToJsTime( fileData.ftLastWriteTime );
+
+    return fileStat;
+}
+
+} // namespace
+
+namespace mozjs::async_file
+{
+
+JSObject* GetReadTextFilePromise( JSContext* cx, HWND hWnd, const std::u8string& path, uint32_t codepage )
+{
+    return CreateFilePromise<std::wstring>(
+        cx,
+        hWnd,
+        []( JSContext* cx, std::wstring& result, JS::MutableHandleValue jsResult ) {
+            convert::to_js::ToValue( cx, result, jsResult );
+        },
+        [path, codepage] {
+            return smp::file::ReadFileW( path, codepage );
+        } );
+}
+
+JSObject* GetReadBinaryFilePromise( JSContext* cx, HWND hWnd, const std::wstring& path )
+{
+    return CreateFilePromise<BinaryFileData>(
+        cx,
+        hWnd,
+        []( JSContext* cx, BinaryFileData& result, JS::MutableHandleValue jsResult ) {
+            JS::RootedObject jsBuffer( cx );
+            if ( result.pData )
+            {
+                jsBuffer = JS_NewArrayBufferWithContents( cx, result.size, result.pData.get() );
+                JsException::ExpectTrue( jsBuffer );
+                // ownership was transferred only on success
+                (void)result.pData.release();
+            }
+            else
+            {
+                jsBuffer = JS_NewArrayBuffer( cx, 0 );
+                JsException::ExpectTrue( jsBuffer );
+            }
+
+            jsResult.setObject( *jsBuffer );
+        },
+        [path] {
+            return ReadBinaryFile( std::filesystem::path( path ).lexically_normal().wstring() );
+        } );
+}
+
+JSObject* GetWriteTextFilePromise( JSContext* cx, HWND hWnd, const std::wstring& path, const std::u8string& content, bool write_bom )
+{
+    return CreateFilePromise<std::nullptr_t>(
+        cx,
+        hWnd,
+        []( JSContext*, std::nullptr_t&, JS::MutableHandleValue jsResult ) {
+            jsResult.setUndefined();
+        },
+        [path, content, write_bom] {
+            smp::file::WriteFileAtomic( path, content, write_bom );
+            return nullptr;
+        } );
+}
+
+JSObject* GetGlobPromise( JSContext* cx, HWND hWnd, const std::u8string& pattern, uint32_t exc_mask, uint32_t inc_mask )
+{
+    return CreateFilePromise<std::vector<std::u8string>>(
+        cx,
+        hWnd,
+        []( JSContext* cx, std::vector<std::u8string>& result, JS::MutableHandleValue jsResult ) {
+            convert::to_js::ToArrayValue(
+                cx,
+                result,
+                []( auto& vec, auto idx ) {
+                    return vec[idx];
+                },
+                jsResult );
+        },
+        [pattern, exc_mask, inc_mask] {
+            return smp::file::Glob( pattern, exc_mask, inc_mask );
+        } );
+}
+
+JSObject* GetStatPromise( JSContext* cx, HWND hWnd, const std::wstring& path )
+{
+    return CreateFilePromise<FileStat>(
+        cx,
+        hWnd,
+        []( JSContext* cx, FileStat& result, JS::MutableHandleValue jsResult ) {
+            JS::RootedValue jsExists( cx, JS::BooleanValue( result.exists ) );
+            JS::RootedValue jsIsDirectory( cx, JS::BooleanValue( result.isDirectory ) );
+
+            JS::RootedObject jsStat( cx, JS_NewPlainObject( cx ) );
+            if ( !jsStat
+                 || !JS_DefineProperty( cx, jsStat, "exists", jsExists, DefaultPropsFlags() )
+                 || !JS_DefineProperty( cx, jsStat, "isDirectory", jsIsDirectory, DefaultPropsFlags() )
+                 || !JS_DefineProperty( cx, jsStat, "size", static_cast<double>( result.size ), DefaultPropsFlags() )
+                 || !JS_DefineProperty( cx, jsStat, "attributes", result.attributes, DefaultPropsFlags() )
+                 || !JS_DefineProperty( cx, jsStat, "created", result.created, DefaultPropsFlags() )
+                 || !JS_DefineProperty( cx, jsStat, "modified", result.modified, DefaultPropsFlags() ) )
+            {
+                throw JsException();
+            }
+
+            jsResult.setObject( *jsStat );
+        },
+        [path] {
+            return GetFileStat( std::filesystem::path( path ).lexically_normal().wstring() );
+        } );
+}
+
+} // namespace mozjs::async_file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+class JSObject;
+struct JSContext;
+
+namespace mozjs::async_file
+{
+
+// Promise-returning counterparts of the synchronous file methods in JsUtils.
+// All of the filesystem work is performed in the thread pool,
+// results are delivered to the main thread via `hWnd` panel message queue.
+
+/// @throw smp::SmpException
+/// @throw smp::JsException
+JSObject* GetReadTextFilePromise( JSContext* cx, HWND hWnd, const std::u8string& path, uint32_t codepage );
+
+/// @throw smp::SmpException
+/// @throw smp::JsException
+JSObject* GetReadBinaryFilePromise( JSContext* cx, HWND hWnd, const std::wstring& path );
+
+/// @throw smp::SmpException
+/// @throw smp::JsException
+JSObject* GetWriteTextFilePromise( JSContext* cx, HWND hWnd, const std::wstring& path, const std::u8string& content, bool write_bom );
+
+/// @throw smp::SmpException
+/// @throw smp::JsException
+JSObject* GetGlobPromise( JSContext* cx, HWND hWnd, const std::u8string& pattern, uint32_t exc_mask, uint32_t inc_mask );
+
+/// @throw smp::SmpException
+/// @throw smp::JsException
+JSObject* GetStatPromise( JSContext* cx, HWND hWnd, const std::wstring& path );
+
+} // namespace mozjs::async_file
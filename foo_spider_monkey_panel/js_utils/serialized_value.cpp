@@ -4,6 +4,516 @@
 #include <convert/native_to_js.h>
 #include <convert/js_to_native.h>
 
+#include <js/GCHashTable.h>
+
+namespace
+{
+
+enum class StructureTag : uint8_t
+{ // Take care changing this: used in config
+    kUndefined = 0,
+    kNull = 1,
+    kFalse = 2,
+    kTrue = 3,
+    kInt32 = 4,
+    kDouble = 5,
+    kString = 6,
+    kArray = 7,
+    kObject = 8,
+    kArrayBuffer = 9,
+    kTypedArray = 10,
+    kBackReference = 11,
+};
+
+/// @brief Should be increased only on incompatible changes
+constexpr uint8_t kStructureFormatVersion = 1;
+constexpr uint32_t kMaxNestingDepth = 256;
+
+} // namespace
+
+namespace
+{
+
+using namespace mozjs;
+
+class StructureWriter
+{
+public:
+    StructureWriter( JSContext* cx )
+        : pJsCtx_( cx )
+        , objectIds_( cx, ObjectIdMap() )
+    {
+        if ( !objectIds_.init() )
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    std::vector<uint8_t> Write( JS::HandleObject jsObject )
+    {
+        data_.clear();
+        WritePod( kStructureFormatVersion );
+        WriteObject( jsObject );
+        data_.shrink_to_fit();
+
+        return std::move( data_ );
+    }
+
+private:
+    void WriteValue( JS::HandleValue jsValue )
+    {
+        if ( jsValue.isUndefined() )
+        {
+            WriteTag( StructureTag::kUndefined );
+        }
+        else if ( jsValue.isNull() )
+        {
+            WriteTag( StructureTag::kNull );
+        }
+        else if ( jsValue.isBoolean() )
+        {
+            WriteTag( jsValue.toBoolean() ? StructureTag::kTrue : StructureTag::kFalse );
+        }
+        else if ( jsValue.isInt32() )
+        {
+            WriteTag( StructureTag::kInt32 );
+            WritePod( jsValue.toInt32() );
+        }
+        else if ( jsValue.isDouble() )
+        {
+            WriteTag( StructureTag::kDouble );
+            WritePod( jsValue.toDouble() );
+        }
+        else if ( jsValue.isString() )
+        {
+            WriteTag( StructureTag::kString );
+            WriteString( convert::to_native::ToValue<std::u8string>( pJsCtx_, jsValue ) );
+        }
+        else if ( jsValue.isObject() )
+        {
+            JS::RootedObject jsObject( pJsCtx_, &jsValue.toObject() );
+            WriteObject( jsObject );
+        }
+        else
+        {
+            throw smp::SmpException( "Unsupported value type" );
+        }
+    }
+
+    void WriteObject( JS::HandleObject jsObject )
+    {
+        if ( auto it = objectIds_.lookup( jsObject ); it )
+        {
+            WriteTag( StructureTag::kBackReference );
+            WritePod( it->value() );
+            return;
+        }
+
+        smp::SmpException::ExpectTrue( depth_ < kMaxNestingDepth, "Value is nested too deeply" );
+        ++depth_;
+
+        const auto objectId = static_cast<uint32_t>( objectIds_.count() );
+        if ( !objectIds_.put( jsObject, objectId ) )
+        {
+            throw std::bad_alloc();
+        }
+
+        if ( JS_IsTypedArrayObject( jsObject ) )
+        {
+            WriteTypedArray( jsObject );
+        }
+        else
+        {
+            js::ESClass cls;
+            if ( !js::GetBuiltinClass( pJsCtx_, jsObject, &cls ) )
+            {
+                throw smp::JsException();
+            }
+
+            switch ( cls )
+            {
+            case js::ESClass::Array:
+                WriteArray( jsObject );
+                break;
+            case js::ESClass::Object:
+                WritePlainObject( jsObject );
+                break;
+            case js::ESClass::ArrayBuffer:
+                WriteArrayBuffer( jsObject );
+                break;
+            default:
+                throw smp::SmpException( "Unsupported value type" );
+            }
+        }
+
+        --depth_;
+    }
+
+    void WriteArray( JS::HandleObject jsObject )
+    {
+        uint32_t arraySize;
+        if ( !JS_GetArrayLength( pJsCtx_, jsObject, &arraySize ) )
+        {
+            throw smp::JsException();
+        }
+
+        WriteTag( StructureTag::kArray );
+        WritePod( arraySize );
+
+        JS::RootedValue jsElement( pJsCtx_ );
+        for ( uint32_t i = 0; i < arraySize; ++i )
+        {
+            if ( !JS_GetElement( pJsCtx_, jsObject, i, &jsElement ) )
+            {
+                throw smp::JsException();
+            }
+
+            WriteValue( jsElement );
+        }
+    }
+
+    void WritePlainObject( JS::HandleObject jsObject )
+    {
+        JS::AutoIdVector jsIds( pJsCtx_ );
+        if ( !js::GetPropertyKeys( pJsCtx_, jsObject, JSITER_OWNONLY, &jsIds ) )
+        {
+            throw smp::JsException();
+        }
+
+        WriteTag( StructureTag::kObject );
+        WritePod( static_cast<uint32_t>( jsIds.length() ) );
+
+        JS::RootedValue jsIdValue( pJsCtx_ );
+        JS::RootedValue jsValue( pJsCtx_ );
+        for ( size_t i = 0; i < jsIds.length(); ++i )
+        {
+            if ( !JS_GetPropertyById( pJsCtx_, jsObject, jsIds[i], &jsValue ) )
+            {
+                throw smp::JsException();
+            }
+
+            jsIdValue = js::IdToValue( jsIds[i] );
+            WriteString( convert::to_native::ToValue<std::u8string>( pJsCtx_, jsIdValue ) );
+            WriteValue( jsValue );
+        }
+    }
+
+    void WriteArrayBuffer( JS::HandleObject jsObject )
+    {
+        const uint32_t byteLength = JS_GetArrayBufferByteLength( jsObject );
+
+        WriteTag( StructureTag::kArrayBuffer );
+        WritePod( byteLength );
+
+        JS::AutoCheckCannotGC nogc;
+        bool isShared;
+        const auto pData = JS_GetArrayBufferData( jsObject, &isShared, nogc );
+        WriteBytes( pData, byteLength );
+    }
+
+    void WriteTypedArray( JS::HandleObject jsObject )
+    {
+        const auto arrayType = JS_GetArrayBufferViewType( jsObject );
+        smp::SmpException::ExpectTrue( arrayType < js::Scalar::MaxTypedArrayViewType, "Unsupported typed array type" );
+
+        const uint32_t byteLength = JS_GetArrayBufferViewByteLength( jsObject );
+
+        WriteTag( StructureTag::kTypedArray );
+        WritePod( static_cast<uint8_t>( arrayType ) );
+        WritePod( byteLength );
+
+        JS::AutoCheckCannotGC nogc;
+        bool isShared;
+        const auto pData = JS_GetArrayBufferViewData( jsObject, &isShared, nogc );
+        WriteBytes( pData, byteLength );
+    }
+
+    void WriteTag( StructureTag tag )
+    {
+        WritePod( static_cast<uint8_t>( tag ) );
+    }
+
+    void WriteString( const std::u8string& value )
+    {
+        WritePod( static_cast<uint32_t>( value.length() ) );
+        WriteBytes( value.data(), value.length() );
+    }
+
+    template <typename T>
+    void WritePod( const T& value )
+    {
+        static_assert( std::is_trivially_copyable_v<T> );
+        WriteBytes( &value, sizeof( T ) );
+    }
+
+    void WriteBytes( const void* pData, size_t size )
+    {
+        const auto pBytes = static_cast<const uint8_t*>( pData );
+        data_.insert( data_.end(), pBytes, pBytes + size );
+    }
+
+private:
+    using ObjectIdMap = JS::GCHashMap<JSObject*, uint32_t, js::MovableCellHasher<JSObject*>, js::SystemAllocPolicy>;
+
+    JSContext* pJsCtx_ = nullptr;
+    JS::Rooted<ObjectIdMap> objectIds_;
+    uint32_t depth_ = 0;
+    std::vector<uint8_t> data_;
+};
+
+class StructureReader
+{
+public:
+    StructureReader( JSContext* cx, const std::vector<uint8_t>& data )
+        : pJsCtx_( cx )
+        , objects_( cx )
+        , data_( data )
+    {
+    }
+
+    void Read( JS::MutableHandleValue jsValue )
+    {
+        pos_ = 0;
+        smp::SmpException::ExpectTrue( ReadPod<uint8_t>() == kStructureFormatVersion, "Unsupported serialized value format" );
+
+        ReadValue( jsValue );
+        smp::SmpException::ExpectTrue( pos_ == data_.size(), "Corrupted serialized value" );
+    }
+
+private:
+    void ReadValue( JS::MutableHandleValue jsValue )
+    {
+        const auto tag = static_cast<StructureTag>( ReadPod<uint8_t>() );
+        switch ( tag )
+        {
+        case StructureTag::kUndefined:
+            jsValue.setUndefined();
+            break;
+        case StructureTag::kNull:
+            jsValue.setNull();
+            break;
+        case StructureTag::kFalse:
+            jsValue.setBoolean( false );
+            break;
+        case StructureTag::kTrue:
+            jsValue.setBoolean( true );
+            break;
+        case StructureTag::kInt32:
+            jsValue.setInt32( ReadPod<int32_t>() );
+            break;
+        case StructureTag::kDouble:
+            jsValue.setDouble( ReadPod<double>() );
+            break;
+        case StructureTag::kString:
+            convert::to_js::ToValue( pJsCtx_, ReadString(), jsValue );
+            break;
+        case StructureTag::kBackReference:
+        {
+            const auto objectId = ReadPod<uint32_t>();
+            smp::SmpException::ExpectTrue( objectId < objects_.length(), "Corrupted serialized value" );
+            jsValue.setObject( *objects_[objectId] );
+            break;
+        }
+        case StructureTag::kArray:
+        case StructureTag::kObject:
+        case StructureTag::kArrayBuffer:
+        case StructureTag::kTypedArray:
+        {
+            smp::SmpException::ExpectTrue( depth_ < kMaxNestingDepth, "Corrupted serialized value" );
+            ++depth_;
+            ReadObject( tag, jsValue );
+            --depth_;
+            break;
+        }
+        default:
+            throw smp::SmpException( "Corrupted serialized value" );
+        }
+    }
+
+    void ReadObject( StructureTag tag, JS::MutableHandleValue jsValue )
+    {
+        JS::RootedObject jsObject( pJsCtx_ );
+        switch ( tag )
+        {
+        case StructureTag::kArray:
+        {
+            const auto arraySize = ReadPod<uint32_t>();
+            jsObject = JS_NewArrayObject( pJsCtx_, arraySize );
+            smp::JsException::ExpectTrue( jsObject );
+            AddObject( jsObject );
+
+            JS::RootedValue jsElement( pJsCtx_ );
+            for ( uint32_t i = 0; i < arraySize; ++i )
+            {
+                ReadValue( &jsElement );
+                if ( !JS_SetElement( pJsCtx_, jsObject, i, jsElement ) )
+                {
+                    throw smp::JsException();
+                }
+            }
+            break;
+        }
+        case StructureTag::kObject:
+        {
+            const auto propCount = ReadPod<uint32_t>();
+            jsObject = JS_NewPlainObject( pJsCtx_ );
+            smp::JsException::ExpectTrue( jsObject );
+            AddObject( jsObject );
+
+            JS::RootedValue jsPropValue( pJsCtx_ );
+            for ( uint32_t i = 0; i < propCount; ++i )
+            {
+                const auto propName = smp::unicode::ToWide( ReadString() );
+                ReadValue( &jsPropValue );
+                if ( !JS_SetUCProperty( pJsCtx_, jsObject, reinterpret_cast<const char16_t*>( propName.c_str() ), propName.length(), jsPropValue ) )
+                {
+                    throw smp::JsException();
+                }
+            }
+            break;
+        }
+        case StructureTag::kArrayBuffer:
+        {
+            const auto byteLength = ReadPod<uint32_t>();
+            jsObject = ReadArrayBuffer( byteLength );
+            AddObject( jsObject );
+            break;
+        }
+        case StructureTag::kTypedArray:
+        {
+            const auto arrayType = static_cast<js::Scalar::Type>( ReadPod<uint8_t>() );
+            const auto byteLength = ReadPod<uint32_t>();
+            JS::RootedObject jsBuffer( pJsCtx_, ReadArrayBuffer( byteLength ) );
+            jsObject = CreateTypedArray( arrayType, jsBuffer, byteLength );
+            AddObject( jsObject );
+            break;
+        }
+        default:
+        {
+            assert( 0 );
+            throw smp::SmpException( "Corrupted serialized value" );
+        }
+        }
+
+        jsValue.setObject( *jsObject );
+    }
+
+    JSObject* ReadArrayBuffer( uint32_t byteLength )
+    {
+        smp::SmpException::ExpectTrue( data_.size() - pos_ >= byteLength, "Corrupted serialized value" );
+
+        JS::RootedObject jsBuffer( pJsCtx_, JS_NewArrayBuffer( pJsCtx_, byteLength ) );
+        smp::JsException::ExpectTrue( jsBuffer );
+
+        {
+            JS::AutoCheckCannotGC nogc;
+            bool isShared;
+            auto pData = JS_GetArrayBufferData( jsBuffer, &isShared, nogc );
+            std::memcpy( pData, data_.data() + pos_, byteLength );
+        }
+        pos_ += byteLength;
+
+        return jsBuffer;
+    }
+
+    JSObject* CreateTypedArray( js::Scalar::Type arrayType, JS::HandleObject jsBuffer, uint32_t byteLength )
+    {
+        const auto elementSize = [arrayType]() -> uint32_t {
+            switch ( arrayType )
+            {
+            case js::Scalar::Int8:
+            case js::Scalar::Uint8:
+            case js::Scalar::Uint8Clamped:
+                return 1;
+            case js::Scalar::Int16:
+            case js::Scalar::Uint16:
+                return 2;
+            case js::Scalar::Int32:
+            case js::Scalar::Uint32:
+            case js::Scalar::Float32:
+                return 4;
+            case js::Scalar::Float64:
+                return 8;
+            default:
+                throw smp::SmpException( "Corrupted serialized value" );
+            }
+        }();
+        smp::SmpException::ExpectTrue( !( byteLength % elementSize ), "Corrupted serialized value" );
+
+        const int32_t length = byteLength / elementSize;
+        JSObject* pJsArray = [&]() -> JSObject* {
+            switch ( arrayType )
+            {
+            case js::Scalar::Int8:
+                return JS_NewInt8ArrayWithBuffer( pJsCtx_, jsBuffer, 0, length );
+            case js::Scalar::Uint8:
+                return JS_NewUint8ArrayWithBuffer( pJsCtx_, jsBuffer, 0, length );
+            case js::Scalar::Uint8Clamped:
+                return JS_NewUint8ClampedArrayWithBuffer( pJsCtx_, jsBuffer, 0, length );
+            case js::Scalar::Int16:
+                return JS_NewInt16ArrayWithBuffer( pJsCtx_, jsBuffer, 0, length );
+            case js::Scalar::Uint16:
+                return JS_NewUint16ArrayWithBuffer( pJsCtx_, jsBuffer, 0, length );
+            case js::Scalar::Int32:
+                return JS_NewInt32ArrayWithBuffer( pJsCtx_, jsBuffer, 0, length );
+            case js::Scalar::Uint32:
+                return JS_NewUint32ArrayWithBuffer( pJsCtx_, jsBuffer, 0, length );
+            case js::Scalar::Float32:
+                return JS_NewFloat32ArrayWithBuffer( pJsCtx_, jsBuffer, 0, length );
+            case js::Scalar::Float64:
+                return JS_NewFloat64ArrayWithBuffer( pJsCtx_, jsBuffer, 0, length );
+            default:
+                assert( 0 );
+                return nullptr;
+            }
+        }();
+        smp::JsException::ExpectTrue( pJsArray );
+
+        return pJsArray;
+    }
+
+    void AddObject( JS::HandleObject jsObject )
+    {
+        if ( !objects_.append( jsObject ) )
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    std::u8string ReadString()
+    {
+        const auto length = ReadPod<uint32_t>();
+        smp::SmpException::ExpectTrue( data_.size() - pos_ >= length, "Corrupted serialized value" );
+
+        std::u8string value( reinterpret_cast<const char*>( data_.data() + pos_ ), length );
+        pos_ += length;
+
+        return value;
+    }
+
+    template <typename T>
+    T ReadPod()
+    {
+        static_assert( std::is_trivially_copyable_v<T> );
+        smp::SmpException::ExpectTrue( data_.size() - pos_ >= sizeof( T ), "Corrupted serialized value" );
+
+        T value;
+        std::memcpy( &value, data_.data() + pos_, sizeof( T ) );
+        pos_ += sizeof( T );
+
+        return value;
+    }
+
+private:
+    JSContext* pJsCtx_ = nullptr;
+    JS::AutoObjectVector objects_;
+    uint32_t depth_ = 0;
+    const std::vector<uint8_t>& data_;
+    size_t pos_ = 0;
+};
+
+} // namespace
+
 namespace mozjs
 {
 
@@ -28,6 +538,11 @@ SerializedJsValue SerializeJsValue( JSContext* cx, JS::HandleValue jsValue )
         JS::RootedValue rVal( cx, jsValue );
         serializedValue = convert::to_native::ToValue<std::u8string>( cx, rVal );
     }
+    else if ( jsValue.isObject() && !JS_ObjectIsFunction( cx, &jsValue.toObject() ) )
+    {
+        JS::RootedObject jsObject( cx, &jsValue.toObject() );
+        serializedValue = SerializedJsStructure{ StructureWriter( cx ).Write( jsObject ) };
+    }
     else
     {
         throw smp::SmpException( "Unsupported value type" );
@@ -56,6 +571,10 @@ void DeserializeJsValue( JSContext* cx, const SerializedJsValue& serializedValue
         {
             convert::to_js::ToValue( cx, arg, jsValue );
         }
+        else if constexpr ( std::is_same_v<T, SerializedJsStructure> )
+        {
+            StructureReader( cx, arg.data ).Read( jsValue );
+        }
         else
         {
             static_assert( false, "non-exhaustive visitor!" );
@@ -63,4 +582,23 @@ void DeserializeJsValue( JSContext* cx, const SerializedJsValue& serializedValue
     }, serializedValue );
 }
 
+size_t GetSerializedValueSize( const SerializedJsValue& serializedValue )
+{
+    return std::visit( []( auto&& arg ) -> size_t {
+        using T = std::decay_t<decltype( arg )>;
+        if constexpr ( std::is_same_v<T, std::u8string> )
+        {
+            return arg.length();
+        }
+        else if constexpr ( std::is_same_v<T, SerializedJsStructure> )
+        {
+            return arg.data.size();
+        }
+        else
+        {
+            return sizeof( T );
+        }
+    }, serializedValue );
+}
+
 } // namespace mozjs
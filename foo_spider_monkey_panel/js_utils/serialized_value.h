@@ -2,14 +2,24 @@
 
 #include <optional>
 #include <variant>
+#include <vector>
 
 namespace mozjs
 {
 
-using SerializedJsValue = std::variant<bool, int32_t, double, std::u8string>;
+/// @brief Arrays, plain objects, ArrayBuffers and typed arrays in a compact binary form.
+///        Stored as is and decoded to JS value only when requested.
+struct SerializedJsStructure
+{
+    std::vector<uint8_t> data;
+};
+
+using SerializedJsValue = std::variant<bool, int32_t, double, std::u8string, SerializedJsStructure>;
 
 SerializedJsValue SerializeJsValue( JSContext* cx, JS::HandleValue jsValue );
 void DeserializeJsValue( JSContext* cx, const SerializedJsValue& serializedValue, JS::MutableHandleValue jsValue );
 
+/// @brief Returns the amount of bytes that serialized value occupies in config
+size_t GetSerializedValueSize( const SerializedJsValue& serializedValue );
 
 }
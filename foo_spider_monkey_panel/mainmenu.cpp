@@ -1,6 +1,9 @@
 #include <stdafx.h>
 #include "user_message.h"
 
+#include <js_engine/js_engine.h>
+#include <utils/trace_recorder.h>
+
 #include <message_manager.h>
 
 using namespace smp;
@@ -25,6 +28,26 @@ private:
     const std::array<GUID, 10> menuObjects_;
 };
 
+class my_profiler_mainmenu_commands : public mainmenu_commands
+{
+public:
+    enum class ProfilerCommand : t_uint32
+    {
+        sampling_profiler,
+        tracing,
+        count
+    };
+
+public:
+    t_uint32 get_command_count() override;
+    GUID get_command( t_uint32 p_index ) override;
+    void get_name( t_uint32 p_index, pfc::string_base& p_out ) override;
+    bool get_description( t_uint32 p_index, pfc::string_base& p_out ) override;
+    GUID get_parent() override;
+    void execute( t_uint32 p_index, service_ptr_t<service_base> p_callback ) override;
+    bool get_display( t_uint32 p_index, pfc::string_base& p_out, t_uint32& p_flags ) override;
+};
+
 } // namespace
 
 namespace
@@ -88,6 +111,122 @@ bool my_mainmenu_commands::get_display( t_uint32 p_index, pfc::string_base& p_ou
     return true;
 }
 
+t_uint32 my_profiler_mainmenu_commands::get_command_count()
+{
+    return static_cast<t_uint32>( ProfilerCommand::count );
+}
+GUID my_profiler_mainmenu_commands::get_command( t_uint32 p_index )
+{
+    switch ( static_cast<ProfilerCommand>( p_index ) )
+    {
+    case ProfilerCommand::sampling_profiler:
+        return smp::guid::menu_sampling_profiler;
+    case ProfilerCommand::tracing:
+        return smp::guid::menu_tracing;
+    default:
+        uBugCheck();
+        return pfc::guid_null;
+    }
+}
+void my_profiler_mainmenu_commands::get_name( t_uint32 p_index, pfc::string_base& p_out )
+{
+    switch ( static_cast<ProfilerCommand>( p_index ) )
+    {
+    case ProfilerCommand::sampling_profiler:
+        p_out = "Sampling profiler";
+        break;
+    case ProfilerCommand::tracing:
+        p_out = "Tracing";
+        break;
+    default:
+        uBugCheck();
+    }
+}
+bool my_profiler_mainmenu_commands::get_description( t_uint32 p_index, pfc::string_base& p_out )
+{
+    switch ( static_cast<ProfilerCommand>( p_index ) )
+    {
+    case ProfilerCommand::sampling_profiler:
+        p_out = "Start or stop sampling profiler for panel scripts";
+        return true;
+    case ProfilerCommand::tracing:
+        p_out = "Start or stop recording of Chrome trace";
+        return true;
+    default:
+        return false;
+    }
+}
+GUID my_profiler_mainmenu_commands::get_parent()
+{
+    return smp::guid::mainmenu_group;
+}
+void my_profiler_mainmenu_commands::execute( t_uint32 p_index, service_ptr_t<service_base> /* p_callback */ )
+{
+    try
+    {
+        switch ( static_cast<ProfilerCommand>( p_index ) )
+        {
+        case ProfilerCommand::sampling_profiler:
+        {
+            auto& profiler = mozjs::JsEngine::GetInstance().GetSamplingProfiler();
+            if ( !profiler.IsRunning() )
+            {
+                profiler.Start( mozjs::JsSamplingProfiler::kDefaultFrequency );
+                FB2K_console_formatter() << SMP_NAME_WITH_VERSION ": sampling profiler started";
+            }
+            else
+            {
+                const auto [collapsedPath, tracePath] = profiler.Stop();
+                FB2K_console_formatter() << SMP_NAME_WITH_VERSION ": sampling profile saved:\n"
+                                         << collapsedPath.u8string().c_str() << "\n"
+                                         << tracePath.u8string().c_str();
+            }
+            break;
+        }
+        case ProfilerCommand::tracing:
+        {
+            auto& traceRecorder = smp::utils::TraceRecorder::GetInstance();
+            if ( !smp::utils::TraceRecorder::IsEnabled() )
+            {
+                traceRecorder.Start();
+                FB2K_console_formatter() << SMP_NAME_WITH_VERSION ": tracing started";
+            }
+            else
+            {
+                const auto tracePath = traceRecorder.Stop();
+                FB2K_console_formatter() << SMP_NAME_WITH_VERSION ": trace saved:\n"
+                                         << tracePath.u8string().c_str();
+            }
+            break;
+        }
+        default:
+            uBugCheck();
+        }
+    }
+    catch ( const SmpException& e )
+    {
+        FB2K_console_formatter() << "Error: " SMP_NAME_WITH_VERSION ": " << e.what();
+    }
+}
+bool my_profiler_mainmenu_commands::get_display( t_uint32 p_index, pfc::string_base& p_out, t_uint32& p_flags )
+{
+    get_name( p_index, p_out );
+
+    const bool isRunning = [p_index] {
+        switch ( static_cast<ProfilerCommand>( p_index ) )
+        {
+        case ProfilerCommand::sampling_profiler:
+            return mozjs::JsEngine::GetInstance().GetSamplingProfiler().IsRunning();
+        case ProfilerCommand::tracing:
+            return smp::utils::TraceRecorder::IsEnabled();
+        default:
+            return false;
+        }
+    }();
+    p_flags = ( isRunning ? mainmenu_commands::flag_checked : 0 );
+    return true;
+}
+
 } // namespace
 
 namespace
@@ -97,5 +236,6 @@ mainmenu_group_popup_factory g_mainmenu_group(
     smp::guid::mainmenu_group, mainmenu_groups::file, static_cast<t_uint32>( mainmenu_commands::sort_priority_dontcare ), SMP_NAME );
 
 mainmenu_commands_factory_t<my_mainmenu_commands> g_my_mainmenu_commands_factory;
+mainmenu_commands_factory_t<my_profiler_mainmenu_commands> g_my_profiler_mainmenu_commands_factory;
 
 } // namespace
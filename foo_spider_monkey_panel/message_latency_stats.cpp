@@ -0,0 +1,216 @@
+#include <stdafx.h>
+#include "message_latency_stats.h"
+
+#include <user_message.h>
+
+namespace
+{
+
+uint64_t ToUs( std::chrono::steady_clock::duration duration )
+{
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>( duration ).count();
+    return ( us < 0 ? 0 : static_cast<uint64_t>( us ) );
+}
+
+std::u8string FormatUs( uint64_t us )
+{
+    if ( us < 1000 )
+    {
+        return fmt::format( "{}us", us );
+    }
+    else if ( us < 1000 * 1000 )
+    {
+        return fmt::format( "{:.2f}ms", us / 1000.0 );
+    }
+    else
+    {
+        return fmt::format( "{:.2f}s", us / ( 1000.0 * 1000.0 ) );
+    }
+}
+
+std::u8string FormatHistogram( const smp::utils::HdrHistogram& histogram )
+{
+    return fmt::format( "mean {:>8}, p50 {:>8}, p90 {:>8}, p99 {:>8}, max {:>8}",
+                        FormatUs( static_cast<uint64_t>( histogram.GetMean() ) ),
+                        FormatUs( histogram.GetValueAtPercentile( 50 ) ),
+                        FormatUs( histogram.GetValueAtPercentile( 90 ) ),
+                        FormatUs( histogram.GetValueAtPercentile( 99 ) ),
+                        FormatUs( histogram.GetMax() ) );
+}
+
+} // namespace
+
+namespace smp::panel
+{
+
+void MessageLatencyStats::Record( UINT msg, std::chrono::steady_clock::duration queueDelay, std::chrono::steady_clock::duration handlerTime )
+{
+    auto& pStats = msgToStats_[msg];
+    if ( !pStats )
+    {
+        pStats = std::make_unique<MessageStats>();
+    }
+
+    pStats->queueDelay.Record( ToUs( queueDelay ) );
+    pStats->handlerTime.Record( ToUs( handlerTime ) );
+}
+
+void MessageLatencyStats::Reset()
+{
+    msgToStats_.clear();
+}
+
+const std::map<UINT, std::unique_ptr<MessageLatencyStats::MessageStats>>& MessageLatencyStats::GetStats() const
+{
+    return msgToStats_;
+}
+
+std::u8string MessageLatencyStats::GetMessageName( UINT msg )
+{
+    if ( IsInEnumRange<CallbackMessage>( msg ) )
+    {
+        switch ( static_cast<CallbackMessage>( msg ) )
+        {
+        case CallbackMessage::fb_item_focus_change:
+            return "on_item_focus_change";
+        case CallbackMessage::fb_item_played:
+            return "on_item_played";
+        case CallbackMessage::fb_library_items_added:
+            return "on_library_items_added";
+        case CallbackMessage::fb_library_items_changed:
+            return "on_library_items_changed";
+        case CallbackMessage::fb_library_items_removed:
+            return "on_library_items_removed";
+        case CallbackMessage::fb_metadb_changed:
+            return "on_metadb_changed";
+        case CallbackMessage::fb_playback_edited:
+            return "on_playback_edited";
+        case CallbackMessage::fb_playback_new_track:
+            return "on_playback_new_track";
+        case CallbackMessage::fb_playback_seek:
+            return "on_playback_seek";
+        case CallbackMessage::fb_playback_time:
+            return "on_playback_time";
+        case CallbackMessage::fb_playlist_items_added:
+            return "on_playlist_items_added";
+        case CallbackMessage::fb_playlist_items_removed:
+            return "on_playlist_items_removed";
+        case CallbackMessage::fb_playlist_items_reordered:
+            return "on_playlist_items_reordered";
+        case CallbackMessage::fb_volume_change:
+            return "on_volume_change";
+        case CallbackMessage::internal_file_changed:
+            return "on_file_changed";
+        case CallbackMessage::internal_file_promise_done:
+            return "<file promise>";
+        case CallbackMessage::internal_get_album_art_done:
+            return "on_get_album_art_done";
+        case CallbackMessage::internal_get_album_art_promise_done:
+            return "<album art promise>";
+        case CallbackMessage::internal_library_query_changed:
+            return "on_library_query_changed";
+        case CallbackMessage::internal_load_image_done:
+            return "on_load_image_done";
+        case CallbackMessage::internal_load_image_promise_done:
+            return "<image promise>";
+        case CallbackMessage::internal_timer_proc:
+            return "<timer>";
+        case CallbackMessage::internal_bitmap_promise_done:
+            return "<bitmap promise>";
+        default:
+            break;
+        }
+    }
+    else if ( IsInEnumRange<PlayerMessage>( msg ) )
+    {
+        switch ( static_cast<PlayerMessage>( msg ) )
+        {
+        case PlayerMessage::fb_always_on_top_changed:
+            return "on_always_on_top_changed";
+        case PlayerMessage::fb_cursor_follow_playback_changed:
+            return "on_cursor_follow_playback_changed";
+        case PlayerMessage::fb_dsp_preset_changed:
+            return "on_dsp_preset_changed";
+        case PlayerMessage::fb_output_device_changed:
+            return "on_output_device_changed";
+        case PlayerMessage::fb_playback_dynamic_info:
+            return "on_playback_dynamic_info";
+        case PlayerMessage::fb_playback_dynamic_info_track:
+            return "on_playback_dynamic_info_track";
+        case PlayerMessage::fb_playback_follow_cursor_changed:
+            return "on_playback_follow_cursor_changed";
+        case PlayerMessage::fb_playback_order_changed:
+            return "on_playback_order_changed";
+        case PlayerMessage::fb_playback_pause:
+            return "on_playback_pause";
+        case PlayerMessage::fb_playback_queue_changed:
+            return "on_playback_queue_changed";
+        case PlayerMessage::fb_playback_starting:
+            return "on_playback_starting";
+        case PlayerMessage::fb_playback_stop:
+            return "on_playback_stop";
+        case PlayerMessage::fb_playlist_item_ensure_visible:
+            return "on_playlist_item_ensure_visible";
+        case PlayerMessage::fb_playlist_items_selection_change:
+            return "on_playlist_items_selection_change";
+        case PlayerMessage::fb_playlist_stop_after_current_changed:
+            return "on_playlist_stop_after_current_changed";
+        case PlayerMessage::fb_playlist_switch:
+            return "on_playlist_switch";
+        case PlayerMessage::fb_playlists_changed:
+            return "on_playlists_changed";
+        case PlayerMessage::fb_replaygain_mode_changed:
+            return "on_replaygain_mode_changed";
+        case PlayerMessage::fb_selection_changed:
+            return "on_selection_changed";
+        case PlayerMessage::ui_colours_changed:
+            return "on_colours_changed";
+        case PlayerMessage::ui_font_changed:
+            return "on_font_changed";
+        default:
+            break;
+        }
+    }
+    else if ( IsInEnumRange<InternalAsyncMessage>( msg ) )
+    {
+        switch ( static_cast<InternalAsyncMessage>( msg ) )
+        {
+        case InternalAsyncMessage::main_menu_item:
+            return "on_main_menu";
+        case InternalAsyncMessage::refresh_bg:
+            return "<refresh background>";
+        case InternalAsyncMessage::reload_script:
+            return "<reload script>";
+        case InternalAsyncMessage::show_configure:
+            return "<show configure>";
+        case InternalAsyncMessage::show_properties:
+            return "<show properties>";
+        case InternalAsyncMessage::size_changed:
+            return "on_size";
+        default:
+            break;
+        }
+    }
+
+    return fmt::format( "<message {}>", msg );
+}
+
+std::u8string MessageLatencyStats::GenerateReport() const
+{
+    if ( msgToStats_.empty() )
+    {
+        return "  no messages were processed\n";
+    }
+
+    std::u8string report;
+    for ( const auto& [msg, pStats]: msgToStats_ )
+    {
+        report += fmt::format( "  {} (count: {})\n", GetMessageName( msg ), pStats->queueDelay.GetCount() );
+        report += fmt::format( "    queue:   {}\n", FormatHistogram( pStats->queueDelay ) );
+        report += fmt::format( "    handler: {}\n", FormatHistogram( pStats->handlerTime ) );
+    }
+
+    return report;
+}
+
+} // namespace smp::panel
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <utils/hdr_histogram.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+
+namespace smp::panel
+{
+
+/// @brief Per-message-type latency statistics of a single panel.
+/// @details Queue delay is the time between message post and its dispatch,
+///          handler time is the time spent processing the message (including nested messages).
+///          All values are in microseconds.
+class MessageLatencyStats
+{
+public:
+    struct MessageStats
+    {
+        utils::HdrHistogram queueDelay;
+        utils::HdrHistogram handlerTime;
+    };
+
+public:
+    MessageLatencyStats() = default;
+    ~MessageLatencyStats() = default;
+    MessageLatencyStats( const MessageLatencyStats& ) = delete;
+    MessageLatencyStats& operator=( const MessageLatencyStats& ) = delete;
+
+    void Record( UINT msg, std::chrono::steady_clock::duration queueDelay, std::chrono::steady_clock::duration handlerTime );
+    void Reset();
+
+    const std::map<UINT, std::unique_ptr<MessageStats>>& GetStats() const;
+
+    /// @return Name of async message (callback name for messages that invoke JS callbacks)
+    static std::u8string GetMessageName( UINT msg );
+    /// @brief Generates human-readable table with statistics
+    std::u8string GenerateReport() const;
+
+private:
+    std::map<UINT, std::unique_ptr<MessageStats>> msgToStats_;
+};
+
+} // namespace smp::panel
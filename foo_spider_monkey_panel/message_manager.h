@@ -3,6 +3,7 @@
 #include <user_message.h>
 #include <callback_data.h>
 
+#include <chrono>
 #include <mutex>
 #include <deque>
 #include <optional>
@@ -20,11 +21,14 @@ public:
             : id( id )
             , wp( wp )
             , lp( lp )
+            , postTime( std::chrono::steady_clock::now() )
         {
         }
         UINT id;
         uint32_t wp;
         uint32_t lp;
+        /// @brief Time of enqueueing, used for latency statistics
+        std::chrono::steady_clock::time_point postTime;
     };
 
 private:
@@ -0,0 +1,660 @@
+#include <stdafx.h>
+#include "sci_symbol_index.h"
+
+#include <utils/file_helpers.h>
+#include <utils/thread_helpers.h>
+
+#include <component_paths.h>
+
+#include <algorithm>
+#include <cctype>
+#include <optional>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+/// @brief Limits the depth of `include()` chains (and protects from cycles)
+constexpr size_t kMaxIncludeDepth = 4;
+
+enum class TokenType
+{
+    identifier, ///< might be qualified (e.g. `a.b.c`)
+    string,     ///< text without quotes
+    templateString,
+    punctuation
+};
+
+struct Token
+{
+    TokenType type;
+    std::u8string_view text;
+    size_t endPos; ///< position right after the token
+};
+
+bool IsIdentifierStart( char8_t ch )
+{
+    const auto uch = static_cast<unsigned char>( ch );
+    return ( std::isalpha( uch ) || ch == '_' || ch == '$' || uch >= 0x80 );
+}
+
+bool IsIdentifierChar( char8_t ch )
+{
+    return ( IsIdentifierStart( ch ) || std::isdigit( static_cast<unsigned char>( ch ) ) );
+}
+
+bool IsKeyword( std::u8string_view word )
+{
+    constexpr std::u8string_view kKeywords[] = {
+        "catch", "for", "function", "if", "return", "switch", "while", "with"
+    };
+    return ( std::cend( kKeywords ) != std::find( std::cbegin( kKeywords ), std::cend( kKeywords ), word ) );
+}
+
+std::u8string_view Trim( std::u8string_view str )
+{
+    const auto first = str.find_first_not_of( " \t" );
+    if ( first == std::u8string_view::npos )
+    {
+        return std::u8string_view{};
+    }
+    const auto last = str.find_last_not_of( " \t" );
+    return str.substr( first, last - first + 1 );
+}
+
+/// @brief Very simplified JS tokenizer: comments are skipped, regular expressions and multi-line constructs are not recognized
+std::vector<Token> Tokenize( std::u8string_view line )
+{
+    std::vector<Token> tokens;
+
+    size_t i = 0;
+    while ( i < line.size() )
+    {
+        const char8_t ch = line[i];
+        if ( std::isspace( static_cast<unsigned char>( ch ) ) )
+        {
+            ++i;
+            continue;
+        }
+
+        if ( ch == '/' && i + 1 < line.size() )
+        {
+            if ( line[i + 1] == '/' )
+            {
+                break;
+            }
+            if ( line[i + 1] == '*' )
+            {
+                const auto commentEnd = line.find( "*/", i + 2 );
+                if ( commentEnd == std::u8string_view::npos )
+                {
+                    break;
+                }
+                i = commentEnd + 2;
+                continue;
+            }
+        }
+
+        if ( IsIdentifierStart( ch ) )
+        {
+            const size_t start = i;
+            while ( i < line.size()
+                    && ( IsIdentifierChar( line[i] )
+                         || ( line[i] == '.' && i + 1 < line.size() && IsIdentifierStart( line[i + 1] ) ) ) )
+            {
+                ++i;
+            }
+            tokens.push_back( { TokenType::identifier, line.substr( start, i - start ), i } );
+            continue;
+        }
+
+        if ( std::isdigit( static_cast<unsigned char>( ch ) ) )
+        {
+            const size_t start = i;
+            while ( i < line.size() && ( IsIdentifierChar( line[i] ) || line[i] == '.' ) )
+            {
+                ++i;
+            }
+            tokens.push_back( { TokenType::punctuation, line.substr( start, i - start ), i } );
+            continue;
+        }
+
+        if ( ch == '\'' || ch == '"' || ch == '`' )
+        {
+            const size_t start = ++i;
+            while ( i < line.size() && line[i] != ch )
+            {
+                i += ( line[i] == '\\' ? 2 : 1 );
+            }
+            const size_t end = std::min( i, line.size() );
+            i = std::min( i + 1, line.size() );
+            tokens.push_back( { ( ch == '`' ? TokenType::templateString : TokenType::string ), line.substr( start, end - start ), i } );
+            continue;
+        }
+
+        // `=>` and comparison operators must not be confused with assignment
+        size_t len = 1;
+        if ( i + 1 < line.size() && line[i + 1] == '=' && ( ch == '=' || ch == '!' || ch == '<' || ch == '>' ) )
+        {
+            len = ( ( ch == '=' || ch == '!' ) && i + 2 < line.size() && line[i + 2] == '=' ) ? 3 : 2;
+        }
+        else if ( ch == '=' && i + 1 < line.size() && line[i + 1] == '>' )
+        {
+            len = 2;
+        }
+        tokens.push_back( { TokenType::punctuation, line.substr( i, len ), i + len } );
+        i += len;
+    }
+
+    return tokens;
+}
+
+class LineParser
+{
+public:
+    LineParser( std::u8string_view line, const std::vector<Token>& tokens )
+        : line_( line )
+        , tokens_( tokens )
+    {
+    }
+
+    bool IsIdentifier( size_t idx ) const
+    {
+        return ( idx < tokens_.size() && tokens_[idx].type == TokenType::identifier );
+    }
+
+    bool IsIdentifier( size_t idx, std::u8string_view text ) const
+    {
+        return ( IsIdentifier( idx ) && tokens_[idx].text == text );
+    }
+
+    bool IsPunctuation( size_t idx, std::u8string_view text ) const
+    {
+        return ( idx < tokens_.size() && tokens_[idx].type == TokenType::punctuation && tokens_[idx].text == text );
+    }
+
+    /// @return Index of the matching `)` token, nullopt if it's not on the same line
+    std::optional<size_t> FindClosingParen( size_t parenIdx ) const
+    {
+        assert( IsPunctuation( parenIdx, "(" ) );
+
+        size_t depth = 0;
+        for ( size_t i = parenIdx; i < tokens_.size(); ++i )
+        {
+            if ( IsPunctuation( i, "(" ) )
+            {
+                ++depth;
+            }
+            else if ( IsPunctuation( i, ")" ) && !--depth )
+            {
+                return i;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    /// @return Parameter list (including parentheses) that starts at `(` token
+    std::u8string GetParams( size_t parenIdx ) const
+    {
+        const auto closingIdxOpt = FindClosingParen( parenIdx );
+        const size_t start = tokens_[parenIdx].endPos;
+        const size_t end = ( closingIdxOpt ? tokens_[*closingIdxOpt].endPos - 1 : tokens_.back().endPos );
+
+        std::u8string params( "(" );
+        params += Trim( line_.substr( start, end - start ) );
+        params += ")";
+        return params;
+    }
+
+    /// @return Parameter list, if the expression at `idx` is a function or an arrow function
+    std::optional<std::u8string> GetFunctionParams( size_t idx ) const
+    {
+        if ( IsIdentifier( idx, "async" ) )
+        {
+            ++idx;
+        }
+
+        if ( IsIdentifier( idx, "function" ) )
+        {
+            const auto parenIdx = ( IsIdentifier( idx + 1 ) ? idx + 2 : idx + 1 );
+            if ( IsPunctuation( parenIdx, "(" ) )
+            {
+                return GetParams( parenIdx );
+            }
+            return std::nullopt;
+        }
+
+        if ( IsPunctuation( idx, "(" ) )
+        {
+            const auto closingIdxOpt = FindClosingParen( idx );
+            if ( closingIdxOpt && IsPunctuation( *closingIdxOpt + 1, "=>" ) )
+            {
+                return GetParams( idx );
+            }
+            return std::nullopt;
+        }
+
+        if ( IsIdentifier( idx ) && IsPunctuation( idx + 1, "=>" ) )
+        {
+            return "(" + std::u8string( tokens_[idx].text ) + ")";
+        }
+
+        return std::nullopt;
+    }
+
+private:
+    std::u8string_view line_;
+    const std::vector<Token>& tokens_;
+};
+
+void AddSymbol( std::vector<std::u8string>& symbols, std::u8string_view name, const std::u8string& params = std::u8string{} )
+{
+    if ( name.substr( 0, 5 ) == "this." )
+    {
+        name.remove_prefix( 5 );
+    }
+    if ( const auto protoPos = name.find( ".prototype." ); protoPos != std::u8string_view::npos )
+    { // methods are accessed through instances
+        name.remove_prefix( protoPos + 11 );
+    }
+    if ( name.empty() )
+    {
+        return;
+    }
+
+    symbols.emplace_back( std::u8string( name ) + params );
+}
+
+} // namespace
+
+namespace scintilla
+{
+
+int CompareCaseInsensitive( std::u8string_view a, std::u8string_view b )
+{
+    const int result = _strnicmp( a.data(), b.data(), std::min( a.size(), b.size() ) );
+    if ( result )
+    {
+        return result;
+    }
+    return ( a.size() == b.size() ? 0 : ( a.size() < b.size() ? -1 : 1 ) );
+}
+
+bool KeyWordComparator::operator()( std::u8string_view a, std::u8string_view b ) const
+{
+    const int result = CompareCaseInsensitive( a, b );
+    if ( !result && !a.empty() && !b.empty() && std::isalpha( static_cast<unsigned char>( a[0] ) ) && ( a[0] != b[0] ) )
+    {
+        return std::isupper( static_cast<unsigned char>( a[0] ) );
+    }
+    else
+    {
+        return result < 0;
+    }
+}
+
+KeyWords::const_iterator FindFirstWithPrefix( const KeyWords& words, std::u8string_view prefix )
+{
+    const auto it = std::lower_bound( words.cbegin(), words.cend(), prefix, []( const auto& word, const auto& prefix ) {
+        return CompareCaseInsensitive( word, prefix ) < 0;
+    } );
+
+    if ( it == words.cend() || CompareCaseInsensitive( std::u8string_view( *it ).substr( 0, prefix.size() ), prefix ) )
+    {
+        return words.cend();
+    }
+    return it;
+}
+
+SymbolIndex::SymbolIndex()
+    : fb2kPath_( smp::get_fb2k_path() )
+    , componentPath_( smp::get_fb2k_component_path() )
+    , profilePath_( smp::get_profile_path() )
+    , lines_( 1 ) // empty document still has a single line
+{
+}
+
+SymbolIndex::~SymbolIndex()
+{
+    if ( !pThread_ )
+    {
+        return;
+    }
+
+    {
+        std::unique_lock lock( updatesMutex_ );
+        isExiting_ = true;
+    }
+    hasUpdates_.notify_one();
+
+    pThread_->join();
+}
+
+void SymbolIndex::UpdateLines( size_t firstLine, size_t oldLineCount, std::vector<std::u8string> newLines )
+{
+    if ( !pThread_ )
+    {
+        pThread_ = std::make_unique<std::thread>( &SymbolIndex::ThreadMain, this );
+        smp::utils::SetThreadName( *pThread_, "SMP Symbol Indexer" );
+    }
+
+    {
+        std::unique_lock lock( updatesMutex_ );
+        updates_.push_back( LineUpdate{ firstLine, oldLineCount, std::move( newLines ) } );
+    }
+    hasUpdates_.notify_one();
+}
+
+std::shared_ptr<const KeyWords> SymbolIndex::GetSymbols() const
+{
+    std::unique_lock lock( symbolsMutex_ );
+    return pSymbols_;
+}
+
+void SymbolIndex::ThreadMain()
+{
+    while ( true )
+    {
+        std::deque<LineUpdate> updates;
+        {
+            std::unique_lock lock( updatesMutex_ );
+            hasUpdates_.wait( lock, [&] { return isExiting_ || !updates_.empty(); } );
+            if ( isExiting_ )
+            {
+                return;
+            }
+
+            std::swap( updates, updates_ );
+        }
+
+        for ( auto& update: updates )
+        {
+            ApplyUpdate( update );
+        }
+        RebuildSymbols();
+    }
+}
+
+void SymbolIndex::ApplyUpdate( LineUpdate& update )
+{
+    const auto firstLine = std::min( update.firstLine, lines_.size() );
+    const auto oldLineCount = std::min( update.oldLineCount, lines_.size() - firstLine );
+
+    std::vector<LineData> newLines;
+    newLines.reserve( update.newLines.size() );
+    for ( const auto& line: update.newLines )
+    {
+        newLines.emplace_back( ParseLine( line ) );
+    }
+
+    const auto itFirst = lines_.begin() + firstLine;
+    lines_.erase( itFirst, itFirst + oldLineCount );
+    lines_.insert( lines_.begin() + firstLine, std::make_move_iterator( newLines.begin() ), std::make_move_iterator( newLines.end() ) );
+}
+
+void SymbolIndex::RebuildSymbols()
+{
+    auto pSymbols = std::make_shared<KeyWords>();
+    std::unordered_set<std::u8string> visitedIncludes;
+
+    const auto addLineData = [&]( const LineData& lineData, size_t depth, auto& self ) -> void {
+        pSymbols->insert( pSymbols->end(), lineData.symbols.cbegin(), lineData.symbols.cend() );
+
+        if ( depth >= kMaxIncludeDepth )
+        {
+            return;
+        }
+
+        for ( const auto& path: lineData.includes )
+        {
+            if ( !visitedIncludes.emplace( path ).second )
+            {
+                continue;
+            }
+
+            const auto pIncludeData = GetIncludeData( path );
+            if ( pIncludeData )
+            {
+                self( *pIncludeData, depth + 1, self );
+            }
+        }
+    };
+
+    for ( const auto& lineData: lines_ )
+    {
+        addLineData( lineData, 0, addLineData );
+    }
+
+    std::sort( pSymbols->begin(), pSymbols->end(), KeyWordComparator{} );
+    pSymbols->erase( std::unique( pSymbols->begin(), pSymbols->end() ), pSymbols->end() );
+
+    std::unique_lock lock( symbolsMutex_ );
+    pSymbols_ = pSymbols;
+}
+
+const SymbolIndex::LineData* SymbolIndex::GetIncludeData( const std::u8string& path )
+{
+    std::error_code ec;
+    const auto fsPath = fs::u8path( path );
+    const auto writeTime = fs::last_write_time( fsPath, ec );
+    if ( ec )
+    {
+        includeCache_.erase( path );
+        return nullptr;
+    }
+
+    if ( const auto it = includeCache_.find( path );
+         it != includeCache_.cend() && it->second.writeTime == writeTime )
+    {
+        return &it->second.data;
+    }
+
+    std::u8string content;
+    try
+    {
+        content = smp::file::ReadFile( path, CP_UTF8 );
+    }
+    catch ( const smp::SmpException& )
+    {
+        includeCache_.erase( path );
+        return nullptr;
+    }
+
+    LineData data;
+    std::u8string_view contentView( content );
+    while ( !contentView.empty() )
+    {
+        const auto lineEnd = contentView.find( '\n' );
+        auto lineData = ParseLine( contentView.substr( 0, lineEnd ) );
+
+        data.symbols.insert( data.symbols.end(), std::make_move_iterator( lineData.symbols.begin() ), std::make_move_iterator( lineData.symbols.end() ) );
+        data.includes.insert( data.includes.end(), std::make_move_iterator( lineData.includes.begin() ), std::make_move_iterator( lineData.includes.end() ) );
+
+        if ( lineEnd == std::u8string_view::npos )
+        {
+            break;
+        }
+        contentView.remove_prefix( lineEnd + 1 );
+    }
+
+    auto& includeData = includeCache_[path];
+    includeData = IncludeData{ writeTime, std::move( data ) };
+    return &includeData.data;
+}
+
+SymbolIndex::LineData SymbolIndex::ParseLine( std::u8string_view line ) const
+{
+    LineData lineData;
+
+    const auto tokens = Tokenize( line );
+    const LineParser parser( line, tokens );
+
+    const auto getPathVariable = [&]( std::u8string_view name ) -> std::optional<std::u8string> {
+        if ( name == "fb.ProfilePath" )
+        {
+            return profilePath_;
+        }
+        if ( name == "fb.ComponentPath" )
+        {
+            return componentPath_;
+        }
+        if ( name == "fb.FoobarPath" )
+        {
+            return fb2kPath_;
+        }
+        return std::nullopt;
+    };
+
+    /// @return Evaluated path, if it consists only of string literals and known path variables
+    const auto parseIncludePath = [&]( size_t idx ) -> std::optional<std::u8string> {
+        std::u8string path;
+        for ( ; idx < tokens.size() && !parser.IsPunctuation( idx, ")" ) && !parser.IsPunctuation( idx, "," ); ++idx )
+        {
+            const auto& token = tokens[idx];
+            switch ( token.type )
+            {
+            case TokenType::string:
+            {
+                path += token.text;
+                break;
+            }
+            case TokenType::templateString:
+            {
+                auto text = token.text;
+                while ( !text.empty() )
+                {
+                    const auto exprStart = text.find( "${" );
+                    path += text.substr( 0, exprStart );
+                    if ( exprStart == std::u8string_view::npos )
+                    {
+                        break;
+                    }
+
+                    const auto exprEnd = text.find( '}', exprStart );
+                    if ( exprEnd == std::u8string_view::npos )
+                    {
+                        return std::nullopt;
+                    }
+
+                    const auto valueOpt = getPathVariable( Trim( text.substr( exprStart + 2, exprEnd - exprStart - 2 ) ) );
+                    if ( !valueOpt )
+                    {
+                        return std::nullopt;
+                    }
+                    path += *valueOpt;
+                    text.remove_prefix( exprEnd + 1 );
+                }
+                break;
+            }
+            case TokenType::identifier:
+            {
+                const auto valueOpt = getPathVariable( token.text );
+                if ( !valueOpt )
+                {
+                    return std::nullopt;
+                }
+                path += *valueOpt;
+                break;
+            }
+            case TokenType::punctuation:
+            {
+                if ( token.text != "+" )
+                {
+                    return std::nullopt;
+                }
+                break;
+            }
+            default:
+            {
+                assert( false );
+                break;
+            }
+            }
+        }
+
+        if ( path.empty() )
+        {
+            return std::nullopt;
+        }
+        return path;
+    };
+
+    for ( size_t i = 0; i < tokens.size(); ++i )
+    {
+        if ( !parser.IsIdentifier( i ) )
+        {
+            continue;
+        }
+
+        const auto name = tokens[i].text;
+        if ( name == "function" )
+        { // function NAME(...)
+            if ( parser.IsIdentifier( i + 1 ) && parser.IsPunctuation( i + 2, "(" ) )
+            {
+                AddSymbol( lineData.symbols, tokens[i + 1].text, parser.GetParams( i + 2 ) );
+            }
+        }
+        else if ( name == "class" )
+        { // class NAME
+            if ( parser.IsIdentifier( i + 1 ) && !parser.IsIdentifier( i + 1, "extends" ) )
+            {
+                AddSymbol( lineData.symbols, tokens[i + 1].text );
+            }
+        }
+        else if ( name == "var" || name == "let" || name == "const" )
+        { // var NAME = ...
+            if ( parser.IsIdentifier( i + 1 ) )
+            {
+                const auto paramsOpt = ( parser.IsPunctuation( i + 2, "=" ) ? parser.GetFunctionParams( i + 3 ) : std::nullopt );
+                AddSymbol( lineData.symbols, tokens[i + 1].text, paramsOpt.value_or( std::u8string{} ) );
+                ++i;
+            }
+        }
+        else if ( name == "include" )
+        { // include(PATH)
+            if ( parser.IsPunctuation( i + 1, "(" ) )
+            {
+                const auto pathOpt = parseIncludePath( i + 2 );
+                if ( pathOpt && fs::u8path( *pathOpt ).is_absolute() )
+                {
+                    lineData.includes.emplace_back( fs::u8path( *pathOpt ).lexically_normal().u8string() );
+                }
+            }
+        }
+        else if ( parser.IsPunctuation( i + 1, "=" ) )
+        { // QUALIFIED.NAME = function(...) or this.NAME = ...
+            const auto paramsOpt = parser.GetFunctionParams( i + 2 );
+            if ( paramsOpt && name.find( '.' ) != std::u8string_view::npos )
+            {
+                AddSymbol( lineData.symbols, name, *paramsOpt );
+            }
+            else if ( name.substr( 0, 5 ) == "this." && name.find( '.', 5 ) == std::u8string_view::npos )
+            {
+                AddSymbol( lineData.symbols, name, paramsOpt.value_or( std::u8string{} ) );
+            }
+        }
+        else if ( parser.IsPunctuation( i + 1, ":" ) )
+        { // NAME: function(...)
+            if ( const auto paramsOpt = parser.GetFunctionParams( i + 2 ); paramsOpt )
+            {
+                AddSymbol( lineData.symbols, name, *paramsOpt );
+            }
+        }
+        else if ( ( i == 0 || ( i == 1 && ( parser.IsIdentifier( 0, "static" ) || parser.IsIdentifier( 0, "async" ) || parser.IsIdentifier( 0, "get" ) || parser.IsIdentifier( 0, "set" ) ) ) )
+                  && parser.IsPunctuation( i + 1, "(" ) && !IsKeyword( name ) && name.find( '.' ) == std::u8string_view::npos )
+        { // class method: NAME(...) {
+            const auto closingIdxOpt = parser.FindClosingParen( i + 1 );
+            if ( closingIdxOpt && parser.IsPunctuation( *closingIdxOpt + 1, "{" ) )
+            {
+                AddSymbol( lineData.symbols, name, parser.GetParams( i + 1 ) );
+            }
+        }
+    }
+
+    return lineData;
+}
+
+} // namespace scintilla
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace scintilla
+{
+
+/// @return Case-insensitive comparison result (same as _stricmp)
+int CompareCaseInsensitive( std::u8string_view a, std::u8string_view b );
+
+/// @brief Case-insensitive ordering of keywords, upper-case variant goes first
+struct KeyWordComparator
+{
+    bool operator()( std::u8string_view a, std::u8string_view b ) const;
+};
+
+/// @brief Sorted (with KeyWordComparator) list of keywords
+using KeyWords = std::vector<std::u8string>;
+
+/// @return Iterator to the first word that starts with `prefix` (case-insensitive).
+KeyWords::const_iterator FindFirstWithPrefix( const KeyWords& words, std::u8string_view prefix );
+
+/// @brief Indexes symbols (functions, variables, properties) defined in the script and in the files it includes.
+/// @details Document is parsed line by line in a background thread: only changed lines are re-parsed.
+///          Declarations that span multiple lines are not fully supported (e.g. only the first line of parameter list is used).
+class SymbolIndex
+{
+public:
+    SymbolIndex();
+    ~SymbolIndex();
+    SymbolIndex( const SymbolIndex& ) = delete;
+    SymbolIndex& operator=( const SymbolIndex& ) = delete;
+
+    /// @brief Replaces lines [firstLine, firstLine + oldLineCount) with `newLines`.
+    /// @details Processed asynchronously.
+    void UpdateLines( size_t firstLine, size_t oldLineCount, std::vector<std::u8string> newLines );
+
+    /// @return Symbols from the latest processed update, might be null
+    std::shared_ptr<const KeyWords> GetSymbols() const;
+
+private:
+    struct LineUpdate
+    {
+        size_t firstLine;
+        size_t oldLineCount;
+        std::vector<std::u8string> newLines;
+    };
+
+    struct LineData
+    {
+        std::vector<std::u8string> symbols;
+        std::vector<std::u8string> includes;
+    };
+
+    struct IncludeData
+    {
+        std::filesystem::file_time_type writeTime;
+        LineData data;
+    };
+
+    void ThreadMain();
+    void ApplyUpdate( LineUpdate& update );
+    void RebuildSymbols();
+    /// @return nullptr if file could not be read
+    const LineData* GetIncludeData( const std::u8string& path );
+
+    LineData ParseLine( std::u8string_view line ) const;
+
+private:
+    // main thread data
+
+    const std::u8string fb2kPath_;
+    const std::u8string componentPath_;
+    const std::u8string profilePath_;
+
+    // shared data
+
+    std::unique_ptr<std::thread> pThread_;
+    std::mutex updatesMutex_;
+    std::condition_variable hasUpdates_;
+    std::deque<LineUpdate> updates_;
+    bool isExiting_ = false;
+
+    mutable std::mutex symbolsMutex_;
+    std::shared_ptr<const KeyWords> pSymbols_;
+
+    // worker thread data
+
+    std::vector<LineData> lines_;
+    std::unordered_map<std::u8string, IncludeData> includeCache_;
+};
+
+} // namespace scintilla
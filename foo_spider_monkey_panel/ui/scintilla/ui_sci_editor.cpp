@@ -253,19 +253,6 @@ bool StartsWith( const std::u8string_view& a, const std::u8string_view& b )
 namespace scintilla
 {
 
-bool CScriptEditorCtrl::KeyWordComparator::operator()( const std::u8string& a, const std::u8string& b )
-{
-    const int result = _stricmp( a.c_str(), b.c_str() );
-    if ( !result && !a.empty() && !b.empty() && std::isalpha( a[0] ) && ( a[0] != b[0] ) )
-    {
-        return std::isupper( static_cast<unsigned char>( a[0] ) );
-    }
-    else
-    {
-        return result < 0;
-    }
-}
-
 CScriptEditorCtrl::CScriptEditorCtrl()
     : CScintillaFindReplaceImpl<CScriptEditorCtrl>( *this )
     , CScintillaGotoImpl( *this )
@@ -282,6 +269,9 @@ LRESULT CScriptEditorCtrl::OnKeyDown( UINT uMsg, WPARAM wParam, LPARAM lParam, B
 
 LRESULT CScriptEditorCtrl::OnUpdateUI( LPNMHDR pnmn )
 {
+    // SCN_UPDATEUI is sent after a batch of modifications is complete
+    FlushLineUpdates();
+
     const auto bracePos = FindBraceMatchPos();
     if ( bracePos.current )
     {
@@ -386,6 +376,36 @@ LRESULT CScriptEditorCtrl::OnZoom( LPNMHDR pnmn )
     return 0;
 }
 
+LRESULT CScriptEditorCtrl::OnModified( LPNMHDR pnmn )
+{
+    auto* notification = reinterpret_cast<SCNotification*>( pnmn );
+    if ( !( notification->modificationType & ( SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT ) ) )
+    {
+        return 0;
+    }
+
+    const int line = LineFromPosition( notification->position );
+    const int linesAdded = notification->linesAdded;
+    const int affectedEnd = line + 1 + std::max( linesAdded, 0 );
+
+    if ( !m_pendingLineUpdate )
+    {
+        m_pendingLineUpdate = PendingLineUpdate{ line, affectedEnd, linesAdded };
+        return 0;
+    }
+
+    auto& pending = *m_pendingLineUpdate;
+    if ( line < pending.lastLine )
+    { // pending lines were shifted
+        pending.lastLine = std::max( pending.lastLine + linesAdded, line + 1 );
+    }
+    pending.firstLine = std::min( pending.firstLine, line );
+    pending.lastLine = std::max( pending.lastLine, affectedEnd );
+    pending.linesAdded += linesAdded;
+
+    return 0;
+}
+
 LRESULT CScriptEditorCtrl::OnChange( UINT uNotifyCode, int nID, HWND wndCtl )
 {
     AutoMarginWidth();
@@ -478,7 +498,7 @@ void CScriptEditorCtrl::ReadAPI()
             {
                 if ( !line.empty() && IsCSym( line[0] ) )
                 {
-                    m_apis.emplace( line.data(), line.size() );
+                    m_apis.emplace_back( line.data(), line.size() );
                 }
             }
         }
@@ -488,6 +508,9 @@ void CScriptEditorCtrl::ReadAPI()
             FB2K_console_formatter() << e.what();
         }
     }
+
+    std::sort( m_apis.begin(), m_apis.end(), KeyWordComparator{} );
+    m_apis.erase( std::unique( m_apis.begin(), m_apis.end() ), m_apis.end() );
 }
 
 void CScriptEditorCtrl::SetContent( const char* text, bool clear_undo_buffer )
@@ -863,11 +886,6 @@ void CScriptEditorCtrl::FillFunctionDefinition( int pos )
         m_nLastPosCallTip = pos;
     }
 
-    if ( m_apis.empty() )
-    {
-        return;
-    }
-
     auto definitionRet = GetFullDefinitionForWord( m_szCurrentCallTipWord );
     if ( !definitionRet )
     {
@@ -882,11 +900,6 @@ void CScriptEditorCtrl::FillFunctionDefinition( int pos )
 
 bool CScriptEditorCtrl::StartAutoComplete()
 {
-    if ( m_apis.empty() )
-    {
-        return false;
-    }
-
     const std::u8string line = GetCurrentLine();
     const size_t curPos = static_cast<size_t>( GetCaretInLine() );
 
@@ -1069,33 +1082,29 @@ CScriptEditorCtrl::BracePosition CScriptEditorCtrl::FindBraceMatchPos()
 
 std::optional<std::vector<std::u8string_view>> CScriptEditorCtrl::GetNearestWords( std::u8string_view wordPart, std::optional<char8_t> separator )
 {
-    if ( m_apis.empty() )
-    {
-        return std::nullopt;
-    }
-
-    const auto startsWithPart = [&wordPart]( std::u8string_view word ) -> bool {
-        return StartsWith_CaseInsensitive( word, wordPart );
-    };
+    m_pScriptSymbols = m_symbolIndex.GetSymbols();
 
     std::vector<std::u8string_view> words;
-    for ( auto it = ranges::find_if( m_apis, startsWithPart ); it != m_apis.end() && startsWithPart( *it ); ++it )
-    {
-        const auto& word = *it;
-        std::u8string_view wordToPlace;
-        if ( separator )
+    const auto addWords = [&]( const KeyWords& keyWords ) {
+        for ( auto it = FindFirstWithPrefix( keyWords, wordPart ); it != keyWords.cend() && StartsWith_CaseInsensitive( *it, wordPart ); ++it )
         {
-            const auto charIt = ranges::find( word, *separator );
-            if ( word.cend() != charIt )
+            std::u8string_view wordToPlace = *it;
+            if ( separator )
             {
-                wordToPlace = std::u8string_view( word.c_str(), (size_t)std::distance( word.cbegin(), charIt ) );
+                const auto separatorPos = wordToPlace.find( *separator );
+                if ( separatorPos != std::u8string_view::npos && separatorPos )
+                {
+                    wordToPlace = wordToPlace.substr( 0, separatorPos );
+                }
             }
+            words.emplace_back( wordToPlace );
         }
-        if ( wordToPlace.empty() )
-        {
-            wordToPlace = word;
-        }
-        words.emplace_back( wordToPlace );
+    };
+
+    addWords( m_apis );
+    if ( m_pScriptSymbols )
+    {
+        addWords( *m_pScriptSymbols );
     }
 
     if ( words.empty() )
@@ -1103,28 +1112,33 @@ std::optional<std::vector<std::u8string_view>> CScriptEditorCtrl::GetNearestWord
         return std::nullopt;
     }
 
+    std::sort( words.begin(), words.end(), KeyWordComparator{} );
+    words.erase( std::unique( words.begin(), words.end() ), words.end() );
+
     return words;
 }
 
 std::optional<std::u8string_view> CScriptEditorCtrl::GetFullDefinitionForWord( std::u8string_view word )
 {
-    if ( m_apis.empty() )
+    const std::u8string wordWithBrace = std::u8string{ word.data(), word.size() } + '(';
+
+    if ( const auto it = FindFirstWithPrefix( m_apis, wordWithBrace ); it != m_apis.cend() )
     {
-        return std::nullopt;
+        return *it;
     }
 
-    const std::u8string wordWithBrace = std::u8string{ word.data(), word.size() } + '(';
-    const auto startsWithPart = [&wordWithBrace]( std::u8string_view word ) -> bool {
-        return StartsWith_CaseInsensitive( word, wordWithBrace );
-    };
-
-    auto it = ranges::find_if( m_apis, startsWithPart );
-    if ( it == m_apis.cend() )
+    m_pScriptSymbols = m_symbolIndex.GetSymbols();
+    if ( !m_pScriptSymbols )
     {
         return std::nullopt;
     }
 
-    return *it;
+    if ( const auto it = FindFirstWithPrefix( *m_pScriptSymbols, wordWithBrace ); it != m_pScriptSymbols->cend() )
+    {
+        return *it;
+    }
+
+    return std::nullopt;
 }
 
 std::optional<DWORD> CScriptEditorCtrl::GetPropertyColor( const char* key )
@@ -1394,4 +1408,34 @@ std::optional<std::u8string> CScriptEditorCtrl::GetPropertyExpanded_Opt( const c
     return propval;
 }
 
+void CScriptEditorCtrl::FlushLineUpdates()
+{
+    if ( !m_pendingLineUpdate )
+    {
+        return;
+    }
+
+    const auto [firstLine, lastLine, linesAdded] = *m_pendingLineUpdate;
+    m_pendingLineUpdate.reset();
+
+    std::vector<std::u8string> lines;
+    lines.reserve( lastLine - firstLine );
+    for ( int i = firstLine; i < std::min( lastLine, GetLineCount() ); ++i )
+    {
+        std::u8string line;
+        line.resize( GetLineLength( i ) );
+        if ( !line.empty() )
+        {
+            GetLine( i, line.data() );
+        }
+        while ( !line.empty() && ( line.back() == '\r' || line.back() == '\n' ) )
+        {
+            line.pop_back();
+        }
+        lines.emplace_back( std::move( line ) );
+    }
+
+    m_symbolIndex.UpdateLines( firstLine, lastLine - linesAdded - firstLine, std::move( lines ) );
+}
+
 } // namespace scintilla
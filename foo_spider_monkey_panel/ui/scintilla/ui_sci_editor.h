@@ -3,6 +3,7 @@
 // The License.txt file describes the conditions under which this software may be distributed.
 #pragma once
 
+#include <ui/scintilla/sci_symbol_index.h>
 #include <ui/scintilla/ui_sci_find_replace.h>
 #include <ui/scintilla/ui_sci_goto.h>
 #include <ui/scintilla/wtlscintilla.h>
@@ -11,8 +12,8 @@
 
 #include <nonstd/span.hpp>
 
+#include <memory>
 #include <optional>
-#include <set>
 
 namespace scintilla
 {
@@ -35,6 +36,7 @@ public:
         REFLECTED_NOTIFY_CODE_HANDLER_EX( SCN_UPDATEUI, OnUpdateUI )
         REFLECTED_NOTIFY_CODE_HANDLER_EX( SCN_CHARADDED, OnCharAdded )
         REFLECTED_NOTIFY_CODE_HANDLER_EX( SCN_ZOOM, OnZoom )
+        REFLECTED_NOTIFY_CODE_HANDLER_EX( SCN_MODIFIED, OnModified )
         REFLECTED_COMMAND_CODE_HANDLER_EX( SCEN_CHANGE, OnChange )
     END_MSG_MAP()
 
@@ -42,6 +44,7 @@ public:
     LRESULT OnUpdateUI( LPNMHDR pnmn );
     LRESULT OnCharAdded( LPNMHDR pnmh );
     LRESULT OnZoom( LPNMHDR pnmn );
+    LRESULT OnModified( LPNMHDR pnmn );
     LRESULT OnChange( UINT uNotifyCode, int nID, HWND wndCtl );
 
     bool ProcessKey( uint32_t vk );
@@ -61,10 +64,12 @@ private:
         isKeyWordStart // Keywords that cause indentation
     };
 
-    struct KeyWordComparator
+    /// @brief Lines modified since the last symbol index update
+    struct PendingLineUpdate
     {
-        bool operator()( const std::u8string& a,
-                         const std::u8string& b );
+        int firstLine;
+        int lastLine;   ///< exclusive, in the current document
+        int linesAdded; ///< might be negative
     };
 
     struct BracePosition
@@ -110,6 +115,7 @@ private:
     std::optional<std::u8string_view> GetFullDefinitionForWord( std::u8string_view word );
     void SetIndentation( int line, int indent );
     std::optional<std::u8string> GetPropertyExpanded_Opt( const char8_t* key );
+    void FlushLineUpdates();
 
 private:
     int m_nBraceCount = 0;
@@ -121,7 +127,12 @@ private:
     std::u8string m_szCurrentCallTipWord;
     std::u8string m_szFunctionDefinition;
 
-    std::set<std::u8string, KeyWordComparator> m_apis;
+    KeyWords m_apis;
+
+    SymbolIndex m_symbolIndex;
+    std::optional<PendingLineUpdate> m_pendingLineUpdate;
+    /// @brief Keeps alive words returned by GetNearestWords and GetFullDefinitionForWord
+    std::shared_ptr<const KeyWords> m_pScriptSymbols;
 };
 
 } // namespace scintilla
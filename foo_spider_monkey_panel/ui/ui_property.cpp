@@ -92,6 +92,9 @@ LRESULT CDialogProperty::OnPinItemChanged( LPNMHDR pnmh )
                     var.ChangeType( VT_BSTR );
                     arg = smp::unicode::ToU8( var.bstrVal );
                 }
+                else if constexpr ( std::is_same_v<T, mozjs::SerializedJsStructure> )
+                { // read-only
+                }
                 else
                 {
                     static_assert( false, "non-exhaustive visitor!" );
@@ -136,8 +139,11 @@ void CDialogProperty::LoadProperties( bool reload )
         }
     };
     std::map<std::wstring, HPROPERTY, LowerLexCmp> propMap;
+    size_t totalSize = 0;
     for ( const auto& [name, pSerializedValue]: m_dup_prop_map )
     {
+        totalSize += name.length() * sizeof( wchar_t ) + mozjs::GetSerializedValueSize( *pSerializedValue );
+
         HPROPERTY hProp = std::visit( [&name]( auto&& arg ) {
             using T = std::decay_t<decltype( arg )>;
             if constexpr ( std::is_same_v<T, bool> || std::is_same_v<T, int32_t> )
@@ -161,6 +167,12 @@ void CDialogProperty::LoadProperties( bool reload )
             {
                 return PropCreateSimple( name.c_str(), smp::unicode::ToWide( arg ).c_str() );
             }
+            else if constexpr ( std::is_same_v<T, mozjs::SerializedJsStructure> )
+            {
+                HPROPERTY hProp = PropCreateSimple( name.c_str(), fmt::format( L"<structured value: {} bytes>", arg.data.size() ).c_str() );
+                hProp->SetEnabled( FALSE );
+                return hProp;
+            }
             else
             {
                 static_assert( false, "non-exhaustive visitor!" );
@@ -174,6 +186,8 @@ void CDialogProperty::LoadProperties( bool reload )
     {
         m_properties.AddItem( hProp );
     }
+
+    SetWindowText( fmt::format( L"Properties ({} entries, {:.1f} KB)", m_dup_prop_map.size(), totalSize / 1024.0 ).c_str() );
 }
 
 LRESULT CDialogProperty::OnDelBnClicked( WORD wNotifyCode, WORD wID, HWND hWndCtl )
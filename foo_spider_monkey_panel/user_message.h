@@ -17,13 +17,20 @@ enum class CallbackMessage : UINT
     fb_playback_new_track,
     fb_playback_seek,
     fb_playback_time,
+    fb_playlist_items_added,
+    fb_playlist_items_removed,
+    fb_playlist_items_reordered,
     fb_volume_change,
+    internal_file_changed,
+    internal_file_promise_done,
     internal_get_album_art_done,
     internal_get_album_art_promise_done,
+    internal_library_query_changed,
     internal_load_image_done,
     internal_load_image_promise_done,
     internal_timer_proc,
-    last_message = internal_timer_proc,
+    internal_bitmap_promise_done,
+    last_message = internal_bitmap_promise_done,
 };
 
 /// @details These messages are asynchronous
@@ -43,9 +50,6 @@ enum class PlayerMessage : UINT
     fb_playback_starting,
     fb_playback_stop,
     fb_playlist_item_ensure_visible,
-    fb_playlist_items_added,
-    fb_playlist_items_reordered,
-    fb_playlist_items_removed,
     fb_playlist_items_selection_change,
     fb_playlist_stop_after_current_changed,
     fb_playlist_switch,
@@ -66,7 +70,8 @@ enum class InternalAsyncMessage : UINT
     reload_script,
     show_configure,
     show_properties,
-    last_message = show_properties,
+    size_changed,
+    last_message = size_changed,
 };
 
 /// @details These messages are synchronous
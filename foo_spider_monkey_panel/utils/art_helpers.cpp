@@ -1,10 +1,12 @@
 #include <stdafx.h>
 #include "art_helpers.h"
 
+#include <utils/bitmap_cache.h>
 #include <utils/gdi_helpers.h>
 #include <utils/string_helpers.h>
 #include <utils/thread_pool.h>
 #include <utils/scope_helpers.h>
+#include <utils/trace_recorder.h>
 
 #include <user_message.h>
 #include <message_manager.h>
@@ -59,7 +61,7 @@ void AlbumArtFetchTask::operator()()
 void AlbumArtFetchTask::run()
 {
     std::u8string imagePath;
-    std::unique_ptr<Gdiplus::Bitmap> bitmap = art::GetBitmapFromMetadbOrEmbed( handle_, artId_, needStub_, onlyEmbed_, noLoad_, &imagePath );
+    std::shared_ptr<Gdiplus::Bitmap> bitmap = art::GetBitmapFromMetadbOrEmbed( handle_, artId_, needStub_, onlyEmbed_, noLoad_, &imagePath );
 
     panel::message_manager::instance().post_callback_msg( hNotifyWnd_,
                                                           smp::CallbackMessage::internal_get_album_art_done,
@@ -67,20 +69,15 @@ void AlbumArtFetchTask::run()
                                                               smp::panel::CallbackDataImpl<
                                                                   metadb_handle_ptr,
                                                                   uint32_t,
-                                                                  std::unique_ptr<Gdiplus::Bitmap>,
+                                                                  std::shared_ptr<Gdiplus::Bitmap>,
                                                                   std::u8string>>( handle_,
                                                                                        artId_,
                                                                                        std::move( bitmap ),
                                                                                        imagePath ) );
 }
 
-std::unique_ptr<Gdiplus::Bitmap> GetBitmapFromAlbumArtData( const album_art_data_ptr& data )
+std::unique_ptr<Gdiplus::Bitmap> DecodeAlbumArtData( const album_art_data_ptr& data )
 {
-    if ( !data.is_valid() )
-    {
-        return nullptr;
-    }
-
     IStreamPtr iStream;
     {
         auto memStream = SHCreateMemStream( nullptr, 0 );
@@ -103,6 +100,8 @@ std::unique_ptr<Gdiplus::Bitmap> GetBitmapFromAlbumArtData( const album_art_data
         return nullptr;
     }
 
+    SMP_TRACE_SCOPE( "image", "DecodeArt" );
+
     std::unique_ptr<Gdiplus::Bitmap> bmp( new Gdiplus::Bitmap( static_cast<IStream*>( iStream ), TRUE ) );
     if ( !gdi::IsGdiPlusObjectValid( bmp ) )
     {
@@ -112,11 +111,17 @@ std::unique_ptr<Gdiplus::Bitmap> GetBitmapFromAlbumArtData( const album_art_data
     return bmp;
 }
 
+/// @details Decoded art is shared with other users of the same data
+std::shared_ptr<Gdiplus::Bitmap> GetBitmapFromAlbumArtData( const album_art_data_ptr& data )
+{
+    return utils::BitmapCache::GetInstance().GetOrDecode( data, DecodeAlbumArtData );
+}
+
 /// @details Throws pfc::exception, if art is not found or if aborted
-std::unique_ptr<Gdiplus::Bitmap> ExtractBitmap( album_art_extractor_instance_v2::ptr extractor, const GUID& artTypeGuid, bool no_load, std::u8string* pImagePath, abort_callback& abort )
+std::shared_ptr<Gdiplus::Bitmap> ExtractBitmap( album_art_extractor_instance_v2::ptr extractor, const GUID& artTypeGuid, bool no_load, std::u8string* pImagePath, abort_callback& abort )
 {
     album_art_data_ptr data = extractor->query( artTypeGuid, abort );
-    std::unique_ptr<Gdiplus::Bitmap> bitmap;
+    std::shared_ptr<Gdiplus::Bitmap> bitmap;
 
     if ( !no_load )
     {
@@ -238,7 +243,7 @@ const GUID& GetGuidForArtId( uint32_t art_id )
     return *guids[art_id];
 }
 
-std::unique_ptr<Gdiplus::Bitmap> GetBitmapFromEmbeddedData( const std::u8string& rawpath, uint32_t art_id )
+std::shared_ptr<Gdiplus::Bitmap> GetBitmapFromEmbeddedData( const std::u8string& rawpath, uint32_t art_id )
 {
     const pfc::string_extension extension( rawpath.c_str() );
     const GUID& artTypeGuid = GetGuidForArtId( art_id );
@@ -267,7 +272,7 @@ std::unique_ptr<Gdiplus::Bitmap> GetBitmapFromEmbeddedData( const std::u8string&
     return nullptr;
 }
 
-std::unique_ptr<Gdiplus::Bitmap> GetBitmapFromMetadb( const metadb_handle_ptr& handle, uint32_t art_id, bool need_stub, bool no_load, std::u8string* pImagePath )
+std::shared_ptr<Gdiplus::Bitmap> GetBitmapFromMetadb( const metadb_handle_ptr& handle, uint32_t art_id, bool need_stub, bool no_load, std::u8string* pImagePath )
 {
     assert( handle.is_valid() );
 
@@ -298,12 +303,12 @@ std::unique_ptr<Gdiplus::Bitmap> GetBitmapFromMetadb( const metadb_handle_ptr& h
     return nullptr;
 }
 
-std::unique_ptr<Gdiplus::Bitmap> GetBitmapFromMetadbOrEmbed( const metadb_handle_ptr& handle, uint32_t art_id, bool need_stub, bool only_embed, bool no_load, std::u8string* pImagePath )
+std::shared_ptr<Gdiplus::Bitmap> GetBitmapFromMetadbOrEmbed( const metadb_handle_ptr& handle, uint32_t art_id, bool need_stub, bool only_embed, bool no_load, std::u8string* pImagePath )
 {
     assert( handle.is_valid() );
 
     std::u8string imagePath;
-    std::unique_ptr<Gdiplus::Bitmap> bitmap;
+    std::shared_ptr<Gdiplus::Bitmap> bitmap;
 
     try
     {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -34,16 +35,19 @@ private:
 /// @throw smp::SmpException
 const GUID& GetGuidForArtId( uint32_t art_id );
 
+// Art images are shared between all users of the same art data (see smp::utils::BitmapCache):
+// they must not be modified in place.
+
 /// @throw smp::SmpException
 /// @throw smp::JsException
-std::unique_ptr<Gdiplus::Bitmap> GetBitmapFromEmbeddedData( const std::u8string& rawpath, uint32_t art_id );
+std::shared_ptr<Gdiplus::Bitmap> GetBitmapFromEmbeddedData( const std::u8string& rawpath, uint32_t art_id );
 
 /// @throw smp::SmpException
 /// @throw smp::JsException
-std::unique_ptr<Gdiplus::Bitmap> GetBitmapFromMetadb( const metadb_handle_ptr& handle, uint32_t art_id, bool need_stub, bool no_load, std::u8string* pImagePath );
+std::shared_ptr<Gdiplus::Bitmap> GetBitmapFromMetadb( const metadb_handle_ptr& handle, uint32_t art_id, bool need_stub, bool no_load, std::u8string* pImagePath );
 
 /// @details Validate art_id before calling this function!
-std::unique_ptr<Gdiplus::Bitmap> GetBitmapFromMetadbOrEmbed( const metadb_handle_ptr& handle, uint32_t art_id, bool need_stub, bool only_embed, bool no_load, std::u8string* pImagePath );
+std::shared_ptr<Gdiplus::Bitmap> GetBitmapFromMetadbOrEmbed( const metadb_handle_ptr& handle, uint32_t art_id, bool need_stub, bool only_embed, bool no_load, std::u8string* pImagePath );
 
 /// @throw smp::SmpException
 /// @throw smp::JsException
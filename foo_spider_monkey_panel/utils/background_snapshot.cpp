@@ -0,0 +1,135 @@
+#include <stdafx.h>
+#include "background_snapshot.h"
+
+namespace smp::gdi
+{
+
+BackgroundSnapshotCache& BackgroundSnapshotCache::GetInstance()
+{
+    static BackgroundSnapshotCache cache;
+    return cache;
+}
+
+void BackgroundSnapshotCache::Finalize()
+{
+    snapshots_.clear();
+}
+
+void BackgroundSnapshotCache::CopyBackground( HWND hParent, const RECT& childRect, HDC hDstDc, const CaptureFn& capture )
+{
+    assert( hParent );
+
+    RemoveStale();
+
+    RECT parentRect;
+    if ( !GetClientRect( hParent, &parentRect ) )
+    {
+        return;
+    }
+
+    RECT rect;
+    if ( !IntersectRect( &rect, &childRect, &parentRect ) )
+    { // panel is not visible inside the parent
+        return;
+    }
+    const int w = rect.right - rect.left;
+    const int h = rect.bottom - rect.top;
+    const int dstX = rect.left - childRect.left;
+    const int dstY = rect.top - childRect.top;
+
+    auto pSnapshot = GetSnapshot( hParent, parentRect.right - parentRect.left, parentRect.bottom - parentRect.top );
+    auto hRectRgn = CreateUniquePtr( CreateRectRgnIndirect( &rect ) );
+    if ( !pSnapshot || !hRectRgn )
+    { // capture directly without caching
+        ++recaptureCount_;
+        capture();
+
+        const HDC hParentDc = GetDC( hParent );
+        BitBlt( hDstDc, dstX, dstY, w, h, hParentDc, rect.left, rect.top, SRCCOPY );
+        ReleaseDC( hParent, hParentDc );
+        return;
+    }
+
+    auto hSnapshotDc = CreateUniquePtr( CreateCompatibleDC( hDstDc ) );
+    ObjectSelector autoBmp( hSnapshotDc.get(), pSnapshot->pBitmap->GetHandle() );
+
+    auto hMissingRgn = CreateUniquePtr( CreateRectRgn( 0, 0, 0, 0 ) );
+    const auto missingType = CombineRgn( hMissingRgn.get(), hRectRgn.get(), pSnapshot->hValidRgn.get(), RGN_DIFF );
+    if ( missingType == NULLREGION )
+    {
+        ++reuseCount_;
+    }
+    else
+    {
+        ++recaptureCount_;
+        capture();
+
+        const HDC hParentDc = GetDC( hParent );
+        BitBlt( hSnapshotDc.get(), rect.left, rect.top, w, h, hParentDc, rect.left, rect.top, SRCCOPY );
+        ReleaseDC( hParent, hParentDc );
+
+        CombineRgn( pSnapshot->hValidRgn.get(), pSnapshot->hValidRgn.get(), hRectRgn.get(), RGN_OR );
+    }
+
+    BitBlt( hDstDc, dstX, dstY, w, h, hSnapshotDc.get(), rect.left, rect.top, SRCCOPY );
+}
+
+void BackgroundSnapshotCache::Invalidate( HWND hParent )
+{
+    snapshots_.erase( hParent );
+}
+
+void BackgroundSnapshotCache::InvalidateAll()
+{
+    snapshots_.clear();
+}
+
+BackgroundSnapshotStats BackgroundSnapshotCache::GetStats() const
+{
+    return BackgroundSnapshotStats{ reuseCount_, recaptureCount_, snapshots_.size() };
+}
+
+BackgroundSnapshotCache::Snapshot* BackgroundSnapshotCache::GetSnapshot( HWND hParent, uint32_t parentWidth, uint32_t parentHeight )
+{
+    if ( auto it = snapshots_.find( hParent ); it != snapshots_.end() )
+    {
+        const auto& pBitmap = it->second.pBitmap;
+        if ( pBitmap->GetWidth() == parentWidth && pBitmap->GetHeight() == parentHeight )
+        {
+            return &it->second;
+        }
+
+        // parent was resized: all of its contents might have changed
+        snapshots_.erase( it );
+    }
+
+    auto pBitmap = DibSection::Create( parentWidth, parentHeight );
+    auto hValidRgn = CreateUniquePtr( CreateRectRgn( 0, 0, 0, 0 ) );
+    if ( !pBitmap || !hValidRgn )
+    {
+        return nullptr;
+    }
+
+    auto& snapshot = snapshots_[hParent];
+    snapshot.pBitmap = std::move( pBitmap );
+    snapshot.hValidRgn = std::move( hValidRgn );
+
+    return &snapshot;
+}
+
+void BackgroundSnapshotCache::RemoveStale()
+{
+    for ( auto it = snapshots_.begin(); it != snapshots_.end(); )
+    {
+        if ( !IsWindow( it->first ) )
+        {
+            it = snapshots_.erase( it );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+} // namespace smp::gdi
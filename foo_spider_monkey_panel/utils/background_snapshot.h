@@ -0,0 +1,72 @@
+#pragma once
+
+#include <utils/dib_pool.h>
+#include <utils/gdi_helpers.h>
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace smp::gdi
+{
+
+struct BackgroundSnapshotStats
+{
+    uint64_t reuseCount;
+    uint64_t recaptureCount;
+    size_t snapshotCount;
+};
+
+/// @brief Cache of parent window backgrounds that are used by pseudo-transparent panels.
+/// @details Every parent has a single snapshot of its client area that is shared between all of its child panels:
+///          each panel captures only its own slice and only if this slice was not captured before.
+///          Snapshot is discarded when the parent is resized and when theme or colours are changed.
+///          All methods must be called from the main thread.
+class BackgroundSnapshotCache
+{
+public:
+    /// @brief Repaints parent area under the panel, so that it can be copied from the parent DC
+    using CaptureFn = std::function<void()>;
+
+public:
+    ~BackgroundSnapshotCache() = default;
+    BackgroundSnapshotCache( const BackgroundSnapshotCache& ) = delete;
+    BackgroundSnapshotCache& operator=( const BackgroundSnapshotCache& ) = delete;
+
+    static BackgroundSnapshotCache& GetInstance();
+
+    void Finalize();
+
+    /// @brief Copies parent background under `childRect` to `hDstDc` at (0, 0).
+    /// @details `capture` is invoked only when the requested area is missing from the snapshot.
+    /// @param childRect Panel rect in `hParent` client coordinates
+    void CopyBackground( HWND hParent, const RECT& childRect, HDC hDstDc, const CaptureFn& capture );
+
+    void Invalidate( HWND hParent );
+    void InvalidateAll();
+
+    BackgroundSnapshotStats GetStats() const;
+
+private:
+    BackgroundSnapshotCache() = default;
+
+    struct Snapshot
+    {
+        std::unique_ptr<DibSection> pBitmap;
+        /// @brief Parts of the snapshot that were captured (in parent client coordinates)
+        unique_gdi_ptr<HRGN> hValidRgn{ nullptr, nullptr };
+    };
+
+    /// @return nullptr, if snapshot could not be created
+    Snapshot* GetSnapshot( HWND hParent, uint32_t parentWidth, uint32_t parentHeight );
+    /// @brief Removes snapshots of destroyed windows
+    void RemoveStale();
+
+private:
+    std::unordered_map<HWND, Snapshot> snapshots_;
+
+    uint64_t reuseCount_ = 0;
+    uint64_t recaptureCount_ = 0;
+};
+
+} // namespace smp::gdi
@@ -0,0 +1,93 @@
+#include <stdafx.h>
+#include "bitmap_cache.h"
+
+#include <utils/trace_recorder.h>
+
+namespace smp::utils
+{
+
+BitmapCache& BitmapCache::GetInstance()
+{
+    static BitmapCache cache;
+    return cache;
+}
+
+void BitmapCache::Finalize()
+{
+    std::scoped_lock sl( mutex_ );
+    entries_.clear();
+}
+
+std::shared_ptr<Gdiplus::Bitmap> BitmapCache::GetOrDecode( const album_art_data_ptr& data, const Decoder& decoder )
+{
+    if ( !data.is_valid() || !data->get_size() )
+    {
+        return nullptr;
+    }
+
+    const auto dataSize = data->get_size();
+    const auto digest = hasher_md5::get()->process_single( data->get_ptr(), dataSize );
+
+    {
+        std::scoped_lock sl( mutex_ );
+        if ( auto pBitmap = FindBitmap( dataSize, digest ) )
+        {
+            return pBitmap;
+        }
+    }
+
+    std::shared_ptr<Gdiplus::Bitmap> pBitmap( decoder( data ) );
+    if ( !pBitmap )
+    {
+        return nullptr;
+    }
+
+    std::scoped_lock sl( mutex_ );
+    if ( auto pOtherBitmap = FindBitmap( dataSize, digest ) )
+    { // same data was decoded concurrently in another thread
+        return pOtherBitmap;
+    }
+
+    RemoveExpired();
+    entries_.emplace( digest.xorHalve(), Entry{ dataSize, digest, pBitmap } );
+    SMP_TRACE_COUNTER( "image", "Shared art", entries_.size() );
+
+    return pBitmap;
+}
+
+std::shared_ptr<Gdiplus::Bitmap> BitmapCache::FindBitmap( size_t dataSize, const hasher_md5_result& digest ) const
+{
+    const auto [itBegin, itEnd] = entries_.equal_range( digest.xorHalve() );
+    for ( auto it = itBegin; it != itEnd; ++it )
+    {
+        const auto& entry = it->second;
+        if ( entry.dataSize != dataSize || entry.digest != digest )
+        {
+            continue;
+        }
+
+        if ( auto pBitmap = entry.pBitmap.lock() )
+        {
+            return pBitmap;
+        }
+    }
+
+    return nullptr;
+}
+
+void BitmapCache::RemoveExpired()
+{
+    for ( auto it = entries_.begin(); it != entries_.end(); )
+    {
+        if ( it->second.pBitmap.expired() )
+        {
+            it = entries_.erase( it );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+} // namespace smp::utils
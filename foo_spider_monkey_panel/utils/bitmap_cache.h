@@ -0,0 +1,57 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace smp::utils
+{
+
+/// @brief Process-wide registry of decoded album art.
+/// @details Art with the same encoded data is decoded only once and is shared between all users (and all panels).
+///          Cache does not own images: entry expires as soon as the last user releases its image.
+///          Encoded data is not retained: entries are identified by data size and MD5 digest.
+///          Shared images must not be modified (see copy-on-write in JsGdiBitmap).
+///          Thread-safe.
+class BitmapCache
+{
+public:
+    using Decoder = std::function<std::unique_ptr<Gdiplus::Bitmap>( const album_art_data_ptr& )>;
+
+public:
+    ~BitmapCache() = default;
+    BitmapCache( const BitmapCache& ) = delete;
+    BitmapCache& operator=( const BitmapCache& ) = delete;
+
+    static BitmapCache& GetInstance();
+
+    void Finalize();
+
+    /// @brief Returns the image that was decoded from the same data or decodes it via `decoder`.
+    /// @details `decoder` is invoked outside of the lock and must not throw.
+    /// @return nullptr, if data is invalid or if `decoder` has failed
+    std::shared_ptr<Gdiplus::Bitmap> GetOrDecode( const album_art_data_ptr& data, const Decoder& decoder );
+
+private:
+    BitmapCache() = default;
+
+    struct Entry
+    {
+        size_t dataSize;
+        hasher_md5_result digest; ///< used to resolve key collisions
+        std::weak_ptr<Gdiplus::Bitmap> pBitmap;
+    };
+
+    /// @details Must be called under lock
+    std::shared_ptr<Gdiplus::Bitmap> FindBitmap( size_t dataSize, const hasher_md5_result& digest ) const;
+    /// @details Must be called under lock
+    void RemoveExpired();
+
+private:
+    mutable std::mutex mutex_;
+    /// @brief Half of the digest > entry
+    std::unordered_multimap<uint64_t, Entry> entries_;
+};
+
+} // namespace smp::utils
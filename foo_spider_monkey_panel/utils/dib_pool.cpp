@@ -0,0 +1,154 @@
+#include <stdafx.h>
+#include "dib_pool.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+
+/// @brief Smallest dimension of the pooled bitmap
+constexpr uint32_t kMinDimension = 64;
+/// @brief Bitmap is not reused if its area is that many times bigger than the requested one
+constexpr uint64_t kMaxAreaWaste = 4;
+/// @brief Maximum memory held by unused bitmaps
+constexpr size_t kMaxFreeSize = 64 * 1024 * 1024;
+/// @brief Maximum amount of unused bitmaps
+constexpr size_t kMaxFreeCount = 8;
+
+/// @brief Size classes grow by 25% and are aligned to 32 pixels
+uint32_t GetSizeClass( uint32_t size )
+{
+    uint64_t sizeClass = kMinDimension;
+    while ( sizeClass < size )
+    {
+        sizeClass = ( sizeClass + sizeClass / 4 + 31 ) & ~31ull;
+    }
+    return static_cast<uint32_t>( std::min<uint64_t>( sizeClass, std::numeric_limits<uint32_t>::max() ) );
+}
+
+} // namespace
+
+namespace smp::gdi
+{
+
+DibSection::DibSection( unique_gdi_ptr<HBITMAP> hBitmap, uint32_t w, uint32_t h )
+    : hBitmap_( std::move( hBitmap ) )
+    , width_( w )
+    , height_( h )
+{
+}
+
+std::unique_ptr<DibSection> DibSection::Create( uint32_t w, uint32_t h )
+{
+    BITMAPINFO bmi{};
+    bmi.bmiHeader.biSize = sizeof( BITMAPINFOHEADER );
+    bmi.bmiHeader.biWidth = static_cast<LONG>( w );
+    bmi.bmiHeader.biHeight = -static_cast<LONG>( h ); ///< top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    void* pBits = nullptr;
+    auto hBitmap = CreateUniquePtr( CreateDIBSection( nullptr, &bmi, DIB_RGB_COLORS, &pBits, nullptr, 0 ) );
+    if ( !hBitmap || !pBits )
+    {
+        return nullptr;
+    }
+
+    return std::unique_ptr<DibSection>( new DibSection( std::move( hBitmap ), w, h ) );
+}
+
+HBITMAP DibSection::GetHandle() const
+{
+    return hBitmap_.get();
+}
+
+uint32_t DibSection::GetWidth() const
+{
+    return width_;
+}
+
+uint32_t DibSection::GetHeight() const
+{
+    return height_;
+}
+
+size_t DibSection::GetSize() const
+{
+    return static_cast<size_t>( width_ ) * height_ * 4;
+}
+
+DibPool& DibPool::GetInstance()
+{
+    static DibPool pool;
+    return pool;
+}
+
+void DibPool::Finalize()
+{
+    freeDibs_.clear();
+    freeSize_ = 0;
+}
+
+std::unique_ptr<DibSection> DibPool::Acquire( uint32_t w, uint32_t h, std::unique_ptr<DibSection> pCurrent )
+{
+    if ( pCurrent && IsSuitable( *pCurrent, w, h ) )
+    {
+        return pCurrent;
+    }
+
+    Release( std::move( pCurrent ) );
+
+    // best fit: the smallest suitable bitmap
+    auto itBest = freeDibs_.end();
+    for ( auto it = freeDibs_.begin(); it != freeDibs_.end(); ++it )
+    {
+        if ( IsSuitable( **it, w, h )
+             && ( itBest == freeDibs_.end() || ( *it )->GetSize() < ( *itBest )->GetSize() ) )
+        {
+            itBest = it;
+        }
+    }
+
+    if ( itBest != freeDibs_.end() )
+    {
+        auto pDib = std::move( *itBest );
+        freeDibs_.erase( itBest );
+        freeSize_ -= pDib->GetSize();
+        return pDib;
+    }
+
+    return DibSection::Create( GetSizeClass( w ), GetSizeClass( h ) );
+}
+
+void DibPool::Release( std::unique_ptr<DibSection> pDib )
+{
+    if ( !pDib )
+    {
+        return;
+    }
+
+    freeSize_ += pDib->GetSize();
+    freeDibs_.emplace_back( std::move( pDib ) );
+
+    Trim();
+}
+
+bool DibPool::IsSuitable( const DibSection& dib, uint32_t w, uint32_t h )
+{
+    const uint64_t minArea = static_cast<uint64_t>( std::max( w, kMinDimension ) ) * std::max( h, kMinDimension );
+    return ( dib.GetWidth() >= w && dib.GetHeight() >= h
+             && static_cast<uint64_t>( dib.GetWidth() ) * dib.GetHeight() <= kMaxAreaWaste * minArea );
+}
+
+void DibPool::Trim()
+{
+    while ( !freeDibs_.empty() && ( freeSize_ > kMaxFreeSize || freeDibs_.size() > kMaxFreeCount ) )
+    {
+        freeSize_ -= freeDibs_.front()->GetSize();
+        freeDibs_.erase( freeDibs_.begin() );
+    }
+}
+
+} // namespace smp::gdi
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <utils/gdi_helpers.h>
+
+#include <memory>
+#include <vector>
+
+namespace smp::gdi
+{
+
+/// @brief Top-down 32bpp DIB section.
+class DibSection
+{
+public:
+    ~DibSection() = default;
+    DibSection( const DibSection& ) = delete;
+    DibSection& operator=( const DibSection& ) = delete;
+
+    /// @details Does not report
+    /// @return nullptr - error, created bitmap - otherwise
+    static std::unique_ptr<DibSection> Create( uint32_t w, uint32_t h );
+
+    HBITMAP GetHandle() const;
+    uint32_t GetWidth() const;
+    uint32_t GetHeight() const;
+    size_t GetSize() const;
+
+private:
+    DibSection( unique_gdi_ptr<HBITMAP> hBitmap, uint32_t w, uint32_t h );
+
+private:
+    unique_gdi_ptr<HBITMAP> hBitmap_;
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+};
+
+/// @brief Cross-panel pool of DIB sections that are used as panel backbuffers.
+/// @details Bitmap dimensions are rounded up to geometrically growing size classes,
+///          so that resizing a panel does not require a new bitmap on every size change:
+///          bitmap is reused while the panel shrinks and is replaced only when it grows out of it
+///          (or when it becomes too wasteful).
+///          All methods must be called from the main thread.
+class DibPool
+{
+public:
+    ~DibPool() = default;
+    DibPool( const DibPool& ) = delete;
+    DibPool& operator=( const DibPool& ) = delete;
+
+    static DibPool& GetInstance();
+
+    void Finalize();
+
+    /// @brief Returns `pCurrent` if it is suitable for the requested size,
+    ///        otherwise returns it to the pool and acquires a suitable one.
+    /// @return nullptr, if bitmap creation failed
+    std::unique_ptr<DibSection> Acquire( uint32_t w, uint32_t h, std::unique_ptr<DibSection> pCurrent = nullptr );
+    /// @brief Returns bitmap to the pool
+    void Release( std::unique_ptr<DibSection> pDib );
+
+private:
+    DibPool() = default;
+
+    static bool IsSuitable( const DibSection& dib, uint32_t w, uint32_t h );
+    /// @brief Evicts least recently released bitmaps, until the pool fits its capacity
+    void Trim();
+
+private:
+    /// @brief Most recently released is last
+    std::vector<std::unique_ptr<DibSection>> freeDibs_;
+    size_t freeSize_ = 0;
+};
+
+} // namespace smp::gdi
@@ -12,6 +12,8 @@
 #include <nonstd/span.hpp>
 
 #include <filesystem>
+#include <mutex>
+#include <optional>
 
 namespace
 {
@@ -27,6 +29,8 @@ constexpr unsigned char kBom8[] = { 0xef, 0xbb, 0xbf };
 
 // TODO: dirty hack! remove
 std::unordered_map<std::wstring, UINT> codepageMap;
+// files might be read from worker threads as well
+std::mutex codepageMapMutex;
 
 template <typename T>
 T ConvertFileContent( const std::wstring& path, std::string_view content, UINT codepage )
@@ -59,14 +63,25 @@ T ConvertFileContent( const std::wstring& path, std::string_view content, UINT c
 
     if ( !isWideCodepage && detectedCodepage == CP_ACP )
     { // TODO: dirty hack! remove
-        if ( const auto it = codepageMap.find( path );
-             it != codepageMap.cend() )
+        const auto cachedCodepage = [&path]() -> std::optional<UINT> {
+            std::scoped_lock sl( codepageMapMutex );
+            if ( const auto it = codepageMap.find( path );
+                 it != codepageMap.cend() )
+            {
+                return it->second;
+            }
+            return std::nullopt;
+        }();
+
+        if ( cachedCodepage )
         {
-            detectedCodepage = it->second;
+            detectedCodepage = *cachedCodepage;
         }
         else
         {
             detectedCodepage = smp::utils::detect_text_charset( std::string_view{ curPos, curSize } );
+
+            std::scoped_lock sl( codepageMapMutex );
             codepageMap.emplace( path, detectedCodepage );
         }
     }
@@ -139,29 +154,8 @@ std::filesystem::path GetAbsoluteNormalPath( const std::filesystem::path& path )
 
 } // namespace
 
-namespace
-{
-
-class FileReader
+namespace smp::file
 {
-public:
-    FileReader( const std::u8string& path, bool checkFileExistense = true );
-    ~FileReader();
-    FileReader( const FileReader& ) = delete;
-    FileReader& operator=( const FileReader& ) = delete;
-
-    std::string_view GetFileContent() const;
-    std::wstring GetFullPath() const;
-
-private:
-    std::string_view fileContent_;
-    std::wstring wPath_;
-
-    HANDLE hFile_ = nullptr;
-    HANDLE hFileMapping_ = nullptr;
-    LPCBYTE pFileView_ = nullptr;
-    size_t fileSize_ = 0;
-};
 
 FileReader::FileReader( const std::u8string& inPath, bool checkFileExistense )
 {
@@ -234,7 +228,10 @@ FileReader::~FileReader()
 
 std::string_view FileReader::GetFileContent() const
 {
-    assert( pFileView_ );
+    if ( !pFileView_ )
+    { // empty file
+        return std::string_view{};
+    }
     return std::string_view{ reinterpret_cast<const char*>( pFileView_ ), fileSize_ };
 }
 
@@ -243,6 +240,11 @@ std::wstring FileReader::GetFullPath() const
     return wPath_;
 }
 
+} // namespace smp::file
+
+namespace
+{
+
 template <typename T>
 T ReadFileImpl( const std::u8string& path, UINT codepage, bool checkFileExistense )
 {
@@ -304,11 +306,111 @@ bool WriteFile( const wchar_t* path, const std::u8string& content, bool write_bo
     return true;
 }
 
+void WriteFileAtomic( const std::wstring& path, const std::u8string& content, bool write_bom )
+{
+    namespace fs = std::filesystem;
+
+    const auto fsPath = GetAbsoluteNormalPath( fs::path( path ) );
+    // temp file must reside in the same directory, otherwise the rename is not atomic
+    const auto tmpPath = fs::path( fsPath ).concat( fmt::format( L".{}.tmp", GetCurrentThreadId() ) );
+
+    HANDLE hFile = CreateFile( tmpPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+    smp::error::CheckWinApi( ( INVALID_HANDLE_VALUE != hFile ), "CreateFile" );
+
+    utils::final_action autoTmpFile( [&hFile, &tmpPath] {
+        if ( hFile != INVALID_HANDLE_VALUE )
+        {
+            CloseHandle( hFile );
+        }
+        DeleteFile( tmpPath.c_str() );
+    } );
+
+    const auto writeData = [hFile]( const void* pData, size_t size ) {
+        const auto* pCurData = static_cast<const uint8_t*>( pData );
+        while ( size )
+        {
+            const auto chunkSize = static_cast<DWORD>( std::min<size_t>( size, 64 * 1024 * 1024 ) );
+            DWORD bytesWritten = 0;
+            BOOL bRet = ::WriteFile( hFile, pCurData, chunkSize, &bytesWritten, nullptr );
+            smp::error::CheckWinApi( bRet && bytesWritten == chunkSize, "WriteFile" );
+
+            pCurData += chunkSize;
+            size -= chunkSize;
+        }
+    };
+
+    if ( write_bom )
+    {
+        writeData( kBom8, sizeof( kBom8 ) );
+    }
+    writeData( content.data(), content.size() );
+
+    BOOL bRet = FlushFileBuffers( hFile );
+    smp::error::CheckWinApi( bRet, "FlushFileBuffers" );
+
+    CloseHandle( hFile );
+    hFile = INVALID_HANDLE_VALUE;
+
+    bRet = MoveFileEx( tmpPath.c_str(), fsPath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH );
+    smp::error::CheckWinApi( bRet, "MoveFileEx" );
+
+    autoTmpFile.cancel();
+}
+
+std::vector<std::u8string> Glob( const std::u8string& pattern, uint32_t excludeMask, uint32_t includeMask )
+{
+    std::vector<std::u8string> files;
+
+    std::unique_ptr<uFindFile> ff( uFindFirstFile( pattern.c_str() ) );
+    if ( ff )
+    {
+        const std::u8string dir( pattern.c_str(), pfc::scan_filename( pattern.c_str() ) );
+        do
+        {
+            const DWORD attr = ff->GetAttributes();
+            if ( ( attr & includeMask ) && !( attr & excludeMask ) )
+            {
+                files.emplace_back( dir + ff->GetFileName() );
+            }
+        } while ( ff->FindNext() );
+    }
+
+    return files;
+}
+
 UINT DetectFileCharset( const std::u8string& path )
 {
     return smp::utils::detect_text_charset( FileReader{ path }.GetFileContent() );
 }
 
+void InvalidateCachedCodepage( const std::filesystem::path& path )
+{
+    const auto absolutePath = path.lexically_normal().wstring();
+    const auto isSameOrChild = [&absolutePath]( const std::wstring& cachedPath ) {
+        if ( cachedPath.size() < absolutePath.size()
+             || _wcsnicmp( cachedPath.c_str(), absolutePath.c_str(), absolutePath.size() ) )
+        {
+            return false;
+        }
+        return ( cachedPath.size() == absolutePath.size()
+                 || cachedPath[absolutePath.size()] == L'\\'
+                 || ( !absolutePath.empty() && absolutePath.back() == L'\\' ) );
+    };
+
+    std::scoped_lock sl( codepageMapMutex );
+    for ( auto it = codepageMap.begin(); it != codepageMap.end(); )
+    {
+        if ( isSameOrChild( it->first ) )
+        {
+            it = codepageMap.erase( it );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
 std::wstring FileDialog( const std::wstring& title,
                          bool saveFile,
                          nonstd::span<const COMDLG_FILTERSPEC> filterSpec,
@@ -2,12 +2,38 @@
 
 #include <nonstd/span.hpp>
 
+#include <filesystem>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace smp::file
 {
 
+/// @brief Read-only memory-mapped view of the whole file
+class FileReader
+{
+public:
+    /// @throw smp::SmpException
+    FileReader( const std::u8string& path, bool checkFileExistense = true );
+    ~FileReader();
+    FileReader( const FileReader& ) = delete;
+    FileReader& operator=( const FileReader& ) = delete;
+
+    std::string_view GetFileContent() const;
+    std::wstring GetFullPath() const;
+
+private:
+    std::string_view fileContent_;
+    std::wstring wPath_;
+
+    HANDLE hFile_ = nullptr;
+    HANDLE hFileMapping_ = nullptr;
+    LPCBYTE pFileView_ = nullptr;
+    size_t fileSize_ = 0;
+};
+
 /// @throw smp::SmpException
 std::u8string ReadFile( const std::u8string& path, UINT codepage, bool checkFileExistense = true );
 
@@ -16,8 +42,21 @@ std::wstring ReadFileW( const std::u8string& path, UINT codepage, bool checkFile
 
 bool WriteFile( const wchar_t* path, const std::u8string& content, bool write_bom = true );
 
+/// @brief Writes data to a temporary file first, which then replaces the target file.
+///        This way the target file is never left in a partially written state.
+/// @throw smp::SmpException
+void WriteFileAtomic( const std::wstring& path, const std::u8string& content, bool write_bom = true );
+
+/// @brief Finds files matching the wildcard pattern.
+/// @return Paths of the matching files (with directory prefix from the pattern)
+std::vector<std::u8string> Glob( const std::u8string& pattern, uint32_t excludeMask = FILE_ATTRIBUTE_DIRECTORY, uint32_t includeMask = 0xFFFFFFFF );
+
 UINT DetectFileCharset( const std::u8string& path );
 
+/// @brief Drops cached detected codepage of the file (or of all files inside the directory),
+///        so that it will be detected again on the next read.
+void InvalidateCachedCodepage( const std::filesystem::path& path );
+
 std::wstring FileDialog( const std::wstring& title, 
                          bool saveFile, 
                          nonstd::span<const COMDLG_FILTERSPEC> filterSpec = std::array<COMDLG_FILTERSPEC, 1>{ COMDLG_FILTERSPEC{ L"All files", L"*.*" } }, 
@@ -0,0 +1,723 @@
+#include <stdafx.h>
+#include "file_watcher.h"
+
+#include <utils/file_helpers.h>
+#include <utils/scope_helpers.h>
+#include <utils/thread_helpers.h>
+#include <utils/winapi_error_helpers.h>
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+using namespace smp;
+using namespace smp::utils;
+
+namespace
+{
+
+/// @brief Delay after the last change, before the batch is dispatched
+constexpr auto kDebounceDelay = std::chrono::milliseconds( 100 );
+/// @brief Maximum delay after the first change, before the batch is dispatched
+constexpr auto kMaxDispatchDelay = std::chrono::milliseconds( 1000 );
+constexpr auto kPollInterval = std::chrono::milliseconds( 2000 );
+/// @brief ReadDirectoryChangesW fails on network shares with larger buffers
+constexpr size_t kNotifyBufferSize = 64 * 1024;
+/// @brief One slot is reserved for the wake event
+constexpr size_t kMaxNativeWatches = MAXIMUM_WAIT_OBJECTS - 1;
+
+/// @return Absolute lower-case path without trailing separator
+std::wstring NormalizePath( const fs::path& path )
+{
+    auto normalizedPath = path.lexically_normal().wstring();
+    while ( normalizedPath.size() > 3 && normalizedPath.back() == L'\\' )
+    { // root path (e.g. `c:\`) must retain its separator
+        normalizedPath.pop_back();
+    }
+    CharLowerBuffW( normalizedPath.data(), static_cast<DWORD>( normalizedPath.size() ) );
+    return normalizedPath;
+}
+
+/// @return true, if `child` is located inside `parent` (both paths must be normalized)
+bool IsChildPath( std::wstring_view parent, std::wstring_view child )
+{
+    if ( child.size() <= parent.size() || child.compare( 0, parent.size(), parent ) )
+    {
+        return false;
+    }
+    return ( child[parent.size()] == L'\\' || parent.back() == L'\\' );
+}
+
+bool IsSameOrChildPath( std::wstring_view parent, std::wstring_view child )
+{
+    return ( parent == child || IsChildPath( parent, child ) );
+}
+
+FileChangeType MergeChangeTypes( FileChangeType oldType, FileChangeType newType )
+{
+    if ( oldType == FileChangeType::rescan || newType == FileChangeType::rescan )
+    {
+        return FileChangeType::rescan;
+    }
+    if ( oldType == FileChangeType::added && newType == FileChangeType::modified )
+    { // file is still new from the subscriber's point of view
+        return FileChangeType::added;
+    }
+    if ( oldType == FileChangeType::removed && newType == FileChangeType::added )
+    { // e.g. file was saved via `write temp + replace`
+        return FileChangeType::modified;
+    }
+    return newType;
+}
+
+class Win32DirectoryWatch final
+    : public IDirectoryWatch
+{
+public:
+    /// @throw smp::SmpException
+    Win32DirectoryWatch( const fs::path& dir, bool isRecursive );
+    ~Win32DirectoryWatch() override;
+
+    HANDLE GetWaitHandle() const override;
+    void CollectChanges( std::vector<FileChangeEvent>& events ) override;
+
+private:
+    bool IssueRead();
+
+private:
+    fs::path dir_;
+    bool isRecursive_;
+
+    HANDLE hDir_ = INVALID_HANDLE_VALUE;
+    HANDLE hEvent_ = nullptr;
+    OVERLAPPED overlapped_{};
+    std::vector<DWORD> buffer_; ///< FILE_NOTIFY_INFORMATION must be DWORD-aligned
+    bool isReadPending_ = false;
+};
+
+Win32DirectoryWatch::Win32DirectoryWatch( const fs::path& dir, bool isRecursive )
+    : dir_( dir )
+    , isRecursive_( isRecursive )
+    , buffer_( kNotifyBufferSize / sizeof( DWORD ) )
+{
+    hDir_ = CreateFile( dir.wstring().c_str(),
+                        FILE_LIST_DIRECTORY,
+                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                        nullptr,
+                        OPEN_EXISTING,
+                        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                        nullptr );
+    smp::error::CheckWinApi( ( INVALID_HANDLE_VALUE != hDir_ ), "CreateFile" );
+
+    utils::final_action autoDir( [hDir = hDir_] {
+        CloseHandle( hDir );
+    } );
+
+    hEvent_ = CreateEvent( nullptr, TRUE, FALSE, nullptr );
+    smp::error::CheckWinApi( hEvent_, "CreateEvent" );
+
+    utils::final_action autoEvent( [hEvent = hEvent_] {
+        CloseHandle( hEvent );
+    } );
+
+    overlapped_.hEvent = hEvent_;
+    smp::error::CheckWinApi( IssueRead(), "ReadDirectoryChangesW" );
+
+    autoEvent.cancel();
+    autoDir.cancel();
+}
+
+Win32DirectoryWatch::~Win32DirectoryWatch()
+{
+    if ( isReadPending_ )
+    {
+        CancelIoEx( hDir_, &overlapped_ );
+
+        // buffer must stay alive until the cancellation is complete
+        DWORD dwBytes = 0;
+        (void)GetOverlappedResult( hDir_, &overlapped_, &dwBytes, TRUE );
+    }
+
+    CloseHandle( hEvent_ );
+    CloseHandle( hDir_ );
+}
+
+HANDLE Win32DirectoryWatch::GetWaitHandle() const
+{
+    return hEvent_;
+}
+
+void Win32DirectoryWatch::CollectChanges( std::vector<FileChangeEvent>& events )
+{
+    if ( !isReadPending_ )
+    { // watch is broken (e.g. directory was removed)
+        return;
+    }
+
+    DWORD dwBytes = 0;
+    if ( !GetOverlappedResult( hDir_, &overlapped_, &dwBytes, FALSE ) )
+    {
+        if ( GetLastError() == ERROR_IO_INCOMPLETE )
+        {
+            return;
+        }
+
+        // event must be reset, otherwise the watcher thread will spin on it
+        ResetEvent( hEvent_ );
+        isReadPending_ = false;
+        events.push_back( FileChangeEvent{ dir_, FileChangeType::rescan } );
+        return;
+    }
+    isReadPending_ = false;
+
+    if ( !dwBytes )
+    { // buffer overflow: changes were lost
+        events.push_back( FileChangeEvent{ dir_, FileChangeType::rescan } );
+    }
+    else
+    {
+        const auto* pCur = reinterpret_cast<const uint8_t*>( buffer_.data() );
+        while ( true )
+        {
+            const auto* pInfo = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>( pCur );
+            const auto type = [action = pInfo->Action]() -> std::optional<FileChangeType> {
+                switch ( action )
+                {
+                case FILE_ACTION_ADDED:
+                case FILE_ACTION_RENAMED_NEW_NAME:
+                    return FileChangeType::added;
+                case FILE_ACTION_REMOVED:
+                case FILE_ACTION_RENAMED_OLD_NAME:
+                    return FileChangeType::removed;
+                case FILE_ACTION_MODIFIED:
+                    return FileChangeType::modified;
+                default:
+                    return std::nullopt;
+                }
+            }();
+
+            if ( type )
+            {
+                const std::wstring_view name( pInfo->FileName, pInfo->FileNameLength / sizeof( wchar_t ) );
+                events.push_back( FileChangeEvent{ dir_ / fs::path( name ), *type } );
+            }
+
+            if ( !pInfo->NextEntryOffset )
+            {
+                break;
+            }
+            pCur += pInfo->NextEntryOffset;
+        }
+    }
+
+    if ( !IssueRead() )
+    {
+        events.push_back( FileChangeEvent{ dir_, FileChangeType::rescan } );
+    }
+}
+
+bool Win32DirectoryWatch::IssueRead()
+{
+    ResetEvent( hEvent_ );
+    isReadPending_ = ReadDirectoryChangesW( hDir_,
+                                            buffer_.data(),
+                                            static_cast<DWORD>( buffer_.size() * sizeof( DWORD ) ),
+                                            isRecursive_,
+                                            FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE,
+                                            nullptr,
+                                            &overlapped_,
+                                            nullptr );
+    return isReadPending_;
+}
+
+/// @brief Fallback watch, that compares directory snapshots
+class PollingDirectoryWatch final
+    : public IDirectoryWatch
+{
+public:
+    PollingDirectoryWatch( const fs::path& dir, bool isRecursive );
+    ~PollingDirectoryWatch() override = default;
+
+    void Initialize() override;
+    HANDLE GetWaitHandle() const override;
+    void CollectChanges( std::vector<FileChangeEvent>& events ) override;
+
+private:
+    struct FileInfo
+    {
+        fs::file_time_type writeTime;
+        uintmax_t size;
+    };
+    using Snapshot = std::unordered_map<std::wstring, FileInfo>;
+
+    Snapshot GenerateSnapshot() const;
+
+private:
+    fs::path dir_;
+    bool isRecursive_;
+    Snapshot snapshot_;
+};
+
+PollingDirectoryWatch::PollingDirectoryWatch( const fs::path& dir, bool isRecursive )
+    : dir_( dir )
+    , isRecursive_( isRecursive )
+{
+}
+
+void PollingDirectoryWatch::Initialize()
+{
+    // might take a while for big recursive directories, hence it's not done in ctor (which is invoked from main thread)
+    snapshot_ = GenerateSnapshot();
+}
+
+HANDLE PollingDirectoryWatch::GetWaitHandle() const
+{
+    return nullptr;
+}
+
+void PollingDirectoryWatch::CollectChanges( std::vector<FileChangeEvent>& events )
+{
+    auto newSnapshot = GenerateSnapshot();
+
+    for ( const auto& [path, info]: newSnapshot )
+    {
+        const auto it = snapshot_.find( path );
+        if ( it == snapshot_.cend() )
+        {
+            events.push_back( FileChangeEvent{ path, FileChangeType::added } );
+        }
+        else if ( it->second.writeTime != info.writeTime || it->second.size != info.size )
+        {
+            events.push_back( FileChangeEvent{ path, FileChangeType::modified } );
+        }
+    }
+    for ( const auto& [path, info]: snapshot_ )
+    {
+        if ( !newSnapshot.count( path ) )
+        {
+            events.push_back( FileChangeEvent{ path, FileChangeType::removed } );
+        }
+    }
+
+    snapshot_ = std::move( newSnapshot );
+}
+
+PollingDirectoryWatch::Snapshot PollingDirectoryWatch::GenerateSnapshot() const
+{
+    Snapshot snapshot;
+
+    const auto addEntry = [&snapshot]( const fs::directory_entry& entry ) {
+        std::error_code ec;
+        FileInfo info{ entry.last_write_time( ec ), 0 };
+        if ( entry.is_regular_file( ec ) )
+        {
+            info.size = entry.file_size( ec );
+        }
+        snapshot.emplace( entry.path().wstring(), info );
+    };
+
+    std::error_code ec;
+    if ( isRecursive_ )
+    {
+        for ( fs::recursive_directory_iterator it( dir_, fs::directory_options::skip_permission_denied, ec ), end;
+              !ec && it != end;
+              it.increment( ec ) )
+        {
+            addEntry( *it );
+        }
+    }
+    else
+    {
+        for ( fs::directory_iterator it( dir_, fs::directory_options::skip_permission_denied, ec ), end;
+              !ec && it != end;
+              it.increment( ec ) )
+        {
+            addEntry( *it );
+        }
+    }
+
+    return snapshot;
+}
+
+} // namespace
+
+namespace smp::utils
+{
+
+FileWatcher::~FileWatcher()
+{
+    assert( !pThread_ );
+    assert( watches_.empty() );
+}
+
+FileWatcher& FileWatcher::GetInstance()
+{
+    static FileWatcher fw;
+    return fw;
+}
+
+void FileWatcher::Finalize()
+{
+    assert( core_api::is_main_thread() );
+
+    if ( isFinalized_ )
+    {
+        return;
+    }
+    isFinalized_ = true;
+
+    subscriptions_.clear();
+
+    if ( pThread_ )
+    {
+        isExiting_ = true;
+        SetEvent( hWakeEvent_ );
+        if ( pThread_->joinable() )
+        {
+            pThread_->join();
+        }
+        pThread_.reset();
+    }
+
+    {
+        std::scoped_lock sl( watchesMutex_ );
+        watches_.clear();
+        nativeWatchCount_ = 0;
+    }
+
+    if ( hWakeEvent_ )
+    {
+        CloseHandle( hWakeEvent_ );
+        hWakeEvent_ = nullptr;
+    }
+}
+
+uint32_t FileWatcher::Subscribe( const fs::path& path, bool isRecursive, Callback callback )
+{
+    assert( core_api::is_main_thread() );
+    SmpException::ExpectTrue( !isFinalized_, "Internal error: file watcher is already finalized" );
+
+    std::error_code ec;
+    const auto absolutePath = fs::absolute( path, ec ).lexically_normal();
+    SmpException::ExpectTrue( !ec, "Failed to watch `{}`: {}", path.u8string(), ec.message() );
+
+    const auto status = fs::status( absolutePath, ec );
+    SmpException::ExpectTrue( !ec && fs::exists( status ), "Path does not exist: {}", absolutePath.u8string() );
+
+    const bool isFile = !fs::is_directory( status );
+    const auto dir = ( isFile ? absolutePath.parent_path() : absolutePath );
+    if ( isFile )
+    {
+        isRecursive = false;
+    }
+
+    if ( !pThread_ )
+    {
+        hWakeEvent_ = CreateEvent( nullptr, FALSE, FALSE, nullptr );
+        smp::error::CheckWinApi( hWakeEvent_, "CreateEvent" );
+
+        pThread_ = std::make_unique<std::thread>( [&] { ThreadMain(); } );
+        smp::utils::SetThreadName( *pThread_, "SMP File Watcher" );
+    }
+
+    const WatchKey watchKey{ NormalizePath( dir ), isRecursive };
+
+    // only main thread modifies `watches_`, so it's safe to check and insert separately
+    const bool hasWatch = [&] {
+        std::scoped_lock sl( watchesMutex_ );
+        return !!watches_.count( watchKey );
+    }();
+
+    // watch is created outside of the lock, since it might block on I/O
+    auto pNewWatch = ( hasWatch ? nullptr : CreateWatch( dir, isRecursive ) );
+
+    {
+        std::scoped_lock sl( watchesMutex_ );
+        auto& watchData = watches_[watchKey];
+        if ( pNewWatch )
+        {
+            if ( pNewWatch->GetWaitHandle() )
+            {
+                ++nativeWatchCount_;
+            }
+            watchData.pWatch = std::move( pNewWatch );
+        }
+        ++watchData.refCount;
+    }
+
+    if ( !hasWatch )
+    { // rebuild wait handle list
+        SetEvent( hWakeEvent_ );
+    }
+
+    const auto subscriptionId = ++lastSubscriptionId_;
+    subscriptions_.try_emplace( subscriptionId, Subscription{ NormalizePath( absolutePath ), isFile, isRecursive, watchKey, std::move( callback ) } );
+
+    return subscriptionId;
+}
+
+void FileWatcher::Unsubscribe( uint32_t subscriptionId )
+{
+    assert( core_api::is_main_thread() );
+
+    const auto it = subscriptions_.find( subscriptionId );
+    if ( it == subscriptions_.cend() )
+    {
+        return;
+    }
+
+    const auto watchKey = it->second.watchKey;
+    subscriptions_.erase( it );
+
+    // watch must be destroyed outside of the lock, since it might block until I/O is cancelled
+    std::shared_ptr<IDirectoryWatch> pWatch;
+    {
+        std::scoped_lock sl( watchesMutex_ );
+
+        const auto watchIt = watches_.find( watchKey );
+        assert( watchIt != watches_.cend() );
+        if ( watchIt != watches_.cend() && !--watchIt->second.refCount )
+        {
+            pWatch = std::move( watchIt->second.pWatch );
+            if ( pWatch->GetWaitHandle() )
+            {
+                --nativeWatchCount_;
+            }
+            watches_.erase( watchIt );
+        }
+    }
+
+    if ( pWatch )
+    { // rebuild wait handle list
+        SetEvent( hWakeEvent_ );
+    }
+}
+
+std::shared_ptr<IDirectoryWatch> FileWatcher::CreateWatch( const fs::path& dir, bool isRecursive )
+{
+    const bool canUseNativeWatch = [&] {
+        std::scoped_lock sl( watchesMutex_ );
+        return ( nativeWatchCount_ < kMaxNativeWatches );
+    }();
+
+    if ( canUseNativeWatch )
+    {
+        try
+        {
+            return std::make_shared<Win32DirectoryWatch>( dir, isRecursive );
+        }
+        catch ( const SmpException& )
+        { // e.g. network share without change notification support: fallback to polling
+        }
+    }
+
+    return std::make_shared<PollingDirectoryWatch>( dir, isRecursive );
+}
+
+void FileWatcher::ThreadMain()
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<std::shared_ptr<IDirectoryWatch>> nativeWatches;
+    std::vector<std::shared_ptr<IDirectoryWatch>> polledWatches;
+    std::vector<std::shared_ptr<IDirectoryWatch>> newWatches;
+    std::vector<HANDLE> waitHandles;
+    std::vector<FileChangeEvent> events;
+    auto nextPollTime = clock::now() + kPollInterval;
+
+    while ( !isExiting_ )
+    {
+        // watches are held by the thread while in use, so that they are not destroyed in the middle of the wait
+        nativeWatches.clear();
+        polledWatches.clear();
+        newWatches.clear();
+        waitHandles.assign( 1, hWakeEvent_ );
+        {
+            std::scoped_lock sl( watchesMutex_ );
+            for ( auto& [key, watchData]: watches_ )
+            {
+                if ( !watchData.isInitialized )
+                {
+                    watchData.isInitialized = true;
+                    newWatches.emplace_back( watchData.pWatch );
+                }
+
+                if ( HANDLE hWait = watchData.pWatch->GetWaitHandle(); hWait )
+                {
+                    nativeWatches.emplace_back( watchData.pWatch );
+                    waitHandles.emplace_back( hWait );
+                }
+                else
+                {
+                    polledWatches.emplace_back( watchData.pWatch );
+                }
+            }
+        }
+        assert( waitHandles.size() <= MAXIMUM_WAIT_OBJECTS );
+
+        // initialized outside of the lock, so that main thread is not blocked by slow initialization (e.g. snapshot of a big directory)
+        for ( auto& pWatch: newWatches )
+        {
+            pWatch->Initialize();
+            if ( isExiting_ )
+            {
+                return;
+            }
+        }
+
+        auto wakeTime = ( polledWatches.empty() ? clock::time_point::max() : nextPollTime );
+        if ( !pendingEvents_.empty() )
+        {
+            wakeTime = std::min( { wakeTime, lastPendingEventTime_ + kDebounceDelay, firstPendingEventTime_ + kMaxDispatchDelay } );
+        }
+
+        const auto waitStartTime = clock::now();
+        const DWORD timeout = [&]() -> DWORD {
+            if ( wakeTime == clock::time_point::max() )
+            {
+                return INFINITE;
+            }
+            if ( wakeTime <= waitStartTime )
+            {
+                return 0;
+            }
+            return static_cast<DWORD>( std::chrono::duration_cast<std::chrono::milliseconds>( wakeTime - waitStartTime ).count() + 1 );
+        }();
+
+        const DWORD dwRet = WaitForMultipleObjects( static_cast<DWORD>( waitHandles.size() ), waitHandles.data(), FALSE, timeout );
+        if ( isExiting_ )
+        {
+            break;
+        }
+
+        events.clear();
+        if ( dwRet > WAIT_OBJECT_0 && dwRet < WAIT_OBJECT_0 + waitHandles.size() )
+        { // WaitForMultipleObjects reports only the first signaled handle, so all watches are checked
+            for ( auto& pWatch: nativeWatches )
+            {
+                pWatch->CollectChanges( events );
+            }
+        }
+
+        const auto curTime = clock::now();
+        if ( !polledWatches.empty() && curTime >= nextPollTime )
+        {
+            for ( auto& pWatch: polledWatches )
+            {
+                pWatch->CollectChanges( events );
+            }
+            nextPollTime = curTime + kPollInterval;
+        }
+
+        if ( !events.empty() )
+        {
+            if ( pendingEvents_.empty() )
+            {
+                firstPendingEventTime_ = curTime;
+            }
+            lastPendingEventTime_ = curTime;
+            AddPendingEvents( events );
+        }
+
+        if ( !pendingEvents_.empty()
+                  && ( curTime >= lastPendingEventTime_ + kDebounceDelay || curTime >= firstPendingEventTime_ + kMaxDispatchDelay ) )
+        {
+            fb2k::inMainThread( [this, batch = std::move( pendingEvents_ )] {
+                DispatchEvents( batch );
+            } );
+            pendingEvents_.clear();
+            pathToPendingEventIdx_.clear();
+        }
+    }
+}
+
+void FileWatcher::AddPendingEvents( std::vector<FileChangeEvent>& events )
+{
+    for ( auto& event: events )
+    {
+        auto normalizedPath = NormalizePath( event.path );
+        if ( const auto it = pathToPendingEventIdx_.find( normalizedPath );
+             it != pathToPendingEventIdx_.cend() )
+        {
+            auto& pendingType = pendingEvents_[it->second].type;
+            pendingType = MergeChangeTypes( pendingType, event.type );
+        }
+        else
+        {
+            pathToPendingEventIdx_.try_emplace( std::move( normalizedPath ), pendingEvents_.size() );
+            pendingEvents_.emplace_back( std::move( event ) );
+        }
+    }
+}
+
+void FileWatcher::DispatchEvents( const std::vector<FileChangeEvent>& events )
+{
+    assert( core_api::is_main_thread() );
+
+    if ( isFinalized_ )
+    {
+        return;
+    }
+
+    for ( const auto& event: events )
+    {
+        smp::file::InvalidateCachedCodepage( event.path );
+    }
+
+    // callbacks might (un)subscribe, so iterators can't be used here
+    std::vector<uint32_t> subscriptionIds;
+    subscriptionIds.reserve( subscriptions_.size() );
+    for ( const auto& [id, subscription]: subscriptions_ )
+    {
+        subscriptionIds.emplace_back( id );
+    }
+
+    std::vector<FileChangeEvent> matchingEvents;
+    for ( const auto id: subscriptionIds )
+    {
+        const auto it = subscriptions_.find( id );
+        if ( it == subscriptions_.cend() )
+        {
+            continue;
+        }
+
+        matchingEvents.clear();
+        std::copy_if( events.cbegin(), events.cend(), std::back_inserter( matchingEvents ), [&subscription = it->second]( const auto& event ) {
+            return IsMatchingEvent( subscription, event );
+        } );
+
+        if ( !matchingEvents.empty() )
+        {
+            // copy: callback might unsubscribe itself
+            const auto callback = it->second.callback;
+            callback( matchingEvents );
+        }
+    }
+}
+
+bool FileWatcher::IsMatchingEvent( const Subscription& subscription, const FileChangeEvent& event )
+{
+    const auto eventPath = NormalizePath( event.path );
+
+    if ( event.type == FileChangeType::rescan )
+    { // anything inside the event path might have changed
+        return ( IsSameOrChildPath( eventPath, subscription.path )
+                 || ( !subscription.isFile && IsChildPath( subscription.path, eventPath ) ) );
+    }
+
+    if ( subscription.isFile )
+    {
+        return ( eventPath == subscription.path );
+    }
+
+    if ( !IsChildPath( subscription.path, eventPath ) )
+    {
+        return false;
+    }
+    return ( subscription.isRecursive || NormalizePath( fs::path( eventPath ).parent_path() ) == subscription.path );
+}
+
+} // namespace smp::utils
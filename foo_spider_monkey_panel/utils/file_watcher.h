@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace smp::utils
+{
+
+enum class FileChangeType : uint8_t
+{
+    added,
+    removed,
+    modified,
+    /// @brief Changes were lost (e.g. because of notification buffer overflow):
+    ///        anything inside the directory (event path) might have changed
+    rescan
+};
+
+struct FileChangeEvent
+{
+    std::filesystem::path path;
+    FileChangeType type;
+};
+
+/// @brief Platform interface for watching a single directory
+class IDirectoryWatch
+{
+public:
+    virtual ~IDirectoryWatch() = default;
+
+    /// @brief Called once on the watcher thread before the watch is used (e.g. to take initial snapshot)
+    virtual void Initialize() {}
+    /// @return Handle that is signaled when changes are available,
+    ///         or nullptr if changes must be polled periodically
+    virtual HANDLE GetWaitHandle() const = 0;
+    /// @brief Appends changes that happened since the previous call
+    virtual void CollectChanges( std::vector<FileChangeEvent>& events ) = 0;
+};
+
+/// @brief Watches files and directories for changes and delivers debounced and coalesced change batches.
+/// @details Directories are watched with ReadDirectoryChangesW,
+///          with a fallback to polling (e.g. for network shares that don't support notifications).
+///          Watches are shared between all subscriptions of the same directory.
+///          All methods and callbacks are invoked on the main thread.
+class FileWatcher
+{
+public:
+    using Callback = std::function<void( const std::vector<FileChangeEvent>& events )>;
+
+public:
+    ~FileWatcher();
+    FileWatcher( const FileWatcher& ) = delete;
+    FileWatcher& operator=( const FileWatcher& ) = delete;
+
+    static FileWatcher& GetInstance();
+
+    void Finalize();
+
+    /// @param path File or directory. File watch also reports `rescan` events for its parent directory.
+    /// @param isRecursive Ignored for files
+    /// @return Subscription id
+    /// @throw smp::SmpException
+    uint32_t Subscribe( const std::filesystem::path& path, bool isRecursive, Callback callback );
+    void Unsubscribe( uint32_t subscriptionId );
+
+private:
+    FileWatcher() = default;
+
+    struct WatchKey
+    {
+        std::wstring dir; // lower case
+        bool isRecursive;
+
+        bool operator<( const WatchKey& other ) const
+        {
+            return std::tie( dir, isRecursive ) < std::tie( other.dir, other.isRecursive );
+        }
+    };
+
+    struct WatchData
+    {
+        std::shared_ptr<IDirectoryWatch> pWatch;
+        uint32_t refCount = 0;
+        bool isInitialized = false;
+    };
+
+    struct Subscription
+    {
+        std::wstring path; // normalized, lower case
+        bool isFile;
+        bool isRecursive;
+        WatchKey watchKey;
+        Callback callback;
+    };
+
+    /// @throw smp::SmpException
+    std::shared_ptr<IDirectoryWatch> CreateWatch( const std::filesystem::path& dir, bool isRecursive );
+
+    void ThreadMain();
+    void AddPendingEvents( std::vector<FileChangeEvent>& events );
+    void DispatchEvents( const std::vector<FileChangeEvent>& events );
+
+    static bool IsMatchingEvent( const Subscription& subscription, const FileChangeEvent& event );
+
+private:
+    // main thread data
+
+    uint32_t lastSubscriptionId_ = 0;
+    std::unordered_map<uint32_t, Subscription> subscriptions_;
+    bool isFinalized_ = false;
+
+    // shared data
+
+    std::mutex watchesMutex_;
+    std::map<WatchKey, WatchData> watches_;
+    size_t nativeWatchCount_ = 0;
+    HANDLE hWakeEvent_ = nullptr;
+
+    std::unique_ptr<std::thread> pThread_;
+    std::atomic_bool isExiting_ = false;
+
+    // watcher thread data
+
+    std::vector<FileChangeEvent> pendingEvents_;
+    std::unordered_map<std::wstring, size_t> pathToPendingEventIdx_;
+    std::chrono::steady_clock::time_point firstPendingEventTime_;
+    std::chrono::steady_clock::time_point lastPendingEventTime_;
+};
+
+} // namespace smp::utils
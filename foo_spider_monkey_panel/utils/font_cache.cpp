@@ -0,0 +1,221 @@
+#include <stdafx.h>
+#include "font_cache.h"
+
+#include <utils/gdi_error_helpers.h>
+#include <utils/gdi_helpers.h>
+#include <utils/scope_helpers.h>
+#include <utils/winapi_error_helpers.h>
+
+namespace
+{
+
+/// @brief Amount of fonts after which unreferenced fonts start being evicted
+constexpr size_t kMaxFontCount = 64;
+
+} // namespace
+
+namespace smp::utils
+{
+
+CachedFont::CachedFont( std::unique_ptr<Gdiplus::Font> pGdiFont, HFONT hFont )
+    : pGdi_( std::move( pGdiFont ) )
+    , hFont_( hFont )
+{
+    assert( pGdi_ );
+    assert( hFont_ );
+
+    {
+        Gdiplus::Bitmap img( 1, 1, PixelFormat32bppPARGB );
+        Gdiplus::Graphics g( &img );
+
+        metrics_.height = static_cast<uint32_t>( pGdi_->GetHeight( &g ) );
+    }
+
+    {
+        auto hDc = smp::gdi::CreateUniquePtr( CreateCompatibleDC( nullptr ) );
+        smp::error::CheckWinApi( !!hDc, "CreateCompatibleDC" );
+        smp::gdi::ObjectSelector autoFont( hDc.get(), hFont_ );
+
+        TEXTMETRICW tm{};
+        BOOL bRet = GetTextMetricsW( hDc.get(), &tm );
+        smp::error::CheckWinApi( bRet, "GetTextMetrics" );
+
+        metrics_.ascent = static_cast<uint32_t>( tm.tmAscent );
+        metrics_.descent = static_cast<uint32_t>( tm.tmDescent );
+        metrics_.avgCharWidth = static_cast<uint32_t>( tm.tmAveCharWidth );
+    }
+}
+
+CachedFont::~CachedFont()
+{
+    DeleteFont( hFont_ );
+}
+
+Gdiplus::Font* CachedFont::GetGdiFont() const
+{
+    return pGdi_.get();
+}
+
+HFONT CachedFont::GetHFont() const
+{
+    return hFont_;
+}
+
+const FontMetrics& CachedFont::GetMetrics() const
+{
+    return metrics_;
+}
+
+FontCache& FontCache::GetInstance()
+{
+    static FontCache cache;
+    return cache;
+}
+
+void FontCache::Finalize()
+{
+    keyToEntry_.clear();
+    entries_.clear();
+}
+
+std::shared_ptr<const CachedFont> FontCache::GetFont( const std::wstring& name, float pxSize, uint32_t style )
+{
+    const Key key = ParamsKey{ name, pxSize, style };
+    if ( auto pFont = FindFont( key ) )
+    {
+        return pFont;
+    }
+
+    std::unique_ptr<Gdiplus::Font> pGdiFont( new Gdiplus::Font( name.c_str(), pxSize, style, Gdiplus::UnitPixel ) );
+    smp::error::CheckGdiPlusObject( pGdiFont );
+
+    // Generate HFONT
+    // The benefit of replacing Gdiplus::Font::GetLogFontW is that you can get it work with CCF/OpenType fonts.
+    HFONT hFont = CreateFont(
+        -(int)pxSize,
+        0,
+        0,
+        0,
+        ( style & Gdiplus::FontStyleBold ) ? FW_BOLD : FW_NORMAL,
+        ( style & Gdiplus::FontStyleItalic ) ? TRUE : FALSE,
+        ( style & Gdiplus::FontStyleUnderline ) ? TRUE : FALSE,
+        ( style & Gdiplus::FontStyleStrikeout ) ? TRUE : FALSE,
+        DEFAULT_CHARSET,
+        OUT_DEFAULT_PRECIS,
+        CLIP_DEFAULT_PRECIS,
+        DEFAULT_QUALITY,
+        DEFAULT_PITCH | FF_DONTCARE,
+        name.c_str() );
+    smp::error::CheckWinApi( !!hFont, "CreateFont" );
+    final_action autoFont( [hFont]() {
+        DeleteObject( hFont );
+    } );
+
+    auto pFont = std::make_shared<const CachedFont>( std::move( pGdiFont ), hFont );
+    autoFont.cancel();
+
+    AddFont( key, pFont );
+    return pFont;
+}
+
+std::shared_ptr<const CachedFont> FontCache::GetFont( HFONT hFont )
+{
+    assert( hFont );
+
+    LOGFONTW logFont{};
+    const int iRet = GetObjectW( hFont, sizeof( logFont ), &logFont );
+    smp::error::CheckWinApi( !!iRet, "GetObject" );
+
+    // face name might contain garbage after the terminator
+    std::wstring faceName( logFont.lfFaceName, wcsnlen( logFont.lfFaceName, LF_FACESIZE ) );
+    std::fill( std::begin( logFont.lfFaceName ), std::end( logFont.lfFaceName ), L'\0' );
+    std::copy( faceName.cbegin(), faceName.cend(), logFont.lfFaceName );
+
+    const Key key = LogFontKey{ faceName,
+                                logFont.lfHeight,
+                                logFont.lfWidth,
+                                logFont.lfEscapement,
+                                logFont.lfOrientation,
+                                logFont.lfWeight,
+                                logFont.lfItalic,
+                                logFont.lfUnderline,
+                                logFont.lfStrikeOut,
+                                logFont.lfCharSet,
+                                logFont.lfOutPrecision,
+                                logFont.lfClipPrecision,
+                                logFont.lfQuality,
+                                logFont.lfPitchAndFamily };
+    if ( auto pFont = FindFont( key ) )
+    {
+        return pFont;
+    }
+
+    // `hFont` might be owned by someone else, so we need our own copy
+    HFONT hFontCopy = CreateFontIndirectW( &logFont );
+    smp::error::CheckWinApi( !!hFontCopy, "CreateFontIndirect" );
+    final_action autoFont( [hFontCopy]() {
+        DeleteObject( hFontCopy );
+    } );
+
+    std::unique_ptr<Gdiplus::Font> pGdiFont;
+    {
+        auto hDc = smp::gdi::CreateUniquePtr( CreateCompatibleDC( nullptr ) );
+        smp::error::CheckWinApi( !!hDc, "CreateCompatibleDC" );
+
+        pGdiFont.reset( new Gdiplus::Font( hDc.get(), hFontCopy ) );
+        if ( !smp::gdi::IsGdiPlusObjectValid( pGdiFont ) )
+        { // Not an error: font is not supported
+            return nullptr;
+        }
+    }
+
+    auto pFont = std::make_shared<const CachedFont>( std::move( pGdiFont ), hFontCopy );
+    autoFont.cancel();
+
+    AddFont( key, pFont );
+    return pFont;
+}
+
+FontCacheStats FontCache::GetStats() const
+{
+    return FontCacheStats{ hitCount_, missCount_, entries_.size() };
+}
+
+std::shared_ptr<const CachedFont> FontCache::FindFont( const Key& key )
+{
+    const auto it = keyToEntry_.find( key );
+    if ( it == keyToEntry_.cend() )
+    { // miss is counted by the caller: font creation might fail
+        return nullptr;
+    }
+
+    ++hitCount_;
+    entries_.splice( entries_.begin(), entries_, it->second );
+    return it->second->pFont;
+}
+
+void FontCache::AddFont( const Key& key, std::shared_ptr<const CachedFont> pFont )
+{
+    ++missCount_;
+
+    entries_.push_front( Entry{ key, pFont } );
+    keyToEntry_.try_emplace( key, entries_.begin() );
+
+    Trim();
+}
+
+void FontCache::Trim()
+{
+    for ( auto it = entries_.end(); entries_.size() > kMaxFontCount && it != entries_.begin(); )
+    {
+        --it;
+        // use_count can't increase concurrently: new references are only created on the main thread
+        if ( it->pFont.use_count() == 1 )
+        {
+            keyToEntry_.erase( it->key );
+            it = entries_.erase( it );
+        }
+    }
+}
+
+} // namespace smp::utils
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <variant>
+
+namespace smp::utils
+{
+
+struct FontMetrics
+{
+    uint32_t height;       ///< line spacing, as reported by GDI+
+    uint32_t ascent;       ///< as reported by GDI
+    uint32_t descent;      ///< as reported by GDI
+    uint32_t avgCharWidth; ///< as reported by GDI
+};
+
+/// @brief Immutable pair of GDI+ font and HFONT with precomputed metrics.
+/// @details Shared between all panels via FontCache.
+class CachedFont
+{
+public:
+    /// @param hFont Is owned by the object
+    /// @throw smp::SmpException
+    CachedFont( std::unique_ptr<Gdiplus::Font> pGdiFont, HFONT hFont );
+    ~CachedFont();
+    CachedFont( const CachedFont& ) = delete;
+    CachedFont& operator=( const CachedFont& ) = delete;
+
+    Gdiplus::Font* GetGdiFont() const;
+    HFONT GetHFont() const;
+    const FontMetrics& GetMetrics() const;
+
+private:
+    std::unique_ptr<Gdiplus::Font> pGdi_;
+    HFONT hFont_ = nullptr;
+    FontMetrics metrics_{};
+};
+
+struct FontCacheStats
+{
+    uint64_t hitCount;
+    uint64_t missCount; ///< amount of fonts that were created (failed and unsupported fonts are not counted)
+    size_t fontCount;
+};
+
+/// @brief Process-wide cache of fonts.
+/// @details Fonts with the same parameters are shared (instead of creating new Gdiplus::Font and HFONT on every request).
+///          Fonts are evicted in LRU order, but only when they are not referenced anymore.
+///          All methods must be called from the main thread.
+class FontCache
+{
+public:
+    ~FontCache() = default;
+    FontCache( const FontCache& ) = delete;
+    FontCache& operator=( const FontCache& ) = delete;
+
+    static FontCache& GetInstance();
+
+    void Finalize();
+
+    /// @throw smp::SmpException
+    std::shared_ptr<const CachedFont> GetFont( const std::wstring& name, float pxSize, uint32_t style );
+    /// @brief Returns font with the same parameters as `hFont`: HFONT itself is not retained.
+    /// @return nullptr, if font is not supported by GDI+
+    /// @throw smp::SmpException
+    std::shared_ptr<const CachedFont> GetFont( HFONT hFont );
+
+    FontCacheStats GetStats() const;
+
+private:
+    FontCache() = default;
+
+    using ParamsKey = std::tuple<std::wstring, float, uint32_t>;
+    /// @brief All LOGFONT fields
+    using LogFontKey = std::tuple<std::wstring, LONG, LONG, LONG, LONG, LONG, BYTE, BYTE, BYTE, BYTE, BYTE, BYTE, BYTE, BYTE>;
+    using Key = std::variant<ParamsKey, LogFontKey>;
+
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<const CachedFont> pFont;
+    };
+
+    /// @return nullptr, if not found
+    std::shared_ptr<const CachedFont> FindFont( const Key& key );
+    /// @brief Adds newly created font and counts it as a cache miss
+    void AddFont( const Key& key, std::shared_ptr<const CachedFont> pFont );
+    /// @brief Evicts least recently used unreferenced fonts, until the cache fits its capacity
+    void Trim();
+
+private:
+    /// @brief Most recently used is first
+    std::list<Entry> entries_;
+    std::map<Key, std::list<Entry>::iterator> keyToEntry_;
+
+    uint64_t hitCount_ = 0;
+    uint64_t missCount_ = 0;
+};
+
+} // namespace smp::utils
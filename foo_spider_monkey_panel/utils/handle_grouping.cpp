@@ -0,0 +1,99 @@
+#include <stdafx.h>
+#include "handle_grouping.h"
+
+#include <utils/thread_helpers.h>
+
+#include <tim/timsort.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+
+/// @brief Title formatting is fast enough, so there is no point in spawning threads for small lists
+constexpr size_t kMinItemsPerThread = 2000;
+
+} // namespace
+
+namespace smp::utils
+{
+
+std::vector<pfc::string8_fast> FormatTitles( const metadb_handle_list& handles, const titleformat_object::ptr& script )
+{
+    std::vector<pfc::string8_fast> titles( handles.get_count() );
+    ParallelFor( titles.size(), kMinItemsPerThread, "SMP Title Formatting", [&handles, &script, &titles]( size_t begin, size_t end ) {
+        for ( size_t i = begin; i < end; ++i )
+        {
+            handles[i]->format_title( nullptr, titles[i], script, nullptr );
+        }
+    } );
+
+    return titles;
+}
+
+std::vector<HandleGroup> GroupHandles( metadb_handle_list& handles,
+                                       const titleformat_object::ptr& groupScript,
+                                       const titleformat_object::ptr& sortScript,
+                                       const HandleGroupOptions& options )
+{
+    if ( sortScript.is_valid() )
+    {
+        handles.sort_by_format( sortScript, nullptr );
+    }
+
+    auto keys = FormatTitles( handles, groupScript );
+    const size_t count = keys.size();
+
+    if ( !sortScript.is_valid() )
+    {
+        std::vector<size_t> order( count );
+        std::iota( order.begin(), order.end(), 0 );
+        tim::timsort( order.begin(), order.end(), [&keys]( size_t a, size_t b ) {
+            return ( stricmp_utf8( keys[a], keys[b] ) < 0 );
+        } );
+
+        handles.reorder( order.data() );
+
+        std::vector<pfc::string8_fast> sortedKeys;
+        sortedKeys.reserve( count );
+        for ( auto idx: order )
+        {
+            sortedKeys.emplace_back( std::move( keys[idx] ) );
+        }
+        keys = std::move( sortedKeys );
+    }
+
+    std::vector<HandleGroup> groups;
+    for ( size_t i = 0; i < count; )
+    {
+        size_t j = i + 1;
+        while ( j < count && !stricmp_utf8( keys[i], keys[j] ) )
+        {
+            ++j;
+        }
+
+        HandleGroup group{ keys[i].c_str(), i, j - i };
+        if ( options.calcDuration || options.calcSize )
+        {
+            metadb_handle_list groupHandles;
+            groupHandles.add_items_fromptr( handles.get_ptr() + i, j - i );
+
+            if ( options.calcDuration )
+            {
+                group.duration = groupHandles.calc_total_duration();
+            }
+            if ( options.calcSize )
+            {
+                group.size = static_cast<uint64_t>( metadb_handle_list_helper::calc_total_size( groupHandles, true ) );
+            }
+        }
+
+        groups.emplace_back( std::move( group ) );
+        i = j;
+    }
+
+    return groups;
+}
+
+} // namespace smp::utils
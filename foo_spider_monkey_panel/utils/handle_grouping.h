@@ -0,0 +1,38 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace smp::utils
+{
+
+struct HandleGroup
+{
+    std::u8string key;
+    size_t start;
+    size_t count;
+    std::optional<double> duration;
+    std::optional<uint64_t> size;
+};
+
+struct HandleGroupOptions
+{
+    bool calcDuration = false;
+    bool calcSize = false;
+};
+
+/// @brief Evaluates title format for every handle.
+/// @details Evaluation is split between multiple threads for large lists.
+std::vector<pfc::string8_fast> FormatTitles( const metadb_handle_list& handles, const titleformat_object::ptr& script );
+
+/// @brief Sorts handles and splits them into groups of adjacent items with the same key.
+/// @details Keys are compared case-insensitively, the key of the first item is used as the group key.
+/// @param handles Sorted in place: by `sortScript` if it is valid, by group key otherwise (both sorts are stable)
+/// @return Groups in the order of handles
+std::vector<HandleGroup> GroupHandles( metadb_handle_list& handles,
+                                       const titleformat_object::ptr& groupScript,
+                                       const titleformat_object::ptr& sortScript,
+                                       const HandleGroupOptions& options );
+
+} // namespace smp::utils
@@ -0,0 +1,106 @@
+#include <stdafx.h>
+#include "hdr_histogram.h"
+
+#include <intrin.h>
+
+namespace smp::utils
+{
+
+void HdrHistogram::Record( uint64_t value )
+{
+    value = std::min( value, kMaxValue );
+
+    auto& count = counts_[GetBucketIdx( value )];
+    if ( count == UINT32_MAX )
+    { // saturate instead of overflowing
+        return;
+    }
+
+    ++count;
+    ++totalCount_;
+    totalSum_ += value;
+    min_ = std::min( min_, value );
+    max_ = std::max( max_, value );
+}
+
+void HdrHistogram::Reset()
+{
+    counts_.fill( 0 );
+    totalCount_ = 0;
+    totalSum_ = 0;
+    min_ = UINT64_MAX;
+    max_ = 0;
+}
+
+uint64_t HdrHistogram::GetCount() const
+{
+    return totalCount_;
+}
+
+uint64_t HdrHistogram::GetMin() const
+{
+    return ( totalCount_ ? min_ : 0 );
+}
+
+uint64_t HdrHistogram::GetMax() const
+{
+    return max_;
+}
+
+double HdrHistogram::GetMean() const
+{
+    return ( totalCount_ ? static_cast<double>( totalSum_ ) / totalCount_ : 0.0 );
+}
+
+uint64_t HdrHistogram::GetValueAtPercentile( double percentile ) const
+{
+    if ( !totalCount_ )
+    {
+        return 0;
+    }
+
+    percentile = std::clamp( percentile, 0.0, 100.0 );
+    const auto targetCount = std::max<uint64_t>( 1, static_cast<uint64_t>( std::ceil( percentile / 100 * totalCount_ ) ) );
+
+    uint64_t curCount = 0;
+    for ( uint32_t i = 0; i < counts_.size(); ++i )
+    {
+        curCount += counts_[i];
+        if ( curCount >= targetCount )
+        {
+            return std::clamp( GetHighestEquivalentValue( i ), min_, max_ );
+        }
+    }
+
+    return max_;
+}
+
+uint32_t HdrHistogram::GetBucketIdx( uint64_t value )
+{
+    if ( value < kSubBucketCount )
+    {
+        return static_cast<uint32_t>( value );
+    }
+
+    unsigned long msb = 0;
+    _BitScanReverse64( &msb, value );
+
+    // `value >> shift` is in [kSubBucketHalfCount, kSubBucketCount)
+    const uint32_t shift = msb - ( kSubBucketBits - 1 );
+    const auto subBucketIdx = static_cast<uint32_t>( value >> shift ) - kSubBucketHalfCount;
+    return kSubBucketCount + ( shift - 1 ) * kSubBucketHalfCount + subBucketIdx;
+}
+
+uint64_t HdrHistogram::GetHighestEquivalentValue( uint32_t bucketIdx )
+{
+    if ( bucketIdx < kSubBucketCount )
+    {
+        return bucketIdx;
+    }
+
+    const uint32_t shift = ( bucketIdx - kSubBucketCount ) / kSubBucketHalfCount + 1;
+    const uint64_t subBucketValue = ( bucketIdx - kSubBucketCount ) % kSubBucketHalfCount + kSubBucketHalfCount;
+    return ( ( subBucketValue + 1 ) << shift ) - 1;
+}
+
+} // namespace smp::utils
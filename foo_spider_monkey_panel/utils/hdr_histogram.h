@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+
+namespace smp::utils
+{
+
+/// @brief High dynamic range histogram with log-linear buckets.
+/// @details Values in [0, 128) are stored exactly, larger values are stored
+///          with relative precision of 1/64 (~1.6%).
+///          Values are clamped to kMaxValue.
+///          Memory footprint is fixed (~7KB), recording is O(1) and does not allocate.
+class HdrHistogram
+{
+public:
+    static constexpr uint64_t kMaxValue = ( uint64_t( 1 ) << 32 ) - 1;
+
+public:
+    HdrHistogram() = default;
+    ~HdrHistogram() = default;
+
+    void Record( uint64_t value );
+    void Reset();
+
+    uint64_t GetCount() const;
+    uint64_t GetMin() const;
+    uint64_t GetMax() const;
+    double GetMean() const;
+    /// @param percentile Value in [0, 100]
+    /// @return Highest value equivalent to the bucket that contains the percentile
+    uint64_t GetValueAtPercentile( double percentile ) const;
+
+private:
+    static constexpr uint32_t kSubBucketBits = 7;
+    static constexpr uint32_t kSubBucketCount = 1 << kSubBucketBits;
+    static constexpr uint32_t kSubBucketHalfCount = kSubBucketCount / 2;
+    static constexpr uint32_t kBucketCount = kSubBucketCount + ( 32 - kSubBucketBits ) * kSubBucketHalfCount;
+
+    static uint32_t GetBucketIdx( uint64_t value );
+    static uint64_t GetHighestEquivalentValue( uint32_t bucketIdx );
+
+private:
+    std::array<uint32_t, kBucketCount> counts_{};
+    uint64_t totalCount_ = 0;
+    uint64_t totalSum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+} // namespace smp::utils
@@ -3,6 +3,7 @@
 
 #include <utils/gdi_helpers.h>
 #include <utils/thread_pool.h>
+#include <utils/trace_recorder.h>
 
 #include <user_message.h>
 #include <message_manager.h>
@@ -89,6 +90,8 @@ uint32_t LoadImageAsync( HWND hWnd, const std::wstring& imagePath )
 
 std::unique_ptr<Gdiplus::Bitmap> LoadImage( const std::wstring& imagePath )
 {
+    SMP_TRACE_SCOPE( "image", "LoadImage" );
+
     // Gdiplus::Bitmap(path) locks file, thus using IStream instead to prevent it.
     IStreamPtr pStream;
     HRESULT hr = SHCreateStreamOnFileEx( imagePath.c_str(), STGM_READ | STGM_SHARE_DENY_WRITE, GENERIC_READ, FALSE, nullptr, &pStream );
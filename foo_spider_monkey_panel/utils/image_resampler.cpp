@@ -0,0 +1,38 @@
+#include <stdafx.h>
+#include "image_resampler.h"
+
+#include <utils/image_resampler_impl.h>
+#include <utils/thread_helpers.h>
+
+#include <algorithm>
+
+using namespace smp::pixels;
+
+namespace
+{
+
+/// @brief Amount of multiply-adds (pixels * taps) that is worth a separate thread
+constexpr size_t kMinOpsPerThread = 2 * 1024 * 1024;
+
+template <typename Fn>
+void ParallelForRows( uint32_t height, size_t opsPerRow, Fn&& fn )
+{
+    const size_t minRowsPerThread = ( kMinOpsPerThread + opsPerRow - 1 ) / std::max<size_t>( opsPerRow, 1 );
+    smp::utils::ParallelFor( height, minRowsPerThread, "SMP Image Resampling", [&fn]( size_t begin, size_t end ) {
+        fn( static_cast<uint32_t>( begin ), static_cast<uint32_t>( end ) );
+    } );
+}
+
+} // namespace
+
+namespace smp::pixels
+{
+
+void Resample( const PixelView& src, const PixelView& dst, ResampleFilter filter )
+{
+    impl::Resample<impl::kHasSimd>( src, dst, filter, []( uint32_t height, size_t opsPerRow, auto&& fn ) {
+        ParallelForRows( height, opsPerRow, fn );
+    } );
+}
+
+} // namespace smp::pixels
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <utils/pixel_kernels.h>
+
+namespace smp::pixels
+{
+
+enum class ResampleFilter
+{
+    box,      ///< area averaging, fastest: best suited for large downscales
+    mitchell, ///< Mitchell-Netravali cubic (B = C = 1/3)
+    lanczos3  ///< sharpest, might produce slight ringing
+};
+
+/// @brief Resamples pixels of `src` to the dimensions of `dst` with a separable filter.
+/// @details Pixels must be in premultiplied ARGB format.
+///          Filter weights are computed once per image dimension and applied in fixed point,
+///          results are bit-exact between SIMD and scalar implementations.
+///          Edge pixels are not blended with the transparent outside area.
+void Resample( const PixelView& src, const PixelView& dst, ResampleFilter filter );
+
+} // namespace smp::pixels
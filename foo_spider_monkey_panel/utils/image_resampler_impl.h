@@ -0,0 +1,389 @@
+#pragma once
+
+// Resampling passes of image_resampler.cpp.
+// Header is self-contained (no stdafx.h or Windows dependencies): resampler is tested and benchmarked separately,
+// see benchmarks/native.
+
+#include <utils/image_resampler.h>
+#include <utils/pixel_kernels_impl.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace smp::pixels::impl
+{
+
+/// @brief Amount of fractional bits in filter weights
+constexpr int kPrecisionBits = 14;
+
+/// @brief Filter weights for resampling of a single dimension
+struct FilterWeights
+{
+    uint32_t maxTapCount = 0; ///< stride of `weights`
+    std::vector<uint32_t> starts;
+    std::vector<uint32_t> tapCounts;
+    std::vector<int16_t> weights;
+};
+
+inline double GetSupport( ResampleFilter filter )
+{
+    switch ( filter )
+    {
+    case ResampleFilter::box:
+        return 0.5;
+    case ResampleFilter::mitchell:
+        return 2.0;
+    case ResampleFilter::lanczos3:
+        return 3.0;
+    default:
+        assert( false );
+        return 0.5;
+    }
+}
+
+inline double Sinc( double x )
+{
+    constexpr double kPi = 3.14159265358979323846;
+
+    if ( x == 0.0 )
+    {
+        return 1.0;
+    }
+
+    x *= kPi;
+    return std::sin( x ) / x;
+}
+
+inline double EvaluateFilter( ResampleFilter filter, double x )
+{
+    x = std::abs( x );
+    switch ( filter )
+    {
+    case ResampleFilter::mitchell:
+    {
+        constexpr double b = 1.0 / 3;
+        constexpr double c = 1.0 / 3;
+        if ( x < 1.0 )
+        {
+            return ( ( 12 - 9 * b - 6 * c ) * x * x * x + ( -18 + 12 * b + 6 * c ) * x * x + ( 6 - 2 * b ) ) / 6;
+        }
+        if ( x < 2.0 )
+        {
+            return ( ( -b - 6 * c ) * x * x * x + ( 6 * b + 30 * c ) * x * x + ( -12 * b - 48 * c ) * x + ( 8 * b + 24 * c ) ) / 6;
+        }
+        return 0.0;
+    }
+    case ResampleFilter::lanczos3:
+    {
+        return ( x < 3.0 ? Sinc( x ) * Sinc( x / 3 ) : 0.0 );
+    }
+    default:
+        assert( false );
+        return 0.0;
+    }
+}
+
+inline FilterWeights CalculateWeights( uint32_t srcSize, uint32_t dstSize, ResampleFilter filter )
+{
+    assert( srcSize && dstSize );
+
+    const double scale = static_cast<double>( srcSize ) / dstSize;
+    // box filter covers exactly the area of destination pixel, other filters are widened only when downscaling
+    const double filterScale = ( filter == ResampleFilter::box ? scale : std::max( scale, 1.0 ) );
+    const double support = GetSupport( filter ) * filterScale;
+
+    FilterWeights filterWeights;
+    filterWeights.maxTapCount = std::min( static_cast<uint32_t>( std::ceil( support ) ) * 2 + 1, srcSize );
+    filterWeights.starts.resize( dstSize );
+    filterWeights.tapCounts.resize( dstSize );
+    filterWeights.weights.resize( static_cast<size_t>( dstSize ) * filterWeights.maxTapCount );
+
+    std::vector<double> weights( filterWeights.maxTapCount );
+    for ( uint32_t i = 0; i < dstSize; ++i )
+    {
+        const double center = ( i + 0.5 ) * scale;
+        // weights outside of the image are dropped (instead of clamping the coordinates), which is the same as renormalizing
+        const auto start = static_cast<uint32_t>( std::max( 0.0, std::floor( center - support ) ) );
+        const auto end = static_cast<uint32_t>( std::min<double>( srcSize, std::ceil( center + support ) ) );
+        const uint32_t tapCount = std::min( end - start, filterWeights.maxTapCount );
+
+        double sum = 0;
+        for ( uint32_t j = 0; j < tapCount; ++j )
+        {
+            const double pos = start + j;
+            if ( filter == ResampleFilter::box )
+            { // overlap of the source pixel with the destination pixel area
+                weights[j] = std::max( 0.0, std::min( pos + 1, center + support ) - std::max( pos, center - support ) );
+            }
+            else
+            {
+                weights[j] = EvaluateFilter( filter, ( pos + 0.5 - center ) / filterScale );
+            }
+            sum += weights[j];
+        }
+
+        int16_t* pWeights = &filterWeights.weights[static_cast<size_t>( i ) * filterWeights.maxTapCount];
+        int32_t intSum = 0;
+        uint32_t maxIdx = 0;
+        for ( uint32_t j = 0; j < tapCount; ++j )
+        {
+            pWeights[j] = static_cast<int16_t>( std::lround( ( sum ? weights[j] / sum : 1.0 / tapCount ) * ( 1 << kPrecisionBits ) ) );
+            intSum += pWeights[j];
+            if ( pWeights[j] > pWeights[maxIdx] )
+            {
+                maxIdx = j;
+            }
+        }
+        // rounding error is compensated, so that flat areas are preserved exactly
+        pWeights[maxIdx] = static_cast<int16_t>( pWeights[maxIdx] + ( 1 << kPrecisionBits ) - intSum );
+
+        filterWeights.starts[i] = start;
+        filterWeights.tapCounts[i] = tapCount;
+    }
+
+    return filterWeights;
+}
+
+/// @brief Converts accumulated channels to pixel, colour channels are clamped to alpha to keep pixel properly premultiplied
+inline uint32_t PackPixel( const int32_t ( &acc )[4] )
+{
+    uint32_t channels[4];
+    for ( size_t i = 0; i < 4; ++i )
+    {
+        channels[i] = static_cast<uint32_t>( std::clamp( ( acc[i] + ( 1 << ( kPrecisionBits - 1 ) ) ) >> kPrecisionBits, 0, 255 ) );
+    }
+
+    const uint32_t alpha = channels[3];
+    return ( alpha << 24 )
+           | ( std::min( channels[2], alpha ) << 16 )
+           | ( std::min( channels[1], alpha ) << 8 )
+           | std::min( channels[0], alpha );
+}
+
+inline void AccumulatePixel( int32_t ( &acc )[4], uint32_t pixel, int16_t weight )
+{
+    for ( size_t i = 0; i < 4; ++i )
+    {
+        acc[i] += static_cast<int32_t>( ( pixel >> ( i * 8 ) ) & 0xff ) * weight;
+    }
+}
+
+#ifdef SMP_PIXELS_SSE2
+
+/// @brief Packs weights of two taps for `_mm_madd_epi16`
+inline int32_t PackWeights( int16_t w0, int16_t w1 )
+{
+    return static_cast<int32_t>( static_cast<uint16_t>( w0 ) | ( static_cast<uint32_t>( static_cast<uint16_t>( w1 ) ) << 16 ) );
+}
+
+inline __m128i LoadPixel( uint32_t pixel )
+{
+    return _mm_cvtsi32_si128( static_cast<int>( pixel ) );
+}
+
+/// @brief Rounds and clamps four accumulated channels of two pixels to 8-bit, result is in the lower 64 bits
+inline __m128i PackPixels( __m128i acc0, __m128i acc1 )
+{
+    const __m128i round = _mm_set1_epi32( 1 << ( kPrecisionBits - 1 ) );
+    acc0 = _mm_srai_epi32( _mm_add_epi32( acc0, round ), kPrecisionBits );
+    acc1 = _mm_srai_epi32( _mm_add_epi32( acc1, round ), kPrecisionBits );
+    const __m128i packed = _mm_packs_epi32( acc0, acc1 );
+    return _mm_packus_epi16( packed, packed );
+}
+
+inline __m128i ClampToAlpha( __m128i pixels )
+{
+    __m128i alpha = _mm_srli_epi32( pixels, 24 );
+    alpha = _mm_or_si128( alpha, _mm_slli_epi32( alpha, 8 ) );
+    alpha = _mm_or_si128( alpha, _mm_slli_epi32( alpha, 16 ) );
+    return _mm_min_epu8( pixels, alpha );
+}
+
+#endif
+
+/// @brief Resamples rows [begin, end) of `src` horizontally
+/// @tparam kUseSimd Whether SIMD version should be used (if available)
+template <bool kUseSimd>
+void ResampleHorizontal( const PixelView& src, const PixelView& dst, const FilterWeights& filterWeights, uint32_t begin, uint32_t end )
+{
+    for ( uint32_t y = begin; y < end; ++y )
+    {
+        const uint32_t* pSrcRow = src.GetRow( y );
+        uint32_t* pDstRow = dst.GetRow( y );
+
+        for ( uint32_t x = 0; x < dst.width; ++x )
+        {
+            const uint32_t* pPixels = pSrcRow + filterWeights.starts[x];
+            const int16_t* pWeights = &filterWeights.weights[static_cast<size_t>( x ) * filterWeights.maxTapCount];
+            const uint32_t tapCount = filterWeights.tapCounts[x];
+
+#ifdef SMP_PIXELS_SSE2
+            if constexpr ( kUseSimd )
+            {
+                // channels of two adjacent pixels are interleaved, so that `madd` yields the sum for every channel
+                const __m128i zero = _mm_setzero_si128();
+                __m128i acc = _mm_setzero_si128();
+                uint32_t k = 0;
+                for ( ; k + 1 < tapCount; k += 2 )
+                {
+                    const __m128i pixels = _mm_unpacklo_epi8( _mm_unpacklo_epi8( LoadPixel( pPixels[k] ), LoadPixel( pPixels[k + 1] ) ), zero );
+                    acc = _mm_add_epi32( acc, _mm_madd_epi16( pixels, _mm_set1_epi32( PackWeights( pWeights[k], pWeights[k + 1] ) ) ) );
+                }
+                if ( k < tapCount )
+                {
+                    const __m128i pixels = _mm_unpacklo_epi8( _mm_unpacklo_epi8( LoadPixel( pPixels[k] ), zero ), zero );
+                    acc = _mm_add_epi32( acc, _mm_madd_epi16( pixels, _mm_set1_epi32( PackWeights( pWeights[k], 0 ) ) ) );
+                }
+
+                pDstRow[x] = static_cast<uint32_t>( _mm_cvtsi128_si32( ClampToAlpha( PackPixels( acc, acc ) ) ) );
+                continue;
+            }
+#endif
+            int32_t acc[4] = {};
+            for ( uint32_t k = 0; k < tapCount; ++k )
+            {
+                AccumulatePixel( acc, pPixels[k], pWeights[k] );
+            }
+
+            pDstRow[x] = PackPixel( acc );
+        }
+    }
+}
+
+/// @brief Resamples rows [begin, end) of `dst` vertically
+/// @tparam kUseSimd Whether SIMD version should be used (if available)
+template <bool kUseSimd>
+void ResampleVertical( const PixelView& src, const PixelView& dst, const FilterWeights& filterWeights, uint32_t begin, uint32_t end )
+{
+    for ( uint32_t y = begin; y < end; ++y )
+    {
+        const uint32_t start = filterWeights.starts[y];
+        const int16_t* pWeights = &filterWeights.weights[static_cast<size_t>( y ) * filterWeights.maxTapCount];
+        const uint32_t tapCount = filterWeights.tapCounts[y];
+        uint32_t* pDstRow = dst.GetRow( y );
+
+        uint32_t x = 0;
+#ifdef SMP_PIXELS_SSE2
+        if constexpr ( kUseSimd )
+        {
+            const __m128i zero = _mm_setzero_si128();
+            for ( ; x + 4 <= dst.width; x += 4 )
+            {
+                __m128i acc[4] = { zero, zero, zero, zero };
+
+                const auto accumulate = [&acc, &zero]( __m128i row0, __m128i row1, __m128i weights ) {
+                    // channels of the same pixel from two rows are interleaved
+                    const __m128i lo = _mm_unpacklo_epi8( row0, row1 );
+                    const __m128i hi = _mm_unpackhi_epi8( row0, row1 );
+                    acc[0] = _mm_add_epi32( acc[0], _mm_madd_epi16( _mm_unpacklo_epi8( lo, zero ), weights ) );
+                    acc[1] = _mm_add_epi32( acc[1], _mm_madd_epi16( _mm_unpackhi_epi8( lo, zero ), weights ) );
+                    acc[2] = _mm_add_epi32( acc[2], _mm_madd_epi16( _mm_unpacklo_epi8( hi, zero ), weights ) );
+                    acc[3] = _mm_add_epi32( acc[3], _mm_madd_epi16( _mm_unpackhi_epi8( hi, zero ), weights ) );
+                };
+
+                uint32_t k = 0;
+                for ( ; k + 1 < tapCount; k += 2 )
+                {
+                    accumulate( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src.GetRow( start + k ) + x ) ),
+                                _mm_loadu_si128( reinterpret_cast<const __m128i*>( src.GetRow( start + k + 1 ) + x ) ),
+                                _mm_set1_epi32( PackWeights( pWeights[k], pWeights[k + 1] ) ) );
+                }
+                if ( k < tapCount )
+                {
+                    accumulate( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src.GetRow( start + k ) + x ) ),
+                                zero,
+                                _mm_set1_epi32( PackWeights( pWeights[k], 0 ) ) );
+                }
+
+                const __m128i pixels = _mm_unpacklo_epi64( PackPixels( acc[0], acc[1] ), PackPixels( acc[2], acc[3] ) );
+                _mm_storeu_si128( reinterpret_cast<__m128i*>( pDstRow + x ), ClampToAlpha( pixels ) );
+            }
+
+            for ( ; x < dst.width; ++x )
+            {
+                __m128i acc = zero;
+                uint32_t k = 0;
+                for ( ; k + 1 < tapCount; k += 2 )
+                {
+                    const __m128i pixels = _mm_unpacklo_epi8( _mm_unpacklo_epi8( LoadPixel( src.GetRow( start + k )[x] ), LoadPixel( src.GetRow( start + k + 1 )[x] ) ), zero );
+                    acc = _mm_add_epi32( acc, _mm_madd_epi16( pixels, _mm_set1_epi32( PackWeights( pWeights[k], pWeights[k + 1] ) ) ) );
+                }
+                if ( k < tapCount )
+                {
+                    const __m128i pixels = _mm_unpacklo_epi8( _mm_unpacklo_epi8( LoadPixel( src.GetRow( start + k )[x] ), zero ), zero );
+                    acc = _mm_add_epi32( acc, _mm_madd_epi16( pixels, _mm_set1_epi32( PackWeights( pWeights[k], 0 ) ) ) );
+                }
+
+                pDstRow[x] = static_cast<uint32_t>( _mm_cvtsi128_si32( ClampToAlpha( PackPixels( acc, acc ) ) ) );
+            }
+        }
+#endif
+        for ( ; x < dst.width; ++x )
+        {
+            int32_t acc[4] = {};
+            for ( uint32_t k = 0; k < tapCount; ++k )
+            {
+                AccumulatePixel( acc, src.GetRow( start + k )[x], pWeights[k] );
+            }
+
+            pDstRow[x] = PackPixel( acc );
+        }
+    }
+}
+
+/// @brief Implementation of smp::pixels::Resample.
+/// @param forRows Invoked as `forRows( rowCount, opsPerRow, fn )`, must call `fn( begin, end )` for every row range in [0, rowCount)
+template <bool kUseSimd, typename ForRowsFn>
+void Resample( const PixelView& src, const PixelView& dst, ResampleFilter filter, ForRowsFn&& forRows )
+{
+    if ( !src.width || !src.height || !dst.width || !dst.height )
+    {
+        return;
+    }
+
+    const bool needsHorizontal = ( src.width != dst.width );
+    const bool needsVertical = ( src.height != dst.height );
+
+    if ( !needsHorizontal && !needsVertical )
+    {
+        for ( uint32_t y = 0; y < dst.height; ++y )
+        {
+            std::memcpy( dst.GetRow( y ), src.GetRow( y ), static_cast<size_t>( dst.width ) * sizeof( uint32_t ) );
+        }
+        return;
+    }
+
+    // horizontal pass output: either the final result or the source for the vertical pass
+    std::vector<uint32_t> buffer;
+    PixelView horizontalView = src;
+    if ( needsHorizontal )
+    {
+        if ( needsVertical )
+        {
+            buffer.resize( static_cast<size_t>( dst.width ) * src.height );
+            horizontalView = PixelView{ reinterpret_cast<uint8_t*>( buffer.data() ), dst.width, src.height, static_cast<int32_t>( dst.width * sizeof( uint32_t ) ) };
+        }
+        else
+        {
+            horizontalView = dst;
+        }
+
+        const auto weights = CalculateWeights( src.width, dst.width, filter );
+        forRows( src.height, static_cast<size_t>( dst.width ) * weights.maxTapCount, [&]( uint32_t begin, uint32_t end ) {
+            ResampleHorizontal<kUseSimd>( src, horizontalView, weights, begin, end );
+        } );
+    }
+
+    if ( needsVertical )
+    {
+        const auto weights = CalculateWeights( src.height, dst.height, filter );
+        forRows( dst.height, static_cast<size_t>( dst.width ) * weights.maxTapCount, [&]( uint32_t begin, uint32_t end ) {
+            ResampleVertical<kUseSimd>( horizontalView, dst, weights, begin, end );
+        } );
+    }
+}
+
+} // namespace smp::pixels::impl
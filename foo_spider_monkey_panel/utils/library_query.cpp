@@ -0,0 +1,411 @@
+#include <stdafx.h>
+#include "library_query.h"
+
+#include <algorithm>
+
+namespace
+{
+
+constexpr size_t kMaxRecentQueries = 32;
+
+/// @brief Invoked by the filter when its results might have changed without library changes,
+///        e.g. for time-relative queries (`%added% DURING LAST 1 WEEK`)
+class QueryChangeNotify : public completion_notify
+{
+public:
+    QueryChangeNotify( const std::u8string& expression )
+        : expression_( expression )
+    {
+    }
+
+    void on_completion( unsigned /*p_code*/ ) override
+    {
+        fb2k::inMainThread( [expression = expression_] {
+            smp::utils::LibraryQueryManager::GetInstance().OnQueryResultsChanged( expression );
+        } );
+    }
+
+private:
+    std::u8string expression_;
+};
+
+} // namespace
+
+namespace smp::utils
+{
+
+LibraryQuery::LibraryQuery( const std::u8string& expression )
+    : expression_( expression )
+{
+    try
+    {
+        pFilter_ = search_filter_manager_v2::get()->create_ex( expression.c_str(),
+                                                               fb2k::service_new<QueryChangeNotify>( expression ),
+                                                               0 );
+    }
+    catch ( const pfc::exception& e )
+    {
+        throw SmpException( e.what() );
+    }
+}
+
+const std::u8string& LibraryQuery::GetExpression() const
+{
+    return expression_;
+}
+
+void LibraryQuery::Filter( metadb_handle_list& handles ) const
+{
+    pfc::array_t<bool> mask;
+    TestMulti( handles, mask );
+    handles.filter_mask( mask.get_ptr() );
+}
+
+bool LibraryQuery::Test( const metadb_handle_ptr& handle ) const
+{
+    metadb_handle_list handles;
+    handles.add_item( handle );
+
+    pfc::array_t<bool> mask;
+    TestMulti( handles, mask );
+    return mask[0];
+}
+
+void LibraryQuery::TestMulti( const metadb_handle_list& handles, pfc::array_t<bool>& mask ) const
+{
+    mask.set_size( handles.get_count() );
+    if ( !handles.get_count() )
+    {
+        return;
+    }
+
+    pFilter_->test_multi( handles, mask.get_ptr() );
+}
+
+LibraryQueryView::LibraryQueryView( std::shared_ptr<const LibraryQuery> pQuery )
+    : pQuery_( pQuery )
+{
+    items_ = ScanLibrary();
+}
+
+const LibraryQuery& LibraryQueryView::GetQuery() const
+{
+    return *pQuery_;
+}
+
+const metadb_handle_list& LibraryQueryView::GetItems() const
+{
+    return items_;
+}
+
+void LibraryQueryView::OnItemsAdded( const metadb_handle_list& handles, metadb_handle_list& added )
+{
+    pfc::array_t<bool> mask;
+    pQuery_->TestMulti( handles, mask );
+
+    for ( size_t i = 0, count = handles.get_count(); i < count; ++i )
+    {
+        if ( mask[i] && !Contains( handles[i] ) )
+        {
+            added.add_item( handles[i] );
+        }
+    }
+
+    metadb_handle_list removed;
+    ApplyChanges( added, removed );
+}
+
+void LibraryQueryView::OnItemsModified( const metadb_handle_list& handles, metadb_handle_list& added, metadb_handle_list& removed )
+{
+    pfc::array_t<bool> mask;
+    pQuery_->TestMulti( handles, mask );
+
+    for ( size_t i = 0, count = handles.get_count(); i < count; ++i )
+    {
+        const bool isContained = Contains( handles[i] );
+        if ( mask[i] && !isContained )
+        {
+            added.add_item( handles[i] );
+        }
+        else if ( !mask[i] && isContained )
+        {
+            removed.add_item( handles[i] );
+        }
+    }
+
+    ApplyChanges( added, removed );
+}
+
+void LibraryQueryView::OnItemsRemoved( const metadb_handle_list& handles, metadb_handle_list& removed )
+{
+    for ( size_t i = 0, count = handles.get_count(); i < count; ++i )
+    {
+        if ( Contains( handles[i] ) )
+        {
+            removed.add_item( handles[i] );
+        }
+    }
+
+    metadb_handle_list added;
+    ApplyChanges( added, removed );
+}
+
+void LibraryQueryView::Rescan( metadb_handle_list& added, metadb_handle_list& removed )
+{
+    const auto newItems = ScanLibrary();
+
+    // both lists are sorted, so a single merge pass is enough
+    const size_t oldCount = items_.get_count();
+    const size_t newCount = newItems.get_count();
+    for ( size_t i = 0, j = 0; i < oldCount || j < newCount; )
+    {
+        if ( j == newCount || ( i < oldCount && items_[i].get_ptr() < newItems[j].get_ptr() ) )
+        {
+            removed.add_item( items_[i++] );
+        }
+        else if ( i == oldCount || newItems[j].get_ptr() < items_[i].get_ptr() )
+        {
+            added.add_item( newItems[j++] );
+        }
+        else
+        {
+            ++i;
+            ++j;
+        }
+    }
+
+    items_ = newItems;
+}
+
+metadb_handle_list LibraryQueryView::ScanLibrary() const
+{
+    metadb_handle_list items;
+    library_manager::get()->get_all_items( items );
+    pQuery_->Filter( items );
+    items.sort_by_pointer_remove_duplicates();
+
+    return items;
+}
+
+bool LibraryQueryView::Contains( const metadb_handle_ptr& handle ) const
+{
+    return ( items_.bsearch_by_pointer( handle ) != pfc_infinite );
+}
+
+void LibraryQueryView::ApplyChanges( metadb_handle_list& added, metadb_handle_list& removed )
+{
+    added.sort_by_pointer_remove_duplicates();
+    removed.sort_by_pointer_remove_duplicates();
+
+    if ( removed.get_count() )
+    {
+        pfc::bit_array_bittable mask( items_.get_count() );
+        for ( size_t i = 0, count = removed.get_count(); i < count; ++i )
+        {
+            mask.set( items_.bsearch_by_pointer( removed[i] ), true );
+        }
+        items_.remove_mask( mask );
+    }
+
+    if ( added.get_count() )
+    { // both lists are sorted, so a single merge pass is enough
+        const size_t itemCount = items_.get_count();
+        const size_t addedCount = added.get_count();
+
+        metadb_handle_list merged;
+        merged.prealloc( itemCount + addedCount );
+        for ( size_t i = 0, j = 0; i < itemCount || j < addedCount; )
+        {
+            if ( j == addedCount || ( i < itemCount && items_[i].get_ptr() < added[j].get_ptr() ) )
+            {
+                merged.add_item( items_[i++] );
+            }
+            else
+            {
+                merged.add_item( added[j++] );
+            }
+        }
+
+        items_ = std::move( merged );
+    }
+}
+
+LibraryQueryManager& LibraryQueryManager::GetInstance()
+{
+    static LibraryQueryManager manager;
+    return manager;
+}
+
+void LibraryQueryManager::Finalize()
+{
+    isFinalized_ = true;
+
+    subscriptions_.clear();
+    views_.clear();
+    recentQueries_.clear();
+    queries_.clear();
+}
+
+std::shared_ptr<const LibraryQuery> LibraryQueryManager::GetQuery( const std::u8string& expression )
+{
+    if ( auto it = queries_.find( expression ); it != queries_.end() )
+    {
+        if ( auto pQuery = it->second.lock() )
+        {
+            MarkRecentlyUsed( pQuery );
+            return pQuery;
+        }
+    }
+
+    auto pQuery = std::make_shared<const LibraryQuery>( expression );
+    MarkRecentlyUsed( pQuery );
+
+    for ( auto it = queries_.begin(); it != queries_.end(); )
+    {
+        it = ( it->second.expired() ? queries_.erase( it ) : std::next( it ) );
+    }
+    queries_[expression] = pQuery;
+
+    return pQuery;
+}
+
+void LibraryQueryManager::MarkRecentlyUsed( const std::shared_ptr<const LibraryQuery>& pQuery )
+{
+    if ( auto it = std::find( recentQueries_.begin(), recentQueries_.end(), pQuery ); it != recentQueries_.end() )
+    {
+        recentQueries_.splice( recentQueries_.begin(), recentQueries_, it );
+        return;
+    }
+
+    recentQueries_.push_front( pQuery );
+    if ( recentQueries_.size() > kMaxRecentQueries )
+    {
+        recentQueries_.pop_back();
+    }
+}
+
+std::shared_ptr<LibraryQueryView> LibraryQueryManager::GetView( const std::u8string& expression )
+{
+    if ( auto it = views_.find( expression ); it != views_.end() )
+    {
+        if ( auto pView = it->second.lock() )
+        {
+            return pView;
+        }
+    }
+
+    for ( auto it = views_.begin(); it != views_.end(); )
+    {
+        it = ( it->second.expired() ? views_.erase( it ) : std::next( it ) );
+    }
+
+    auto pView = std::make_shared<LibraryQueryView>( GetQuery( expression ) );
+    views_[expression] = pView;
+
+    return pView;
+}
+
+uint32_t LibraryQueryManager::Subscribe( const std::u8string& expression, Callback callback )
+{
+    SmpException::ExpectTrue( !isFinalized_, "Internal error: library query manager is already finalized" );
+
+    const auto subscriptionId = ++lastSubscriptionId_;
+    subscriptions_.try_emplace( subscriptionId, Subscription{ GetView( expression ), std::move( callback ) } );
+
+    return subscriptionId;
+}
+
+void LibraryQueryManager::Unsubscribe( uint32_t subscriptionId )
+{
+    subscriptions_.erase( subscriptionId );
+}
+
+template <typename Fn>
+void LibraryQueryManager::UpdateViews( Fn&& fn )
+{
+    if ( isFinalized_ )
+    {
+        return;
+    }
+
+    for ( auto it = views_.begin(); it != views_.end(); )
+    {
+        auto pView = it->second.lock();
+        if ( !pView )
+        {
+            it = views_.erase( it );
+            continue;
+        }
+
+        metadb_handle_list added;
+        metadb_handle_list removed;
+        fn( *pView, added, removed );
+        NotifySubscribers( pView, added, removed );
+
+        ++it;
+    }
+}
+
+void LibraryQueryManager::NotifySubscribers( const std::shared_ptr<LibraryQueryView>& pView, const metadb_handle_list& added, const metadb_handle_list& removed )
+{
+    if ( !added.get_count() && !removed.get_count() )
+    {
+        return;
+    }
+
+    for ( const auto& [id, subscription]: subscriptions_ )
+    {
+        if ( subscription.pView == pView )
+        {
+            subscription.callback( added, removed );
+        }
+    }
+}
+
+void LibraryQueryManager::OnItemsAdded( const metadb_handle_list& handles )
+{
+    UpdateViews( [&handles]( auto& view, auto& added, auto& ) {
+        view.OnItemsAdded( handles, added );
+    } );
+}
+
+void LibraryQueryManager::OnItemsModified( const metadb_handle_list& handles )
+{
+    UpdateViews( [&handles]( auto& view, auto& added, auto& removed ) {
+        view.OnItemsModified( handles, added, removed );
+    } );
+}
+
+void LibraryQueryManager::OnItemsRemoved( const metadb_handle_list& handles )
+{
+    UpdateViews( [&handles]( auto& view, auto&, auto& removed ) {
+        view.OnItemsRemoved( handles, removed );
+    } );
+}
+
+void LibraryQueryManager::OnQueryResultsChanged( const std::u8string& expression )
+{
+    if ( isFinalized_ )
+    {
+        return;
+    }
+
+    const auto it = views_.find( expression );
+    if ( it == views_.end() )
+    { // query is not used by any view
+        return;
+    }
+
+    auto pView = it->second.lock();
+    if ( !pView )
+    {
+        return;
+    }
+
+    metadb_handle_list added;
+    metadb_handle_list removed;
+    pView->Rescan( added, removed );
+    NotifySubscribers( pView, added, removed );
+}
+
+} // namespace smp::utils
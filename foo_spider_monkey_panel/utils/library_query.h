@@ -0,0 +1,136 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace smp::utils
+{
+
+/// @brief Compiled media library query (search filter).
+/// @details Immutable, can be shared between panels.
+class LibraryQuery
+{
+public:
+    /// @throw smp::SmpException
+    LibraryQuery( const std::u8string& expression );
+    ~LibraryQuery() = default;
+    LibraryQuery( const LibraryQuery& ) = delete;
+    LibraryQuery& operator=( const LibraryQuery& ) = delete;
+
+    const std::u8string& GetExpression() const;
+
+    /// @brief Removes all items that don't match the query
+    void Filter( metadb_handle_list& handles ) const;
+    bool Test( const metadb_handle_ptr& handle ) const;
+    /// @param mask Receives the test result for every item
+    void TestMulti( const metadb_handle_list& handles, pfc::array_t<bool>& mask ) const;
+
+private:
+    std::u8string expression_;
+    search_filter_v2::ptr pFilter_;
+};
+
+/// @brief Media library items that match the query.
+/// @details Library is scanned on view creation: afterwards the result is maintained
+///          incrementally from library change deltas (only the changed items are evaluated).
+///          Library is rescanned only when the query reports that its results might have changed by themselves
+///          (e.g. time-relative queries).
+class LibraryQueryView
+{
+public:
+    LibraryQueryView( std::shared_ptr<const LibraryQuery> pQuery );
+    ~LibraryQueryView() = default;
+    LibraryQueryView( const LibraryQueryView& ) = delete;
+    LibraryQueryView& operator=( const LibraryQueryView& ) = delete;
+
+    const LibraryQuery& GetQuery() const;
+    /// @return Items sorted by pointer
+    const metadb_handle_list& GetItems() const;
+
+    /// @brief Applies library changes to the result set
+    /// @param added Items that were added to the result set (sorted by pointer)
+    /// @param removed Items that were removed from the result set (sorted by pointer)
+    void OnItemsAdded( const metadb_handle_list& handles, metadb_handle_list& added );
+    void OnItemsModified( const metadb_handle_list& handles, metadb_handle_list& added, metadb_handle_list& removed );
+    void OnItemsRemoved( const metadb_handle_list& handles, metadb_handle_list& removed );
+    /// @brief Re-evaluates the query for the whole library
+    void Rescan( metadb_handle_list& added, metadb_handle_list& removed );
+
+private:
+    /// @return Matching items sorted by pointer
+    metadb_handle_list ScanLibrary() const;
+    bool Contains( const metadb_handle_ptr& handle ) const;
+    void ApplyChanges( metadb_handle_list& added, metadb_handle_list& removed );
+
+private:
+    std::shared_ptr<const LibraryQuery> pQuery_;
+    metadb_handle_list items_;
+};
+
+/// @brief Caches compiled queries by expression and maintains live views for subscribed panels.
+/// @details The most recently used queries are kept alive even when nobody references them,
+///          so that repeated calls with the same expression (e.g. `fb.GetQueryItems()` in a loop) don't recompile it.
+///          All methods and callbacks are invoked on the main thread.
+class LibraryQueryManager
+{
+public:
+    using Callback = std::function<void( const metadb_handle_list& added, const metadb_handle_list& removed )>;
+
+public:
+    ~LibraryQueryManager() = default;
+    LibraryQueryManager( const LibraryQueryManager& ) = delete;
+    LibraryQueryManager& operator=( const LibraryQueryManager& ) = delete;
+
+    static LibraryQueryManager& GetInstance();
+
+    void Finalize();
+
+    /// @throw smp::SmpException
+    std::shared_ptr<const LibraryQuery> GetQuery( const std::u8string& expression );
+    /// @brief Returns live view of the query, view is created if needed.
+    /// @details View is kept alive while it is referenced or has subscriptions.
+    /// @throw smp::SmpException
+    std::shared_ptr<LibraryQueryView> GetView( const std::u8string& expression );
+
+    /// @return Subscription id
+    /// @throw smp::SmpException
+    uint32_t Subscribe( const std::u8string& expression, Callback callback );
+    void Unsubscribe( uint32_t subscriptionId );
+
+    void OnItemsAdded( const metadb_handle_list& handles );
+    void OnItemsModified( const metadb_handle_list& handles );
+    void OnItemsRemoved( const metadb_handle_list& handles );
+    /// @brief Invoked when query results might have changed without library changes (e.g. time-relative queries)
+    void OnQueryResultsChanged( const std::u8string& expression );
+
+private:
+    LibraryQueryManager() = default;
+
+    struct Subscription
+    {
+        std::shared_ptr<LibraryQueryView> pView;
+        Callback callback;
+    };
+
+    template <typename Fn>
+    void UpdateViews( Fn&& fn );
+    void NotifySubscribers( const std::shared_ptr<LibraryQueryView>& pView, const metadb_handle_list& added, const metadb_handle_list& removed );
+
+    void MarkRecentlyUsed( const std::shared_ptr<const LibraryQuery>& pQuery );
+
+private:
+    bool isFinalized_ = false;
+    std::unordered_map<std::u8string, std::weak_ptr<const LibraryQuery>> queries_;
+    /// @brief Strong references to the most recently used queries, most recent first
+    std::list<std::shared_ptr<const LibraryQuery>> recentQueries_;
+    std::unordered_map<std::u8string, std::weak_ptr<LibraryQueryView>> views_;
+
+    uint32_t lastSubscriptionId_ = 0;
+    std::map<uint32_t, Subscription> subscriptions_;
+};
+
+} // namespace smp::utils
@@ -0,0 +1,87 @@
+#include <stdafx.h>
+#include "pixel_kernels.h"
+
+#include <utils/pixel_kernels_impl.h>
+#include <utils/thread_helpers.h>
+
+#include <algorithm>
+
+using namespace smp::pixels;
+using namespace smp::pixels::impl;
+
+namespace
+{
+
+/// @brief Kernels are memory bound, so there is no point in spawning threads for small images
+constexpr size_t kMinPixelsPerThread = 256 * 1024;
+
+template <typename Fn>
+void ParallelForRows( uint32_t height, uint32_t width, Fn&& fn )
+{
+    const size_t minRowsPerThread = ( kMinPixelsPerThread + width - 1 ) / std::max<size_t>( width, 1 );
+    smp::utils::ParallelFor( height, minRowsPerThread, "SMP Pixel Processing", [&fn]( size_t begin, size_t end ) {
+        fn( static_cast<uint32_t>( begin ), static_cast<uint32_t>( end ) );
+    } );
+}
+
+/// @brief Applies kernel to every pixel of `dst`, see ProcessRows
+template <typename Kernel>
+void ProcessPixels( const PixelView& dst, const Kernel& kernel )
+{
+    ParallelForRows( dst.height, dst.width, [&dst, &kernel]( uint32_t begin, uint32_t end ) {
+        ProcessRows<kHasSimd>( dst, begin, end, kernel );
+    } );
+}
+
+/// @brief Same as above, but kernel receives the corresponding pixel of `src` as the second argument
+template <typename Kernel>
+void ProcessPixels( const PixelView& dst, const PixelView& src, const Kernel& kernel )
+{
+    assert( dst.width == src.width && dst.height == src.height );
+
+    ParallelForRows( dst.height, dst.width, [&dst, &src, &kernel]( uint32_t begin, uint32_t end ) {
+        ProcessRows<kHasSimd>( dst, src, begin, end, kernel );
+    } );
+}
+
+} // namespace
+
+namespace smp::pixels
+{
+
+void ApplyMask( const PixelView& dst, const PixelView& mask )
+{
+    ProcessPixels( dst, mask, MaskKernel{} );
+}
+
+void ScaleAlpha( const PixelView& dst, uint8_t factor )
+{
+    ProcessPixels( dst, ScaleAlphaKernel{ factor } );
+}
+
+void Greyscale( const PixelView& dst )
+{
+    ProcessPixels( dst, GreyscaleKernel{} );
+}
+
+void Invert( const PixelView& dst )
+{
+    ProcessPixels( dst, InvertKernel{} );
+}
+
+void Tint( const PixelView& dst, uint32_t tint, uint8_t amount )
+{
+    ProcessPixels( dst, TintKernel( tint, amount ) );
+}
+
+void AdjustBrightness( const PixelView& dst, int32_t delta )
+{
+    ProcessPixels( dst, BrightnessKernel( delta ) );
+}
+
+void AdjustContrast( const PixelView& dst, uint32_t factor )
+{
+    ProcessPixels( dst, ContrastKernel( factor ) );
+}
+
+} // namespace smp::pixels
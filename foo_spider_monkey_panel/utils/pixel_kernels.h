@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace smp::pixels
+{
+
+/// @brief Mutable view of 32bpp pixels in `0xAARRGGBB` format (e.g. locked Gdiplus::BitmapData).
+struct PixelView
+{
+    uint8_t* pScan0;
+    uint32_t width;
+    uint32_t height;
+    int32_t stride; ///< in bytes, might be negative
+
+    uint32_t* GetRow( uint32_t y ) const
+    {
+        return reinterpret_cast<uint32_t*>( pScan0 + static_cast<ptrdiff_t>( y ) * stride );
+    }
+};
+
+// Kernels are vectorized (SSE2) when available, results are bit-exact with the scalar versions.
+// Large images are processed in parallel.
+// Colour kernels don't change the alpha channel.
+
+/// @brief alpha = ( ( 255 - mask.blue ) * alpha ) >> 8
+/// @details `mask` must have the same dimensions as `dst`.
+void ApplyMask( const PixelView& dst, const PixelView& mask );
+
+/// @brief alpha = round( alpha * factor / 255 )
+void ScaleAlpha( const PixelView& dst, uint8_t factor );
+
+/// @brief rgb = ( 77 * red + 150 * green + 29 * blue + 128 ) >> 8
+void Greyscale( const PixelView& dst );
+
+/// @brief rgb = 255 - rgb
+void Invert( const PixelView& dst );
+
+/// @brief rgb = round( ( rgb * ( 255 - amount ) + tint.rgb * amount ) / 255 )
+void Tint( const PixelView& dst, uint32_t tint, uint8_t amount );
+
+/// @brief rgb = clamp( rgb + delta )
+/// @param delta [-255, 255]
+void AdjustBrightness( const PixelView& dst, int32_t delta );
+
+/// @brief rgb = clamp( ( ( rgb - 128 ) * factor >> 8 ) + 128 )
+/// @param factor Fixed point value with 8 fractional bits (i.e. 256 means no change), [0, 32767]
+void AdjustContrast( const PixelView& dst, uint32_t factor );
+
+} // namespace smp::pixels
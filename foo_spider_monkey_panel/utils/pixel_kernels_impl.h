@@ -0,0 +1,308 @@
+#pragma once
+
+// Row kernels of pixel_kernels.cpp.
+// Header is self-contained (no stdafx.h or Windows dependencies): kernels are tested and benchmarked separately,
+// see benchmarks/native.
+
+#include <utils/pixel_kernels.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#if !defined( SMP_PIXELS_NO_SIMD ) \
+    && ( defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) || defined( __SSE2__ ) )
+#    define SMP_PIXELS_SSE2
+#    include <emmintrin.h>
+#endif
+
+namespace smp::pixels::impl
+{
+
+#ifdef SMP_PIXELS_SSE2
+constexpr bool kHasSimd = true;
+#else
+constexpr bool kHasSimd = false;
+#endif
+
+/// @brief Applies kernel to every pixel in rows [begin, end) of `dst`.
+/// @details Kernel must implement `uint32_t operator()( uint32_t )` and (when SIMD is available) `__m128i operator()( __m128i )`.
+/// @tparam kUseSimd Whether SIMD version of the kernel should be used (if available), tail of the row is always processed by the scalar version
+template <bool kUseSimd, typename Kernel>
+void ProcessRows( const PixelView& dst, uint32_t begin, uint32_t end, const Kernel& kernel )
+{
+    for ( uint32_t y = begin; y < end; ++y )
+    {
+        uint32_t* pRow = dst.GetRow( y );
+        uint32_t x = 0;
+#ifdef SMP_PIXELS_SSE2
+        if constexpr ( kUseSimd )
+        {
+            for ( ; x + 4 <= dst.width; x += 4 )
+            {
+                auto* pPixels = reinterpret_cast<__m128i*>( pRow + x );
+                _mm_storeu_si128( pPixels, kernel( _mm_loadu_si128( pPixels ) ) );
+            }
+        }
+#endif
+        for ( ; x < dst.width; ++x )
+        {
+            pRow[x] = kernel( pRow[x] );
+        }
+    }
+}
+
+/// @brief Same as above, but kernel receives the corresponding pixel of `src` as the second argument
+template <bool kUseSimd, typename Kernel>
+void ProcessRows( const PixelView& dst, const PixelView& src, uint32_t begin, uint32_t end, const Kernel& kernel )
+{
+    for ( uint32_t y = begin; y < end; ++y )
+    {
+        uint32_t* pRow = dst.GetRow( y );
+        const uint32_t* pSrcRow = src.GetRow( y );
+        uint32_t x = 0;
+#ifdef SMP_PIXELS_SSE2
+        if constexpr ( kUseSimd )
+        {
+            for ( ; x + 4 <= dst.width; x += 4 )
+            {
+                auto* pPixels = reinterpret_cast<__m128i*>( pRow + x );
+                const auto* pSrcPixels = reinterpret_cast<const __m128i*>( pSrcRow + x );
+                _mm_storeu_si128( pPixels, kernel( _mm_loadu_si128( pPixels ), _mm_loadu_si128( pSrcPixels ) ) );
+            }
+        }
+#endif
+        for ( ; x < dst.width; ++x )
+        {
+            pRow[x] = kernel( pRow[x], pSrcRow[x] );
+        }
+    }
+}
+
+/// @brief round( x / 255 ) for x in [0, 65535]
+inline uint32_t Div255( uint32_t x )
+{
+    x += 128;
+    return ( x + ( x >> 8 ) ) >> 8;
+}
+
+template <int kShift>
+uint32_t GetChannel( uint32_t pixel )
+{
+    return ( pixel >> kShift ) & 0xff;
+}
+
+inline uint32_t ClampChannel( int32_t value )
+{
+    return static_cast<uint32_t>( std::clamp( value, 0, 255 ) );
+}
+
+#ifdef SMP_PIXELS_SSE2
+
+// Values are processed in 32-bit lanes, one pixel (or one channel of a pixel) per lane
+
+/// @brief round( x / 255 ) for x in [0, 65535]
+inline __m128i Div255( __m128i x )
+{
+    x = _mm_add_epi32( x, _mm_set1_epi32( 128 ) );
+    return _mm_srli_epi32( _mm_add_epi32( x, _mm_srli_epi32( x, 8 ) ), 8 );
+}
+
+/// @brief Multiplies values in 32-bit lanes: both values and the result must fit in 16 bits
+inline __m128i MulLow( __m128i a, __m128i b )
+{ // high halves of the lanes are zero, so 16-bit multiplication yields the same results
+    return _mm_mullo_epi16( a, b );
+}
+
+template <int kShift>
+__m128i GetChannel( __m128i pixels )
+{
+    return _mm_and_si128( _mm_srli_epi32( pixels, kShift ), _mm_set1_epi32( 0xff ) );
+}
+
+/// @brief Clamps signed values in 32-bit lanes to [0, 255], values must fit in 16 bits
+inline __m128i ClampChannel( __m128i values )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i packed = _mm_packus_epi16( _mm_packs_epi32( values, values ), zero );
+    return _mm_unpacklo_epi16( _mm_unpacklo_epi8( packed, zero ), zero );
+}
+
+#endif
+
+struct MaskKernel
+{
+    uint32_t operator()( uint32_t pixel, uint32_t mask ) const
+    {
+        const uint32_t alpha = ( ( ( ~mask & 0xff ) * ( pixel >> 24 ) ) << 16 ) & 0xff000000;
+        return alpha | ( pixel & 0xffffff );
+    }
+
+#ifdef SMP_PIXELS_SSE2
+    __m128i operator()( __m128i pixels, __m128i mask ) const
+    {
+        const __m128i invertedMask = _mm_andnot_si128( mask, _mm_set1_epi32( 0xff ) );
+        const __m128i product = MulLow( invertedMask, _mm_srli_epi32( pixels, 24 ) );
+        const __m128i alpha = _mm_and_si128( _mm_slli_epi32( product, 16 ), _mm_set1_epi32( 0xff000000 ) );
+        return _mm_or_si128( alpha, _mm_and_si128( pixels, _mm_set1_epi32( 0xffffff ) ) );
+    }
+#endif
+};
+
+struct ScaleAlphaKernel
+{
+    uint32_t factor;
+
+    uint32_t operator()( uint32_t pixel ) const
+    {
+        return ( Div255( ( pixel >> 24 ) * factor ) << 24 ) | ( pixel & 0xffffff );
+    }
+
+#ifdef SMP_PIXELS_SSE2
+    __m128i operator()( __m128i pixels ) const
+    {
+        const __m128i alpha = Div255( MulLow( _mm_srli_epi32( pixels, 24 ), _mm_set1_epi32( factor ) ) );
+        return _mm_or_si128( _mm_slli_epi32( alpha, 24 ), _mm_and_si128( pixels, _mm_set1_epi32( 0xffffff ) ) );
+    }
+#endif
+};
+
+struct GreyscaleKernel
+{
+    uint32_t operator()( uint32_t pixel ) const
+    {
+        const uint32_t luma = ( 77 * GetChannel<16>( pixel ) + 150 * GetChannel<8>( pixel ) + 29 * GetChannel<0>( pixel ) + 128 ) >> 8;
+        return ( pixel & 0xff000000 ) | ( luma * 0x010101 );
+    }
+
+#ifdef SMP_PIXELS_SSE2
+    __m128i operator()( __m128i pixels ) const
+    {
+        __m128i luma = _mm_add_epi32( MulLow( GetChannel<16>( pixels ), _mm_set1_epi32( 77 ) ),
+                                      MulLow( GetChannel<8>( pixels ), _mm_set1_epi32( 150 ) ) );
+        luma = _mm_add_epi32( luma, MulLow( GetChannel<0>( pixels ), _mm_set1_epi32( 29 ) ) );
+        luma = _mm_srli_epi32( _mm_add_epi32( luma, _mm_set1_epi32( 128 ) ), 8 );
+
+        const __m128i rgb = _mm_or_si128( _mm_or_si128( luma, _mm_slli_epi32( luma, 8 ) ), _mm_slli_epi32( luma, 16 ) );
+        return _mm_or_si128( _mm_and_si128( pixels, _mm_set1_epi32( 0xff000000 ) ), rgb );
+    }
+#endif
+};
+
+struct InvertKernel
+{
+    uint32_t operator()( uint32_t pixel ) const
+    {
+        return pixel ^ 0xffffff;
+    }
+
+#ifdef SMP_PIXELS_SSE2
+    __m128i operator()( __m128i pixels ) const
+    {
+        return _mm_xor_si128( pixels, _mm_set1_epi32( 0xffffff ) );
+    }
+#endif
+};
+
+struct TintKernel
+{
+    TintKernel( uint32_t tint, uint8_t amount )
+        : inverseAmount( 255u - amount )
+        , red( GetChannel<16>( tint ) * amount )
+        , green( GetChannel<8>( tint ) * amount )
+        , blue( GetChannel<0>( tint ) * amount )
+    {
+    }
+
+    uint32_t operator()( uint32_t pixel ) const
+    {
+        const uint32_t r = Div255( GetChannel<16>( pixel ) * inverseAmount + red );
+        const uint32_t g = Div255( GetChannel<8>( pixel ) * inverseAmount + green );
+        const uint32_t b = Div255( GetChannel<0>( pixel ) * inverseAmount + blue );
+        return ( pixel & 0xff000000 ) | ( r << 16 ) | ( g << 8 ) | b;
+    }
+
+#ifdef SMP_PIXELS_SSE2
+    __m128i operator()( __m128i pixels ) const
+    {
+        const __m128i inverse = _mm_set1_epi32( inverseAmount );
+        const __m128i r = Div255( _mm_add_epi32( MulLow( GetChannel<16>( pixels ), inverse ), _mm_set1_epi32( red ) ) );
+        const __m128i g = Div255( _mm_add_epi32( MulLow( GetChannel<8>( pixels ), inverse ), _mm_set1_epi32( green ) ) );
+        const __m128i b = Div255( _mm_add_epi32( MulLow( GetChannel<0>( pixels ), inverse ), _mm_set1_epi32( blue ) ) );
+
+        const __m128i rgb = _mm_or_si128( _mm_or_si128( _mm_slli_epi32( r, 16 ), _mm_slli_epi32( g, 8 ) ), b );
+        return _mm_or_si128( _mm_and_si128( pixels, _mm_set1_epi32( 0xff000000 ) ), rgb );
+    }
+#endif
+
+    uint32_t inverseAmount;
+    uint32_t red;   ///< tint.red * amount
+    uint32_t green; ///< tint.green * amount
+    uint32_t blue;  ///< tint.blue * amount
+};
+
+struct BrightnessKernel
+{
+    /// @param delta Clamped to [-255, 255]
+    explicit BrightnessKernel( int32_t delta )
+        : delta( std::clamp( delta, -255, 255 ) )
+    {
+    }
+
+    uint32_t operator()( uint32_t pixel ) const
+    {
+        const uint32_t r = ClampChannel( static_cast<int32_t>( GetChannel<16>( pixel ) ) + delta );
+        const uint32_t g = ClampChannel( static_cast<int32_t>( GetChannel<8>( pixel ) ) + delta );
+        const uint32_t b = ClampChannel( static_cast<int32_t>( GetChannel<0>( pixel ) ) + delta );
+        return ( pixel & 0xff000000 ) | ( r << 16 ) | ( g << 8 ) | b;
+    }
+
+#ifdef SMP_PIXELS_SSE2
+    __m128i operator()( __m128i pixels ) const
+    { // alpha byte of the delta is zero, so alpha is not affected
+        const __m128i absDelta = _mm_set1_epi32( static_cast<int>( static_cast<uint32_t>( std::abs( delta ) ) * 0x010101 ) );
+        return ( delta >= 0 ? _mm_adds_epu8( pixels, absDelta ) : _mm_subs_epu8( pixels, absDelta ) );
+    }
+#endif
+
+    int32_t delta;
+};
+
+struct ContrastKernel
+{
+    /// @param factor Clamped to [0, 32767]
+    explicit ContrastKernel( uint32_t factor )
+        : factor( static_cast<int32_t>( std::min<uint32_t>( factor, 32767 ) ) )
+    {
+    }
+
+    uint32_t operator()( uint32_t pixel ) const
+    {
+        const auto adjust = [factor = factor]( uint32_t value ) {
+            return ClampChannel( ( ( ( static_cast<int32_t>( value ) - 128 ) * factor ) >> 8 ) + 128 );
+        };
+
+        return ( pixel & 0xff000000 ) | ( adjust( GetChannel<16>( pixel ) ) << 16 ) | ( adjust( GetChannel<8>( pixel ) ) << 8 ) | adjust( GetChannel<0>( pixel ) );
+    }
+
+#ifdef SMP_PIXELS_SSE2
+    __m128i operator()( __m128i pixels ) const
+    {
+        // low halves of the lanes contain signed 16-bit values, high halves are multiplied by zero
+        const __m128i multiplier = _mm_set1_epi32( factor );
+        const __m128i offset = _mm_set1_epi32( 128 );
+        const auto adjust = [&multiplier, &offset]( __m128i values ) {
+            const __m128i product = _mm_madd_epi16( _mm_sub_epi32( values, offset ), multiplier );
+            return ClampChannel( _mm_add_epi32( _mm_srai_epi32( product, 8 ), offset ) );
+        };
+
+        const __m128i rgb = _mm_or_si128( _mm_or_si128( _mm_slli_epi32( adjust( GetChannel<16>( pixels ) ), 16 ),
+                                                         _mm_slli_epi32( adjust( GetChannel<8>( pixels ) ), 8 ) ),
+                                          adjust( GetChannel<0>( pixels ) ) );
+        return _mm_or_si128( _mm_and_si128( pixels, _mm_set1_epi32( 0xff000000 ) ), rgb );
+    }
+#endif
+
+    int32_t factor;
+};
+
+} // namespace smp::pixels::impl
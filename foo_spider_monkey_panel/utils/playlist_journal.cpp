@@ -0,0 +1,215 @@
+#include <stdafx.h>
+#include "playlist_journal.h"
+
+#include <algorithm>
+
+namespace
+{
+
+/// @brief Maximum amount of changes stored per playlist
+constexpr size_t kMaxChangeCount = 256;
+/// @brief Maximum amount of handles and indices stored per playlist
+constexpr size_t kMaxTotalSize = 256 * 1024;
+
+} // namespace
+
+namespace smp::utils
+{
+
+PlaylistJournal& PlaylistJournal::GetInstance()
+{
+    static PlaylistJournal journal;
+    return journal;
+}
+
+uint32_t PlaylistJournal::GetVersion( size_t playlistIndex )
+{
+    Synchronize();
+
+    if ( playlistIndex >= playlists_.size() )
+    {
+        return 0;
+    }
+
+    return playlists_[playlistIndex].version;
+}
+
+std::optional<std::vector<PlaylistChange>> PlaylistJournal::GetChanges( size_t playlistIndex, uint32_t sinceVersion )
+{
+    Synchronize();
+
+    if ( playlistIndex >= playlists_.size() )
+    {
+        return std::nullopt;
+    }
+
+    const auto& playlistData = playlists_[playlistIndex];
+    if ( sinceVersion < playlistData.baseVersion || sinceVersion > playlistData.version )
+    {
+        return std::nullopt;
+    }
+
+    const auto it = std::upper_bound( playlistData.changes.cbegin(), playlistData.changes.cend(), sinceVersion, []( uint32_t version, const auto& change ) {
+        return version < change.version;
+    } );
+    return std::vector<PlaylistChange>( it, playlistData.changes.cend() );
+}
+
+uint32_t PlaylistJournal::OnItemsAdded( size_t playlistIndex, size_t start, const metadb_handle_list& handles )
+{
+    PlaylistChange change{};
+    change.type = PlaylistChangeType::added;
+    change.start = start;
+    change.handles = handles;
+
+    return AddChange( playlistIndex, std::move( change ) );
+}
+
+uint32_t PlaylistJournal::OnItemsRemoved( size_t playlistIndex, const pfc::bit_array& mask, size_t oldCount )
+{
+    PlaylistChange change{};
+    change.type = PlaylistChangeType::removed;
+
+    for ( size_t i = 0; i < oldCount; ++i )
+    {
+        if ( !mask.get( i ) )
+        {
+            continue;
+        }
+
+        if ( !change.ranges.empty() && change.ranges.back().first + change.ranges.back().second == i )
+        {
+            ++change.ranges.back().second;
+        }
+        else
+        {
+            change.ranges.emplace_back( i, 1 );
+        }
+    }
+
+    return AddChange( playlistIndex, std::move( change ) );
+}
+
+uint32_t PlaylistJournal::OnItemsReordered( size_t playlistIndex, const size_t* order, size_t count )
+{
+    PlaylistChange change{};
+    change.type = PlaylistChangeType::reordered;
+    change.indices.assign( order, order + count );
+
+    return AddChange( playlistIndex, std::move( change ) );
+}
+
+uint32_t PlaylistJournal::OnItemsReplaced( size_t playlistIndex, const pfc::list_base_const_t<playlist_callback::t_on_items_replaced_entry>& entries )
+{
+    PlaylistChange change{};
+    change.type = PlaylistChangeType::replaced;
+
+    const size_t count = entries.get_count();
+    change.indices.reserve( count );
+    change.handles.prealloc( count );
+    for ( size_t i = 0; i < count; ++i )
+    {
+        const auto& entry = entries[i];
+        change.indices.emplace_back( entry.m_index );
+        change.handles.add_item( entry.m_new );
+    }
+
+    return AddChange( playlistIndex, std::move( change ) );
+}
+
+void PlaylistJournal::OnPlaylistCreated( size_t playlistIndex )
+{
+    if ( playlistIndex <= playlists_.size() )
+    {
+        playlists_.insert( playlists_.begin() + playlistIndex, CreatePlaylistData() );
+    }
+
+    Synchronize();
+}
+
+void PlaylistJournal::OnPlaylistsRemoved( const pfc::bit_array& mask, size_t oldCount )
+{
+    if ( oldCount == playlists_.size() )
+    {
+        std::vector<PlaylistData> newPlaylists;
+        newPlaylists.reserve( oldCount );
+        for ( size_t i = 0; i < oldCount; ++i )
+        {
+            if ( !mask.get( i ) )
+            {
+                newPlaylists.emplace_back( std::move( playlists_[i] ) );
+            }
+        }
+        playlists_ = std::move( newPlaylists );
+    }
+
+    Synchronize();
+}
+
+void PlaylistJournal::OnPlaylistsReordered( const size_t* order, size_t count )
+{
+    if ( count == playlists_.size() )
+    {
+        std::vector<PlaylistData> newPlaylists;
+        newPlaylists.reserve( count );
+        for ( size_t i = 0; i < count; ++i )
+        {
+            newPlaylists.emplace_back( std::move( playlists_[order[i]] ) );
+        }
+        playlists_ = std::move( newPlaylists );
+    }
+
+    Synchronize();
+}
+
+void PlaylistJournal::Synchronize()
+{
+    const size_t playlistCount = playlist_manager::get()->get_playlist_count();
+    if ( playlists_.size() == playlistCount )
+    {
+        return;
+    }
+
+    // we've lost track of playlists (or it's the first use): all the history must be dropped
+    playlists_.clear();
+    playlists_.resize( playlistCount, CreatePlaylistData() );
+}
+
+uint32_t PlaylistJournal::AddChange( size_t playlistIndex, PlaylistChange change )
+{
+    Synchronize();
+
+    change.version = ++lastVersion_;
+    if ( playlistIndex >= playlists_.size() )
+    {
+        return change.version;
+    }
+
+    auto& playlistData = playlists_[playlistIndex];
+    playlistData.version = change.version;
+    playlistData.totalSize += GetChangeSize( change );
+    playlistData.changes.emplace_back( std::move( change ) );
+
+    while ( !playlistData.changes.empty()
+            && ( playlistData.changes.size() > kMaxChangeCount || playlistData.totalSize > kMaxTotalSize ) )
+    {
+        const auto& oldestChange = playlistData.changes.front();
+        playlistData.baseVersion = oldestChange.version;
+        playlistData.totalSize -= GetChangeSize( oldestChange );
+        playlistData.changes.pop_front();
+    }
+
+    return playlistData.version;
+}
+
+PlaylistJournal::PlaylistData PlaylistJournal::CreatePlaylistData() const
+{
+    return PlaylistData{ lastVersion_, lastVersion_ };
+}
+
+size_t PlaylistJournal::GetChangeSize( const PlaylistChange& change )
+{
+    return change.handles.get_count() + change.ranges.size() + change.indices.size();
+}
+
+} // namespace smp::utils
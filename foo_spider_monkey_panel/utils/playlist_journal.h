@@ -0,0 +1,89 @@
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace smp::utils
+{
+
+enum class PlaylistChangeType : uint8_t
+{
+    added,
+    removed,
+    reordered,
+    replaced
+};
+
+struct PlaylistChange
+{
+    uint32_t version;
+    PlaylistChangeType type;
+    /// @brief `added`: index of the first inserted item
+    size_t start = 0;
+    /// @brief `added`: inserted items; `replaced`: new items
+    metadb_handle_list handles;
+    /// @brief `removed`: ascending [start, count] ranges of removed items (indices before the removal)
+    std::vector<std::pair<size_t, size_t>> ranges;
+    /// @brief `reordered`: order[newIndex] = oldIndex; `replaced`: indices of the replaced items
+    std::vector<size_t> indices;
+};
+
+/// @brief Versioned per-playlist journal of item changes.
+/// @details Allows playlist views to patch their contents with deltas instead of re-reading the whole playlist.
+///          Versions are shared by all playlists and are strictly increasing.
+///          Only the most recent changes are kept: older versions become unavailable when the journal is trimmed.
+///          All methods must be called from the main thread.
+class PlaylistJournal
+{
+public:
+    ~PlaylistJournal() = default;
+    PlaylistJournal( const PlaylistJournal& ) = delete;
+    PlaylistJournal& operator=( const PlaylistJournal& ) = delete;
+
+    static PlaylistJournal& GetInstance();
+
+    /// @return Current version of the playlist, 0 if playlist does not exist
+    uint32_t GetVersion( size_t playlistIndex );
+    /// @return Changes made after `sinceVersion`,
+    ///         nullopt if they are not available (e.g. were trimmed or version is invalid)
+    std::optional<std::vector<PlaylistChange>> GetChanges( size_t playlistIndex, uint32_t sinceVersion );
+
+    /// @return Version of the change
+    uint32_t OnItemsAdded( size_t playlistIndex, size_t start, const metadb_handle_list& handles );
+    /// @return Version of the change
+    uint32_t OnItemsRemoved( size_t playlistIndex, const pfc::bit_array& mask, size_t oldCount );
+    /// @return Version of the change
+    uint32_t OnItemsReordered( size_t playlistIndex, const size_t* order, size_t count );
+    /// @return Version of the change
+    uint32_t OnItemsReplaced( size_t playlistIndex, const pfc::list_base_const_t<playlist_callback::t_on_items_replaced_entry>& entries );
+
+    void OnPlaylistCreated( size_t playlistIndex );
+    void OnPlaylistsRemoved( const pfc::bit_array& mask, size_t oldCount );
+    void OnPlaylistsReordered( const size_t* order, size_t count );
+
+private:
+    PlaylistJournal() = default;
+
+    struct PlaylistData
+    {
+        uint32_t baseVersion;
+        uint32_t version;
+        std::deque<PlaylistChange> changes;
+        size_t totalSize = 0; ///< total amount of handles and indices in `changes`
+    };
+
+    /// @brief Re-synchronizes the list of playlists with playlist_manager (e.g. on the first use)
+    void Synchronize();
+    uint32_t AddChange( size_t playlistIndex, PlaylistChange change );
+    PlaylistData CreatePlaylistData() const;
+
+    static size_t GetChangeSize( const PlaylistChange& change );
+
+private:
+    uint32_t lastVersion_ = 0;
+    std::vector<PlaylistData> playlists_;
+};
+
+} // namespace smp::utils
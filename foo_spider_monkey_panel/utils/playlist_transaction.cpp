@@ -0,0 +1,422 @@
+#include <stdafx.h>
+#include "playlist_transaction.h"
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+
+bool IsSameList( const metadb_handle_list& a, const metadb_handle_list& b )
+{
+    if ( a.get_count() != b.get_count() )
+    {
+        return false;
+    }
+
+    for ( size_t i = 0, count = a.get_count(); i < count; ++i )
+    {
+        if ( a[i] != b[i] )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+namespace smp::utils
+{
+
+PlaylistTransaction::PlaylistTransaction( size_t playlistIndex )
+    : playlist_callback_impl_base( flag_on_playlist_created | flag_on_playlists_reorder | flag_on_playlists_removed )
+    , playlistIndexOpt_( playlistIndex )
+{
+    auto api = playlist_manager::get();
+    SmpException::ExpectTrue( playlistIndex < api->get_playlist_count(), "Index is out of bounds" );
+
+    api->playlist_get_all_items( playlistIndex, originalItems_ );
+
+    const size_t count = originalItems_.get_count();
+    pfc::bit_array_bittable selection( count );
+    api->playlist_get_selection_mask( playlistIndex, selection );
+    const size_t focusIdx = api->playlist_get_focus_item( playlistIndex );
+
+    items_.reserve( count );
+    for ( size_t i = 0; i < count; ++i )
+    {
+        items_.push_back( Item{ originalItems_[i], i, selection.get( i ), i == focusIdx } );
+    }
+}
+
+std::optional<size_t> PlaylistTransaction::GetPlaylistIndex() const
+{
+    return playlistIndexOpt_;
+}
+
+void PlaylistTransaction::Commit()
+{
+    auto api = playlist_manager::get();
+    SmpException::ExpectTrue( playlistIndexOpt_.has_value(), "Playlist does not exist anymore" );
+    assert( *playlistIndexOpt_ < api->get_playlist_count() );
+
+    const size_t playlistIndex = *playlistIndexOpt_;
+
+    {
+        metadb_handle_list currentItems;
+        api->playlist_get_all_items( playlistIndex, currentItems );
+        SmpException::ExpectTrue( IsSameList( currentItems, originalItems_ ), "Playlist was modified outside of the transaction" );
+    }
+
+    const size_t originalCount = originalItems_.get_count();
+
+    pfc::bit_array_bittable removalMask( originalCount );
+    for ( size_t i = 0; i < originalCount; ++i )
+    {
+        removalMask.set( i, true );
+    }
+
+    bool isRetainedOrderPreserved = true;
+    std::optional<size_t> lastRetainedIdx;
+    std::optional<size_t> firstNewPos;
+    std::optional<size_t> lastNewPos;
+    size_t newItemCount = 0;
+    for ( size_t i = 0; i < items_.size(); ++i )
+    {
+        const auto& item = items_[i];
+        if ( item.originalIndex )
+        {
+            removalMask.set( *item.originalIndex, false );
+            if ( lastRetainedIdx && *lastRetainedIdx > *item.originalIndex )
+            {
+                isRetainedOrderPreserved = false;
+            }
+            lastRetainedIdx = *item.originalIndex;
+        }
+        else
+        {
+            if ( !firstNewPos )
+            {
+                firstNewPos = i;
+            }
+            lastNewPos = i;
+            ++newItemCount;
+        }
+    }
+
+    const size_t retainedCount = items_.size() - newItemCount;
+    const bool hasRemovedItems = ( retainedCount != originalCount );
+    const bool isNewItemBlockContiguous = ( !newItemCount || ( *lastNewPos - *firstNewPos + 1 == newItemCount ) );
+    const bool needsReorder = ( !isRetainedOrderPreserved || !isNewItemBlockContiguous );
+
+    if ( hasRemovedItems || newItemCount || needsReorder )
+    {
+        const auto lockMask = ( api->playlist_lock_is_present( playlistIndex ) ? api->playlist_lock_get_filter_mask( playlistIndex ) : 0 );
+        SmpException::ExpectTrue( !hasRemovedItems || !( lockMask & playlist_lock::filter_remove ), "Playlist is locked: removing items is not allowed" );
+        SmpException::ExpectTrue( !newItemCount || !( lockMask & playlist_lock::filter_add ), "Playlist is locked: adding items is not allowed" );
+        SmpException::ExpectTrue( !needsReorder || !( lockMask & playlist_lock::filter_reorder ), "Playlist is locked: reordering items is not allowed" );
+
+        api->playlist_undo_backup( playlistIndex );
+    }
+
+    if ( hasRemovedItems )
+    {
+        api->playlist_remove_items( playlistIndex, removalMask );
+    }
+
+    if ( newItemCount )
+    {
+        metadb_handle_list newItems;
+        newItems.prealloc( newItemCount );
+        pfc::bit_array_bittable newSelection( newItemCount );
+        for ( const auto& item: items_ )
+        {
+            if ( !item.originalIndex )
+            {
+                newSelection.set( newItems.get_count(), item.isSelected );
+                newItems.add_item( item.handle );
+            }
+        }
+
+        // items before the contiguous block are all retained ones, so its position is the same in both lists
+        const size_t base = ( needsReorder ? retainedCount : *firstNewPos );
+        api->playlist_insert_items( playlistIndex, base, newItems, newSelection );
+    }
+
+    if ( needsReorder )
+    { // current contents: retained items in the original order followed by new items
+        std::vector<size_t> retainedPos( originalCount );
+        for ( size_t i = 0, pos = 0; i < originalCount; ++i )
+        {
+            if ( !removalMask.get( i ) )
+            {
+                retainedPos[i] = pos++;
+            }
+        }
+
+        std::vector<size_t> order;
+        order.reserve( items_.size() );
+        size_t newItemIdx = 0;
+        for ( const auto& item: items_ )
+        {
+            order.push_back( item.originalIndex ? retainedPos[*item.originalIndex] : retainedCount + newItemIdx++ );
+        }
+
+        api->playlist_reorder_items( playlistIndex, order.data(), order.size() );
+    }
+
+    {
+        const size_t count = api->playlist_get_item_count( playlistIndex );
+        if ( count == items_.size() )
+        {
+            pfc::bit_array_bittable currentSelection( count );
+            api->playlist_get_selection_mask( playlistIndex, currentSelection );
+
+            bool isSelectionChanged = false;
+            pfc::bit_array_bittable newSelection( count );
+            for ( size_t i = 0; i < count; ++i )
+            {
+                newSelection.set( i, items_[i].isSelected );
+                isSelectionChanged |= ( items_[i].isSelected != currentSelection.get( i ) );
+            }
+
+            if ( isSelectionChanged )
+            {
+                api->playlist_set_selection( playlistIndex, pfc::bit_array_true(), newSelection );
+            }
+        }
+    }
+
+    if ( const auto focusIdxOpt = GetFocusItem();
+         focusIdxOpt && api->playlist_get_focus_item( playlistIndex ) != *focusIdxOpt )
+    {
+        api->playlist_set_focus_item( playlistIndex, *focusIdxOpt );
+    }
+}
+
+void PlaylistTransaction::on_playlist_created( t_size p_index, const char* /*p_name*/, t_size /*p_name_len*/ )
+{
+    if ( playlistIndexOpt_ && p_index <= *playlistIndexOpt_ )
+    {
+        ++*playlistIndexOpt_;
+    }
+}
+
+void PlaylistTransaction::on_playlists_reorder( const t_size* p_order, t_size p_count )
+{
+    if ( !playlistIndexOpt_ )
+    {
+        return;
+    }
+
+    const auto it = std::find( p_order, p_order + p_count, *playlistIndexOpt_ );
+    assert( it != p_order + p_count );
+    playlistIndexOpt_ = static_cast<size_t>( it - p_order );
+}
+
+void PlaylistTransaction::on_playlists_removed( const pfc::bit_array& p_mask, t_size /*p_old_count*/, t_size /*p_new_count*/ )
+{
+    if ( !playlistIndexOpt_ )
+    {
+        return;
+    }
+
+    if ( p_mask.get( *playlistIndexOpt_ ) )
+    {
+        playlistIndexOpt_.reset();
+        return;
+    }
+
+    size_t removedBefore = 0;
+    for ( size_t i = 0; i < *playlistIndexOpt_; ++i )
+    {
+        removedBefore += ( p_mask.get( i ) ? 1 : 0 );
+    }
+    *playlistIndexOpt_ -= removedBefore;
+}
+
+size_t PlaylistTransaction::GetItemCount() const
+{
+    return items_.size();
+}
+
+void PlaylistTransaction::GetItems( metadb_handle_list& items ) const
+{
+    items.remove_all();
+    items.prealloc( items_.size() );
+    for ( const auto& item: items_ )
+    {
+        items.add_item( item.handle );
+    }
+}
+
+void PlaylistTransaction::GetSelectedItems( metadb_handle_list& items ) const
+{
+    items.remove_all();
+    for ( const auto& item: items_ )
+    {
+        if ( item.isSelected )
+        {
+            items.add_item( item.handle );
+        }
+    }
+}
+
+bool PlaylistTransaction::IsItemSelected( size_t itemIndex ) const
+{
+    return ( itemIndex < items_.size() && items_[itemIndex].isSelected );
+}
+
+std::optional<size_t> PlaylistTransaction::GetFocusItem() const
+{
+    const auto it = ranges::find_if( items_, []( const auto& item ) { return item.isFocused; } );
+    if ( it == items_.cend() )
+    {
+        return std::nullopt;
+    }
+
+    return static_cast<size_t>( std::distance( items_.cbegin(), it ) );
+}
+
+void PlaylistTransaction::Clear()
+{
+    items_.clear();
+}
+
+void PlaylistTransaction::InsertItems( size_t base, const metadb_handle_list& items, bool select )
+{
+    std::vector<Item> newItems;
+    newItems.reserve( items.get_count() );
+    for ( size_t i = 0, count = items.get_count(); i < count; ++i )
+    {
+        newItems.push_back( Item{ items[i], std::nullopt, select, false } );
+    }
+
+    const auto it = items_.begin() + std::min( base, items_.size() );
+    items_.insert( it, std::make_move_iterator( newItems.begin() ), std::make_move_iterator( newItems.end() ) );
+}
+
+void PlaylistTransaction::RemoveSelection( bool crop )
+{
+    items_.erase( std::remove_if( items_.begin(), items_.end(), [crop]( const auto& item ) { return item.isSelected != crop; } ),
+                  items_.end() );
+}
+
+void PlaylistTransaction::SetSelection( const pfc::bit_array& affected, bool state )
+{
+    for ( size_t i = 0; i < items_.size(); ++i )
+    {
+        if ( affected.get( i ) )
+        {
+            items_[i].isSelected = state;
+        }
+    }
+}
+
+void PlaylistTransaction::SetSelectionSingle( size_t itemIndex, bool state )
+{
+    if ( itemIndex < items_.size() )
+    {
+        items_[itemIndex].isSelected = state;
+    }
+}
+
+void PlaylistTransaction::ClearSelection()
+{
+    for ( auto& item: items_ )
+    {
+        item.isSelected = false;
+    }
+}
+
+void PlaylistTransaction::SetFocusItem( size_t itemIndex )
+{
+    for ( size_t i = 0; i < items_.size(); ++i )
+    {
+        items_[i].isFocused = ( i == itemIndex );
+    }
+}
+
+void PlaylistTransaction::SetFocusByHandle( const metadb_handle_ptr& handle )
+{
+    const auto it = ranges::find_if( items_, [&handle]( const auto& item ) { return item.handle == handle; } );
+    if ( it != items_.cend() )
+    {
+        SetFocusItem( std::distance( items_.begin(), it ) );
+    }
+}
+
+void PlaylistTransaction::MoveSelection( int delta )
+{
+    if ( !delta || items_.empty() )
+    {
+        return;
+    }
+
+    pfc::bit_array_bittable selection( items_.size() );
+    for ( size_t i = 0; i < items_.size(); ++i )
+    {
+        selection.set( i, items_[i].isSelected );
+    }
+
+    std::vector<size_t> order( items_.size() );
+    playlist_manager::g_make_selection_move_permutation( order.data(), order.size(), selection, delta );
+
+    Reorder( order );
+}
+
+void PlaylistTransaction::SortByFormat( const titleformat_object::ptr& script, bool selOnly, int direction )
+{
+    std::vector<size_t> positions;
+    positions.reserve( items_.size() );
+    for ( size_t i = 0; i < items_.size(); ++i )
+    {
+        if ( !selOnly || items_[i].isSelected )
+        {
+            positions.push_back( i );
+        }
+    }
+
+    std::vector<size_t> positionsOrder = ranges::view::indices( positions.size() );
+    if ( script.is_valid() )
+    {
+        metadb_handle_list handles;
+        handles.prealloc( positions.size() );
+        for ( auto pos: positions )
+        {
+            handles.add_item( items_[pos].handle );
+        }
+
+        metadb_handle_list_helper::sort_by_format_get_order( handles, positionsOrder.data(), script, nullptr, direction );
+    }
+    else
+    {
+        std::shuffle( positionsOrder.begin(), positionsOrder.end(), std::mt19937( std::random_device{}() ) );
+    }
+
+    std::vector<size_t> order = ranges::view::indices( items_.size() );
+    for ( size_t i = 0; i < positions.size(); ++i )
+    {
+        order[positions[i]] = positions[positionsOrder[i]];
+    }
+
+    Reorder( order );
+}
+
+void PlaylistTransaction::Reorder( const std::vector<size_t>& order )
+{
+    assert( order.size() == items_.size() );
+
+    std::vector<Item> newItems;
+    newItems.reserve( items_.size() );
+    for ( auto idx: order )
+    {
+        newItems.push_back( items_[idx] );
+    }
+
+    items_ = std::move( newItems );
+}
+
+} // namespace smp::utils
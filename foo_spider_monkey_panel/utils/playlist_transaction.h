@@ -0,0 +1,77 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+namespace smp::utils
+{
+
+/// @brief Stages playlist edits and applies them with a minimal set of `playlist_manager` operations.
+/// @details Every staged operation works on the in-memory copy of the playlist.
+///          Commit takes a single undo backup and performs at most one removal, one insertion,
+///          one reordering, one selection change and one focus change,
+///          so that every playlist callback is fired at most once per commit.
+///          The playlist is tracked through playlist callbacks, so the transaction follows it
+///          when other playlists are created, removed or reordered.
+///          Must be used from the main thread only.
+class PlaylistTransaction
+    : private playlist_callback_impl_base
+{
+public:
+    /// @throw smp::SmpException
+    PlaylistTransaction( size_t playlistIndex );
+    ~PlaylistTransaction() override = default;
+    PlaylistTransaction( const PlaylistTransaction& ) = delete;
+    PlaylistTransaction& operator=( const PlaylistTransaction& ) = delete;
+
+    /// @return Current index of the playlist, nullopt if it was removed
+    std::optional<size_t> GetPlaylistIndex() const;
+
+    /// @brief Applies all staged edits to the playlist
+    /// @throw smp::SmpException
+    void Commit();
+
+public:
+    size_t GetItemCount() const;
+    void GetItems( metadb_handle_list& items ) const;
+    void GetSelectedItems( metadb_handle_list& items ) const;
+    bool IsItemSelected( size_t itemIndex ) const;
+    std::optional<size_t> GetFocusItem() const;
+
+    void Clear();
+    void InsertItems( size_t base, const metadb_handle_list& items, bool select );
+    void RemoveSelection( bool crop );
+    /// @param affected Mask for the current items
+    void SetSelection( const pfc::bit_array& affected, bool state );
+    void SetSelectionSingle( size_t itemIndex, bool state );
+    void ClearSelection();
+    void SetFocusItem( size_t itemIndex );
+    void SetFocusByHandle( const metadb_handle_ptr& handle );
+    void MoveSelection( int delta );
+    /// @param script Items are shuffled if null
+    void SortByFormat( const titleformat_object::ptr& script, bool selOnly, int direction );
+
+private: // playlist_callback
+    void on_playlist_created( t_size p_index, const char* p_name, t_size p_name_len ) override;
+    void on_playlists_reorder( const t_size* p_order, t_size p_count ) override;
+    void on_playlists_removed( const pfc::bit_array& p_mask, t_size p_old_count, t_size p_new_count ) override;
+
+private:
+    struct Item
+    {
+        metadb_handle_ptr handle;
+        std::optional<size_t> originalIndex; ///< not set for inserted items
+        bool isSelected;
+        bool isFocused;
+    };
+
+    /// @param order order[newIndex] = oldIndex
+    void Reorder( const std::vector<size_t>& order );
+
+private:
+    std::optional<size_t> playlistIndexOpt_;
+    metadb_handle_list originalItems_;
+    std::vector<Item> items_;
+};
+
+} // namespace smp::utils
@@ -0,0 +1,269 @@
+#include <stdafx.h>
+#include "text_file_reader.h"
+
+#include <utils/text_helpers.h>
+
+#include <algorithm>
+#include <cwchar>
+
+namespace
+{
+
+constexpr unsigned char kBom16Le[] = { 0xff, 0xfe };
+constexpr unsigned char kBom8[] = { 0xef, 0xbb, 0xbf };
+
+/// @brief Charset detection is performed only on the beginning of the file,
+///        since it's too slow to be performed on the whole file.
+constexpr size_t kCharsetDetectionSampleSize = 64 * 1024;
+
+} // namespace
+
+namespace smp::file
+{
+
+TextFileReader::TextFileReader( const std::u8string& path, UINT codepage )
+    : fileReader_( path )
+    , content_( fileReader_.GetFileContent() )
+    , codepage_( codepage )
+{
+    if ( content_.size() >= sizeof( kBom16Le )
+         && !memcmp( kBom16Le, content_.data(), sizeof( kBom16Le ) ) )
+    {
+        content_.remove_prefix( sizeof( kBom16Le ) );
+        content_.remove_suffix( content_.size() % sizeof( wchar_t ) );
+        isWide_ = true;
+        charSize_ = sizeof( wchar_t );
+        codepage_ = 1200; // UTF-16LE
+    }
+    else if ( content_.size() >= sizeof( kBom8 )
+              && !memcmp( kBom8, content_.data(), sizeof( kBom8 ) ) )
+    {
+        content_.remove_prefix( sizeof( kBom8 ) );
+        codepage_ = CP_UTF8;
+    }
+    else if ( codepage_ == CP_ACP )
+    {
+        codepage_ = smp::utils::detect_text_charset( content_.substr( 0, kCharsetDetectionSampleSize ) );
+    }
+
+    if ( content_.empty() )
+    {
+        isIndexComplete_ = true;
+    }
+    else
+    {
+        lineIndex_.emplace_back( 0 );
+        indexedLineCount_ = 1;
+    }
+}
+
+size_t TextFileReader::GetLineCount()
+{
+    ExtendIndex( SIZE_MAX );
+    return indexedLineCount_;
+}
+
+size_t TextFileReader::GetCurrentLine() const
+{
+    return curLine_;
+}
+
+UINT TextFileReader::GetCodepage() const
+{
+    return codepage_;
+}
+
+size_t TextFileReader::GetSize() const
+{
+    return content_.size();
+}
+
+void TextFileReader::Seek( size_t lineIdx )
+{
+    if ( lineIdx == curLine_ )
+    {
+        return;
+    }
+
+    const auto lineStartOpt = FindLineStart( lineIdx );
+    if ( !lineStartOpt )
+    { // positioning right after the last line is allowed
+        SmpException::ExpectTrue( lineIdx == indexedLineCount_, "Line index is out of bounds: {}", lineIdx );
+
+        curLine_ = lineIdx;
+        curOffset_ = content_.size();
+        return;
+    }
+
+    curLine_ = lineIdx;
+    curOffset_ = *lineStartOpt;
+}
+
+std::optional<std::wstring> TextFileReader::ReadLine()
+{
+    if ( curOffset_ >= content_.size() )
+    {
+        return std::nullopt;
+    }
+
+    const auto lineEnd = FindLineEnd( curOffset_ );
+    auto line = DecodeLine( curOffset_, lineEnd );
+
+    curOffset_ = GetNextLineStart( lineEnd );
+    ++curLine_;
+
+    return line;
+}
+
+std::optional<std::wstring> TextFileReader::ReadChunk( size_t maxSize )
+{
+    if ( curOffset_ >= content_.size() )
+    {
+        return std::nullopt;
+    }
+
+    const auto chunkStart = curOffset_;
+    do
+    {
+        curOffset_ = GetNextLineStart( FindLineEnd( curOffset_ ) );
+        ++curLine_;
+    } while ( curOffset_ < content_.size() && curOffset_ - chunkStart < maxSize );
+
+    return Decode( content_.substr( chunkStart, curOffset_ - chunkStart ) );
+}
+
+std::vector<std::wstring> TextFileReader::ReadLines( size_t startLine, size_t count )
+{
+    std::vector<std::wstring> lines;
+
+    const auto lineStartOpt = FindLineStart( startLine );
+    if ( !lineStartOpt )
+    {
+        return lines;
+    }
+
+    lines.reserve( std::min<size_t>( count, kLineIndexStride * 64 ) );
+
+    size_t offset = *lineStartOpt;
+    for ( size_t i = 0; i < count && offset < content_.size(); ++i )
+    {
+        const auto lineEnd = FindLineEnd( offset );
+        lines.emplace_back( DecodeLine( offset, lineEnd ) );
+        offset = GetNextLineStart( lineEnd );
+    }
+
+    return lines;
+}
+
+std::optional<size_t> TextFileReader::FindLineStart( size_t lineIdx )
+{
+    if ( lineIdx == curLine_ && curOffset_ < content_.size() )
+    { // fast path for sequential access
+        return curOffset_;
+    }
+
+    ExtendIndex( lineIdx );
+    if ( lineIdx >= indexedLineCount_ )
+    {
+        return std::nullopt;
+    }
+
+    const auto indexPos = lineIdx / kLineIndexStride;
+    assert( indexPos < lineIndex_.size() );
+
+    size_t offset = lineIndex_[indexPos];
+    for ( size_t i = indexPos * kLineIndexStride; i < lineIdx; ++i )
+    {
+        offset = GetNextLineStart( FindLineEnd( offset ) );
+    }
+
+    return offset;
+}
+
+size_t TextFileReader::FindLineEnd( size_t lineStart ) const
+{
+    assert( lineStart <= content_.size() );
+    assert( !( lineStart % charSize_ ) );
+
+    if ( isWide_ )
+    {
+        const auto* pBegin = reinterpret_cast<const wchar_t*>( content_.data() + lineStart );
+        const auto charCount = ( content_.size() - lineStart ) / sizeof( wchar_t );
+        const auto* pEnd = wmemchr( pBegin, L'\n', charCount );
+        return ( pEnd ? lineStart + ( pEnd - pBegin ) * sizeof( wchar_t ) : content_.size() );
+    }
+    else
+    {
+        const auto* pBegin = content_.data() + lineStart;
+        const auto* pEnd = static_cast<const char*>( memchr( pBegin, '\n', content_.size() - lineStart ) );
+        return ( pEnd ? lineStart + ( pEnd - pBegin ) : content_.size() );
+    }
+}
+
+size_t TextFileReader::GetNextLineStart( size_t lineEnd ) const
+{
+    return std::min( lineEnd + charSize_, content_.size() );
+}
+
+void TextFileReader::ExtendIndex( size_t lineIdx )
+{
+    while ( !isIndexComplete_ && indexedLineCount_ <= lineIdx )
+    {
+        const auto nextLineStart = GetNextLineStart( FindLineEnd( lastIndexedLineStart_ ) );
+        if ( nextLineStart >= content_.size() )
+        { // trailing line separator does not start a new line
+            isIndexComplete_ = true;
+            break;
+        }
+
+        if ( !( indexedLineCount_ % kLineIndexStride ) )
+        {
+            lineIndex_.emplace_back( nextLineStart );
+        }
+        lastIndexedLineStart_ = nextLineStart;
+        ++indexedLineCount_;
+    }
+}
+
+std::wstring TextFileReader::DecodeLine( size_t lineStart, size_t lineEnd ) const
+{
+    auto line = content_.substr( lineStart, lineEnd - lineStart );
+
+    if ( isWide_ )
+    {
+        if ( line.size() >= sizeof( wchar_t )
+             && *reinterpret_cast<const wchar_t*>( line.data() + line.size() - sizeof( wchar_t ) ) == L'\r' )
+        {
+            line.remove_suffix( sizeof( wchar_t ) );
+        }
+    }
+    else if ( !line.empty() && line.back() == '\r' )
+    {
+        line.remove_suffix( 1 );
+    }
+
+    return Decode( line );
+}
+
+std::wstring TextFileReader::Decode( std::string_view data ) const
+{
+    if ( isWide_ )
+    {
+        std::wstring tmpString;
+        tmpString.resize( data.size() / sizeof( wchar_t ) );
+        // Can't use wstring.assign(), because of potential aliasing issues
+        memcpy( tmpString.data(), data.data(), tmpString.size() * sizeof( wchar_t ) );
+        return tmpString;
+    }
+
+    std::wstring tmpString;
+    size_t outputSize = pfc::stringcvt::estimate_codepage_to_wide( codepage_, data.data(), data.size() );
+    tmpString.resize( outputSize );
+
+    outputSize = pfc::stringcvt::convert_codepage_to_wide( codepage_, tmpString.data(), outputSize, data.data(), data.size() );
+    tmpString.resize( outputSize );
+
+    return tmpString;
+}
+
+} // namespace smp::file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <utils/file_helpers.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace smp::file
+{
+
+/// @brief Streaming line reader for (potentially huge) text files.
+/// @details File is memory-mapped and only the requested lines are decoded.
+///          Line offsets are indexed lazily and sparsely (every `kLineIndexStride`-th line),
+///          so that index size stays small even for files with millions of lines.
+///          Lines are separated by `\n`, trailing `\r` is removed.
+class TextFileReader
+{
+public:
+    static constexpr size_t kLineIndexStride = 128;
+
+public:
+    /// @param codepage Codepage of the file, CP_ACP (0) for auto-detection.
+    ///                 BOM (UTF-8 or UTF-16LE), if present, takes precedence.
+    /// @throw smp::SmpException
+    TextFileReader( const std::u8string& path, UINT codepage );
+    ~TextFileReader() = default;
+    TextFileReader( const TextFileReader& ) = delete;
+    TextFileReader& operator=( const TextFileReader& ) = delete;
+
+    /// @details Indexes the whole file on the first call
+    size_t GetLineCount();
+    size_t GetCurrentLine() const;
+    UINT GetCodepage() const;
+    /// @return File size in bytes (excluding BOM)
+    size_t GetSize() const;
+
+    /// @brief Sets position of the sequential reader
+    /// @throw smp::SmpException
+    void Seek( size_t lineIdx );
+    /// @brief Reads the line at the current position and advances it
+    /// @return nullopt, if there are no more lines
+    std::optional<std::wstring> ReadLine();
+    /// @brief Reads whole lines at the current position and advances it,
+    ///        until the total size of read data reaches `maxSize` bytes.
+    ///        At least one line is read (regardless of its size). Line separators are retained.
+    /// @return nullopt, if there are no more lines
+    std::optional<std::wstring> ReadChunk( size_t maxSize );
+    /// @brief Random access read, does not change the current position
+    /// @return Lines in range [startLine, startLine + count), truncated by the line count
+    std::vector<std::wstring> ReadLines( size_t startLine, size_t count );
+
+private:
+    /// @return Offset of the line start, nullopt if line does not exist
+    std::optional<size_t> FindLineStart( size_t lineIdx );
+    /// @return Offset of the line separator, or content size if there is none
+    size_t FindLineEnd( size_t lineStart ) const;
+    /// @return Start of the next line (might be equal to content size)
+    size_t GetNextLineStart( size_t lineEnd ) const;
+
+    /// @brief Extends index until it covers the specified line or the end of the file
+    void ExtendIndex( size_t lineIdx );
+
+    std::wstring DecodeLine( size_t lineStart, size_t lineEnd ) const;
+    std::wstring Decode( std::string_view data ) const;
+
+private:
+    FileReader fileReader_;
+    std::string_view content_; ///< without BOM
+    UINT codepage_ = CP_ACP;
+    bool isWide_ = false;
+    size_t charSize_ = 1;
+
+    std::vector<size_t> lineIndex_; ///< offset of every kLineIndexStride-th line
+    size_t indexedLineCount_ = 0;
+    size_t lastIndexedLineStart_ = 0;
+    bool isIndexComplete_ = false;
+
+    size_t curLine_ = 0;
+    size_t curOffset_ = 0;
+};
+
+} // namespace smp::file
@@ -1,10 +1,51 @@
 #pragma once
 
+#include <algorithm>
 #include <thread>
+#include <vector>
 
 namespace smp::utils
 {
 
 void SetThreadName( std::thread& thread, const char* threadName );
 
-}
\ No newline at end of file
+/// @brief Splits [0, count) into chunks and invokes `fn( begin, end )` for every chunk in a separate thread.
+/// @details The first chunk is processed in the calling thread. `fn` must not throw.
+/// @param minItemsPerThread Threads are not spawned for workloads smaller than this
+template <typename Fn>
+void ParallelFor( size_t count, size_t minItemsPerThread, const char* threadName, Fn&& fn )
+{
+    const size_t maxThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+    const size_t threadCount = std::min( maxThreadCount, ( count + minItemsPerThread - 1 ) / std::max<size_t>( minItemsPerThread, 1 ) );
+    if ( threadCount <= 1 )
+    {
+        fn( size_t{}, count );
+        return;
+    }
+
+    const size_t chunkSize = ( count + threadCount - 1 ) / threadCount;
+
+    std::vector<std::thread> threads;
+    threads.reserve( threadCount - 1 );
+    for ( size_t i = 1; i < threadCount; ++i )
+    {
+        const size_t begin = i * chunkSize;
+        const size_t end = std::min( count, begin + chunkSize );
+        if ( begin >= end )
+        {
+            break;
+        }
+
+        threads.emplace_back( [&fn, begin, end] { fn( begin, end ); } );
+        SetThreadName( threads.back(), threadName );
+    }
+
+    fn( size_t{}, chunkSize );
+
+    for ( auto& thread: threads )
+    {
+        thread.join();
+    }
+}
+
+} // namespace smp::utils
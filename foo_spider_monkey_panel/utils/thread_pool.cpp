@@ -1,6 +1,7 @@
 #include <stdafx.h>
 #include "thread_pool.h"
 
+#include <utils/scope_helpers.h>
 #include <utils/thread_helpers.h>
 
 namespace smp
@@ -64,6 +65,15 @@ void ThreadPool::ThreadProc()
         --idleThreadsCount;
     };
 
+    // tasks might use COM objects (e.g. MLang in charset detection)
+    const HRESULT hr = CoInitializeEx( nullptr, COINIT_MULTITHREADED );
+    utils::final_action autoCom( [hr] {
+        if ( SUCCEEDED( hr ) )
+        {
+            CoUninitialize();
+        }
+    } );
+
     while ( true )
     {
         if ( isExiting_ )
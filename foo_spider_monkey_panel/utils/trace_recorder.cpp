@@ -0,0 +1,254 @@
+#include <stdafx.h>
+#include "trace_recorder.h"
+
+#include <utils/file_helpers.h>
+
+#include <component_paths.h>
+
+#include <nlohmann/json.hpp>
+
+#include <ctime>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+uint64_t GetTimestamp()
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter( &counter );
+    return static_cast<uint64_t>( counter.QuadPart );
+}
+
+std::u8string GenerateTraceName()
+{
+    const auto curTime = std::time( nullptr );
+    std::tm localTime{};
+    localtime_s( &localTime, &curTime );
+
+    std::array<char, 64> buffer{};
+    std::strftime( buffer.data(), buffer.size(), "%Y%m%d_%H%M%S", &localTime );
+
+    return std::u8string( "trace_" ) + buffer.data();
+}
+
+} // namespace
+
+namespace smp::utils
+{
+
+TraceRecorder& TraceRecorder::GetInstance()
+{
+    static TraceRecorder tr;
+    return tr;
+}
+
+void TraceRecorder::Start()
+{
+    assert( core_api::is_main_thread() );
+    SmpException::ExpectTrue( !isEnabled_, "Tracing is already running" );
+
+    // buffers are reset by their owners when they notice the new session id
+    ++sessionId_;
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency( &frequency );
+    timestampFrequency_ = static_cast<uint64_t>( frequency.QuadPart );
+    startTimestamp_ = GetTimestamp();
+    mainThreadId_ = GetCurrentThreadId();
+
+    isEnabled_ = true;
+}
+
+fs::path TraceRecorder::Stop()
+{
+    assert( core_api::is_main_thread() );
+    SmpException::ExpectTrue( isEnabled_, "Tracing is not running" );
+
+    isEnabled_ = false;
+    WaitForWriters();
+
+    const auto traceDir = fs::u8path( get_profile_path() ) / SMP_UNDERSCORE_NAME / "profiler";
+    std::error_code ec;
+    fs::create_directories( traceDir, ec );
+    SmpException::ExpectTrue( !ec, "Failed to create directory `{}`: {}", traceDir.u8string(), ec.message() );
+
+    const auto tracePath = traceDir / fs::u8path( GenerateTraceName() + ".json" );
+    SaveTrace( tracePath );
+
+    return tracePath;
+}
+
+void TraceRecorder::Begin( const char* category, std::string_view name )
+{
+    Record( EventType::Begin, category, name, 0 );
+}
+
+void TraceRecorder::End( const char* category )
+{
+    Record( EventType::End, category, std::string_view(), 0 );
+}
+
+void TraceRecorder::Counter( const char* category, std::string_view name, double value )
+{
+    Record( EventType::Counter, category, name, value );
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::GetThreadBuffer()
+{
+    thread_local ThreadBuffer* pThreadBuffer = nullptr;
+    if ( !pThreadBuffer )
+    {
+        auto pNewBuffer = std::make_unique<ThreadBuffer>();
+        pNewBuffer->threadId = GetCurrentThreadId();
+        pThreadBuffer = pNewBuffer.get();
+
+        std::lock_guard<std::mutex> lg( threadBuffersMutex_ );
+        threadBuffers_.emplace_back( std::move( pNewBuffer ) );
+    }
+
+    return *pThreadBuffer;
+}
+
+void TraceRecorder::Record( EventType type, const char* category, std::string_view name, double value )
+{
+    auto& threadBuffer = GetThreadBuffer();
+
+    // handshake with Stop(): either it sees `isWriting` and waits for us, or we see that tracing was disabled
+    threadBuffer.isWriting.store( true, std::memory_order_seq_cst );
+    if ( !isEnabled_.load( std::memory_order_seq_cst ) )
+    {
+        threadBuffer.isWriting.store( false, std::memory_order_release );
+        return;
+    }
+
+    if ( const auto sessionId = sessionId_.load( std::memory_order_relaxed );
+         threadBuffer.sessionId != sessionId )
+    { // drop events from the previous session
+        threadBuffer.sessionId = sessionId;
+        threadBuffer.writePos = 0;
+    }
+
+    const auto writePos = threadBuffer.writePos;
+    auto& event = threadBuffer.events[writePos % kEventsPerThread];
+
+    event.timestamp = GetTimestamp();
+    event.category = category;
+    event.value = value;
+    event.type = type;
+
+    auto nameSize = std::min( name.size(), sizeof( event.name ) - 1 );
+    if ( nameSize < name.size() )
+    { // don't cut UTF-8 sequence in the middle
+        while ( nameSize && ( static_cast<uint8_t>( name[nameSize] ) & 0xC0 ) == 0x80 )
+        {
+            --nameSize;
+        }
+    }
+    memcpy( event.name, name.data(), nameSize );
+    event.name[nameSize] = '\0';
+
+    threadBuffer.writePos = writePos + 1;
+    threadBuffer.isWriting.store( false, std::memory_order_release );
+}
+
+void TraceRecorder::WaitForWriters()
+{
+    assert( !isEnabled_ );
+
+    std::lock_guard<std::mutex> lg( threadBuffersMutex_ );
+    for ( const auto& pBuffer: threadBuffers_ )
+    {
+        while ( pBuffer->isWriting.load( std::memory_order_acquire ) )
+        { // writers don't block, so it won't take long
+            std::this_thread::yield();
+        }
+    }
+}
+
+void TraceRecorder::SaveTrace( const fs::path& path )
+{
+    using json = nlohmann::json;
+
+    const auto toUs = [startTimestamp = startTimestamp_, frequency = timestampFrequency_]( uint64_t timestamp ) {
+        return ( timestamp < startTimestamp
+                     ? 0.0
+                     : static_cast<double>( timestamp - startTimestamp ) * 1'000'000 / frequency );
+    };
+
+    json traceEvents = json::array();
+    traceEvents.push_back( { { "name", "process_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", 0 }, { "args", { { "name", SMP_NAME } } } } );
+
+    const auto sessionId = sessionId_.load( std::memory_order_relaxed );
+
+    // no concurrent writers: see WaitForWriters()
+    std::lock_guard<std::mutex> lg( threadBuffersMutex_ );
+    for ( const auto& pBuffer: threadBuffers_ )
+    {
+        if ( pBuffer->sessionId != sessionId )
+        { // thread hasn't recorded anything in this session
+            continue;
+        }
+
+        const auto endPos = pBuffer->writePos;
+        if ( !endPos )
+        {
+            continue;
+        }
+        const auto startPos = ( endPos > kEventsPerThread ? endPos - kEventsPerThread : 0 );
+
+        const std::u8string threadName = ( pBuffer->threadId == mainThreadId_
+                                               ? std::u8string( "Main thread" )
+                                               : fmt::format( "Thread {}", pBuffer->threadId ) );
+        traceEvents.push_back( { { "name", "thread_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", pBuffer->threadId }, { "args", { { "name", threadName } } } } );
+
+        for ( auto i = startPos; i < endPos; ++i )
+        {
+            const auto& event = pBuffer->events[i % kEventsPerThread];
+
+            json eventJson = { { "pid", 1 },
+                               { "tid", pBuffer->threadId },
+                               { "ts", toUs( event.timestamp ) },
+                               { "cat", event.category } };
+            switch ( event.type )
+            {
+            case EventType::Begin:
+            {
+                eventJson["ph"] = "B";
+                eventJson["name"] = event.name;
+                break;
+            }
+            case EventType::End:
+            {
+                eventJson["ph"] = "E";
+                break;
+            }
+            case EventType::Counter:
+            {
+                eventJson["ph"] = "C";
+                eventJson["name"] = event.name;
+                eventJson["args"] = { { "value", event.value } };
+                break;
+            }
+            default:
+            {
+                assert( false );
+                continue;
+            }
+            }
+
+            traceEvents.push_back( std::move( eventJson ) );
+        }
+    }
+
+    const json trace = { { "traceEvents", std::move( traceEvents ) },
+                         { "displayTimeUnit", "ms" } };
+
+    SmpException::ExpectTrue( smp::file::WriteFile( path.wstring().c_str(), trace.dump(), false ),
+                              "Failed to write file: {}",
+                              path.u8string() );
+}
+
+} // namespace smp::utils
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace smp::utils
+{
+
+/// @brief Records begin/end spans and counters into per-thread ring buffers,
+///        which are then saved as Chrome `trace_event` JSON.
+/// @details Writing an event is lock-free: each thread owns its buffer (allocated on first event).
+///          Buffers are only reset by their owning threads (on the first event of a new session),
+///          and Stop() waits for all writers to leave Record() before reading the buffers.
+///          Recording methods must not be called when tracing is disabled (see IsEnabled()),
+///          use TraceSpan and SMP_TRACE_* macros instead.
+class TraceRecorder
+{
+public:
+    enum class EventType : uint8_t
+    {
+        Begin,
+        End,
+        Counter
+    };
+
+public:
+    ~TraceRecorder() = default;
+    TraceRecorder( const TraceRecorder& ) = delete;
+    TraceRecorder& operator=( const TraceRecorder& ) = delete;
+
+    static TraceRecorder& GetInstance();
+
+    /// @brief The only thing that is checked when tracing is disabled
+    static bool IsEnabled()
+    {
+        return isEnabled_.load( std::memory_order_relaxed );
+    }
+
+    /// @brief Id of the current (or the last) tracing session, changes on every Start().
+    ///        Can be used to drop end events of the spans that were started in another session.
+    static uint32_t GetSessionId()
+    {
+        return sessionId_.load( std::memory_order_relaxed );
+    }
+
+    /// @throw smp::SmpException
+    void Start();
+    /// @brief Stops tracing and saves collected events to `<profile>\foo_spider_monkey_panel\profiler\`.
+    /// @return Path of the saved trace file
+    /// @throw smp::SmpException
+    std::filesystem::path Stop();
+
+    /// @param category Must have static storage duration
+    /// @param name Is copied (truncated if needed)
+    void Begin( const char* category, std::string_view name );
+    void End( const char* category );
+    /// @param category Must have static storage duration
+    /// @param name Is copied (truncated if needed)
+    void Counter( const char* category, std::string_view name, double value );
+
+private:
+    TraceRecorder() = default;
+
+    struct Event
+    {
+        uint64_t timestamp;
+        const char* category;
+        double value;
+        EventType type;
+        char name[39];
+    };
+    static_assert( sizeof( Event ) == 64 );
+
+    static constexpr size_t kEventsPerThread = 16 * 1024;
+
+    struct ThreadBuffer
+    {
+        uint32_t threadId = 0;
+        // set by the owning thread while it's inside Record()
+        std::atomic_bool isWriting = false;
+        // sessionId and writePos are modified only by the owning thread while `isWriting` is set
+        uint32_t sessionId = 0;
+        uint64_t writePos = 0;
+        std::array<Event, kEventsPerThread> events;
+    };
+
+    ThreadBuffer& GetThreadBuffer();
+    void Record( EventType type, const char* category, std::string_view name, double value );
+    /// @brief Waits until all threads that were writing events when tracing was disabled are finished
+    void WaitForWriters();
+
+    /// @throw smp::SmpException
+    void SaveTrace( const std::filesystem::path& path );
+
+private:
+    inline static std::atomic_bool isEnabled_ = false;
+    // 0 is never used as a session id, so that new buffers are always reset on first event
+    inline static std::atomic<uint32_t> sessionId_ = 0;
+
+    uint64_t startTimestamp_ = 0;
+    uint64_t timestampFrequency_ = 1;
+    uint32_t mainThreadId_ = 0;
+
+    std::mutex threadBuffersMutex_;
+    // Buffers are never freed, since threads might still be holding them
+    std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers_;
+};
+
+/// @brief Records a begin event on construction and an end event on destruction.
+///        Does nothing, if tracing was disabled when span was created.
+class TraceSpan
+{
+public:
+    /// @param category Must have static storage duration
+    TraceSpan( const char* category, std::string_view name )
+        : category_( TraceRecorder::IsEnabled() ? category : nullptr )
+        , sessionId_( TraceRecorder::GetSessionId() )
+    {
+        if ( category_ )
+        {
+            TraceRecorder::GetInstance().Begin( category_, name );
+        }
+    }
+    ~TraceSpan()
+    {
+        if ( category_ && TraceRecorder::IsEnabled() && TraceRecorder::GetSessionId() == sessionId_ )
+        {
+            TraceRecorder::GetInstance().End( category_ );
+        }
+    }
+
+    TraceSpan( const TraceSpan& ) = delete;
+    TraceSpan& operator=( const TraceSpan& ) = delete;
+
+private:
+    const char* category_;
+    uint32_t sessionId_;
+};
+
+} // namespace smp::utils
+
+#define SMP_TRACE_CONCAT_HELPER( a, b ) a##b
+#define SMP_TRACE_CONCAT( a, b ) SMP_TRACE_CONCAT_HELPER( a, b )
+
+/// @brief Traces the rest of the current scope as a span.
+///        `name` is evaluated only when tracing is enabled.
+#define SMP_TRACE_SCOPE( category, name ) \
+    smp::utils::TraceSpan SMP_TRACE_CONCAT( autoTraceSpan_, __LINE__ )( category, smp::utils::TraceRecorder::IsEnabled() ? std::string_view( name ) : std::string_view() )
+
+/// @brief Records counter value.
+///        `value` is evaluated only when tracing is enabled.
+#define SMP_TRACE_COUNTER( category, name, value )                                  \
+    do                                                                              \
+    {                                                                               \
+        if ( smp::utils::TraceRecorder::IsEnabled() )                               \
+        {                                                                           \
+            smp::utils::TraceRecorder::GetInstance().Counter( category, name, value ); \
+        }                                                                           \
+    } while ( false )